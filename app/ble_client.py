@@ -83,29 +83,45 @@ async def _wait_for_services(client: "BleakClient", tries: int = 40, delay: floa
     return None
 
 # ---------- OTA over BLE ---------- #
-async def ble_ota_upload(client, ctrl_uuid: str, data_uuid: str, tx_uuid: str, bin_path):
+async def ble_ota_upload(client, ctrl_uuid: str, data_uuid: str, tx_uuid: str, bin_path,
+                         bulk: bool = True, acks: Optional[asyncio.Queue] = None):
+    """bulk asks for header-free frames of the full ATT payload; the device answers
+    "ACK START BULK <n>" or plain "ACK START" (framed GATT path, also the fallback)."""
     data  = bin_path.read_bytes()
     size  = len(data)
     crc32 = zlib.crc32(data) & 0xFFFFFFFF
     print(f"[BLE-OTA] {bin_path.name}  {size} bytes  CRC 0x{crc32:08X}")
 
+    start = f"BL_OTA START {size} {crc32:08X}" + (" BULK" if bulk else "")
     try:
-        await client.write_gatt_char(ctrl_uuid, f"BL_OTA START {size} {crc32:08X}".encode(), response=True)
+        await client.write_gatt_char(ctrl_uuid, start.encode(), response=True)
     except Exception as e:
         print(f"[BLE-OTA] START failed: {e}")
         return False
 
     mtu = getattr(client, "mtu_size", None) or 23
     frame_payload = max(8, min(180, mtu - 3 - 6))
-
+    raw = False
+    if bulk and acks is not None:
+        try:
+            ack = await asyncio.wait_for(acks.get(), timeout=2.0)
+        except asyncio.TimeoutError:
+            ack = ""
+        parts = ack.split()
+        if len(parts) == 4 and parts[2] == "BULK" and parts[3].isdigit():
+            raw = True
+            frame_payload = max(8, min(int(parts[3]), mtu - 3))
+    print(f"[BLE-OTA] {'bulk' if raw else 'framed'} frames of {frame_payload} bytes")
+
+    t0 = time.monotonic()
     seq = 0
     off = 0
     last_prog = 0
     try:
         while off < size:
             chunk = data[off:off+frame_payload]
-            hdr = struct.pack("<IH", seq, len(chunk))
-            await client.write_gatt_char(data_uuid, hdr + chunk, response=False)
+            frame = chunk if raw else struct.pack("<IH", seq, len(chunk)) + chunk
+            await client.write_gatt_char(data_uuid, frame, response=False)
             seq += 1
             off += len(chunk)
 
@@ -122,6 +138,8 @@ async def ble_ota_upload(client, ctrl_uuid: str, data_uuid: str, tx_uuid: str, b
             pass
         return False
 
+    dt = max(time.monotonic() - t0, 1e-3)
+    print(f"[BLE-OTA] {size} bytes in {dt:.1f} s: {size / dt / 1024:.2f} KB/s ({'bulk' if raw else 'gatt'})")
     await asyncio.sleep(0.45)
 
     for attempt in range(2):
@@ -154,6 +172,7 @@ async def ble_session() -> bool:
 
     wifi_ok_event = asyncio.Event()
     expect_none_until = 0.0
+    ota_acks: asyncio.Queue = asyncio.Queue()
 
     async def _notify(sender, data: bytearray):
         nonlocal expect_none_until
@@ -165,11 +184,26 @@ async def ble_session() -> bool:
             return
 
         print(f"[BLE] {msg}")
+        if msg.startswith("ACK START"):
+            ota_acks.put_nowait(msg)
         low = msg.lower()
         if is_wifi_ok(msg) or (low == "none" and time.monotonic() < expect_none_until):
             await asyncio.sleep(0.4)
             wifi_ok_event.set()
 
+    # TX notifications are a byte stream: one may carry several lines or part of one.
+    tx_buf = bytearray()
+
+    async def _notify_tx(sender, data: bytearray):
+        tx_buf.extend(data)
+        while True:
+            i = tx_buf.find(b"\n")
+            if i < 0:
+                break
+            line = bytes(tx_buf[:i])
+            del tx_buf[:i + 1]
+            await _notify(sender, bytearray(line))
+
     async with BleakClient(dev) as client:
         print(f"[BLE] Connected to {getattr(dev, 'address', 'unknown')} ({getattr(dev, 'name', '')}).")
 
@@ -200,7 +234,7 @@ async def ble_session() -> bool:
         # Enable notifications (TX/ERR/ALERT always; DHT if present)
         notify_ok = False
         try:
-            await client.start_notify(tx_uuid, _notify)
+            await client.start_notify(tx_uuid, _notify_tx)
             notify_ok = True
             try:
                 if err_uuid:
@@ -270,6 +304,10 @@ async def ble_session() -> bool:
             if low.startswith(("/ota ", "ota ")):
                 import pathlib
                 path_str = line.split(None, 1)[1] if len(line.split(None, 1)) == 2 else ""
+                # "/ota <file> gatt" forces the framed path (for comparing throughput).
+                bulk = True
+                if path_str.lower().endswith(" gatt"):
+                    path_str, bulk = path_str[:-5].rstrip(), False
                 bin_path = pathlib.Path(path_str)
                 if not bin_path.is_file():
                     print("[BLE-OTA] file not found.")
@@ -278,7 +316,10 @@ async def ble_session() -> bool:
                     print("[BLE-OTA] Device lacks BLE-OTA characteristics.")
                     continue
 
-                ok = await ble_ota_upload(client, ota_ctrl_uuid, ota_data_uuid, tx_uuid, bin_path)
+                while not ota_acks.empty():
+                    ota_acks.get_nowait()
+                ok = await ble_ota_upload(client, ota_ctrl_uuid, ota_data_uuid, tx_uuid, bin_path,
+                                          bulk=bulk, acks=ota_acks)
                 if ok:
                     await asyncio.sleep(2.0)
                     return False
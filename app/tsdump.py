@@ -0,0 +1,118 @@
+"""Decoder for the `tsdump <from> <to>` binary stream (format: components/tsstore/include/ts_codec.h).
+
+Stream: <len:le16><block> chunks, a zero length at the end. Block: header
+<magic "TSB1"><seq:le32><t0:le32><~seq:le32>, then records
+<id<<2 | n-1:u8><dt varint><n x zigzag varint delta> until erased flash (0xFF) or the end.
+
+    python3 app/tsdump.py dump.bin [--expect samples.txt]
+prints one "<ts> <id> <v>..." line per sample (store seconds, raw tenths); with --expect
+it compares against such a file instead and exits 1 on a mismatch.
+"""
+import struct, sys
+from typing import Iterator, List, Optional, Tuple
+
+TS_MAGIC = b"TSB1"
+TS_HDR_SIZE = 16
+TS_MAX_IDS = 16
+
+Sample = Tuple[int, int, List[int]]   # (ts, id, values)
+
+# ---------- Codec ---------- #
+def _varint(buf: bytes, pos: int) -> Tuple[Optional[int], int]:
+    v = 0
+    for i in range(5):
+        if pos >= len(buf):
+            return None, pos
+        b = buf[pos]
+        pos += 1
+        v |= (b & 0x7F) << (7 * i)
+        if not b & 0x80:
+            return v & 0xFFFFFFFF, pos
+    return None, pos
+
+def _s32(v: int) -> int:
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+def _unzigzag(z: int) -> int:
+    return (z >> 1) ^ -(z & 1)
+
+def decode_block(blk: bytes) -> Tuple[int, int, List[Sample]]:
+    """(seq, t0, samples). Stops at the first erased or damaged record, like the device."""
+    if len(blk) < TS_HDR_SIZE or blk[:4] != TS_MAGIC:
+        raise ValueError("not a TSB1 block")
+    seq, t0, nseq = struct.unpack_from("<III", blk, 4)
+    if nseq != (~seq & 0xFFFFFFFF):
+        raise ValueError("torn block header")
+    prev = {}
+    last_ts = t0
+    out: List[Sample] = []
+    pos = TS_HDR_SIZE
+    while pos < len(blk) and blk[pos] != 0xFF:
+        h = blk[pos]
+        sid, n = h >> 2, (h & 3) + 1
+        dt, p = _varint(blk, pos + 1)
+        if sid >= TS_MAX_IDS or dt is None:
+            break
+        vals = []
+        for i in range(n):
+            z, p = _varint(blk, p)
+            if z is None:
+                break
+            vals.append(_s32(prev.get((sid, i), 0) + _unzigzag(z)))
+        if len(vals) != n:
+            break
+        last_ts = (last_ts + dt) & 0xFFFFFFFF
+        for i, v in enumerate(vals):
+            prev[(sid, i)] = v
+        out.append((last_ts, sid, vals))
+        pos = p
+    return seq, t0, out
+
+def iter_chunks(data: bytes) -> Iterator[bytes]:
+    """Blocks of a tsdump stream, up to the zero length."""
+    pos = 0
+    while pos + 2 <= len(data):
+        (n,) = struct.unpack_from("<H", data, pos)
+        pos += 2
+        if n == 0:
+            return
+        if pos + n > len(data):
+            raise ValueError("stream cut short")
+        yield data[pos:pos + n]
+        pos += n
+    raise ValueError("no end marker")
+
+def decode_stream(data: bytes) -> List[Sample]:
+    samples: List[Sample] = []
+    for blk in iter_chunks(data):
+        samples.extend(decode_block(blk)[2])
+    return samples
+
+# ---------- CLI ---------- #
+def _fmt(s: Sample) -> str:
+    return " ".join(str(x) for x in (s[0], s[1], *s[2]))
+
+def main(argv: List[str]) -> int:
+    if not argv or argv[0].startswith("-"):
+        print(__doc__)
+        return 2
+    samples = decode_stream(open(argv[0], "rb").read())
+    if len(argv) == 3 and argv[1] == "--expect":
+        want = [l.strip() for l in open(argv[2]) if l.strip()]
+        got = [_fmt(s) for s in samples]
+        for i, (g, w) in enumerate(zip(got, want)):
+            if g != w:
+                print(f"sample {i}: got '{g}', expected '{w}'")
+                return 1
+        if len(got) != len(want):
+            print(f"{len(got)} samples, expected {len(want)}")
+            return 1
+        print(f"{len(got)} samples match")
+        return 0
+    for s in samples:
+        print(_fmt(s))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -26,15 +26,33 @@
 #ifndef NVS_KEY_WIFI_PASSWORD
 #define NVS_KEY_WIFI_PASSWORD "password"
 #endif
+#ifndef NVS_KEY_WIFI_FAST
+#define NVS_KEY_WIFI_FAST "fastlink"  /* last-good BSSID/channel/IP blob */
+#endif
 /* Wi-Fi reconnect tuning (centralized). */
+/* Per-reason policies in net/wifi/wifi_sched.c scale from these. */
 #ifndef WIFI_RECONN_BASE_MS
-#define WIFI_RECONN_BASE_MS  500   /* initial delay. */
+#define WIFI_RECONN_BASE_MS  500   /* backoff floor. */
 #endif
 #ifndef WIFI_RECONN_MAX_MS
-#define WIFI_RECONN_MAX_MS   30000 /* cap at 30s. */
+#define WIFI_RECONN_MAX_MS   30000 /* generic cap at 30s. */
 #endif
-#ifndef WIFI_RECONN_JITTER_PCT
-#define WIFI_RECONN_JITTER_PCT 10  /* ±10% jitter; set 0 to disable. */
+#ifndef WIFI_RECONN_PARK_MS
+#define WIFI_RECONN_PARK_MS  300000 /* retry interval once a policy gives up. */
+#endif
+
+/* TCP listener: client table size, rebind poll and retry after a failed bind. */
+#ifndef TCP_MAX_CLIENTS
+#define TCP_MAX_CLIENTS      4
+#endif
+#ifndef TCP_LISTEN_POLL_MS
+#define TCP_LISTEN_POLL_MS   250
+#endif
+#ifndef TCP_REBIND_RETRY_MS
+#define TCP_REBIND_RETRY_MS  1000
+#endif
+#ifndef TCP_SEND_TIMEOUT_S
+#define TCP_SEND_TIMEOUT_S   2     /* bounds pushes to a stalled client */
 #endif
 
 #ifndef OTA_RECV_TIMEOUT_S
@@ -53,4 +71,101 @@
 #endif
 #ifndef DHT_PERIOD_MS
 #define DHT_PERIOD_MS   2000
-#endif
\ No newline at end of file
+#endif
+/* Outlier filter: median window (odd, 1 = off) and max change per second in tenths. */
+#ifndef DHT_MEDIAN_N
+#define DHT_MEDIAN_N           3
+#endif
+#ifndef DHT_ROC_T_DC
+#define DHT_ROC_T_DC           10    /* 1.0 °C/s */
+#endif
+#ifndef DHT_ROC_RH_DP
+#define DHT_ROC_RH_DP          50    /* 5.0 %RH/s */
+#endif
+/* Flash time-series (spiffs partition): at most one stored sample per sensor per period. */
+#ifndef TS_LOG_EVERY_S
+#define TS_LOG_EVERY_S         10
+#endif
+/* BLE DHT-CCC push filter: deadbands in tenths (°C / %RH), max silence. */
+#ifndef DHT_BLE_DB_T_DC
+#define DHT_BLE_DB_T_DC        2
+#endif
+#ifndef DHT_BLE_DB_RH_DP
+#define DHT_BLE_DB_RH_DP       10
+#endif
+#ifndef DHT_BLE_HEARTBEAT_MS
+#define DHT_BLE_HEARTBEAT_MS   60000
+#endif
+/* BLE TX notify queue: bytes buffered per link, notifications in flight before waiting for the stack. */
+#ifndef BLE_TXQ_BYTES
+#define BLE_TXQ_BYTES          1024
+#endif
+#ifndef BLE_TX_WINDOW
+#define BLE_TX_WINDOW          2
+#endif
+/* Local ATT MTU offered in the exchange; notifications carry up to MTU-3 (max 512). */
+#ifndef BLE_LOCAL_MTU
+#define BLE_LOCAL_MTU          517
+#endif
+/* Concurrent BLE centrals; keep <= CONFIG_BTDM_CTRL_BLE_MAX_CONN and CONFIG_BT_ACL_CONNECTIONS. */
+#ifndef BLE_MAX_CONN
+#define BLE_MAX_CONN           3
+#endif
+/* BLE RX/WIFI/OTA-CTRL writes are copied into preallocated slots and handled by the BLE
+ * worker, so GATT callbacks return at once. 0 = handle them inline (old behaviour). */
+#ifndef BLE_DEFER_WRITES
+#define BLE_DEFER_WRITES       1
+#endif
+#ifndef BLE_DEFER_SLOTS
+#define BLE_DEFER_SLOTS        4
+#endif
+/* Advertising status block: at most one payload update per this many ms. */
+#ifndef BLE_TLM_MIN_MS
+#define BLE_TLM_MIN_MS         5000
+#endif
+/* BLE-OTA bulk mode ("BL_OTA START <size> <crc> BULK"): header-free DATA frames of up to the
+ * ATT payload, a short connection interval (1.25 ms units) and LL data length for the transfer.
+ * 0 = always the framed GATT path. */
+#ifndef BLE_OTA_BULK
+#define BLE_OTA_BULK           1
+#endif
+#ifndef BLE_OTA_BULK_ITVL_MIN
+#define BLE_OTA_BULK_ITVL_MIN  6
+#endif
+#ifndef BLE_OTA_BULK_ITVL_MAX
+#define BLE_OTA_BULK_ITVL_MAX  12
+#endif
+#ifndef BLE_OTA_LL_OCTETS
+#define BLE_OTA_LL_OCTETS      251
+#endif
+/* Simulated host (-DBLE_PORT=sim, include/ble_sim.h): the central's interval until it is
+ * asked for another (1.25 ms units), LL packets per connection event, and notifications
+ * the host holds before refusing more. */
+#ifndef BLE_SIM_ITVL
+#define BLE_SIM_ITVL           24
+#endif
+#ifndef BLE_SIM_PKTS_PER_EVT
+#define BLE_SIM_PKTS_PER_EVT   4
+#endif
+#ifndef BLE_SIM_INFLIGHT
+#define BLE_SIM_INFLIGHT       8
+#endif
+/* Lifeboat advertising: 20 ms for FAST_MS after RECOVERY entry or a disconnect, 152 ms until
+ * MID_MS, then ~1 s. Around a Wi-Fi connect attempt (LEAD_MS before, GUARD_MS long) it drops
+ * to ~1 s so the shared radio goes to Wi-Fi. */
+#ifndef BLE_ADV_FAST_MS
+#define BLE_ADV_FAST_MS        30000
+#endif
+#ifndef BLE_ADV_MID_MS
+#define BLE_ADV_MID_MS         120000
+#endif
+#ifndef BLE_ADV_WIFI_LEAD_MS
+#define BLE_ADV_WIFI_LEAD_MS   300
+#endif
+#ifndef BLE_ADV_WIFI_GUARD_MS
+#define BLE_ADV_WIFI_GUARD_MS  4000
+#endif
+/* Longest gap between schedule/watchdog ticks. */
+#ifndef BLE_ADV_TICK_MAX_MS
+#define BLE_ADV_TICK_MAX_MS    5000
+#endif
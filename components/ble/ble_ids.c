@@ -1,15 +1,8 @@
 #include "ble_ids.h"
+#include "gatt_table.h"
 
-/* Base efbe0000-fbfb-fbfb-fb4b-494545434956 with tails 0000..0700. */
-const uint8_t SERVICE_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x00,0xBE,0xEF };
-const uint8_t RX_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x01,0xBE,0xEF };
-const uint8_t TX_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x02,0xBE,0xEF };
-const uint8_t WIFI_CRED_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x03,0xBE,0xEF };
-const uint8_t ERRSRC_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x04,0xBE,0xEF };
-const uint8_t ALERT_UUID[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x05,0xBE,0xEF };
-const uint8_t UUID_EFBE_OTA_CTRL[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x06,0xBE,0xEF };
-const uint8_t UUID_EFBE_OTA_DATA[16] = { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB,0x00,0x07,0xBE,0xEF };
-// matches efbe0800-fbfb-fbfb-fb4b-494545434956
-const uint8_t DHT_UUID[16] = {
-    0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB, 0x00,0x08,0xBE,0xEF
-};
\ No newline at end of file
+/* Base efbe0000-fbfb-fbfb-fb4b-494545434956; characteristic tails come from gatt_table.h. */
+const uint8_t SERVICE_UUID[16] = GATT_UUID128(0x0000);
+
+#define GATT_UUID_DEF(n, tail, ...) const uint8_t n##_UUID[16] = GATT_UUID128(tail);
+GATT_SVC_TABLE(GATT_UUID_DEF, GATT_UUID_DEF)
@@ -0,0 +1,112 @@
+// ble_advsched.c, advertising phases + airtime accounting (no RTOS calls; host-buildable).
+#include <string.h>
+#include "app_cfg.h"
+#include "ble_advsched.h"
+#include "ble_tlm.h"        // BLE_TLM_ADV_LEN
+
+/* 0.625 ms units. 20 ms for quick discovery; 152.5 and 1022.5 ms (0x00F4, 0x0664) are
+ * the usual phone-friendly background values. YIELD stays connectable at the slow rate. */
+static const uint16_t s_int[BLE_ADV_PHASES][2] = {
+    [BLE_ADV_FAST]  = { 0x0020, 0x0030 },
+    [BLE_ADV_MID]   = { 0x00F4, 0x0100 },
+    [BLE_ADV_SLOW]  = { 0x0664, 0x0690 },
+    [BLE_ADV_YIELD] = { 0x0664, 0x0690 },
+};
+
+/* One ADV_IND on each of 3 channels at 1 Mbit/s: preamble 1 + AA 4 + header 2 +
+ * AdvA 6 + data + CRC 3 bytes. Scan responses and connection events are not counted. */
+#define ADV_PDU_US    ((1u + 4u + 2u + 6u + BLE_TLM_ADV_LEN + 3u) * 8u)
+#define ADV_EVENT_US  (3u * ADV_PDU_US)
+#define ADV_DELAY_US  5000u     /* mean of the 0..10 ms advDelay the controller adds */
+
+#define TICK_MIN_MS   100u
+
+void ble_advsched_interval(ble_adv_phase_t p, uint16_t *min_units, uint16_t *max_units) {
+    if ((unsigned)p >= BLE_ADV_PHASES) p = BLE_ADV_SLOW;
+    if (min_units) *min_units = s_int[p][0];
+    if (max_units) *max_units = s_int[p][1];
+}
+
+/* Mean time between advertising events for a phase. */
+static uint32_t period_us(ble_adv_phase_t p) {
+    return ((uint32_t)s_int[p][0] + s_int[p][1]) * 625u / 2u + ADV_DELAY_US;
+}
+
+void ble_advsched_reset(ble_advsched_t *s, uint32_t now_ms) {
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    s->burst_ms = now_ms;
+    s->last_ms  = now_ms;
+    s->phase    = BLE_ADV_FAST;
+    s->st.phase = BLE_ADV_FAST;
+}
+
+void ble_advsched_burst(ble_advsched_t *s, uint32_t now_ms) {
+    if (!s) return;
+    s->burst_ms = now_ms;
+    s->st.bursts++;
+}
+
+void ble_advsched_wifi(ble_advsched_t *s, uint32_t now_ms, uint32_t in_ms) {
+    if (!s) return;
+    uint32_t lead = in_ms < BLE_ADV_WIFI_LEAD_MS ? in_ms : BLE_ADV_WIFI_LEAD_MS;
+    s->wifi_from = now_ms + in_ms - lead;
+    s->wifi_len  = lead + BLE_ADV_WIFI_GUARD_MS;
+}
+
+static void account(ble_advsched_t *s, uint32_t dt_ms) {
+    s->st.ms[s->phase] += dt_ms;
+    if (!s->on || !dt_ms) return;
+    uint64_t us = (uint64_t)dt_ms * 1000u + s->event_rem;
+    uint32_t per = period_us((ble_adv_phase_t)s->phase);
+    uint32_t ev = (uint32_t)(us / per);
+    s->event_rem = (uint32_t)(us % per);
+    s->st.events += ev;
+    s->st.air_us += (uint64_t)ev * ADV_EVENT_US;
+    s->st.on_ms  += dt_ms;
+}
+
+ble_adv_phase_t ble_advsched_eval(ble_advsched_t *s, uint32_t now_ms, bool on, uint32_t *next_ms) {
+    if (!s) return BLE_ADV_SLOW;
+    account(s, (uint32_t)(now_ms - s->last_ms));
+    s->last_ms = now_ms;
+    s->on = on;
+
+    uint32_t next = BLE_ADV_TICK_MAX_MS;
+    ble_adv_phase_t p;
+    uint32_t since = (uint32_t)(now_ms - s->burst_ms);
+    if (since < BLE_ADV_FAST_MS) {
+        p = BLE_ADV_FAST;
+        if (BLE_ADV_FAST_MS - since < next) next = BLE_ADV_FAST_MS - since;
+    } else if (since < BLE_ADV_MID_MS) {
+        p = BLE_ADV_MID;
+        if (BLE_ADV_MID_MS - since < next) next = BLE_ADV_MID_MS - since;
+    } else {
+        p = BLE_ADV_SLOW;
+    }
+
+    if (s->wifi_len) {
+        uint32_t into = (uint32_t)(now_ms - s->wifi_from);
+        uint32_t ahead = (uint32_t)(s->wifi_from - now_ms);
+        if (into < s->wifi_len) {
+            if (s->phase != BLE_ADV_YIELD) s->st.yields++;
+            p = BLE_ADV_YIELD;
+            if (s->wifi_len - into < next) next = s->wifi_len - into;
+        } else if (ahead && ahead < 0x80000000u) {
+            if (ahead < next) next = ahead;      // window still ahead: wake at its start
+        } else {
+            s->wifi_len = 0;                     // window over
+        }
+    }
+
+    if (next < TICK_MIN_MS) next = TICK_MIN_MS;
+    if (next_ms) *next_ms = next;
+    /* Carry the part-event into the new period as the same fraction of an event; as us it
+     * would be worth up to ~35 FAST events after a SLOW stretch. */
+    if (p != s->phase) {
+        s->event_rem = (uint32_t)((uint64_t)s->event_rem * period_us(p) / period_us((ble_adv_phase_t)s->phase));
+    }
+    s->phase = (uint8_t)p;
+    s->st.phase = (uint8_t)p;
+    return p;
+}
@@ -0,0 +1,42 @@
+// ble_tlm.c, advertising telemetry encoder + refresh gate (no RTOS calls; host-buildable).
+#include <string.h>
+#include "ble_tlm.h"
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+size_t ble_tlm_build_adv(const ble_tlm_t *t, const uint8_t uuid128[16], uint8_t *out, size_t cap) {
+    if (!t || !uuid128 || !out || cap < BLE_TLM_ADV_LEN) return 0;
+    uint8_t *p = out;
+    *p++ = 2;  *p++ = 0x01;  *p++ = 0x06;             // flags
+    *p++ = 1 + 16 + BLE_TLM_LEN;  *p++ = 0x21;        // service data, 128-bit UUID
+    memcpy(p, uuid128, 16);  p += 16;
+    *p++ = (uint8_t)((BLE_TLM_VER << 4) | (t->mode & 0x0F));
+    *p++ = t->errsrc;
+    *p++ = t->alert_seq;
+    *p++ = t->alert_code;
+    put_le16(p, (uint16_t)t->t_dc);  p += 2;
+    put_le16(p, t->rh_dp);           p += 2;
+    put_le16(p, t->fw);              p += 2;
+    return (size_t)(p - out);
+}
+
+static bool same(const ble_tlm_t *a, const ble_tlm_t *b) {
+    return a->mode == b->mode && a->errsrc == b->errsrc && a->alert_seq == b->alert_seq &&
+           a->alert_code == b->alert_code && a->t_dc == b->t_dc && a->rh_dp == b->rh_dp &&
+           a->fw == b->fw;
+}
+
+bool ble_tlm_due(ble_tlm_gate_t *g, const ble_tlm_t *cur, uint32_t now_ms, uint32_t min_ms) {
+    if (!g || !cur) return false;
+    if (g->sent) {
+        if (same(&g->last, cur)) return false;
+        if ((uint32_t)(now_ms - g->last_ms) < min_ms) return false;
+    }
+    g->last    = *cur;
+    g->last_ms = now_ms;
+    g->sent    = true;
+    return true;
+}
@@ -0,0 +1,85 @@
+// components/ble/fallback/fb_adv.c
+// Applies the advertising schedule (ble_advsched.c): interval per phase, Wi-Fi yield windows.
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ble_fallback.h"
+#include "ble_advsched.h"
+#include "fb_priv.h"
+
+static const char *TAG = "BLE.fb.adv";
+
+static const char *const s_name[BLE_ADV_PHASES] = { "FAST", "MID", "SLOW", "YIELD" };
+
+static ble_advsched_t s_sched;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void fb_adv_sched_reset(void) {
+    portENTER_CRITICAL(&s_mux);
+    ble_advsched_reset(&s_sched, now_ms());
+    portEXIT_CRITICAL(&s_mux);
+    ble_post(BLE_EVT_ADV_SCHED);
+}
+
+void fb_adv_burst(void) {
+    portENTER_CRITICAL(&s_mux);
+    ble_advsched_burst(&s_sched, now_ms());
+    portEXIT_CRITICAL(&s_mux);
+    ble_post(BLE_EVT_ADV_SCHED);
+}
+
+void ble_adv_on_wifi_attempt(uint32_t in_ms) {
+    if (!s_lifeboat_enabled) return;
+    portENTER_CRITICAL(&s_mux);
+    ble_advsched_wifi(&s_sched, now_ms(), in_ms);
+    portEXIT_CRITICAL(&s_mux);
+    ble_post(BLE_EVT_ADV_SCHED);
+}
+
+/* Worker context: pick the phase, restart advertising if the interval changed, and
+ * re-arm the watch timer for the next phase boundary. */
+void fb_adv_sched_apply(void) {
+    if (!s_stack_ready || !s_lifeboat_enabled) return;
+    uint32_t next = 0;
+    portENTER_CRITICAL(&s_mux);
+    ble_adv_phase_t p = ble_advsched_eval(&s_sched, now_ms(), s_adv_running, &next);
+    portEXIT_CRITICAL(&s_mux);
+
+    uint16_t lo, hi;
+    ble_advsched_interval(p, &lo, &hi);
+    if (lo != s_adv_itvl_min || hi != s_adv_itvl_max) {
+        s_adv_itvl_min = lo;
+        s_adv_itvl_max = hi;
+        ESP_LOGI(TAG, "ADV %s: %u-%u ms", s_name[p],
+                 (unsigned)(lo * 5u / 8u), (unsigned)(hi * 5u / 8u));
+        fb_adv_restart();
+    }
+    if (s_adv_watch) xTimerChangePeriod(s_adv_watch, pdMS_TO_TICKS(next), 0);
+}
+
+void ble_adv_get_stats(ble_adv_stats_t *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_sched.st;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void fb_adv_log_stats(void) {
+    ble_adv_stats_t st;
+    ble_adv_get_stats(&st);
+    uint32_t total = 0;
+    for (int i = 0; i < BLE_ADV_PHASES; ++i) total += st.ms[i];
+    ESP_LOGI(TAG, "ADV airtime %u ms in %u s (%u ppm), %u events; fast=%us mid=%us slow=%us yield=%us, "
+             "bursts=%u yields=%u",
+             (unsigned)(st.air_us / 1000), (unsigned)(total / 1000),
+             (unsigned)(total ? st.air_us * 1000u / total : 0), (unsigned)st.events,
+             (unsigned)(st.ms[BLE_ADV_FAST] / 1000), (unsigned)(st.ms[BLE_ADV_MID] / 1000),
+             (unsigned)(st.ms[BLE_ADV_SLOW] / 1000), (unsigned)(st.ms[BLE_ADV_YIELD] / 1000),
+             (unsigned)st.bursts, (unsigned)st.yields);
+}
@@ -2,12 +2,12 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
+#include "freertos/semphr.h"
 
-#include "esp_bt.h"
-#include "esp_bt_main.h"
-#include "esp_gap_ble_api.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdbool.h>
 
@@ -15,6 +15,7 @@
 #include "gatt_server.h"    // gatt_server_init()
 #include "ble_ids.h"        // SERVICE_UUID
 #include "fb_priv.h"        // worker, GAP bridge, watchdog, shared state
+#include "ble_port.h"       // host backend (Bluedroid / NimBLE / sim)
 
 static const char *TAG = "BLE.fb.core";
 
@@ -22,7 +23,7 @@ static const char *TAG = "BLE.fb.core";
 bool s_stack_ready = false;
 bool s_adv_ready = false;
 bool s_adv_running = false;
-bool s_connected = false;
+uint8_t s_links = 0;
 bool s_lifeboat_enabled = false;
 bool s_adv_start_deferred = false;
 
@@ -31,14 +32,35 @@ TimerHandle_t s_adv_watch = NULL;
 uint8_t  s_adv_uuid[16];
 uint8_t  s_adv_cfg_done = 0;
 
-esp_ble_adv_params_t s_adv_params = {
-    .adv_int_min = 0x20,                 // ~20 ms
-    .adv_int_max = 0x40,                 // ~40 ms
-    .adv_type = ADV_TYPE_IND,
-    .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
-    .channel_map = ADV_CHNL_ALL,
-    .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
-};
+/* Connectable undirected, all channels; the interval is rewritten per phase by fb_adv.c
+ * and is FAST until the first evaluation. */
+uint16_t s_adv_itvl_min = 0x20;          // 20 ms
+uint16_t s_adv_itvl_max = 0x30;          // 30 ms
+
+/* init/stop run on whichever task asks (syscoord worker, command task); one at a time. */
+static SemaphoreHandle_t s_life_lock = NULL;
+static portMUX_TYPE s_life_mux = portMUX_INITIALIZER_UNLOCKED;
+static ble_fallback_stats_t s_life;
+static bool s_borrowed = false;   /* up through ble_fallback_borrow(), not claimed since */
+
+static void life_lock(void) {
+    if (!s_life_lock) {
+        SemaphoreHandle_t m = xSemaphoreCreateMutex();
+        portENTER_CRITICAL(&s_life_mux);
+        if (!s_life_lock) { s_life_lock = m; m = NULL; }
+        portEXIT_CRITICAL(&s_life_mux);
+        if (m) vSemaphoreDelete(m);
+    }
+    if (s_life_lock) xSemaphoreTake(s_life_lock, portMAX_DELAY);
+}
+
+static void life_unlock(void) {
+    if (s_life_lock) xSemaphoreGive(s_life_lock);
+}
+
+static uint32_t heap_free(void) {
+    return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
 
 /* Local helper: stop advertising via GAP bridge */
 static void ble_stop_advertising(void) {
@@ -56,7 +78,8 @@ void ble_lifeboat_set(bool enable) {
         ble_stop_advertising();
         return;
     }
-    if (!s_connected && s_adv_ready && s_stack_ready) {
+    fb_adv_sched_reset();   // RECOVERY entry: fast burst
+    if (!fb_links_full() && s_adv_ready && s_stack_ready) {
         ble_post(BLE_EVT_ADV_KICK);
     } else {
         s_adv_start_deferred = true;
@@ -80,109 +103,148 @@ void ble_start_advertising(void) {
     ble_post(BLE_EVT_ADV_KICK);
 }
 
-/* Exported (non-static) so it can override the weak symbol in gatt_server.c */
-void ble_set_connected(bool on) {
-    s_connected = on;
-    if (!on) {
-        if (s_lifeboat_enabled) {
-            if (s_adv_ready && s_stack_ready) ble_post(BLE_EVT_ADV_KICK);
-            else s_adv_start_deferred = true;
-        }
-    } else {
-        ESP_LOGI(TAG, "Marked CONNECTED; advertising off until disconnect.");
+/* Exported (non-static) so it can override the weak symbol in gatt_server.c.
+ * The controller ends connectable advertising on every connect, so restart it
+ * while another central still fits. */
+void ble_set_links(uint8_t n) {
+    if (n > s_links) s_adv_running = false;
+    if (n < s_links && s_lifeboat_enabled) fb_adv_burst();   // a central left: be findable again
+    s_links = n;
+    if (fb_links_full()) {
+        ESP_LOGI(TAG, "Links %u/%u; advertising off until a disconnect.", (unsigned)n, (unsigned)BLE_MAX_CONN);
+        return;
+    }
+    if (s_lifeboat_enabled) {
+        if (s_adv_ready && s_stack_ready) ble_post(BLE_EVT_ADV_KICK);
+        else s_adv_start_deferred = true;
     }
 }
 
-void ble_fallback_init(void) {
+/* Lifecycle bodies; callers hold life_lock(). */
+static void init_locked(void) {
     if (s_stack_ready) {
         ESP_LOGW(TAG, "BLE stack already active — skipping init.");
         return;
     }
+    uint32_t pre = heap_free();
 
     /* Worker first */
     fb_worker_init_once();
 
-    /* Free classic BT RAM. */
-    esp_err_t r = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
-    if (r != ESP_OK && r != ESP_ERR_INVALID_STATE) ESP_ERROR_CHECK(r);
-
-    /* Controller + Bluedroid */
-    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-    esp_err_t cr = esp_bt_controller_init(&bt_cfg);
-    if (cr != ESP_OK && cr != ESP_ERR_INVALID_STATE) ESP_ERROR_CHECK(cr);
-    esp_err_t en = esp_bt_controller_enable(ESP_BT_MODE_BLE);
-    if (en != ESP_OK && en != ESP_ERR_INVALID_STATE) ESP_ERROR_CHECK(en);
-
-    if (esp_bluedroid_get_status() == ESP_BLUEDROID_STATUS_UNINITIALIZED) {
-        ESP_ERROR_CHECK(esp_bluedroid_init());
-    }
-    if (esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_ENABLED) {
-        ESP_ERROR_CHECK(esp_bluedroid_enable());
-    }
+    /* Controller (classic BT RAM released first) + host; GAP usable from here, GATT registered below. */
+    ESP_ERROR_CHECK(ble_port_up("LoPy4"));
     s_stack_ready = true;
 
-    /* GAP callback + device name */
-    ESP_ERROR_CHECK(esp_ble_gap_register_callback(fb_gap_evt));
-    ESP_ERROR_CHECK(esp_ble_gap_set_device_name("LoPy4"));
-
-    /* ADV payloads: NAME in scan response; UUID in primary ADV. */
-    static esp_ble_adv_data_t adv_data = {
-        .set_scan_rsp = false,
-        .include_name = false,
-        .include_txpower = false,
-        .min_interval = 0x20,
-        .max_interval = 0x40,
-        .appearance = 0x00,
-        .manufacturer_len = 0,
-        .p_manufacturer_data = NULL,
-        .service_data_len = 0,
-        .p_service_data = NULL,
-        .service_uuid_len = 16,
-        .p_service_uuid = s_adv_uuid,
-        .flag = (ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT),
-    };
-    static esp_ble_adv_data_t scan_rsp_data = {
-        .set_scan_rsp = true,
-        .include_name = true,
-        .include_txpower = true,
-        .appearance = 0,
-        .service_uuid_len = 16,
-        .p_service_uuid = s_adv_uuid,
-        .flag = (ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT),
-    };
-
     s_adv_ready = false;
     s_adv_start_deferred = false;
-    s_connected = false;
+    s_links = 0;
     s_adv_running = false;
     s_adv_cfg_done = 0;
 
+    /* ADV payloads: status block (service data) in primary ADV; NAME + UUID in scan response. */
     memcpy(s_adv_uuid, SERVICE_UUID, sizeof(s_adv_uuid));
-    ESP_ERROR_CHECK(esp_ble_gap_config_adv_data(&adv_data));
-    ESP_ERROR_CHECK(esp_ble_gap_config_adv_data(&scan_rsp_data));
+    fb_tlm_refresh(true);
+    ESP_ERROR_CHECK(ble_port_scan_rsp_set(s_adv_uuid));
 
     /* Bring up GATT; it will call syscoord_on_ble_service_started() and then we kick ADV. */
     gatt_server_init();
+    ESP_ERROR_CHECK(ble_port_start());
 
     fb_watchdog_start_if_needed();
 
-    ESP_LOGI(TAG, "BLE fallback init done. Waiting for GATT start and ADV payload ready.");
+    uint32_t up = heap_free();
+    portENTER_CRITICAL(&s_life_mux);
+    s_life.up = true;
+    s_life.host = ble_port_name();
+    s_life.heap_pre_init = pre;
+    s_life.heap_up = up;
+    portEXIT_CRITICAL(&s_life_mux);
+    ESP_LOGI(TAG, "BLE fallback init done on %s (heap %u -> %u). Waiting for GATT start and ADV payload ready.",
+             ble_port_name(), (unsigned)pre, (unsigned)up);
 }
 
-void ble_fallback_stop(void) {
-    ble_stop_advertising();
+/* Full teardown: nothing BT stays allocated except the worker task/queue and the link
+ * slots, which the next init reuses. Order matters: no GATT state may be touched by a
+ * queued event once the host is gone, and the host must go before the controller. */
+static void stop_locked(void) {
     fb_watchdog_stop();
+    bool was_up = s_stack_ready;
+    s_stack_ready = false;     // worker events and GAP upcalls from here on are no-ops
+    ble_stop_advertising();    // NimBLE reports the stop synchronously: nothing may re-kick
 
-    /* Clear transient state (keep stack enabled unlessneed RAM back is needed) */
-    s_connected = false;
+    s_links = 0;
     s_adv_running = false;
     s_adv_start_deferred = false;
 
-    /* to fully free BT/BLE RAM when needed, uncomment below:
-       s_stack_ready = false; s_adv_ready = false;
-       if (esp_bluedroid_get_status() == ESP_BLUEDROID_STATUS_ENABLED)      esp_bluedroid_disable();
-       if (esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_UNINITIALIZED) esp_bluedroid_deinit();
-       if (esp_bt_controller_get_status() == ESP_BT_CONTROLLER_STATUS_ENABLED) esp_bt_controller_disable();
-       if (esp_bt_controller_get_status() == ESP_BT_CONTROLLER_STATUS_INITED)  esp_bt_controller_deinit();
-    */
+    if (!was_up) return;
+    int64_t t0 = esp_timer_get_time();
+    uint32_t before = heap_free();
+
+    s_adv_ready = false;
+    s_adv_cfg_done = 0;
+
+    fb_adv_log_stats();
+    gatt_server_deinit();      // links, subscriptions, GATT app
+    fb_worker_quiesce();       // queued ADV/TLM/deferred writes run (and drop) now
+    fb_watchdog_stop();        // a schedule apply may have re-armed it meanwhile
+
+    ble_port_down();           // host, then controller
+
+    uint32_t down = heap_free();
+    uint32_t largest = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    portENTER_CRITICAL(&s_life_mux);
+    s_life.up = false;
+    s_life.cycles++;
+    s_life.heap_down = down;
+    s_life.largest_down = largest;
+    s_life.stop_ms = ms;
+    portEXIT_CRITICAL(&s_life_mux);
+    ESP_LOGI(TAG, "BLE stack (%s) freed in %u ms: heap %u -> %u (+%d), largest block %u.",
+             ble_port_name(), (unsigned)ms, (unsigned)before, (unsigned)down, (int)(down - before), (unsigned)largest);
+}
+
+/* init/stop claim the stack for RECOVERY (syscoord); a borrowed stack becomes theirs. */
+void ble_fallback_init(void) {
+    life_lock();
+    s_borrowed = false;
+    init_locked();
+    life_unlock();
+}
+
+void ble_fallback_stop(void) {
+    life_lock();
+    s_borrowed = false;
+    stop_locked();
+    life_unlock();
+}
+
+bool ble_fallback_borrow(void) {
+    life_lock();
+    bool ok = !s_stack_ready;
+    if (ok) {
+        init_locked();
+        s_borrowed = s_stack_ready;
+        ok = s_borrowed;
+    }
+    life_unlock();
+    return ok;
+}
+
+bool ble_fallback_give_back(void) {
+    life_lock();
+    bool ok = s_borrowed;
+    if (ok) {
+        s_borrowed = false;
+        stop_locked();
+    }
+    life_unlock();
+    return ok;
+}
+
+void ble_fallback_get_stats(ble_fallback_stats_t *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_life_mux);
+    *out = s_life;
+    portEXIT_CRITICAL(&s_life_mux);
 }
@@ -0,0 +1,71 @@
+// fb_tlm.c, keeps the advertising status block current (BLE worker context).
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_ota_ops.h"
+
+#include "app_cfg.h"
+#include "alerts.h"
+#include "errsrc.h"
+#include "syscoord.h"
+#include "sensor.h"
+#include "ble_ids.h"
+#include "ble_tlm.h"
+#include "fb_priv.h"
+#include "ble_port.h"
+
+static const char *TAG = "BLE.fb.tlm";
+
+static ble_tlm_gate_t s_gate;
+static uint16_t s_fw;
+static bool s_fw_read = false;
+
+static uint16_t fw_hash(void) {
+    if (!s_fw_read) {
+        esp_app_desc_t d = (esp_app_desc_t){0};
+        const esp_partition_t *run = esp_ota_get_running_partition();
+        if (run && esp_ota_get_partition_description(run, &d) == ESP_OK) {
+            s_fw = (uint16_t)(d.app_elf_sha256[0] | (d.app_elf_sha256[1] << 8));
+        }
+        s_fw_read = true;
+    }
+    return s_fw;
+}
+
+static void snapshot(ble_tlm_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->mode   = (uint8_t)syscoord_get_mode();
+    t->errsrc = (uint8_t)errsrc_get_code();
+
+    alert_record_t a;
+    alert_latest(&a);
+    t->alert_seq  = (uint8_t)a.seq;
+    t->alert_code = (uint8_t)a.code;
+
+    t->t_dc  = BLE_TLM_T_NA;
+    t->rh_dp = BLE_TLM_RH_NA;
+    sensor_rec_t r;
+    if (sensor_latest(sensor_find("DHT"), &r) && r.valid) {
+        for (uint8_t i = 0; i < r.n; ++i) {
+            if (r.qty[i] == SENSOR_Q_TEMP_DC) t->t_dc = (int16_t)r.v[i];
+            else if (r.qty[i] == SENSOR_Q_RH_DP) t->rh_dp = (uint16_t)r.v[i];
+        }
+    }
+    t->fw = fw_hash();
+}
+
+void fb_tlm_refresh(bool force) {
+    if (!s_stack_ready) return;   // queued before a teardown
+    ble_tlm_t t;
+    snapshot(&t);
+    if (force) s_gate.sent = false;
+    if (!ble_tlm_due(&s_gate, &t, (uint32_t)(esp_timer_get_time() / 1000), BLE_TLM_MIN_MS)) return;
+
+    uint8_t adv[BLE_TLM_ADV_LEN];
+    size_t n = ble_tlm_build_adv(&t, SERVICE_UUID, adv, sizeof(adv));
+    esp_err_t e = ble_port_adv_set_raw(adv, n);
+    if (e != ESP_OK) {
+        ESP_LOGW(TAG, "adv payload update: %s", esp_err_to_name(e));
+        s_gate.sent = false;   // retry on the next tick
+    }
+}
@@ -1,28 +1,46 @@
 // components/ble/fallback/fb_worker.c
 #include "fb_priv.h"
+#include "gatt_priv.h"     // gatt_defer_run()
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "BLE.fb.worker";
 
 #define BLE_WORKER_STACK 4096
 #define BLE_WORKER_PRIO 5
-#define BLE_QUEUE_DEPTH 8
+#define BLE_QUEUE_DEPTH (8 + BLE_DEFER_SLOTS)
+
+/* Queue wait for fb_worker_quiesce(); teardown gives up on a wedged worker after this. */
+#define BLE_QUIESCE_MS 1000
 
 QueueHandle_t s_ble_q = NULL;
 TaskHandle_t s_ble_wkr = NULL;
+static SemaphoreHandle_t s_fence = NULL;
 
 static void ble_worker(void *arg) {
     (void)arg;
-    ble_evt_t ev;
+    ble_msg_t m;
     for (;;) {
-        if (xQueueReceive(s_ble_q, &ev, portMAX_DELAY) != pdTRUE) continue;
+        if (xQueueReceive(s_ble_q, &m, portMAX_DELAY) != pdTRUE) continue;
 
-        switch (ev) {
+        switch (m.ev) {
         case BLE_EVT_ADV_KICK:
             fb_adv_kick();
             break;
+        case BLE_EVT_GATT_WRITE:
+            gatt_defer_run(m.arg);
+            break;
+        case BLE_EVT_TLM:
+            fb_tlm_refresh(false);
+            break;
+        case BLE_EVT_ADV_SCHED:
+            fb_adv_sched_apply();
+            break;
+        case BLE_EVT_FENCE:
+            xSemaphoreGive(s_fence);
+            break;
         default:
             // future events can be handled here
             break;
@@ -31,14 +49,33 @@ static void ble_worker(void *arg) {
 }
 
 void ble_post(ble_evt_t ev) {
-    if (!s_ble_q) return;
-    (void)xQueueSend(s_ble_q, &ev, 0);
+    (void)ble_post_arg(ev, 0);
+}
+
+bool ble_post_arg(ble_evt_t ev, uint8_t arg) {
+    if (!s_ble_q) return false;
+    ble_msg_t m = { .ev = ev, .arg = arg };
+    return xQueueSend(s_ble_q, &m, 0) == pdTRUE;
+}
+
+/* Drain: returns once every event queued so far has been handled. The worker and
+ * its queue stay alive across stack teardowns; only the stack itself is freed. */
+void fb_worker_quiesce(void) {
+    if (!s_ble_q || !s_ble_wkr || !s_fence) return;
+    if (xTaskGetCurrentTaskHandle() == s_ble_wkr) return;   // would wait on ourselves
+    (void)xSemaphoreTake(s_fence, 0);                        // stale give from a timed-out fence
+    ble_msg_t m = { .ev = BLE_EVT_FENCE, .arg = 0 };
+    if (xQueueSend(s_ble_q, &m, pdMS_TO_TICKS(BLE_QUIESCE_MS)) != pdTRUE ||
+        xSemaphoreTake(s_fence, pdMS_TO_TICKS(BLE_QUIESCE_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "worker did not drain within %u ms", (unsigned)BLE_QUIESCE_MS);
+    }
 }
 
 /* Create worker/queue if needed */
 void fb_worker_init_once(void) {
+    if (!s_fence) s_fence = xSemaphoreCreateBinary();
     if (!s_ble_q) {
-        s_ble_q = xQueueCreate(BLE_QUEUE_DEPTH, sizeof(ble_evt_t));
+        s_ble_q = xQueueCreate(BLE_QUEUE_DEPTH, sizeof(ble_msg_t));
         if (!s_ble_q) {
             ESP_LOGE(TAG, "Failed to create BLE event queue");
             return;
@@ -2,11 +2,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include "esp_log.h"
-#include "esp_gatts_api.h"
 #include "gatt_priv.h"       // ble_cmd_t forward-decl + internal APIs
-#include "gatt_server.h"     // gatt_server_send_status()
 #include "command.h"         // cmd_ctx_t, cmd_dispatch_line
 #include "commands.h"        // command table & needs_auth flags
+#include "cmd_stream.h"      // cmd_stream_drop()
 #include <limits.h>
 
 static const char *TAG = "BLE_CMD";
@@ -14,9 +13,7 @@ static const char *TAG = "BLE_CMD";
 #define BLE_CMD_LINE_MAX 128
 
 struct ble_cmd {
-    esp_gatt_if_t ifx;
-    uint16_t conn_id;
-    uint16_t tx_handle;                // efbe0200… (notify/read) char handle
+    ble_link_t *link;                  // owning connection; replies go to its TX queue
     char line[BLE_CMD_LINE_MAX];
     size_t len;
     cmd_ctx_t ctx;               // persisted across commands (keeps .authed)
@@ -24,26 +21,18 @@ struct ble_cmd {
 
 
 
+/* Straight into the owning link's TX ring; the ring adds the '\n' itself. */
 static int ble_cmd_write_cb(const void *buf, size_t n, void *user) {
-    (void)user;
-    if (!buf || n == 0) return 0;
+    ble_cmd_t *cli = (ble_cmd_t*)user;   // ctx.u.ble_link
+    if (!cli || !buf || n == 0) return 0;
 
     const char *p = (const char*)buf;
-
-    // Trim one trailing newline so we don't end up with double '\n' from gatt_server_send_status
     size_t use_n = n;
+    if (p[use_n - 1] == '\0') use_n--;
     if (use_n && p[use_n - 1] == '\n') use_n--;
 
-    if (use_n && p[use_n - 1] == '\0') {
-        gatt_server_send_status(p);
-    } else {
-        char tmp[BLE_CMD_LINE_MAX + 2];
-        size_t m = use_n > (size_t)BLE_CMD_LINE_MAX ? (size_t)BLE_CMD_LINE_MAX : use_n;
-        memcpy(tmp, p, m);
-        tmp[m] = '\0';
-        gatt_server_send_status(tmp);
-    }
-    return (int)(use_n > (size_t)INT_MAX ? INT_MAX : use_n);
+    gatt_tx_send_line(cli->link, p, use_n);
+    return (int)(n > (size_t)INT_MAX ? INT_MAX : n);
 }
 
 
@@ -56,23 +45,18 @@ void ble_cmd_destroy(ble_cmd_t* cli) {
     if (cli) free(cli);
 }
 
-void ble_cmd_on_connect(ble_cmd_t* cli, esp_gatt_if_t gatts_if,
-                        uint16_t conn_id, uint16_t tx_char_handle)
+void ble_cmd_on_connect(ble_cmd_t* cli, ble_link_t *link)
 {
-    if (!cli) return;
+    if (!cli || !link) return;
     memset(cli, 0, sizeof(*cli));
 
-    cli->ifx = gatts_if;
-    cli->conn_id = conn_id;
-    cli->tx_handle = tx_char_handle;
-
+    cli->link = link;
     cli->ctx.authed = false;
     cli->ctx.xport = CMD_XPORT_BLE;
-    cli->ctx.u.ble_link = cli;     // opaque backref if needed.
+    cli->ctx.u.ble_link = cli;     // write target; sessions are keyed by it
     cli->ctx.write  = ble_cmd_write_cb;
 
-    ESP_LOGI(TAG, "BLE CMD connected (conn_id=%u, tx_handle=0x%04x).",
-             (unsigned)conn_id, (unsigned)tx_char_handle);
+    ESP_LOGI(TAG, "BLE CMD connected (conn_id=%u).", (unsigned)link->conn_id);
 }
 
 void ble_cmd_on_rx(ble_cmd_t* cli, const uint8_t* data, uint16_t len) {
@@ -102,5 +86,6 @@ void ble_cmd_on_disconnect(ble_cmd_t* cli) {
     if (!cli) return;
     cli->len        = 0;
     cli->ctx.authed = false; // drop auth on link loss to mirror TCP lifecycle
-    ESP_LOGI(TAG, "BLE CMD disconnected (conn_id=%u).", (unsigned)cli->conn_id);
+    cmd_stream_drop(CMD_XPORT_BLE, cli);
+    ESP_LOGI(TAG, "BLE CMD disconnected (conn_id=%u).", cli->link ? (unsigned)cli->link->conn_id : 0xFFFFu);
 }
@@ -6,35 +6,69 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 
 #include "ota_bridge.h"    // declares the hooks we override
 #include "ota_handler.h"      // ota_begin_xport / write_xport / finish_xport / abort_xport
 #include "monitor.h"          // health_monitor_control_ok(...)
 #include "syscoord.h"         // gating via mode?
-#include "gatt_server.h"      // gatt_server_send_status(...)
+#include "gatt_priv.h"        // gatt_link_find / gatt_link_send_line
+#include "app_cfg.h"          // BLE_OTA_BULK*
 
 static const char *TAG = "BLE-OTA";
 
-/* Convenience wrapper: push a line to the BLE TX characteristic. */
-static inline void ble_tx_send(const char *s) {
-    gatt_server_send_status(s ? s : "");
+/* Reply on the TX characteristic of the link that wrote CTRL/DATA. */
+static inline void ble_tx_send(uint16_t conn_id, const char *s) {
+    gatt_link_send_line(gatt_link_find(conn_id), s ? s : "");
 }
 
-/* ---- BLE OTA state ---- */
+/* ---- BLE OTA state ----
+ * CTRL runs on the BLE worker, DATA and disconnects on the host task: s_bo (and the
+ * xport session behind it) is only touched under s_bo_lock. START drops the
+ * lock for the partition erase and holds the session as `starting`; a disconnect of the
+ * owner meanwhile sets `gone`, so the session is abandoned even if the link id is reused. */
 typedef struct {
     bool active;
+    bool starting;       // xport begin in progress (unlocked)
+    bool gone;           // owner disconnected while starting
+    uint16_t conn_id;    // owner link
     uint32_t total;
     uint32_t written;
     uint32_t expect_crc;
     uint32_t expect_seq;
     uint32_t next_prog_mark;
+    bool bulk;           // header-free DATA frames (negotiated by START ... BULK)
+    int64_t t0_us;       // START time, for the throughput log
 } ble_ota_state_t;
 
 static ble_ota_state_t s_bo;
+static SemaphoreHandle_t s_bo_lock;
+
+static const ble_ota_xport_t s_flash = {
+    ota_begin_xport, ota_write_xport, ota_finish_xport, ota_abort_xport,
+};
+static const ble_ota_xport_t *s_x = &s_flash;   // under s_bo_lock
+static portMUX_TYPE s_bo_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void bo_lock(void) {
+    if (!s_bo_lock) {
+        SemaphoreHandle_t m = xSemaphoreCreateMutex();
+        portENTER_CRITICAL(&s_bo_mux);
+        if (!s_bo_lock) { s_bo_lock = m; m = NULL; }
+        portEXIT_CRITICAL(&s_bo_mux);
+        if (m) vSemaphoreDelete(m);
+    }
+    if (s_bo_lock) xSemaphoreTake(s_bo_lock, portMAX_DELAY);
+}
+
+static void bo_unlock(void) {
+    if (s_bo_lock) xSemaphoreGive(s_bo_lock);
+}
 
 static inline void ble_ota_reset(void) { memset(&s_bo, 0, sizeof(s_bo)); }
 
@@ -42,67 +76,123 @@ static inline void ble_ota_reset(void) { memset(&s_bo, 0, sizeof(s_bo)); }
 static inline uint32_t rd_le32(const uint8_t *p) { return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
 static inline uint16_t rd_le16(const uint8_t *p) { return (uint16_t)p[0] | ((uint16_t)p[1]<<8); }
 
-/* ---------- Hooks called by gatt_server.c ---------- */
-
-void ble_ota_on_ctrl_write(const uint8_t *data, uint16_t len)
+/* Bulk mode: ask the owner's central for a short interval and long LL packets for the
+ * transfer; back to a relaxed interval if it ends without a reboot. Both are requests:
+ * the central decides, and the transfer works either way. */
+static void bulk_link(uint16_t conn_id, bool on)
 {
-    if (!data || !len) return;
+    ble_link_t *l = gatt_link_find(conn_id);
+    if (!l) return;
+    esp_err_t e = ble_port_conn_params(l->conn_id, l->bda,
+                                       on ? BLE_OTA_BULK_ITVL_MIN : 24,   // 1.25 ms units; idle 30-50 ms
+                                       on ? BLE_OTA_BULK_ITVL_MAX : 40,
+                                       400);                               // 10 ms units
+    if (e != ESP_OK) ESP_LOGW(TAG, "conn params: %s", esp_err_to_name(e));
+    if (on) {
+        e = ble_port_data_len(l->conn_id, l->bda, BLE_OTA_LL_OCTETS);
+        if (e != ESP_OK) ESP_LOGW(TAG, "data length: %s", esp_err_to_name(e));
+    }
+}
 
-    char line[128];
-    size_t n = (len < sizeof(line)-1) ? len : sizeof(line)-1;
-    memcpy(line, data, n);
-    line[n] = '\0';
-    for (char *p = line; *p; ++p) if (*p == '\r' || *p == '\n') *p = ' ';
+/* Throughput of the DATA phase, for comparing bulk and framed transfers. */
+static void report_rate(void)
+{
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - s_bo.t0_us) / 1000);
+    uint32_t bps = ms ? (uint32_t)((uint64_t)s_bo.written * 1000u / ms) : 0;
+    const char *path = s_bo.bulk ? "bulk" : "gatt";
+    ESP_LOGI(TAG, "BLE-OTA %u bytes in %u ms: %u.%02u KB/s (%s).", (unsigned)s_bo.written,
+             (unsigned)ms, (unsigned)(bps / 1024), (unsigned)((bps % 1024) * 100 / 1024), path);
+    char msg[48];
+    snprintf(msg, sizeof(msg), "RATE %u B/s %s", (unsigned)bps, path);
+    ble_tx_send(s_bo.conn_id, msg);
+}
 
-    ESP_LOGI(TAG, "CTRL: %s", line);
+/* START: the erase in the xport begin takes seconds, so it runs unlocked. */
+static void ctrl_start(uint16_t conn_id, const char *line)
+{
+    uint32_t size = 0, crc = 0;
+    if (sscanf(line + 12, "%" SCNu32 " %" SCNx32, &size, &crc) != 2 || size == 0) {
+        ble_tx_send(conn_id, "ERR BADFMT");
+        return;
+    }
+    // Gate by mode: allow BLE OTA only in RECOVERY
+    if (syscoord_get_mode() != SC_MODE_RECOVERY) {
+        ble_tx_send(conn_id, "ERR FORBIDDEN");
+        return;
+    }
 
-    if (strncmp(line, "BL_OTA START", 12) == 0) {
-        if (s_bo.active) { ble_tx_send("ERR BUSY"); return; }
+    bo_lock();
+    if (s_bo.active || s_bo.starting) {   // another link may own it
+        bo_unlock();
+        ble_tx_send(conn_id, "ERR BUSY");
+        return;
+    }
+    s_bo.starting = true;
+    s_bo.gone = false;
+    s_bo.conn_id = conn_id;
+    const ble_ota_xport_t *x = s_x;     // fixed while `starting`
+    bo_unlock();
 
-        uint32_t size = 0, crc = 0;
-        if (sscanf(line + 12, "%" SCNu32 " %" SCNx32, &size, &crc) != 2 || size == 0) {
-            ble_tx_send("ERR BADFMT");
-            return;
-        }
+    esp_err_t err = x->begin(size, crc, "BLE");
 
-        // Gate by mode: allow BLE OTA only in RECOVERY
-        if (syscoord_get_mode() != SC_MODE_RECOVERY) {
-            ble_tx_send("ERR FORBIDDEN");
-            return;
-        }
-        esp_err_t err = ota_begin_xport(size, crc, "BLE");
+    bo_lock();
+    bool gone = s_bo.gone || !gatt_link_find(conn_id);
+    if (err != ESP_OK || gone) {
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "ota_begin_xport failed: %s", esp_err_to_name(err));
-            ble_tx_send("ERR BEGIN");
-            return;
+            ESP_LOGE(TAG, "xport begin failed: %s", esp_err_to_name(err));
+        } else {
+            ESP_LOGW(TAG, "BLE link dropped during START — aborting.");
+            x->abort("ble disconnect");
         }
-
-        s_bo.active = true;
-        s_bo.total = size;
-        s_bo.written = 0;
-        s_bo.expect_crc = crc;     // checked inside ota_finish_xport.
-        s_bo.expect_seq = 0;
-        s_bo.next_prog_mark = 256 * 1024;
-
-        // Latch health monitor so the device doesn’t try to rollback mid-flash.
-        health_monitor_control_ok("BLE-OTA");
-
-        ble_tx_send("ACK START");
+        ble_ota_reset();
+        bo_unlock();
+        if (!gone) ble_tx_send(conn_id, "ERR BEGIN");
         return;
     }
 
+    s_bo.starting = false;
+    s_bo.active = true;
+    s_bo.total = size;
+    s_bo.written = 0;
+    s_bo.expect_crc = crc;     // checked by the xport finish.
+    s_bo.expect_seq = 0;
+    s_bo.next_prog_mark = 256 * 1024;
+    s_bo.bulk = BLE_OTA_BULK && strstr(line + 12, "BULK") != NULL;
+    s_bo.t0_us = esp_timer_get_time();
+
+    // Latch health monitor so the device doesn’t try to rollback mid-flash.
+    health_monitor_control_ok("BLE-OTA");
+
+    if (s_bo.bulk) {
+        /* Writes without response on one link arrive in order and intact, so the frame
+         * header adds nothing; the image CRC is still checked at the end. */
+        ble_link_t *l = gatt_link_find(conn_id);
+        char ack[40];
+        snprintf(ack, sizeof(ack), "ACK START BULK %u", (unsigned)(l ? l->mtu_payload : 20));
+        bulk_link(conn_id, true);
+        ble_tx_send(conn_id, ack);
+    } else {
+        ble_tx_send(conn_id, "ACK START");
+    }
+    bo_unlock();
+}
+
+/* FINISH / ABORT / unknown; s_bo_lock held. */
+static void ctrl_locked(uint16_t conn_id, const char *line)
+{
     if (strncmp(line, "BL_OTA FINISH", 13) == 0) {
-        if (!s_bo.active) { ble_tx_send("ERR NOACTIVE"); return; }
+        if (!s_bo.active || s_bo.conn_id != conn_id) { ble_tx_send(conn_id, "ERR NOACTIVE"); return; }
 
-        esp_err_t err = ota_finish_xport();
+        esp_err_t err = s_x->finish();
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "ota_finish_xport failed: %s", esp_err_to_name(err));
-            ble_tx_send("ERR FINISH");
+            ESP_LOGE(TAG, "xport finish failed: %s", esp_err_to_name(err));
+            ble_tx_send(conn_id, "ERR FINISH");
             ble_ota_reset();
             return;
         }
 
-        ble_tx_send("OK REBOOTING");
+        report_rate();
+        ble_tx_send(conn_id, "OK REBOOTING");
         ESP_LOGI(TAG, "BLE-OTA complete: %u bytes.", (unsigned)s_bo.written);
         ble_ota_reset();                       // To avoid finalize-on-disconnect race.
         vTaskDelay(pdMS_TO_TICKS(400));
@@ -110,31 +200,61 @@ void ble_ota_on_ctrl_write(const uint8_t *data, uint16_t len)
     }
 
     if (strncmp(line, "BL_OTA ABORT", 12) == 0) {
-        if (!s_bo.active) { ble_tx_send("ERR NOACTIVE"); return; }
-        ota_abort_xport("ble abort");
+        if (!s_bo.active || s_bo.conn_id != conn_id) { ble_tx_send(conn_id, "ERR NOACTIVE"); return; }
+        s_x->abort("ble abort");
+        if (s_bo.bulk) bulk_link(conn_id, false);
         ble_ota_reset();
-        ble_tx_send("OK ABORTED");
+        ble_tx_send(conn_id, "OK ABORTED");
         return;
     }
 
-    ble_tx_send("ERR UNKNOWN");
+    ble_tx_send(conn_id, "ERR UNKNOWN");
 }
 
-void ble_ota_on_data_write(const uint8_t *data, uint16_t len)
+/* ---------- Hooks called by gatt_server.c ---------- */
+
+void ble_ota_on_ctrl_write(uint16_t conn_id, const uint8_t *data, uint16_t len)
 {
-    if (!s_bo.active || !data || len < 6) return;
+    if (!data || !len) return;
+
+    char line[128];
+    size_t n = (len < sizeof(line)-1) ? len : sizeof(line)-1;
+    memcpy(line, data, n);
+    line[n] = '\0';
+    for (char *p = line; *p; ++p) if (*p == '\r' || *p == '\n') *p = ' ';
 
-    uint32_t seq  = rd_le32(data);
-    uint16_t blen = rd_le16(data + 4);
-    if ((uint32_t)len != (uint32_t)6 + blen) {
-        ESP_LOGW(TAG, "DATA bad frame: len=%u hdr.len=%u", (unsigned)len, (unsigned)blen);
+    ESP_LOGI(TAG, "CTRL: %s", line);
+
+    if (strncmp(line, "BL_OTA START", 12) == 0) {
+        ctrl_start(conn_id, line);
         return;
     }
+    bo_lock();
+    ctrl_locked(conn_id, line);
+    bo_unlock();
+}
 
-    if (seq != s_bo.expect_seq) {
-        ESP_LOGW(TAG, "DATA out-of-order: got=%u expect=%u", (unsigned)seq, (unsigned)s_bo.expect_seq);
-        if (seq < s_bo.expect_seq) return; // drop duplicates
-        return; // drop ahead-of-time frames
+static void data_locked(uint16_t conn_id, const uint8_t *data, uint16_t len)
+{
+    if (!s_bo.active || s_bo.conn_id != conn_id) return;
+
+    const uint8_t *payload = data;
+    uint16_t blen = len;
+    if (!s_bo.bulk) {
+        if (len < 6) return;
+        uint32_t seq = rd_le32(data);
+        blen = rd_le16(data + 4);
+        if ((uint32_t)len != (uint32_t)6 + blen) {
+            ESP_LOGW(TAG, "DATA bad frame: len=%u hdr.len=%u", (unsigned)len, (unsigned)blen);
+            return;
+        }
+
+        if (seq != s_bo.expect_seq) {
+            ESP_LOGW(TAG, "DATA out-of-order: got=%u expect=%u", (unsigned)seq, (unsigned)s_bo.expect_seq);
+            if (seq < s_bo.expect_seq) return; // drop duplicates
+            return; // drop ahead-of-time frames
+        }
+        payload = data + 6;
     }
 
     if (s_bo.written + blen > s_bo.total) {
@@ -142,12 +262,12 @@ void ble_ota_on_data_write(const uint8_t *data, uint16_t len)
         return;
     }
 
-    const uint8_t *payload = data + 6;
-    esp_err_t err = ota_write_xport(payload, blen);
+    esp_err_t err = s_x->write(payload, blen);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "ota_write_xport failed: %s", esp_err_to_name(err));
-        ble_tx_send("ERR WRITE");
-        ota_abort_xport("write_fail");
+        ESP_LOGE(TAG, "xport write failed: %s", esp_err_to_name(err));
+        ble_tx_send(conn_id, "ERR WRITE");
+        s_x->abort("write_fail");
+        if (s_bo.bulk) bulk_link(conn_id, false);
         ble_ota_reset();
         return;
     }
@@ -159,21 +279,22 @@ void ble_ota_on_data_write(const uint8_t *data, uint16_t len)
         char msg[48];
         snprintf(msg, sizeof(msg), "PROG %u/%u",
                  (unsigned)s_bo.written, (unsigned)s_bo.total);
-        ble_tx_send(msg);
+        ble_tx_send(conn_id, msg);
         s_bo.next_prog_mark += 256 * 1024;
     }
     /* Finalize as soon as the last chunk arrives: FINISH becomes optional. */
     if (s_bo.written == s_bo.total) {
         ESP_LOGI(TAG, "Image complete on DATA stream; finalizing (no FINISH required)...");
-        esp_err_t err = ota_finish_xport();
+        esp_err_t err = s_x->finish();
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "ota_finish_xport failed at end-of-data: %s", esp_err_to_name(err));
-            ble_tx_send("ERR FINISH");
-            ota_abort_xport("finish_fail");
+            ESP_LOGE(TAG, "xport finish failed at end-of-data: %s", esp_err_to_name(err));
+            ble_tx_send(conn_id, "ERR FINISH");
+            s_x->abort("finish_fail");
             ble_ota_reset();
             return;
         }
-        ble_tx_send("OK REBOOTING");
+        report_rate();
+        ble_tx_send(conn_id, "OK REBOOTING");
         ESP_LOGI(TAG, "BLE-OTA complete: %u bytes.", (unsigned)s_bo.written);
         ble_ota_reset();                       /* avoid double-finalize on disconnect */
         vTaskDelay(pdMS_TO_TICKS(400));
@@ -181,24 +302,52 @@ void ble_ota_on_data_write(const uint8_t *data, uint16_t len)
     }
 }
 
-void ble_ota_on_disconnect(void)
+void ble_ota_on_data_write(uint16_t conn_id, const uint8_t *data, uint16_t len)
 {
-    if (!s_bo.active) return;
+    if (!data || !len) return;
+    bo_lock();
+    data_locked(conn_id, data, len);
+    bo_unlock();
+}
+
+static void disconnect_locked(uint16_t conn_id)
+{
+    if (s_bo.starting && s_bo.conn_id == conn_id) {
+        s_bo.gone = true;      // ctrl_start() aborts once the erase returns
+        return;
+    }
+    if (!s_bo.active || s_bo.conn_id != conn_id) return;
 
     if (s_bo.written >= s_bo.total && s_bo.total > 0) {
         ESP_LOGW(TAG, "BLE dropped but image is complete (%u/%u). Finalizing...",
                  (unsigned)s_bo.written, (unsigned)s_bo.total);
-        if (ota_finish_xport() == ESP_OK) {
+        if (s_x->finish() == ESP_OK) {
             ESP_LOGI(TAG, "BLE-OTA complete on disconnect; rebooting.");
             vTaskDelay(pdMS_TO_TICKS(400));
             esp_restart();
         } else {
             ESP_LOGE(TAG, "finish_xport failed after complete image; aborting.");
-            ota_abort_xport("finish_fail");
+            s_x->abort("finish_fail");
         }
     } else {
         ESP_LOGW(TAG, "BLE link dropped during OTA — aborting.");
-        ota_abort_xport("ble disconnect");
+        s_x->abort("ble disconnect");
     }
     ble_ota_reset();
 }
+
+void ble_ota_on_disconnect(uint16_t conn_id)
+{
+    bo_lock();
+    disconnect_locked(conn_id);
+    bo_unlock();
+}
+
+esp_err_t ble_ota_set_xport(const ble_ota_xport_t *x)
+{
+    bo_lock();
+    bool busy = s_bo.active || s_bo.starting;
+    if (!busy) s_x = x ? x : &s_flash;
+    bo_unlock();
+    return busy ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
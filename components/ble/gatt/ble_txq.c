@@ -0,0 +1,83 @@
+// ble_txq.c, TX byte ring + packing accounting (no RTOS calls; host-buildable).
+#include <string.h>
+#include "ble_txq.h"
+
+void ble_txq_reset(ble_txq_t *q) {
+    if (q) memset(q, 0, sizeof(*q));
+}
+
+static size_t ring_tail(const ble_txq_t *q) {
+    return (q->head + q->len) % BLE_TXQ_BYTES;
+}
+
+static void ring_write(ble_txq_t *q, size_t at, const uint8_t *p, size_t n) {
+    size_t first = BLE_TXQ_BYTES - at;
+    if (first > n) first = n;
+    memcpy(q->buf + at, p, first);
+    memcpy(q->buf, p + first, n - first);
+}
+
+static void ring_put(ble_txq_t *q, const uint8_t *p, size_t n) {
+    ring_write(q, ring_tail(q), p, n);
+    q->len = (uint16_t)(q->len + n);
+}
+
+bool ble_txq_push_line(ble_txq_t *q, const char *s, size_t n) {
+    if (!q || (!s && n)) return false;
+    if (n > BLE_TXQ_BYTES - 1) n = BLE_TXQ_BYTES - 1;
+    if (n + 1 > (size_t)(BLE_TXQ_BYTES - q->len)) {
+        q->st.dropped++;
+        return false;
+    }
+    const uint8_t nl = '\n';
+    q->last_at  = (uint16_t)ring_tail(q);
+    q->last_len = (uint16_t)n;
+    ring_put(q, (const uint8_t *)s, n);
+    ring_put(q, &nl, 1);
+    q->st.lines++;
+    return true;
+}
+
+void ble_txq_keep_line(ble_txq_t *q, const char *s, size_t n) {
+    if (!q || (!s && n)) return;
+    size_t room = BLE_TXQ_BYTES - q->len;
+    if (n > room) n = room;
+    q->last_at  = (uint16_t)ring_tail(q);
+    q->last_len = (uint16_t)n;
+    ring_write(q, q->last_at, (const uint8_t *)s, n);
+}
+
+bool ble_txq_last(const ble_txq_t *q, size_t off, uint8_t *out, size_t cap, size_t *n) {
+    if (!q || !out || !n || off > q->last_len) return false;
+    size_t k = q->last_len - off;
+    if (k > cap) k = cap;
+    size_t at = (q->last_at + off) % BLE_TXQ_BYTES;
+    size_t first = BLE_TXQ_BYTES - at;
+    if (first > k) first = k;
+    memcpy(out, q->buf + at, first);
+    memcpy(out + first, q->buf, k - first);
+    *n = k;
+    return true;
+}
+
+size_t ble_txq_front(const ble_txq_t *q, const uint8_t **p, size_t cap) {
+    if (!q || !p) return 0;
+    size_t n = q->len < cap ? q->len : cap;
+    size_t first = BLE_TXQ_BYTES - q->head;
+    if (n > first) n = first;
+    *p = q->buf + q->head;
+    return n;
+}
+
+void ble_txq_consume(ble_txq_t *q, size_t n) {
+    if (!q || !n) return;
+    if (n > q->len) n = q->len;
+    q->head = (uint16_t)((q->head + n) % BLE_TXQ_BYTES);
+    q->len  = (uint16_t)(q->len - n);
+    q->st.notifs++;
+    q->st.bytes += (uint32_t)n;
+}
+
+bool ble_txq_ready(const ble_txq_t *q, uint8_t window) {
+    return q && q->len && !q->congested && q->inflight < window;
+}
@@ -0,0 +1,38 @@
+// gatt_bin.c, binary characteristic values (no RTOS calls; host-buildable).
+#include "gatt_bin.h"
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+size_t gatt_bin_errsrc(uint8_t code, uint32_t ms_in_state, uint8_t *out, size_t cap) {
+    if (!out || cap < GATT_BIN_ERRSRC_LEN) return 0;
+    out[0] = GATT_BIN_VER;
+    out[1] = code;
+    put_le32(out + 2, ms_in_state);
+    return GATT_BIN_ERRSRC_LEN;
+}
+
+size_t gatt_bin_alert(uint8_t code, uint16_t seq, uint8_t *out, size_t cap) {
+    if (!out || cap < GATT_BIN_ALERT_LEN) return 0;
+    out[0] = GATT_BIN_VER;
+    out[1] = code;
+    put_le16(out + 2, seq);
+    return GATT_BIN_ALERT_LEN;
+}
+
+size_t gatt_bin_dht(const gatt_bin_dht_t *d, uint8_t *out, size_t cap) {
+    if (!d || !out || cap < GATT_BIN_DHT_LEN) return 0;
+    out[0] = GATT_BIN_VER;
+    out[1] = d->valid ? 0x01 : 0x00;
+    put_le16(out + 2, (uint16_t)(d->valid ? d->t_cdeg : GATT_BIN_T_NA));
+    put_le16(out + 4, d->valid ? d->rh_cpct : GATT_BIN_RH_NA);
+    put_le32(out + 6, d->age_ms);
+    return GATT_BIN_DHT_LEN;
+}
@@ -0,0 +1,104 @@
+// gatt_defer.c, hands RX / WIFI / OTA-CTRL writes from the host callback to the BLE worker.
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+#include "app_cfg.h"
+#include "gatt_priv.h"
+#include "ota_bridge.h"
+#include "fb_priv.h"        // ble_post_arg()
+
+static const char *TAG = "GATT.defer";
+
+/* Fixed pool: a write is copied once into a free slot and its index travels through the
+ * worker queue. One worker drains the queue, so writes run in arrival order. */
+typedef struct {
+    gatt_defer_kind_t kind;
+    ble_link_t   *link;
+    uint32_t      gen;          // link->gen at queue time: the slot, even the conn_id, may be
+                                // reused by the time the worker runs
+    ble_port_req_t req;
+    uint16_t      len;
+    uint8_t       data[BLE_ATT_PAYLOAD_MAX];
+} defer_slot_t;
+
+static defer_slot_t s_slot[BLE_DEFER_SLOTS];
+static uint32_t s_free = (1u << BLE_DEFER_SLOTS) - 1u;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static gatt_defer_stats_t s_st;
+
+static void run(gatt_defer_kind_t kind, ble_link_t *l, const uint8_t *v, uint16_t n) {
+    switch (kind) {
+    case GATT_DEFER_RX:       ble_cmd_on_rx(l->cli, v, n); break;
+    case GATT_DEFER_WIFI:     gatt_on_wifi_cred_write(l, v, n); break;
+    case GATT_DEFER_OTA_CTRL: ble_ota_on_ctrl_write(l->conn_id, v, n); break;
+    default: break;
+    }
+}
+
+/* OTA-CTRL is answered by the app: the response leaves only once the command ran, so
+ * a client that waits for it cannot race DATA frames ahead of START. A host that needs
+ * the answer inside its callback (NimBLE) therefore gets such writes run inline. */
+void gatt_defer_write(gatt_defer_kind_t kind, ble_link_t *l, const ble_port_req_t *r,
+                      const uint8_t *v, uint16_t n) {
+    if (!l || !r) return;
+    if (n > BLE_ATT_PAYLOAD_MAX) n = BLE_ATT_PAYLOAD_MAX;
+
+    int i = -1;
+#if BLE_DEFER_WRITES
+    if (!(r->sync && r->need_rsp)) {
+        portENTER_CRITICAL(&s_mux);
+        if (s_free) {
+            i = __builtin_ctz(s_free);
+            s_free &= ~(1u << i);
+        }
+        portEXIT_CRITICAL(&s_mux);
+    }
+#endif
+    if (i >= 0) {
+        defer_slot_t *d = &s_slot[i];
+        d->kind     = kind;
+        d->link     = l;
+        d->gen      = l->gen;
+        d->req      = *r;
+        d->len      = n;
+        if (n) memcpy(d->data, v, n);
+        if (ble_post_arg(BLE_EVT_GATT_WRITE, (uint8_t)i)) {
+            s_st.deferred++;
+            return;
+        }
+        portENTER_CRITICAL(&s_mux);
+        s_free |= 1u << i;
+        portEXIT_CRITICAL(&s_mux);
+    }
+
+    /* Pool or queue exhausted (or deferral off): run here rather than lose the write. */
+    if (BLE_DEFER_WRITES && !(r->sync && r->need_rsp)) s_st.inline_fallback++;
+    run(kind, l, v, n);
+    ble_port_write_rsp(r, BLE_PORT_OK);
+}
+
+void gatt_defer_run(uint8_t slot) {
+    if (slot >= BLE_DEFER_SLOTS) return;
+    defer_slot_t *d = &s_slot[slot];
+    if (d->link->used && d->link->gen == d->gen) {
+        run(d->kind, d->link, d->data, d->len);
+        ble_port_write_rsp(&d->req, BLE_PORT_OK);
+    } else {
+        ESP_LOGW(TAG, "conn %u gone; dropped %u-byte write.", (unsigned)d->req.conn_id, (unsigned)d->len);
+    }
+    portENTER_CRITICAL(&s_mux);
+    s_free |= 1u << slot;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void gatt_defer_note_cb(uint32_t us, int event) {
+    if (us > s_st.cb_max_us) {
+        s_st.cb_max_us  = us;
+        s_st.cb_max_evt = event;
+    }
+}
+
+void gatt_defer_get_stats(gatt_defer_stats_t *out) {
+    if (out) *out = s_st;
+}
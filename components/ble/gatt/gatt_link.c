@@ -0,0 +1,67 @@
+// gatt_link.c, per-connection slots: conn_id, MTU, CCC bits, command context, TX queue.
+#include <string.h>
+#include "esp_log.h"
+
+#include "gatt_priv.h"
+
+static const char *TAG = "GATT.link";
+
+ble_link_t g_links[BLE_MAX_CONN];
+
+void gatt_link_init(void) {
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        ble_link_t *l = &g_links[i];
+        if (!l->cli) l->cli = ble_cmd_create();
+        gatt_tx_init(&l->tx);
+        if (!l->cli || !l->tx.send) ESP_LOGE(TAG, "slot %d: out of memory", i);
+    }
+}
+
+ble_link_t *gatt_link_open(uint16_t conn_id) {
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        ble_link_t *l = &g_links[i];
+        if (l->used || !l->cli) continue;
+        l->conn_id     = conn_id;
+        l->gen++;
+        l->mtu_payload = 20;
+        l->ccc         = 0;
+        l->bin         = 0;
+        l->dht_f_reset = true;
+        l->hist_tier   = DHT_TIER_MIN;
+        l->hist_count  = 0;
+        l->hist_len    = 0;
+        l->hist_sent   = 0;
+        gatt_tx_reset(l);
+        l->used = true;
+        return l;
+    }
+    return NULL;
+}
+
+ble_link_t *gatt_link_find(uint16_t conn_id) {
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        if (g_links[i].used && g_links[i].conn_id == conn_id) return &g_links[i];
+    }
+    return NULL;
+}
+
+void gatt_link_close(ble_link_t *l) {
+    if (!l) return;
+    l->used = false;
+    l->ccc  = 0;
+    gatt_tx_reset(l);
+    l->conn_id = 0xFFFF;
+}
+
+uint8_t gatt_link_count(void) {
+    uint8_t n = 0;
+    for (int i = 0; i < BLE_MAX_CONN; ++i) n += g_links[i].used ? 1 : 0;
+    return n;
+}
+
+bool gatt_link_any(uint8_t ccc_bit) {
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        if (g_links[i].used && (g_links[i].ccc & ccc_bit)) return true;
+    }
+    return false;
+}
@@ -2,100 +2,217 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "esp_timer.h"
+
 #include "gatt_priv.h"
+#include "gatt_bin.h"      // binary values (FMT characteristic)
+#include "fb_priv.h"       // ble_post(BLE_EVT_TLM)
+#include "errsrc.h"
+#include "sensor.h"        // latest DHT record for reads / new subscribers
 #include "sys_sink.h" 
+#include "app_cfg.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static errsrc_t s_last_errsrc_sent = ES_COUNT;   /* nothing sent yet */
+
+/* Builds one value in text (bin = false) or binary (gatt_bin.h) from `src`. */
+typedef uint16_t (*val_fn)(bool bin, const void *src, uint8_t *out, uint16_t cap);
+
+/* One notification of the value to l (if given) or to every live link that enabled ccc_bit,
+ * in the format that link picked; each encoding is built at most once, and only if some
+ * recipient wants it. Each copy is clamped to that link's negotiated ATT payload. */
+static void notify_links(ble_link_t *only, uint8_t ccc_bit, int idx, val_fn fn, const void *src) {
+    if (!ble_port_gatt_ready()) return;
+    uint8_t  buf[2][128];
+    uint16_t len[2] = { 0, 0 };
+    bool     built[2] = { false, false };
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        ble_link_t *l = &g_links[i];
+        if (only && l != only) continue;
+        if (!l->used || !(l->ccc & ccc_bit)) continue;
+        int b = (l->bin & ccc_bit) ? 1 : 0;
+        if (!built[b]) {
+            len[b] = fn(b != 0, src, buf[b], sizeof(buf[b]));
+            built[b] = true;
+        }
+        if (!len[b]) continue;
+        uint16_t send_len = (len[b] > l->mtu_payload) ? l->mtu_payload : len[b];
+        ble_port_notify(l->conn_id, (uint8_t)idx, buf[b], send_len);
+    }
+}
 
-static char s_last_errsrc_sent[64] = "";
-
-/* Update characteristic value always; send indicate only if changed. */
-static void errsrc_notify_if_changed(const char *current_err) {
-    if (!current_err) current_err = "NONE";
-
-    size_t used = strnlen(current_err, sizeof(s_last_errsrc_sent) - 1); // 63
-
-    if (g_gatts_if != ESP_GATT_IF_NONE && gatt_handle_table[IDX_ERRSRC_VAL]) {
-        esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_ERRSRC_VAL],
-                                     (uint16_t)used,
-                                     (const uint8_t*)current_err);
+/* ---- ERRSRC ---- */
+
+static uint16_t errsrc_val(bool bin, const void *src, uint8_t *out, uint16_t cap) {
+    errsrc_t code = *(const errsrc_t *)src;
+    if (bin) {
+        errsrc_stat_t st;
+        errsrc_get_stats(code, &st);
+        int64_t now = esp_timer_get_time();
+        uint32_t ms = (st.last_enter_us && now > st.last_enter_us)
+                    ? (uint32_t)((now - st.last_enter_us) / 1000) : 0;
+        return (uint16_t)gatt_bin_errsrc((uint8_t)code, ms, out, cap);
     }
+    const char *s = errsrc_to_string(code);
+    size_t n = strnlen(s, ERRSRC_STR_MAX - 1);
+    if (n > cap) n = cap;
+    memcpy(out, s, n);
+    return (uint16_t)n;
+}
 
-    if (strncmp(current_err, s_last_errsrc_sent, sizeof(s_last_errsrc_sent)) == 0) return;
+uint16_t gatt_errsrc_value(const ble_link_t *l, uint8_t *out, uint16_t cap) {
+    errsrc_t code = errsrc_get_code();
+    return errsrc_val(l && (l->bin & GATT_CCC_ERRSRC), &code, out, cap);
+}
 
-    if (es_notify_enabled && g_conn_id != 0xFFFF && g_gatts_if != ESP_GATT_IF_NONE) {
-        uint16_t send_len = (uint16_t)((used > (size_t)g_mtu_payload) ? g_mtu_payload : used);
-        esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id,
-                                    gatt_handle_table[IDX_ERRSRC_VAL],
-                                    send_len, (uint8_t *)current_err, false);
-    }
+/* Notify only on change; reads always go through gatt_errsrc_value(). */
+void gatt_server_notify_errsrc(errsrc_t code, const char *err) {
+    (void)err;                                      /* interned string of code */
+    if (code == s_last_errsrc_sent) return;
+    notify_links(NULL, GATT_CCC_ERRSRC, IDX_ERRSRC_VAL, errsrc_val, &code);
+    s_last_errsrc_sent = code;
+    ble_post(BLE_EVT_TLM);
+}
 
-    strncpy(s_last_errsrc_sent, current_err, sizeof(s_last_errsrc_sent) - 1);
-    s_last_errsrc_sent[sizeof(s_last_errsrc_sent) - 1] = '\0';
+void gatt_errsrc_push(ble_link_t *l) {
+    errsrc_t code = errsrc_get_code();
+    notify_links(l, GATT_CCC_ERRSRC, IDX_ERRSRC_VAL, errsrc_val, &code);
 }
 
 /* Public notify helpers */
+void gatt_link_send_line(ble_link_t *l, const char *s) {
+    if (!l || !s) return;
+    gatt_tx_send_line(l, s, strlen(s));
+}
+
+/* Status lines not tied to a request go to every central (notified if TX notify is on). */
 void gatt_server_send_status(const char *s) {
     if (!s) return;
     size_t slen = strlen(s);
+    for (int i = 0; i < BLE_MAX_CONN; ++i) gatt_tx_send_line(&g_links[i], s, slen);
+}
 
-    if (g_gatts_if != ESP_GATT_IF_NONE && gatt_handle_table[IDX_TX_VAL]) {
-        esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_TX_VAL],
-                                     (uint16_t)slen, (const uint8_t*)s);
-    }
-    if (!tx_notify_enabled || g_conn_id == 0xFFFF || g_gatts_if == ESP_GATT_IF_NONE) return;
-
-    const uint8_t *p = (const uint8_t *)s;
-    size_t len = slen;
+/* ---- ALERT ---- */
 
-    uint16_t max_chunk = g_mtu_payload;
-    if (max_chunk < 1)   max_chunk = 1;
-    if (max_chunk > 180) max_chunk = 180;
+static uint16_t alert_val(bool bin, const void *src, uint8_t *out, uint16_t cap) {
+    const alert_record_t *rec = (const alert_record_t *)src;
+    if (bin) return (uint16_t)gatt_bin_alert((uint8_t)rec->code, rec->seq, out, cap);
+    size_t dlen = strnlen(rec->detail, ALERT_DETAIL_MAX);
+    int n = snprintf((char *)out, cap, "ALERT seq=%u code=%u %.*s",
+                     (unsigned)rec->seq, (unsigned)rec->code, (int)dlen, rec->detail);
+    if (n < 0) n = 0;
+    if (n >= (int)cap) n = (int)cap - 1;
+    return (uint16_t)n;
+}
 
-    while (len) {
-        uint16_t chunk = (len > max_chunk) ? max_chunk : (uint16_t)len;
-        esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id, gatt_handle_table[IDX_TX_VAL],
-                                    chunk, (uint8_t *)p, false);
-        p += chunk;
-        len -= chunk;
-    }
-    const uint8_t nl = '\n';
-    esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id, gatt_handle_table[IDX_TX_VAL],
-                                1, (uint8_t *)&nl, false);
+uint16_t gatt_alert_value(const ble_link_t *l, uint8_t *out, uint16_t cap) {
+    alert_record_t rec;
+    alert_latest(&rec);
+    return alert_val(l && (l->bin & GATT_CCC_ALERT), &rec, out, cap);
 }
 
 void gatt_alert_notify(const void *rec_any) {
     const alert_record_t *rec = (const alert_record_t *)rec_any;
     if (!rec) return;
+    notify_links(NULL, GATT_CCC_ALERT, IDX_ALERT_VAL, alert_val, rec);
+    ble_post(BLE_EVT_TLM);
+}
 
-    size_t dlen = strnlen(rec->detail, ALERT_DETAIL_MAX);
-    char line[128];
-    int n = snprintf(line, sizeof(line), "ALERT seq=%u code=%u %.*s",
-                     (unsigned)rec->seq, (unsigned)rec->code,
-                     (int)dlen, rec->detail);
-    if (n < 0) n = 0;
-    size_t used = (size_t)n;
+void gatt_alert_push(ble_link_t *l) {
+    alert_record_t snap;
+    alert_latest(&snap);
+    notify_links(l, GATT_CCC_ALERT, IDX_ALERT_VAL, alert_val, &snap);
+}
 
-    if (g_gatts_if != ESP_GATT_IF_NONE && gatt_handle_table[IDX_ALERT_VAL]) {
-        esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_ALERT_VAL],
-                                     (uint16_t)used, (const uint8_t*)line);
-    }
+/* Override of the syscoord hook: forward alerts to BLE. */
+void syscoord_alert_sink(const alert_record_t *rec) {
+    gatt_alert_notify(rec);
+}
+
+/* ---- DHT ---- */
+
+static int16_t centi(float v, int32_t lo, int32_t hi) {
+    float c = v * 100.0f;
+    int32_t r = (int32_t)(c < 0 ? c - 0.5f : c + 0.5f);
+    return (int16_t)(r < lo ? lo : (r > hi ? hi : r));
+}
 
-    /* Clamp to negotiated ATT payload (g_mtu_payload). */
-    uint16_t send_len = (uint16_t)((used > (size_t)g_mtu_payload) ? g_mtu_payload : used);
+/* From the sampler callback (floats). */
+static uint16_t dht_sample_val(bool bin, const void *src, uint8_t *out, uint16_t cap) {
+    const dht_sample_t *s = (const dht_sample_t *)src;
+    if (bin) {
+        const gatt_bin_dht_t d = {
+            .valid   = s->valid,
+            .t_cdeg  = s->valid ? centi(s->temp_c, -32767, 32767) : GATT_BIN_T_NA,
+            .rh_cpct = s->valid ? (uint16_t)centi(s->rh, 0, 10000) : GATT_BIN_RH_NA,
+            .age_ms  = s->age_ms,
+        };
+        return (uint16_t)gatt_bin_dht(&d, out, cap);
+    }
+    int n = s->valid
+        ? snprintf((char *)out, cap, "DHT T=%.1fC RH=%.1f%% age=%ums", (double)s->temp_c, (double)s->rh,
+                   (unsigned)s->age_ms)
+        : snprintf((char *)out, cap, "DHT NA");
+    if (n < 0) n = 0;
+    if (n >= (int)cap) n = (int)cap - 1;
+    return (uint16_t)n;
+}
 
-    if (alert_notify_enabled && g_conn_id != 0xFFFF && g_gatts_if != ESP_GATT_IF_NONE) {
-        esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id,
-                                    gatt_handle_table[IDX_ALERT_VAL],
-                                    send_len, (uint8_t*)line, false);
+/* From the latest sensor record (reads, and the first value a new subscriber gets). */
+static uint16_t dht_rec_val(bool bin, const void *src, uint8_t *out, uint16_t cap) {
+    (void)src;
+    sensor_rec_t r;
+    bool have = sensor_latest(sensor_find("DHT"), &r);
+    if (bin) {
+        gatt_bin_dht_t d = { .valid = have && r.valid, .t_cdeg = GATT_BIN_T_NA,
+                             .rh_cpct = GATT_BIN_RH_NA, .age_ms = have ? r.age_ms : 0 };
+        for (unsigned i = 0; d.valid && i < r.n; ++i) {
+            if (r.qty[i] == SENSOR_Q_TEMP_DC) d.t_cdeg  = (int16_t)(r.v[i] * 10);
+            if (r.qty[i] == SENSOR_Q_RH_DP)   d.rh_cpct = (uint16_t)(r.v[i] * 10);
+        }
+        return (uint16_t)gatt_bin_dht(&d, out, cap);
     }
+    int n;
+    if (have) {
+        n = sensor_format(&r, (char *)out, cap);
+        if (r.valid && n < (int)cap)
+            n += snprintf((char *)out + n, cap - n, " age=%ums", (unsigned)r.age_ms);
+    } else {
+        n = snprintf((char *)out, cap, "DHT NA");
+    }
+    if (n < 0) n = 0;
+    if (n > (int)cap) n = (int)cap;
+    return (uint16_t)n;
 }
 
+uint16_t gatt_dht_value(const ble_link_t *l, uint8_t *out, uint16_t cap) {
+    return dht_rec_val(l && (l->bin & GATT_CCC_DHT), NULL, out, cap);
+}
 
-void gatt_server_notify_errsrc(const char *err) {
-    if (!err || !*err) err = "NONE";
-    errsrc_notify_if_changed(err);
+/* DHT-CCC push: deadband + heartbeat so airtime follows change, not the sample rate.
+ * Each link has its own filter, only touched by the sampler task; CCC writes just
+ * request a reset. */
+void gatt_dht_push(ble_link_t *l) {
+    if (!l) return;
+    l->dht_f_reset = true;
+    notify_links(l, GATT_CCC_DHT, IDX_DHT_VAL, dht_rec_val, NULL);
 }
 
-/* Override of the syscoord hook: forward alerts to BLE. */
-void syscoord_alert_sink(const alert_record_t *rec) {
-    gatt_alert_notify(rec);
+void gatt_dht_on_sample(const dht_sample_t *s) {
+    if (!s || !gatt_link_any(GATT_CCC_DHT) || !ble_port_gatt_ready()) return;
+
+    uint32_t now = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        ble_link_t *l = &g_links[i];
+        if (!l->used || !(l->ccc & GATT_CCC_DHT)) continue;
+        if (l->dht_f_reset) {
+            const dht_filter_cfg_t cfg = { .db_t_dc = DHT_BLE_DB_T_DC, .db_rh_dp = DHT_BLE_DB_RH_DP,
+                                           .heartbeat_ms = DHT_BLE_HEARTBEAT_MS };
+            dht_filter_init(&l->dht_f, &cfg);
+            l->dht_f_reset = false;
+        }
+        if (!dht_filter_pass(&l->dht_f, s, now)) continue;
+        notify_links(l, GATT_CCC_DHT, IDX_DHT_VAL, dht_sample_val, s);
+    }
 }
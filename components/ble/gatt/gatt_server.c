@@ -4,219 +4,332 @@
 #include <stdbool.h>
 
 #include "esp_log.h"
-#include "esp_gatts_api.h"
 
 #include "alerts.h"
 #include "errsrc.h"
 #include "syscoord.h"
 #include "ota_bridge.h"      // ctrl/data/disconnect hooks for OTA over GATT
-#include "dht.h"            // DHT latest reading
+#include "dht.h"            // DHT stream hold / subscribers
 
 #include "gatt_server.h"
-#include "gatt_priv.h"      // internal helpers, handle table, flags, etc.
+#include "gatt_priv.h"      // internal helpers, links, IDX_*, host backend
+#include "ble_txq.h"        // BLE_ATT_PAYLOAD_MAX
+#include "app_cfg.h"
 
 static const char *TAG = "GATT.srv";
 
-/* If fallback provides this, it will override at link time. */
-__attribute__((weak)) void ble_set_connected(bool on) { (void)on; }
-
-/* Shared state (defined here, extern'd in gatt_priv.h) */
-esp_gatt_if_t g_gatts_if = ESP_GATT_IF_NONE;
-uint16_t g_conn_id = 0xFFFF;
-uint16_t g_mtu_payload = 20;
-
-bool tx_notify_enabled = false;
-bool es_notify_enabled = false;
-bool alert_notify_enabled = false;
-/* dht notify gate */
-bool dht_notify_enabled = false;
-
-uint16_t gatt_handle_table[EFBE_IDX_NB];
-uint8_t cccd_tx_val[2] = {0,0};
-uint8_t cccd_err_val[2] = {0,0};
-uint8_t cccd_alert_val[2] = {0,0};
-/* CCC storage for DHT char */
-uint8_t cccd_dht_val[2] = {0,0};
-
-ble_cmd_t *g_ble_cli = NULL;
-
-/* Helpers to refresh readable values just before a READ/NOTIFY */
-static void on_read_errsrc(void) {
-    const char *err = errsrc_get();
-    if (!err) err = "NONE";
-    esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_ERRSRC_VAL],
-                                 (uint16_t)strlen(err),
-                                 (const uint8_t*)err);
-}
-
-static void on_read_alert(void) {
-    alert_record_t rec; alert_latest(&rec);
-    char line[128];
-    int n = snprintf(line, sizeof(line),
-                     "ALERT seq=%u code=%u %s",
-                     (unsigned)rec.seq, (unsigned)rec.code, rec.detail);
-    if (n < 0) n = 0;
-    size_t used = strnlen(line, sizeof(line));
-    esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_ALERT_VAL],
-                                 (uint16_t)used,
-                                 (const uint8_t*)line);
-}
-
-/* build+set the DHT readout string */
-static uint16_t on_read_dht_and_len(const uint8_t **out_ptr_opt, uint8_t *tmp_buf, uint16_t tmp_sz) {
-    dht_sample_t s; dht_read_latest(&s);
-    int n;
-    if (s.valid) {
-        n = snprintf((char*)tmp_buf, tmp_sz, "DHT T=%.1fC RH=%.1f%% age=%ums",
-                     (double)s.temp_c, (double)s.rh, (unsigned)s.age_ms);
-    } else {
-        n = snprintf((char*)tmp_buf, tmp_sz, "DHT NA");
-    }
-    if (n < 0) n = 0;
-    if (n > (int)tmp_sz) n = (int)tmp_sz;
-    esp_ble_gatts_set_attr_value(gatt_handle_table[IDX_DHT_VAL],
-                                 (uint16_t)n, (const uint8_t*)tmp_buf);
-    if (out_ptr_opt) *out_ptr_opt = tmp_buf;
-    return (uint16_t)n;
-}
-
-/* ---- GATTS dispatcher ---- */
-static void gatts_event_handler(esp_gatts_cb_event_t event,
-                                esp_gatt_if_t gatts_if,
-                                esp_ble_gatts_cb_param_t *param)
+/* If fallback provides this, it will override at link time. n = live connections. */
+__attribute__((weak)) void ble_set_links(uint8_t n) { (void)n; }
+
+uint16_t gatt_ccc_decode(const uint8_t *val, uint16_t len)
 {
-    switch (event) {
-    case ESP_GATTS_REG_EVT:
-        g_gatts_if = gatts_if;
-        gatt_build_attr_table(gatts_if);
-        break;
+    if (!val || !len) return 0;
+    uint16_t v = val[0];
+    if (len > 1) v |= ((uint16_t)val[1]) << 8;   // CCC is little-endian
+    return v;
+}
 
-    case ESP_GATTS_CREAT_ATTR_TAB_EVT:
-        gatt_on_attr_table_created(param);
-        break;
+/* Copy v[off..len) into out; off > 0 is a read-blob continuation. */
+static ble_port_status_t rd_slice(const void *v, size_t len, uint16_t off,
+                                  uint8_t *out, uint16_t cap, uint16_t *n) {
+    if (off > len) return BLE_PORT_ERR_OFFSET;
+    size_t k = len - off;
+    if (k > cap) k = cap;
+    memcpy(out, (const uint8_t *)v + off, k);
+    *n = (uint16_t)k;
+    return BLE_PORT_OK;
+}
 
-    case ESP_GATTS_START_EVT:
-        ESP_LOGI(TAG, "Service started");
-        syscoord_on_ble_service_started();
-        break;
+/* FMT bits are GATT_CCC_* and on the wire; rows must only be appended. */
+_Static_assert(GATT_CCC_ERRSRC == 0x02 && GATT_CCC_ALERT == 0x04 && GATT_CCC_DHT == 0x08,
+               "FMT bit values changed");
+
+/* CCC index -> GATT_CCC_* bit. */
+#define CCC_BIT(n, ...) [IDX_##n##_CCC] = GATT_CCC_##n,
+static const uint8_t s_ccc_bit[EFBE_IDX_NB] = { GATT_SVC_TABLE(GATT_ROW_NONE, CCC_BIT) };
 
-    case ESP_GATTS_MTU_EVT: {
-        uint16_t mtu = param->mtu.mtu;
-        /* ATT payload = MTU - 3; clamp within sane bounds */
-        g_mtu_payload = (mtu > 23) ? (mtu - 3) : 20;
-        if (g_mtu_payload < 1)   g_mtu_payload = 1;
-        if (g_mtu_payload > 180) g_mtu_payload = 180;
-        ESP_LOGI(TAG, "MTU updated: mtu=%u payload=%u", (unsigned)mtu, (unsigned)g_mtu_payload);
+/* One central (un)subscribed: flip its bit, then prime what it just subscribed to. */
+static void ccc_set(ble_link_t *l, uint8_t bit, bool on) {
+    bool was = (l->ccc & bit) != 0;
+    if (on) l->ccc |= bit; else l->ccc &= (uint8_t)~bit;
+
+    switch (bit) {
+    case GATT_CCC_TX:
+        if (on != was) gatt_tx_reset(l);
+        break;
+    case GATT_CCC_ERRSRC:
+        if (on) gatt_errsrc_push(l);
+        break;
+    case GATT_CCC_ALERT:
+        if (on) gatt_alert_push(l);
+        break;
+    case GATT_CCC_DHT:
+        /* Any subscriber keeps the sampler running; each gets filtered samples. */
+        dht_stream_hold(DHT_HOLD_BLE, gatt_link_any(GATT_CCC_DHT));
+        if (on) gatt_dht_push(l);
+        break;
+    default:
         break;
     }
+}
 
-    case ESP_GATTS_READ_EVT:
-        if (param->read.handle == gatt_handle_table[IDX_ERRSRC_VAL]) {
-            on_read_errsrc();
-
-        } else if (param->read.handle == gatt_handle_table[IDX_ALERT_VAL]) {
-            on_read_alert();
-
-        } else if (param->read.handle == gatt_handle_table[IDX_DHT_VAL]) {
-            uint8_t tmp[64];
-            const uint8_t *p = NULL;
-            uint16_t n = on_read_dht_and_len(&p, tmp, sizeof(tmp));
-
-            esp_gatt_rsp_t rsp;
-            memset(&rsp, 0, sizeof(rsp));
-            rsp.attr_value.handle = param->read.handle;
-            rsp.attr_value.len = n;
-            if (n > sizeof(rsp.attr_value.value)) n = sizeof(rsp.attr_value.value);
-            memcpy(rsp.attr_value.value, p, n);
-
-            esp_ble_gatts_send_response(gatts_if, param->read.conn_id,
-                                        param->read.trans_id, ESP_GATT_OK, &rsp);
-        }
-    break;
-
-    case ESP_GATTS_CONNECT_EVT:
-        g_conn_id = param->connect.conn_id;
-        tx_notify_enabled = es_notify_enabled = alert_notify_enabled = false;
-        dht_notify_enabled = false;  
-        syscoord_on_ble_state(true);
-        ble_set_connected(true);
-        if (g_ble_cli) {
-            ble_cmd_on_connect(g_ble_cli, gatts_if, g_conn_id, gatt_handle_table[IDX_TX_VAL]);
-        }
-        break;
+/* ---- Per-attribute handlers, bound to indexes by GATT_SVC_TABLE ----
+ * Reads may arrive for a link we refused (l == NULL); writes other than CCC never do.
+ * A reader fills out[] from `off`; a writer answers r through ble_port_write_rsp(). */
+typedef ble_port_status_t (*gatt_rd_fn)(ble_link_t *l, uint8_t idx, uint16_t off,
+                                        uint8_t *out, uint16_t cap, uint16_t *n);
+typedef void (*gatt_wr_fn)(const ble_port_req_t *r, ble_link_t *l, uint8_t idx,
+                           const uint8_t *v, uint16_t len);
+
+static ble_port_status_t rd_ccc(ble_link_t *l, uint8_t idx, uint16_t off,
+                                uint8_t *out, uint16_t cap, uint16_t *n) {
+    const uint8_t v[2] = { (l && (l->ccc & s_ccc_bit[idx])) ? 0x01 : 0x00, 0x00 };
+    return rd_slice(v, sizeof(v), off, out, cap, n);
+}
 
-    case ESP_GATTS_DISCONNECT_EVT:
-        ble_ota_on_disconnect();
-        syscoord_on_ble_state(false);
-        ble_set_connected(false);
-        if (g_ble_cli) ble_cmd_on_disconnect(g_ble_cli);
-        g_conn_id = 0xFFFF;
-        tx_notify_enabled = es_notify_enabled = alert_notify_enabled = false;
-        dht_notify_enabled = false; 
-        break;
+static void wr_ccc(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    ble_port_write_rsp(r, l ? BLE_PORT_OK : BLE_PORT_ERR_STATE);
+    if (!l) return;
+    ccc_set(l, s_ccc_bit[idx], (gatt_ccc_decode(v, len) & 0x0001) != 0);
+}
 
-    case ESP_GATTS_WRITE_EVT: {
-        uint16_t h = param->write.handle;
-
-        if (h == gatt_handle_table[IDX_RX_VAL]) {
-            if (g_ble_cli) ble_cmd_on_rx(g_ble_cli, param->write.value, param->write.len);
-
-        } else if (h == gatt_handle_table[IDX_WIFI_VAL]) {
-            gatt_on_wifi_cred_write(param->write.value, param->write.len);
-
-        } else if (h == gatt_handle_table[IDX_TX_CCC]) {
-            tx_notify_enabled = (gatt_ccc_decode(param->write.value, param->write.len) & 0x0001) != 0;
-
-        } else if (h == gatt_handle_table[IDX_ERRSRC_CCC]) {
-            es_notify_enabled = (gatt_ccc_decode(param->write.value, param->write.len) & 0x0001) != 0;
-            if (es_notify_enabled) {
-                gatt_server_notify_errsrc(errsrc_get());
-            }
-
-        } else if (h == gatt_handle_table[IDX_ALERT_CCC]) {
-            alert_notify_enabled = (gatt_ccc_decode(param->write.value, param->write.len) & 0x0001) != 0;
-            if (alert_notify_enabled) {
-                alert_record_t snap; alert_latest(&snap);
-                gatt_alert_notify(&snap);
-            }
-
-        } else if (h == gatt_handle_table[IDX_DHT_CCC]) {
-            /* DHT CCC enable/disable + immediate notify of latest value */
-            dht_notify_enabled = (gatt_ccc_decode(param->write.value, param->write.len) & 0x0001) != 0;
-            if (dht_notify_enabled) {
-                uint8_t tmp[64];
-                const uint8_t *p = NULL;
-                uint16_t n = on_read_dht_and_len(&p, tmp, sizeof(tmp));
-                if (n > g_mtu_payload) n = g_mtu_payload;  // clamp to negotiated ATT payload.
-                (void)esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id,
-                                                gatt_handle_table[IDX_DHT_VAL],
-                                                n, (uint8_t*)p, false);
-            }
-
-        } else if (h == gatt_handle_table[IDX_OTA_CTRL_VAL]) {
-            ble_ota_on_ctrl_write(param->write.value, param->write.len);
-
-        } else if (h == gatt_handle_table[IDX_OTA_DATA_VAL]) {
-            ble_ota_on_data_write(param->write.value, param->write.len);
-        }
-        break;
+/* TX: the newest line this link was sent, read out of its ring; "OK" before the first. */
+static ble_port_status_t rd_tx(ble_link_t *l, uint8_t idx, uint16_t off,
+                               uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    if (l && gatt_tx_read_last(l, off, out, cap, n) && (off || *n)) return BLE_PORT_OK;
+    return rd_slice("OK", 2, off, out, cap, n);
+}
+
+/* ERRSRC / ALERT / DHT in the format this link picked (text for a refused link). */
+static ble_port_status_t rd_errsrc(ble_link_t *l, uint8_t idx, uint16_t off,
+                                   uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    uint8_t tmp[ERRSRC_STR_MAX];
+    return rd_slice(tmp, gatt_errsrc_value(l, tmp, sizeof(tmp)), off, out, cap, n);
+}
+
+static ble_port_status_t rd_alert(ble_link_t *l, uint8_t idx, uint16_t off,
+                                  uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    uint8_t tmp[128];
+    return rd_slice(tmp, gatt_alert_value(l, tmp, sizeof(tmp)), off, out, cap, n);
+}
+
+static ble_port_status_t rd_dht(ble_link_t *l, uint8_t idx, uint16_t off,
+                                uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    uint8_t tmp[64];
+    return rd_slice(tmp, gatt_dht_value(l, tmp, sizeof(tmp)), off, out, cap, n);
+}
+
+/* FMT: GATT_CCC_* bits of the characteristics this link reads and gets notified in binary. */
+#define FMT_BIN_MASK (GATT_CCC_ERRSRC | GATT_CCC_ALERT | GATT_CCC_DHT)
+
+static ble_port_status_t rd_fmt(ble_link_t *l, uint8_t idx, uint16_t off,
+                                uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    const uint8_t v = l ? l->bin : 0;
+    return rd_slice(&v, sizeof(v), off, out, cap, n);
+}
+
+static void wr_fmt(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)idx;
+    bool ok = v && len == 1 && !(v[0] & ~FMT_BIN_MASK);
+    if (ok) l->bin = v[0];
+    ble_port_write_rsp(r, ok ? BLE_PORT_OK : BLE_PORT_ERR_RANGE);
+}
+
+static void hist_snapshot(ble_link_t *l) {
+    size_t want = l->hist_count ? l->hist_count : sizeof(l->hist_blob);
+    l->hist_len = (uint16_t)dht_history_pack(l->hist_tier, want, l->hist_blob, sizeof(l->hist_blob));
+}
+
+/* DHT history window of this link. A read at offset 0 snapshots the window; read-blob
+ * continuations are served from that snapshot so the client sees one consistent blob,
+ * whatever other centrals read meanwhile. A refused link gets the default window, unsplit.
+ * A host that hides the offset (BLE_PORT_OFF_WHOLE) gets the whole snapshot each time;
+ * the next one is taken once a response came out shorter than MTU - 1, which ends a
+ * long read. */
+static ble_port_status_t rd_dht_hist(ble_link_t *l, uint8_t idx, uint16_t off,
+                                     uint8_t *out, uint16_t cap, uint16_t *n) {
+    (void)idx;
+    if (!l) {
+        if (off && off != BLE_PORT_OFF_WHOLE) return BLE_PORT_ERR_OFFSET;
+        *n = (uint16_t)dht_history_pack(DHT_TIER_MIN, cap, out, cap);
+        return BLE_PORT_OK;
+    }
+    if (off == BLE_PORT_OFF_WHOLE) {
+        if (!l->hist_sent) hist_snapshot(l);
+        l->hist_sent += l->mtu_payload + 2;             // one Read (Blob) Response: MTU - 1
+        if (l->hist_sent > l->hist_len) l->hist_sent = 0;
+        off = 0;
+    } else if (off == 0) {
+        hist_snapshot(l);
+    }
+    return rd_slice(l->hist_blob, l->hist_len, off, out, cap, n);
+}
+
+static void wr_dht_hist(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)idx;
+    bool ok = v && len && v[0] < DHT_TIER_COUNT;
+    if (ok) {
+        l->hist_tier  = (dht_tier_t)v[0];
+        l->hist_count = (len > 1) ? v[1] : 0;
+        l->hist_sent  = 0;
     }
+    /* RSP_BY_APP covers writes too. */
+    ble_port_write_rsp(r, ok ? BLE_PORT_OK : BLE_PORT_ERR_RANGE);
+}
 
+static void wr_rx(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)idx;
+    gatt_defer_write(GATT_DEFER_RX, l, r, v, len);
+}
 
-    default:
-        break;
+static void wr_wifi(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)idx;
+    gatt_defer_write(GATT_DEFER_WIFI, l, r, v, len);
+}
+
+static void wr_ota_ctrl(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)idx;
+    gatt_defer_write(GATT_DEFER_OTA_CTRL, l, r, v, len);
+}
+
+static void wr_ota_data(const ble_port_req_t *r, ble_link_t *l, uint8_t idx, const uint8_t *v, uint16_t len) {
+    (void)r; (void)idx;
+    ble_ota_on_data_write(l->conn_id, v, len);
+}
+
+typedef struct { gatt_rd_fn rd; gatt_wr_fn wr; } gatt_attr_ops_t;
+
+#define OPS_CHR(n, tail, props, perm, max_len, rsp, rd, wr) \
+    [IDX_##n##_VAL] = { rd, wr },
+#define OPS_NTF(n, tail, props, perm, max_len, rsp, rd, wr) \
+    [IDX_##n##_VAL] = { rd, wr }, [IDX_##n##_CCC] = { rd_ccc, wr_ccc },
+static const gatt_attr_ops_t s_ops[EFBE_IDX_NB] = { GATT_SVC_TABLE(OPS_CHR, OPS_NTF) };
+
+static void log_cb_stats(void) {
+    gatt_defer_stats_t st;
+    gatt_defer_get_stats(&st);
+    ESP_LOGI(TAG, "%s cb max=%u us (evt %d), writes deferred=%u inline=%u%s", ble_port_name(),
+             (unsigned)st.cb_max_us, st.cb_max_evt, (unsigned)st.deferred,
+             (unsigned)st.inline_fallback, BLE_DEFER_WRITES ? "" : " (deferral off)");
+}
+
+/* ---- Upcalls from the backend (ble_port.h), on the host task ---- */
+
+bool gatt_core_reads(uint8_t idx) {
+    return idx < EFBE_IDX_NB && s_ops[idx].rd;
+}
+
+ble_port_status_t gatt_core_read(uint16_t conn_id, uint8_t idx, uint16_t off,
+                                 uint8_t *out, uint16_t cap, uint16_t *n) {
+    *n = 0;
+    if (!gatt_core_reads(idx)) return BLE_PORT_OK;
+    if (off == BLE_PORT_OFF_WHOLE && idx != IDX_DHT_HIST_VAL) off = 0;   // no per-read state
+    return s_ops[idx].rd(gatt_link_find(conn_id), idx, off, out, cap, n);
+}
+
+void gatt_core_write(const ble_port_req_t *r, uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (idx >= EFBE_IDX_NB || !s_ops[idx].wr) return;
+    ble_link_t *l = gatt_link_find(r->conn_id);
+    if (!l && !s_ccc_bit[idx]) {
+        ble_port_write_rsp(r, BLE_PORT_ERR_STATE);
+        return;
     }
+    s_ops[idx].wr(r, l, idx, v, n);
+}
+
+void gatt_core_on_subscribe(uint16_t conn_id, uint8_t ccc_idx, bool on) {
+    ble_link_t *l = gatt_link_find(conn_id);
+    if (l && ccc_idx < EFBE_IDX_NB && s_ccc_bit[ccc_idx]) ccc_set(l, s_ccc_bit[ccc_idx], on);
+}
+
+void gatt_core_on_started(void) {
+    ESP_LOGI(TAG, "Service started");
+    syscoord_on_ble_service_started();
+}
+
+void gatt_core_on_mtu(uint16_t conn_id, uint16_t mtu) {
+    ble_link_t *l = gatt_link_find(conn_id);
+    if (!l) return;
+    /* ATT payload = MTU - 3; clamp within sane bounds */
+    l->mtu_payload = (mtu > 23) ? (mtu - 3) : 20;
+    if (l->mtu_payload < 1)   l->mtu_payload = 1;
+    if (l->mtu_payload > BLE_ATT_PAYLOAD_MAX) l->mtu_payload = BLE_ATT_PAYLOAD_MAX;
+    ESP_LOGI(TAG, "conn %u MTU updated: mtu=%u payload=%u", (unsigned)l->conn_id,
+             (unsigned)mtu, (unsigned)l->mtu_payload);
+}
+
+void gatt_core_on_sent(uint16_t conn_id, uint8_t idx, bool ok, bool congested) {
+    if (idx != IDX_TX_VAL) return;
+    gatt_tx_on_conf(gatt_link_find(conn_id), ok, congested);
+}
+
+void gatt_core_on_congest(uint16_t conn_id, bool congested) {
+    gatt_tx_on_congest(gatt_link_find(conn_id), congested);
+}
+
+void gatt_core_on_connect(uint16_t conn_id, const uint8_t bda[6]) {
+    ble_link_t *l = gatt_link_open(conn_id);
+    if (!l) {
+        /* Advertising stops at the cap, so this is a race with a late connect. */
+        ESP_LOGW(TAG, "conn %u refused: %u links in use", (unsigned)conn_id, (unsigned)BLE_MAX_CONN);
+        ble_port_close(conn_id);
+        return;
+    }
+    memcpy(l->bda, bda, sizeof(l->bda));
+    ble_cmd_on_connect(l->cli, l);
+    syscoord_on_ble_state(true);
+    ble_set_links(gatt_link_count());
+}
+
+void gatt_core_on_disconnect(uint16_t conn_id) {
+    ble_link_t *l = gatt_link_find(conn_id);
+    if (!l) return;
+    ble_ota_on_disconnect(l->conn_id);
+    ble_cmd_on_disconnect(l->cli);
+    gatt_tx_log_stats(l);
+    log_cb_stats();
+    gatt_link_close(l);
+    dht_stream_hold(DHT_HOLD_BLE, gatt_link_any(GATT_CCC_DHT));
+    uint8_t n = gatt_link_count();
+    syscoord_on_ble_state(n > 0);
+    ble_set_links(n);
 }
 
 void gatt_server_init(void)
 {
-    ESP_ERROR_CHECK(esp_ble_gatts_register_callback(gatts_event_handler));
-    ESP_ERROR_CHECK(esp_ble_gatts_app_register(0x42));
+    ESP_ERROR_CHECK(ble_port_gatt_register());
 
-    if (!g_ble_cli) g_ble_cli = ble_cmd_create();
+    gatt_link_init();
 
     /* Syscoord owns alert subscription via syscoord_alert_sink hook. */
     errsrc_subscribe(gatt_server_notify_errsrc);
+    dht_subscribe(gatt_dht_on_sample);
+
+    ESP_LOGI(TAG, "GATT server registered on %s (up to %u links).", ble_port_name(), (unsigned)BLE_MAX_CONN);
+}
+
+void gatt_server_deinit(void)
+{
+    errsrc_unsubscribe(gatt_server_notify_errsrc);
+    dht_unsubscribe(gatt_dht_on_sample);
+
+    /* The host goes away without disconnect events; run the same cleanup here.
+     * Link slots (cli, TX lock) are kept for the next init. */
+    for (int i = 0; i < BLE_MAX_CONN; ++i) {
+        ble_link_t *l = &g_links[i];
+        if (!l->used) continue;
+        ble_ota_on_disconnect(l->conn_id);
+        ble_cmd_on_disconnect(l->cli);
+        gatt_link_close(l);
+    }
+    dht_stream_hold(DHT_HOLD_BLE, false);
+    syscoord_on_ble_state(false);
 
-    ESP_LOGI(TAG, "GATT server registered.");
+    ble_port_gatt_unregister();
+    ESP_LOGI(TAG, "GATT server unregistered.");
 }
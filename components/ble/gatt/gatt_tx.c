@@ -0,0 +1,137 @@
+// gatt_tx.c, TX-characteristic notify pump per link: coalesced, windowed, congestion-aware.
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "app_cfg.h"
+#include "gatt_priv.h"
+#include "ble_txq.h"
+
+static const char *TAG = "GATT.tx";
+
+/* Queue state is touched under s_mux only; tx.send elects the single task that drains a
+ * link. Nobody blocks on tx.send: a caller that loses the race leaves tx.kick set and the
+ * holder drains again, so the host task never waits on a task that waits on the host.
+ * Only the drainer consumes, so the bytes at the head stay put while it sends them. */
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void gatt_tx_init(gatt_tx_t *t) {
+    if (t && !t->send) t->send = xSemaphoreCreateMutex();
+}
+
+static void tx_drain(ble_link_t *l) {
+    ble_txq_t *q = &l->tx.q;
+    for (;;) {
+        uint16_t cap = l->mtu_payload;
+        if (cap < 1) cap = 1;
+        if (cap > BLE_ATT_PAYLOAD_MAX) cap = BLE_ATT_PAYLOAD_MAX;
+
+        const uint8_t *p = NULL;
+        size_t n = 0;
+        portENTER_CRITICAL(&s_mux);
+        if (ble_txq_ready(q, BLE_TX_WINDOW)) n = ble_txq_front(q, &p, cap);
+        portEXIT_CRITICAL(&s_mux);
+        if (!n || !l->used || !(l->ccc & GATT_CCC_TX) || !ble_port_gatt_ready()) return;
+
+        /* Both hosts copy the value, so the ring can be handed over directly. */
+        esp_err_t e = ble_port_notify(l->conn_id, IDX_TX_VAL, p, (uint16_t)n);
+        portENTER_CRITICAL(&s_mux);
+        if (e == ESP_OK) {
+            ble_txq_consume(q, n);
+            q->inflight++;
+        } else {
+            q->st.errors++;   // host queue full: the bytes stay queued for the next confirm/push
+        }
+        portEXIT_CRITICAL(&s_mux);
+        if (e != ESP_OK) return;
+    }
+}
+
+static void tx_pump(ble_link_t *l) {
+    gatt_tx_t *t = &l->tx;
+    if (!t->send) return;
+    t->kick = true;
+    while (t->kick) {
+        if (xSemaphoreTake(t->send, 0) != pdTRUE) return;   // holder sees the kick
+        t->kick = false;
+        tx_drain(l);
+        xSemaphoreGive(t->send);
+    }
+}
+
+void gatt_tx_reset(ble_link_t *l) {
+    if (!l) return;
+    portENTER_CRITICAL(&s_mux);
+    ble_txq_reset(&l->tx.q);
+    portEXIT_CRITICAL(&s_mux);
+}
+
+/* The only copy of a reply: into the link's ring, queued if TX notifications are on and
+ * kept as the newest line either way, so a TX read is served from the ring too. */
+void gatt_tx_send_line(ble_link_t *l, const char *s, size_t n) {
+    if (!l || !s || !l->used) return;
+    if (!(l->ccc & GATT_CCC_TX)) {
+        portENTER_CRITICAL(&s_mux);
+        ble_txq_keep_line(&l->tx.q, s, n);
+        portEXIT_CRITICAL(&s_mux);
+        return;
+    }
+    portENTER_CRITICAL(&s_mux);
+    bool ok = ble_txq_push_line(&l->tx.q, s, n);
+    portEXIT_CRITICAL(&s_mux);
+    if (!ok) ESP_LOGW(TAG, "conn %u: TX queue full; line dropped (%u bytes).", (unsigned)l->conn_id, (unsigned)n);
+    tx_pump(l);
+}
+
+bool gatt_tx_read_last(ble_link_t *l, uint16_t off, uint8_t *out, uint16_t cap, uint16_t *n) {
+    size_t k = 0;
+    portENTER_CRITICAL(&s_mux);
+    bool ok = ble_txq_last(&l->tx.q, off, out, cap, &k);
+    portEXIT_CRITICAL(&s_mux);
+    *n = (uint16_t)k;
+    return ok;
+}
+
+/* Both hosts report each notification (Bluedroid CONF_EVT, NimBLE NOTIFY_TX). congested
+ * (Bluedroid only) means the PDU was queued in L2CAP but the channel is now full. */
+void gatt_tx_on_conf(ble_link_t *l, bool ok, bool congested) {
+    if (!l) return;
+    ble_txq_t *q = &l->tx.q;
+    portENTER_CRITICAL(&s_mux);
+    if (q->inflight) q->inflight--;
+    if (congested) {
+        if (!q->congested) q->st.congest++;
+        q->congested = true;
+    } else if (!ok) {
+        q->st.errors++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    tx_pump(l);
+}
+
+void gatt_tx_on_congest(ble_link_t *l, bool congested) {
+    if (!l) return;
+    ble_txq_t *q = &l->tx.q;
+    portENTER_CRITICAL(&s_mux);
+    if (congested && !q->congested) q->st.congest++;
+    q->congested = congested;
+    portEXIT_CRITICAL(&s_mux);
+    if (!congested) tx_pump(l);
+}
+
+void gatt_tx_log_stats(ble_link_t *l) {
+    if (!l) return;
+    ble_txq_stats_t st;
+    portENTER_CRITICAL(&s_mux);
+    st = l->tx.q.st;
+    portEXIT_CRITICAL(&s_mux);
+    if (!st.lines) return;
+    /* notifications per line and bytes per notification, in hundredths */
+    unsigned npl = (unsigned)((st.notifs * 100ULL) / st.lines);
+    unsigned bpn = st.notifs ? (unsigned)((st.bytes * 100ULL) / st.notifs) : 0;
+    ESP_LOGI(TAG, "conn %u TX lines=%u notifs=%u (%u.%02u/line) bytes=%u (%u.%02u/notif) drop=%u congest=%u err=%u",
+             (unsigned)l->conn_id, (unsigned)st.lines, (unsigned)st.notifs, npl / 100, npl % 100,
+             (unsigned)st.bytes, bpn / 100, bpn % 100,
+             (unsigned)st.dropped, (unsigned)st.congest, (unsigned)st.errors);
+}
@@ -5,8 +5,7 @@
 #include <stdbool.h>
 #include "esp_log.h"
 
-#include "gatt_priv.h"    // g_ble_cli, ble_cmd_on_rx(...)
-#include "gatt_server.h"  // gatt_server_send_status(...)
+#include "gatt_priv.h"    // ble_link_t, ble_cmd_on_rx(...), gatt_link_send_line(...)
 
 static const char *TAG = "GATT.wifi";
 
@@ -17,8 +16,8 @@ static inline void rstrip_crlf(char *s) {
     }
 }
 
-void gatt_on_wifi_cred_write(const uint8_t *data, uint16_t len) {
-    if (!data || !len) return;
+void gatt_on_wifi_cred_write(ble_link_t *l, const uint8_t *data, uint16_t len) {
+    if (!l || !data || !len) return;
 
     char buf[200];
     if (len >= sizeof(buf)) len = sizeof(buf) - 1;
@@ -54,19 +53,17 @@ void gatt_on_wifi_cred_write(const uint8_t *data, uint16_t len) {
 
     if (!ok) {
         ESP_LOGW(TAG, "Wi-Fi creds format invalid.");
-        gatt_server_send_status("BADFMT");
+        gatt_link_send_line(l, "BADFMT");
         return;
     }
 
-    // Route to the normal command path so existing auth/policy applies.
+    // Route to this link's command path so its auth/policy applies.
     char cmdline[120];
     int n = snprintf(cmdline, sizeof(cmdline), "setwifi %s %s", ssid, pwd);
     if (n < 0) n = 0;
     if (n >= (int)sizeof(cmdline)) cmdline[sizeof(cmdline)-1] = '\0';
 
-    if (g_ble_cli) {
-        size_t L = strnlen(cmdline, sizeof(cmdline));
-        if (L < sizeof(cmdline) - 1) cmdline[L++] = '\n';
-        ble_cmd_on_rx(g_ble_cli, (const uint8_t*)cmdline, (uint16_t)L);
-    }
+    size_t L = strnlen(cmdline, sizeof(cmdline));
+    if (L < sizeof(cmdline) - 1) cmdline[L++] = '\n';
+    ble_cmd_on_rx(l->cli, (const uint8_t*)cmdline, (uint16_t)L);
 }
@@ -1,6 +1,7 @@
 //include/blefallback.h
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,10 +9,56 @@ extern "C" {
 
 /* Lifeboat / recovery BLE control (called by syscoord). */
 void ble_fallback_init(void);        /* bring up BLE stack if needed */
-void ble_fallback_stop(void);        /* tear down / stop advertising */
+void ble_fallback_stop(void);        /* stop advertising and free the whole BT stack */
 void ble_lifeboat_set(bool on);      /* enable/disable recovery advertising */
 void ble_start_advertising(void);    /* kick advertising when GATT is ready */
 
+/* Diagnostics bring-up: borrow() starts the stack only if it is down (false otherwise).
+ * give_back() stops it unless ble_fallback_init()/stop() claimed it meanwhile (false then);
+ * the check and the stop are one step, so RECOVERY never loses a stack it took over. */
+bool ble_fallback_borrow(void);
+bool ble_fallback_give_back(void);
+
+/* Heap around the last bring-up/teardown (free bytes, default caps). init/stop may be
+ * called from any task except the BLE worker and host callbacks; they serialize. */
+typedef struct {
+    bool     up;             /* stack currently initialised */
+    const char *host;        /* "bluedroid" / "nimble" once initialised, else NULL */
+    uint32_t cycles;         /* completed teardowns since boot */
+    uint32_t heap_pre_init;  /* free heap before the last init */
+    uint32_t heap_up;        /* ... after it */
+    uint32_t heap_down;      /* ... after the last teardown */
+    uint32_t largest_down;   /* largest free block after the last teardown */
+    uint32_t stop_ms;        /* duration of the last teardown */
+} ble_fallback_stats_t;
+
+void ble_fallback_get_stats(ble_fallback_stats_t *out);
+
+/* Advertising schedule: FAST after RECOVERY entry or a disconnect, then MID, then SLOW;
+ * YIELD (slow, still connectable) around Wi-Fi connect attempts. */
+typedef enum {
+    BLE_ADV_FAST = 0,
+    BLE_ADV_MID,
+    BLE_ADV_SLOW,
+    BLE_ADV_YIELD,
+    BLE_ADV_PHASES
+} ble_adv_phase_t;
+
+/* Since the lifeboat was last enabled. Airtime is an estimate: ADV_IND on 3 channels. */
+typedef struct {
+    uint8_t  phase;                 /* ble_adv_phase_t now */
+    uint32_t ms[BLE_ADV_PHASES];    /* time per phase */
+    uint32_t on_ms;                 /* of which advertising was running */
+    uint32_t events;                /* advertising events */
+    uint64_t air_us;                /* TX airtime */
+    uint32_t bursts;                /* fast bursts after a disconnect */
+    uint32_t yields;                /* windows given to Wi-Fi connect attempts */
+} ble_adv_stats_t;
+
+/* Hint from the Wi-Fi side: a connect attempt starts in in_ms. Any task. */
+void ble_adv_on_wifi_attempt(uint32_t in_ms);
+void ble_adv_get_stats(ble_adv_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,85 @@
+// ble_sim.h, simulated BLE host for the lifeboat (port/port_sim.c).
+// Built instead of Bluedroid/NimBLE with `idf.py -DBLE_PORT=sim`; it still runs on the
+// ESP32 (the rest of the firmware needs the chip). host_test builds it with the GATT core on
+// Linux against stubs (test_blesim). There is no radio: a script plays the
+// central by injecting GATT/GAP events, and every notification the device sends is
+// recorded with a timestamp. Air time is modelled
+// per connection event (interval, LL packets per event, data length, packet loss) on a
+// simulated clock, so throughput figures do not depend on how fast the script runs.
+// Injections run the core upcalls on the caller's task, which plays the host task; they
+// serialize with each other. Outside a sim build only ble_sim_run() exists.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One notification as it left the device. `data` is valid during the sink call only. */
+typedef struct {
+    int64_t        sim_us;      /* simulated clock */
+    int64_t        wall_us;     /* esp_timer_get_time() */
+    uint16_t       conn_id;
+    uint8_t        idx;         /* IDX_*_VAL of the characteristic */
+    uint16_t       len;
+    const uint8_t *data;
+} ble_sim_note_t;
+
+typedef void (*ble_sim_sink_t)(const ble_sim_note_t *n, void *user);
+
+typedef struct {
+    uint32_t connects;          /* injected connects the core accepted */
+    uint32_t refused;           /* ... and closed at once (links full) */
+    uint32_t writes;            /* injected writes */
+    uint32_t write_errs;        /* ... answered with an error status */
+    uint32_t reads;
+    uint32_t notifs;            /* notifications queued by the device */
+    uint32_t notif_bytes;
+    uint32_t notif_busy;        /* refused: BLE_SIM_INFLIGHT already waiting */
+    uint32_t events;            /* connection events simulated */
+    uint32_t pkts;              /* LL packets sent, both directions */
+    uint32_t lost;              /* ... lost and sent again */
+    int64_t  sim_us;            /* simulated clock */
+    uint32_t cbs;               /* upcalls run */
+    uint32_t cb_max_us;         /* longest upcall */
+    uint64_t cb_total_us;
+    uint32_t adv_starts;
+} ble_sim_stats_t;
+
+/* ----- Central side (sim builds) ----- */
+esp_err_t ble_sim_connect(uint16_t conn_id);                 /* ESP_ERR_INVALID_STATE: refused */
+void      ble_sim_disconnect(uint16_t conn_id);
+void      ble_sim_mtu(uint16_t conn_id, uint16_t mtu);
+void      ble_sim_congest(uint16_t conn_id, bool congested);
+esp_err_t ble_sim_subscribe(uint16_t conn_id, uint8_t idx, bool on);   /* CCC of IDX_*_VAL */
+/* Write `len` bytes to IDX_*_VAL; ESP_FAIL if the device answered with an error. The
+ * packets it takes are sent in the next connection events (ble_sim_run_events()). */
+esp_err_t ble_sim_write(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t len);
+esp_err_t ble_sim_read(uint16_t conn_id, uint8_t idx, uint16_t off,
+                       uint8_t *out, uint16_t cap, uint16_t *n);
+
+/* Run `n` connection events on a link: the clock advances one interval each, queued
+ * writes then notifications go out up to BLE_SIM_PKTS_PER_EVT packets, and each sent
+ * notification is confirmed to the core. Returns packets still queued afterwards. */
+uint32_t  ble_sim_run_events(uint16_t conn_id, uint32_t n);
+
+/* Packet loss in 1/1000 per LL packet; a lost packet ends its connection event and goes
+ * again in the next one. Same seed, same losses. */
+void      ble_sim_set_loss(uint16_t permille, uint32_t seed);
+void      ble_sim_set_sink(ble_sim_sink_t fn, void *user);
+void      ble_sim_get_stats(ble_sim_stats_t *out);
+void      ble_sim_reset_stats(void);
+
+/* ----- Scenarios (any build) ----- */
+/* "session [n]", "storm [rounds]" or "ota <bytes> [loss_permille] [bulk]"; result lines go
+ * to `out`. Borrows the lifeboat stack if it is down (ble_fallback_borrow()). `ota` sends
+ * the image to a RAM sink (ble_ota_set_xport()), never to flash. ESP_ERR_NOT_SUPPORTED
+ * outside a sim build. */
+typedef void (*ble_sim_out_t)(void *user, const char *line);
+esp_err_t ble_sim_run(const char *script, ble_sim_out_t out, void *user);
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,7 +7,11 @@ extern "C" {
 /* Initialize GATT services/characteristics and register callbacks. */
 void gatt_server_init(void);
 
-/* Send a single status/telemetry line over the TX characteristic. */
+/* Drop every link, unsubscribe from errsrc/DHT and unregister the GATT app.
+ * Call before the host stack goes down; gatt_server_init() brings it back. */
+void gatt_server_deinit(void);
+
+/* Send a status/telemetry line over the TX characteristic of every subscribed central. */
 void gatt_server_send_status(const char *line);
 
 #ifdef __cplusplus
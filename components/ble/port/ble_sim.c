@@ -0,0 +1,338 @@
+// ble_sim.c, scripted centrals for the simulated host (ble_sim_run(), "blesim" command).
+// Each scenario plays one or more phones against the real GATT core, then reports what the
+// device sent and how long it took on the simulated clock. Compiled in every build; only
+// BLE_PORT_SIM builds (port/port_sim.c) run anything.
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "ble_sim.h"
+
+#if BLE_PORT_SIM
+#include "app_cfg.h"        // BLE_MAX_CONN
+#include "ble_fallback.h"
+#include "ble_port.h"       // ble_port_gatt_ready()
+#include "gatt_priv.h"      // IDX_*, gatt_link_count()
+#include "ota_bridge.h"     // ble_ota_set_xport()
+
+#define SIM_MTU          247     // what a typical phone asks for
+#define SIM_WAIT_MS      2000    // for a reply line
+#define SIM_SESSION_MAX  200
+#define SIM_STORM_MAX    100
+#define SIM_OTA_QUEUE    (2 * BLE_SIM_PKTS_PER_EVT)   // packets the central keeps queued
+
+/* TX lines as the central reassembles them; the last one is kept. */
+static struct {
+    portMUX_TYPE mux;
+    char     part[128];
+    uint16_t part_n;
+    char     last[128];
+    uint32_t lines;
+    uint32_t notifs;
+} s_rx = { .mux = portMUX_INITIALIZER_UNLOCKED };
+
+static void sink(const ble_sim_note_t *n, void *user) {
+    (void)user;
+    portENTER_CRITICAL(&s_rx.mux);
+    s_rx.notifs++;
+    if (n->idx == IDX_TX_VAL) {
+        for (uint16_t i = 0; i < n->len; ++i) {
+            char c = (char)n->data[i];
+            if (c == '\n') {
+                memcpy(s_rx.last, s_rx.part, s_rx.part_n);
+                s_rx.last[s_rx.part_n] = '\0';
+                s_rx.part_n = 0;
+                s_rx.lines++;
+            } else if (s_rx.part_n < sizeof(s_rx.part) - 1) {
+                s_rx.part[s_rx.part_n++] = c;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_rx.mux);
+}
+
+static uint32_t rx_lines(void) {
+    portENTER_CRITICAL(&s_rx.mux);
+    uint32_t n = s_rx.lines;
+    portEXIT_CRITICAL(&s_rx.mux);
+    return n;
+}
+
+/* Run connection events until a line past `seen` arrives; copies it to `out`. RX and
+ * OTA-CTRL writes are handled by the BLE worker, hence the short sleeps. */
+static bool wait_line(uint16_t conn, uint32_t seen, char *out, size_t cap) {
+    int64_t until = esp_timer_get_time() + (int64_t)SIM_WAIT_MS * 1000;
+    while (esp_timer_get_time() < until) {
+        ble_sim_run_events(conn, 1);
+        portENTER_CRITICAL(&s_rx.mux);
+        bool got = s_rx.lines > seen;
+        if (got) snprintf(out, cap, "%s", s_rx.last);
+        portEXIT_CRITICAL(&s_rx.mux);
+        if (got) return true;
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+static void drain(uint16_t conn) {
+    while (ble_sim_run_events(conn, 1)) {}
+}
+
+/* A phone's opening moves: connect, MTU exchange, TX notifications on. */
+static esp_err_t open_link(uint16_t conn) {
+    esp_err_t e = ble_sim_connect(conn);
+    if (e != ESP_OK) return e;
+    ble_sim_mtu(conn, SIM_MTU);
+    return ble_sim_subscribe(conn, IDX_TX_VAL, true);
+}
+
+static esp_err_t send_line(uint16_t conn, uint8_t idx, const char *s) {
+    return ble_sim_write(conn, idx, (const uint8_t *)s, (uint16_t)strlen(s));
+}
+
+static void outf(ble_sim_out_t out, void *user, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+static void outf(ble_sim_out_t out, void *user, const char *fmt, ...) {
+    char line[192];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    out(user, line);
+}
+
+/* session [n]: one phone sends n "ping" lines, each after the previous reply. */
+static void run_session(unsigned n, ble_sim_out_t out, void *user) {
+    if (n == 0 || n > SIM_SESSION_MAX) { outf(out, user, "ERR n=1..%u\n", SIM_SESSION_MAX); return; }
+    const uint16_t conn = 0;
+    if (open_link(conn) != ESP_OK) { out(user, "ERR connect\n"); return; }
+    ble_sim_reset_stats();
+    uint32_t ok = 0, lat_max = 0;
+    uint64_t lat_sum = 0;
+    char line[64];
+    for (unsigned i = 0; i < n; ++i) {
+        uint32_t seen = rx_lines();
+        int64_t t0 = esp_timer_get_time();
+        if (send_line(conn, IDX_RX_VAL, "ping\n") != ESP_OK) break;
+        if (!wait_line(conn, seen, line, sizeof(line)) || strcmp(line, "PONG") != 0) continue;
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        lat_sum += us;
+        if (us > lat_max) lat_max = us;
+        ok++;
+    }
+    drain(conn);
+    ble_sim_stats_t st;
+    ble_sim_get_stats(&st);
+    ble_sim_disconnect(conn);
+    outf(out, user, "SESSION n=%u replies=%u lat_avg=%u us lat_max=%u us notifs=%u bytes=%u busy=%u\n",
+         n, (unsigned)ok, (unsigned)(ok ? lat_sum / ok : 0), (unsigned)lat_max,
+         (unsigned)st.notifs, (unsigned)st.notif_bytes, (unsigned)st.notif_busy);
+    outf(out, user, "CB n=%u max=%u us avg=%u us\n", (unsigned)st.cbs, (unsigned)st.cb_max_us,
+         (unsigned)(st.cbs ? st.cb_total_us / st.cbs : 0));
+}
+
+/* storm [rounds]: one central more than the cap connects, pings and leaves, each round. */
+static void run_storm(unsigned rounds, ble_sim_out_t out, void *user) {
+    if (rounds == 0 || rounds > SIM_STORM_MAX) { outf(out, user, "ERR rounds=1..%u\n", SIM_STORM_MAX); return; }
+    ble_sim_reset_stats();
+    uint32_t heap0 = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    uint32_t replies = 0;
+    for (unsigned r = 0; r < rounds; ++r) {
+        bool open[BLE_MAX_CONN + 1] = { false };
+        for (uint16_t c = 0; c <= BLE_MAX_CONN; ++c) open[c] = open_link(c) == ESP_OK;
+        uint32_t seen = rx_lines();
+        for (uint16_t c = 0; c <= BLE_MAX_CONN; ++c)
+            if (open[c]) send_line(c, IDX_RX_VAL, "ping\n");
+        int64_t until = esp_timer_get_time() + (int64_t)SIM_WAIT_MS * 1000;
+        bool busy = true;
+        while (busy && esp_timer_get_time() < until) {
+            busy = false;
+            for (uint16_t c = 0; c <= BLE_MAX_CONN; ++c)
+                if (open[c] && ble_sim_run_events(c, 1)) busy = true;
+            if (rx_lines() - seen < BLE_MAX_CONN) { busy = true; vTaskDelay(1); }
+        }
+        replies += rx_lines() - seen;
+        for (uint16_t c = 0; c <= BLE_MAX_CONN; ++c) if (open[c]) ble_sim_disconnect(c);
+    }
+    vTaskDelay(pdMS_TO_TICKS(50));                 // let the worker settle before measuring
+    ble_sim_stats_t st;
+    ble_sim_get_stats(&st);
+    uint32_t heap1 = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    outf(out, user, "STORM rounds=%u connects=%u refused=%u replies=%u links_left=%u heap_drift=%d adv_starts=%u\n",
+         rounds, (unsigned)st.connects, (unsigned)st.refused, (unsigned)replies,
+         (unsigned)gatt_link_count(), (int)(heap1 - heap0), (unsigned)st.adv_starts);
+    outf(out, user, "CB n=%u max=%u us avg=%u us\n", (unsigned)st.cbs, (unsigned)st.cb_max_us,
+         (unsigned)(st.cbs ? st.cb_total_us / st.cbs : 0));
+}
+
+/* The image sink of the ota script: checks the pattern run_ota() sends and keeps only
+ * counts, so no flash is erased or written. Called by ble_ota.c under its lock. */
+static struct {
+    uint32_t total;
+    uint32_t got;
+    uint32_t bad;        // bytes that differ from the pattern
+    bool     begun;
+    bool     aborted;
+} s_img;
+
+static esp_err_t img_begin(size_t total, uint32_t crc, const char *src) {
+    (void)crc; (void)src;
+    memset(&s_img, 0, sizeof(s_img));
+    s_img.total = (uint32_t)total;
+    s_img.begun = true;
+    return ESP_OK;
+}
+
+static esp_err_t img_write(const uint8_t *d, size_t len) {
+    if (!s_img.begun || s_img.got + len > s_img.total) return ESP_ERR_INVALID_SIZE;
+    for (size_t i = 0; i < len; ++i) {
+        uint32_t at = s_img.got + (uint32_t)i;
+        if (d[i] != (at ? (uint8_t)at : 0xE9)) s_img.bad++;
+    }
+    s_img.got += (uint32_t)len;
+    return ESP_OK;
+}
+
+static esp_err_t img_finish(void) {
+    return ESP_ERR_NOT_SUPPORTED;          // the script never completes an image
+}
+
+static void img_abort(const char *reason) {
+    (void)reason;
+    s_img.aborted = true;
+}
+
+static const ble_ota_xport_t s_img_xport = { img_begin, img_write, img_finish, img_abort };
+
+/* ota <bytes> [loss] [bulk]: streams all but the last byte into the RAM sink, then aborts. */
+static void run_ota(uint32_t size, unsigned loss, bool bulk, ble_sim_out_t out, void *user) {
+    if (size < 2 || loss > 500) {
+        out(user, "ERR usage: ota <bytes>=2.. [loss_permille<=500] [bulk]\n");
+        return;
+    }
+    if (ble_ota_set_xport(&s_img_xport) != ESP_OK) { out(user, "ERR OTA in progress\n"); return; }
+    memset(&s_img, 0, sizeof(s_img));
+    const uint16_t conn = 0;
+    char line[64], cmd[64];
+    if (open_link(conn) != ESP_OK) { out(user, "ERR connect\n"); ble_ota_set_xport(NULL); return; }
+
+    uint32_t seen = rx_lines();
+    snprintf(cmd, sizeof(cmd), "BL_OTA START %u 0%s", (unsigned)size, bulk ? " BULK" : "");
+    send_line(conn, IDX_OTA_CTRL_VAL, cmd);
+    if (!wait_line(conn, seen, line, sizeof(line)) || strncmp(line, "ACK START", 9) != 0) {
+        outf(out, user, "ERR START: %s\n", seen == rx_lines() ? "no reply" : line);
+        ble_sim_disconnect(conn);
+        ble_ota_set_xport(NULL);
+        return;
+    }
+    bulk = strstr(line, "BULK") != NULL;           // the device may have declined
+    drain(conn);                                   // conn params / data length take effect
+
+    const uint16_t chunk = (uint16_t)(SIM_MTU - 3 - (bulk ? 0 : 6));
+    uint8_t *buf = malloc(SIM_MTU);
+    if (!buf) { out(user, "ERR no mem\n"); ble_sim_disconnect(conn); ble_ota_set_xport(NULL); return; }
+    ble_sim_set_loss((uint16_t)loss, 0x5EED);
+    ble_sim_reset_stats();
+    ble_sim_stats_t st0;
+    ble_sim_get_stats(&st0);
+    int64_t w0 = esp_timer_get_time();
+
+    uint32_t sent = 0, seq = 0;
+    bool failed = false;
+    while (sent < size - 1 && !failed) {
+        uint16_t n = (uint16_t)((size - 1 - sent) < chunk ? (size - 1 - sent) : chunk);
+        uint8_t *p = buf;
+        if (!bulk) {
+            p[0] = (uint8_t)seq; p[1] = (uint8_t)(seq >> 8); p[2] = (uint8_t)(seq >> 16); p[3] = (uint8_t)(seq >> 24);
+            p[4] = (uint8_t)n;   p[5] = (uint8_t)(n >> 8);
+            p += 6;
+        }
+        for (uint16_t i = 0; i < n; ++i) p[i] = (uint8_t)(sent + i);
+        if (sent == 0) p[0] = 0xE9;                // image magic, checked on the first write
+        if (ble_sim_write(conn, IDX_OTA_DATA_VAL, buf, (uint16_t)(n + (bulk ? 0 : 6))) != ESP_OK) failed = true;
+        while (ble_sim_run_events(conn, 1) > SIM_OTA_QUEUE) {}
+        sent += n;
+        seq++;
+    }
+    drain(conn);
+    int64_t wall = esp_timer_get_time() - w0;
+    ble_sim_stats_t st;
+    ble_sim_get_stats(&st);
+    ble_sim_set_loss(0, 1);
+    free(buf);
+
+    seen = rx_lines();
+    send_line(conn, IDX_OTA_CTRL_VAL, "BL_OTA ABORT");
+    bool aborted = wait_line(conn, seen, line, sizeof(line)) && strcmp(line, "OK ABORTED") == 0;
+    ble_sim_disconnect(conn);
+    ble_ota_set_xport(NULL);
+
+    uint32_t ms = (uint32_t)((st.sim_us - st0.sim_us) / 1000);
+    outf(out, user, "OTA bytes=%u mode=%s loss=%u/1000 sim=%u ms rate=%u B/s%s\n",
+         (unsigned)sent, bulk ? "bulk" : "framed", loss, (unsigned)ms,
+         (unsigned)(ms ? (uint64_t)sent * 1000 / ms : 0), aborted ? "" : " (abort not acked)");
+    outf(out, user, "AIR events=%u pkts=%u lost=%u wall=%u ms cb_max=%u us cb_avg=%u us\n",
+         (unsigned)st.events, (unsigned)st.pkts, (unsigned)st.lost, (unsigned)(wall / 1000),
+         (unsigned)st.cb_max_us, (unsigned)(st.cbs ? st.cb_total_us / st.cbs : 0));
+    outf(out, user, "IMG got=%u/%u bad=%u%s\n", (unsigned)s_img.got, (unsigned)s_img.total,
+         (unsigned)s_img.bad, s_img.aborted ? " aborted" : "");
+}
+
+/* "<bytes> [loss] [bulk]": the size first, then numbers and keywords in any order. */
+static void ota_args(const char *args, ble_sim_out_t out, void *user) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s", args);
+    uint32_t size = 0;
+    unsigned loss = 0, nums = 0;
+    bool bulk = false;
+    char *save = NULL;
+    for (char *w = strtok_r(buf, " \t", &save); w; w = strtok_r(NULL, " \t", &save)) {
+        char *end;
+        unsigned long v = strtoul(w, &end, 10);
+        if      (strcmp(w, "bulk") == 0)   bulk = true;
+        else if (*end == '\0' && nums == 0) { size = (uint32_t)v; nums++; }
+        else if (*end == '\0' && nums == 1) { loss = (unsigned)(v > 1000 ? 1000 : v); nums++; }
+        else { outf(out, user, "ERR ota: unexpected '%s'\n", w); return; }
+    }
+    run_ota(size, loss, bulk, out, user);
+}
+
+esp_err_t ble_sim_run(const char *script, ble_sim_out_t out, void *user) {
+    if (!script || !out) return ESP_ERR_INVALID_ARG;
+    bool borrowed = ble_fallback_borrow();
+    if (!ble_port_gatt_ready()) {
+        out(user, "ERR stack not ready\n");
+        if (borrowed) ble_fallback_give_back();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ble_sim_set_sink(sink, NULL);
+    unsigned a = 0;
+    if (strncmp(script, "session", 7) == 0) {
+        run_session(sscanf(script + 7, "%u", &a) == 1 ? a : 10, out, user);
+    } else if (strncmp(script, "storm", 5) == 0) {
+        run_storm(sscanf(script + 5, "%u", &a) == 1 ? a : 10, out, user);
+    } else if (strncmp(script, "ota", 3) == 0) {
+        ota_args(script + 3, out, user);
+    } else {
+        out(user, "ERR usage: session [n] | storm [rounds] | ota <bytes> [loss_permille] [bulk]\n");
+    }
+    ble_sim_set_sink(NULL, NULL);
+    if (borrowed) ble_fallback_give_back();
+    return ESP_OK;
+}
+
+#else
+
+esp_err_t ble_sim_run(const char *script, ble_sim_out_t out, void *user) {
+    (void)script;
+    if (out) out(user, "ERR not a simulator build (-DBLE_PORT=sim)\n");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
@@ -0,0 +1,371 @@
+// port_bluedroid.c, ble_port.h on Bluedroid (CONFIG_BT_BLUEDROID_ENABLED).
+// GATTS/GAP callbacks run on the BTC task and are translated into gatt_core_* / fb_gap_on().
+#include <string.h>
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+#include "esp_gatt_common_api.h"
+
+#include "app_cfg.h"        // BLE_LOCAL_MTU
+#include "ble_ids.h"        // SERVICE_UUID
+#include "ble_port.h"
+#include "gatt_priv.h"      // gatt_table.h, gatt_defer_note_cb()
+
+static const char *TAG = "BLE.port";
+
+/* Column vocabulary of GATT_SVC_TABLE. */
+#define GP_READ         ESP_GATT_CHAR_PROP_BIT_READ
+#define GP_WRITE        ESP_GATT_CHAR_PROP_BIT_WRITE
+#define GP_WRITE_NR     ESP_GATT_CHAR_PROP_BIT_WRITE_NR
+#define GP_NOTIFY       ESP_GATT_CHAR_PROP_BIT_NOTIFY
+#define GATT_PERM_R     ESP_GATT_PERM_READ
+#define GATT_PERM_W     ESP_GATT_PERM_WRITE
+#define GATT_PERM_RW    (ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE)
+#define GATT_RSP_AUTO   ESP_GATT_AUTO_RSP
+#define GATT_RSP_APP    ESP_GATT_RSP_BY_APP
+
+static esp_gatt_if_t s_if = ESP_GATT_IF_NONE;
+static uint16_t s_handle[EFBE_IDX_NB];
+
+/* Properties, one byte per characteristic declaration (only the _CHAR slots are used). */
+#define PROPS_CHR(n, tail, props, ...) [IDX_##n##_CHAR] = (props),
+static const uint8_t s_props[EFBE_IDX_NB] = { GATT_SVC_TABLE(PROPS_CHR, PROPS_CHR) };
+
+/* 16-bit helper UUIDs */
+static const uint16_t primary_service_uuid = ESP_GATT_UUID_PRI_SERVICE;
+static const uint16_t character_declaration_uuid = ESP_GATT_UUID_CHAR_DECLARE;
+static const uint16_t character_client_config_uuid = ESP_GATT_UUID_CHAR_CLIENT_CONFIG;
+
+/* CCCs are answered per connection from ble_link_t.ccc; the stack copy is never used. */
+static const uint8_t ccc_init[2] = {0, 0};
+
+/* The whole table, generated from GATT_SVC_TABLE (gatt_table.h). */
+#define ATTR_DECL(n) \
+    [IDX_##n##_CHAR] = { {ESP_GATT_AUTO_RSP}, \
+        {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ, \
+         sizeof(uint8_t), sizeof(uint8_t), (uint8_t *)&s_props[IDX_##n##_CHAR]} },
+#define ATTR_VAL(n, perm, max_len, rsp) \
+    [IDX_##n##_VAL] = { {GATT_RSP_##rsp}, \
+        {ESP_UUID_LEN_128, (uint8_t *)n##_UUID, GATT_PERM_##perm, (max_len), 0, NULL} },
+#define ATTR_CCC(n) \
+    [IDX_##n##_CCC] = { {ESP_GATT_RSP_BY_APP}, \
+        {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, GATT_PERM_RW, \
+         sizeof(ccc_init), sizeof(ccc_init), (uint8_t *)ccc_init} },
+#define ATTR_CHR(n, tail, props, perm, max_len, rsp, ...) \
+    ATTR_DECL(n) ATTR_VAL(n, perm, max_len, rsp)
+#define ATTR_NTF(n, tail, props, perm, max_len, rsp, ...) \
+    ATTR_DECL(n) ATTR_VAL(n, perm, max_len, rsp) ATTR_CCC(n)
+
+static const esp_gatts_attr_db_t s_db[EFBE_IDX_NB] = {
+    [IDX_SVC] = { {ESP_GATT_AUTO_RSP},
+        {ESP_UUID_LEN_16, (uint8_t *)&primary_service_uuid, ESP_GATT_PERM_READ,
+         sizeof(SERVICE_UUID), sizeof(SERVICE_UUID), (uint8_t *)SERVICE_UUID} },
+    GATT_SVC_TABLE(ATTR_CHR, ATTR_NTF)
+};
+
+/* Handle -> table index. The stack hands out one contiguous handle range per
+ * attribute table, so this is a subtraction checked against the stored handle. */
+static int attr_idx(uint16_t h) {
+    uint16_t base = s_handle[IDX_SVC];
+    if (!base || h < base) return -1;
+    uint16_t i = (uint16_t)(h - base);
+    if (i >= EFBE_IDX_NB || s_handle[i] != h) return -1;
+    return (int)i;
+}
+
+static esp_gatt_status_t att_status(ble_port_status_t st) {
+    switch (st) {
+    case BLE_PORT_OK:         return ESP_GATT_OK;
+    case BLE_PORT_ERR_STATE:  return ESP_GATT_WRONG_STATE;
+    case BLE_PORT_ERR_RANGE:  return ESP_GATT_OUT_OF_RANGE;
+    case BLE_PORT_ERR_OFFSET: return ESP_GATT_INVALID_OFFSET;
+    default:                  return ESP_GATT_ERROR;
+    }
+}
+
+/* READ_EVT: attributes with a reader are APP rows and answered here; the stack answers
+ * AUTO ones from the stored value. */
+static void on_read(esp_ble_gatts_cb_param_t *param) {
+    int i = attr_idx(param->read.handle);
+    if (i < 0 || !gatt_core_reads((uint8_t)i) || s_db[i].attr_control.auto_rsp == ESP_GATT_AUTO_RSP) return;
+
+    esp_gatt_rsp_t rsp;
+    memset(&rsp, 0, sizeof(rsp));
+    uint16_t off = param->read.is_long ? param->read.offset : 0;
+    uint16_t n = 0;
+    ble_port_status_t st = gatt_core_read(param->read.conn_id, (uint8_t)i, off, rsp.attr_value.value,
+                                          sizeof(rsp.attr_value.value), &n);
+    rsp.attr_value.handle = param->read.handle;
+    rsp.attr_value.offset = off;
+    rsp.attr_value.len = n;
+    esp_ble_gatts_send_response(s_if, param->read.conn_id, param->read.trans_id, att_status(st), &rsp);
+}
+
+/* WRITE_EVT: the stack already answered AUTO rows (RX, WIFI, OTA-DATA), so only APP rows
+ * (CCCs, OTA-CTRL) get a response from ble_port_write_rsp(). */
+static void on_write(esp_ble_gatts_cb_param_t *param) {
+    int i = attr_idx(param->write.handle);
+    if (i < 0) return;
+    const ble_port_req_t r = {
+        .conn_id  = param->write.conn_id,
+        .trans_id = param->write.trans_id,
+        .need_rsp = param->write.need_rsp && s_db[i].attr_control.auto_rsp == ESP_GATT_RSP_BY_APP,
+        .sync     = false,
+    };
+    gatt_core_write(&r, (uint8_t)i, param->write.value, param->write.len);
+}
+
+static void on_table_created(esp_ble_gatts_cb_param_t *param) {
+    if (param->add_attr_tab.status == ESP_GATT_OK &&
+        param->add_attr_tab.num_handle == EFBE_IDX_NB)
+    {
+        memcpy(s_handle, param->add_attr_tab.handles, sizeof(s_handle));
+        esp_ble_gatts_start_service(s_handle[IDX_SVC]);
+    } else {
+        ESP_LOGE(TAG, "attr table create failed st=0x%x num=%d.",
+                 param->add_attr_tab.status, param->add_attr_tab.num_handle);
+    }
+}
+
+static void gatts_dispatch(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
+                           esp_ble_gatts_cb_param_t *param)
+{
+    switch (event) {
+    case ESP_GATTS_REG_EVT: {
+        s_if = gatts_if;
+        esp_err_t e = esp_ble_gatts_create_attr_tab(s_db, gatts_if, EFBE_IDX_NB, 0);
+        if (e != ESP_OK) ESP_LOGE(TAG, "create_attr_tab: %s", esp_err_to_name(e));
+        break;
+    }
+
+    case ESP_GATTS_CREAT_ATTR_TAB_EVT:
+        on_table_created(param);
+        break;
+
+    case ESP_GATTS_START_EVT:
+        gatt_core_on_started();
+        break;
+
+    case ESP_GATTS_MTU_EVT:
+        gatt_core_on_mtu(param->mtu.conn_id, param->mtu.mtu);
+        break;
+
+    case ESP_GATTS_CONF_EVT: {
+        int i = attr_idx(param->conf.handle);
+        if (i >= 0) {
+            gatt_core_on_sent(param->conf.conn_id, (uint8_t)i, param->conf.status == ESP_GATT_OK,
+                              param->conf.status == ESP_GATT_CONGESTED);
+        }
+        break;
+    }
+
+    case ESP_GATTS_CONGEST_EVT:
+        gatt_core_on_congest(param->congest.conn_id, param->congest.congested);
+        break;
+
+    case ESP_GATTS_READ_EVT:
+        on_read(param);
+        break;
+
+    case ESP_GATTS_WRITE_EVT:
+        on_write(param);
+        break;
+
+    case ESP_GATTS_CONNECT_EVT:
+        gatt_core_on_connect(param->connect.conn_id, param->connect.remote_bda);
+        break;
+
+    case ESP_GATTS_DISCONNECT_EVT:
+        gatt_core_on_disconnect(param->disconnect.conn_id);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* Runs on the Bluedroid (BTC) task: everything else BLE waits while it runs. */
+static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if,
+                                esp_ble_gatts_cb_param_t *param)
+{
+    int64_t t0 = esp_timer_get_time();
+    gatts_dispatch(event, gatts_if, param);
+    gatt_defer_note_cb((uint32_t)(esp_timer_get_time() - t0), (int)event);
+}
+
+static void gap_event_handler(esp_gap_ble_cb_event_t ev, esp_ble_gap_cb_param_t *p) {
+    switch (ev) {
+    case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
+        fb_gap_on(FB_GAP_ADV_DATA, p->adv_data_cmpl.status == ESP_BT_STATUS_SUCCESS);
+        break;
+    case ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT:
+        fb_gap_on(FB_GAP_ADV_DATA, p->adv_data_raw_cmpl.status == ESP_BT_STATUS_SUCCESS);
+        break;
+    case ESP_GAP_BLE_SCAN_RSP_DATA_SET_COMPLETE_EVT:
+        fb_gap_on(FB_GAP_SCAN_RSP, p->scan_rsp_data_cmpl.status == ESP_BT_STATUS_SUCCESS);
+        break;
+    case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+        fb_gap_on(FB_GAP_ADV_STARTED, p->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS);
+        break;
+    case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT:
+        fb_gap_on(FB_GAP_ADV_STOPPED, true);
+        break;
+    case ESP_GAP_BLE_SEC_REQ_EVT:
+        ESP_LOGI(TAG, "Peer requested security -> REJECT (token-only auth).");
+        esp_ble_gap_security_rsp(p->ble_security.ble_req.bd_addr, false);
+        break;
+    default:
+        break;
+    }
+}
+
+/* ----- Stack ----- */
+
+const char *ble_port_name(void) { return "bluedroid"; }
+
+esp_err_t ble_port_up(const char *dev_name) {
+    esp_err_t e = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
+    if (e != ESP_OK && e != ESP_ERR_INVALID_STATE) return e;
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    e = esp_bt_controller_init(&bt_cfg);
+    if (e != ESP_OK && e != ESP_ERR_INVALID_STATE) return e;
+    e = esp_bt_controller_enable(ESP_BT_MODE_BLE);
+    if (e != ESP_OK && e != ESP_ERR_INVALID_STATE) return e;
+
+    if (esp_bluedroid_get_status() == ESP_BLUEDROID_STATUS_UNINITIALIZED) {
+        e = esp_bluedroid_init();
+        if (e != ESP_OK) return e;
+    }
+    if (esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_ENABLED) {
+        e = esp_bluedroid_enable();
+        if (e != ESP_OK) return e;
+    }
+    e = esp_ble_gap_register_callback(gap_event_handler);
+    if (e == ESP_OK) e = esp_ble_gap_set_device_name(dev_name);
+    return e;
+}
+
+/* Bluedroid runs from esp_bluedroid_enable() on; registration finishes asynchronously. */
+esp_err_t ble_port_start(void) { return ESP_OK; }
+
+void ble_port_down(void) {
+    esp_err_t e = ESP_OK;
+    if (esp_bluedroid_get_status() == ESP_BLUEDROID_STATUS_ENABLED)        e = esp_bluedroid_disable();
+    if (e == ESP_OK && esp_bluedroid_get_status() != ESP_BLUEDROID_STATUS_UNINITIALIZED) e = esp_bluedroid_deinit();
+    if (e != ESP_OK) ESP_LOGE(TAG, "bluedroid teardown: %s", esp_err_to_name(e));
+
+    e = ESP_OK;
+    if (esp_bt_controller_get_status() == ESP_BT_CONTROLLER_STATUS_ENABLED) e = esp_bt_controller_disable();
+    if (e == ESP_OK && esp_bt_controller_get_status() == ESP_BT_CONTROLLER_STATUS_INITED) e = esp_bt_controller_deinit();
+    if (e != ESP_OK) ESP_LOGE(TAG, "controller teardown: %s", esp_err_to_name(e));
+}
+
+/* ----- GATT ----- */
+
+esp_err_t ble_port_gatt_register(void) {
+    esp_err_t e = esp_ble_gatts_register_callback(gatts_event_handler);
+    if (e == ESP_OK) e = esp_ble_gatts_app_register(0x42);
+    if (e != ESP_OK) return e;
+
+    /* Offer a large MTU so one notification can carry several TX lines. */
+    esp_err_t m = esp_ble_gatt_set_local_mtu(BLE_LOCAL_MTU);
+    if (m != ESP_OK) ESP_LOGW(TAG, "set_local_mtu(%u): %s", (unsigned)BLE_LOCAL_MTU, esp_err_to_name(m));
+    return ESP_OK;
+}
+
+void ble_port_gatt_unregister(void) {
+    if (s_if != ESP_GATT_IF_NONE) {
+        esp_err_t e = esp_ble_gatts_app_unregister(s_if);
+        if (e != ESP_OK) ESP_LOGW(TAG, "app_unregister: %s", esp_err_to_name(e));
+    }
+    s_if = ESP_GATT_IF_NONE;
+    memset(s_handle, 0, sizeof(s_handle));
+}
+
+bool ble_port_gatt_ready(void) {
+    return s_if != ESP_GATT_IF_NONE && s_handle[IDX_SVC];
+}
+
+esp_err_t ble_port_notify(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (s_if == ESP_GATT_IF_NONE || idx >= EFBE_IDX_NB || !s_handle[idx]) return ESP_ERR_INVALID_STATE;
+    return esp_ble_gatts_send_indicate(s_if, conn_id, s_handle[idx], n, (uint8_t *)v, false);
+}
+
+void ble_port_set_value(uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (s_if == ESP_GATT_IF_NONE || idx >= EFBE_IDX_NB || !s_handle[idx]) return;
+    esp_ble_gatts_set_attr_value(s_handle[idx], n, v);
+}
+
+void ble_port_write_rsp(const ble_port_req_t *r, ble_port_status_t st) {
+    if (!r || !r->need_rsp || s_if == ESP_GATT_IF_NONE) return;
+    esp_ble_gatts_send_response(s_if, r->conn_id, r->trans_id, att_status(st), NULL);
+}
+
+void ble_port_close(uint16_t conn_id) {
+    if (s_if != ESP_GATT_IF_NONE) esp_ble_gatts_close(s_if, conn_id);
+}
+
+esp_err_t ble_port_conn_params(uint16_t conn_id, const uint8_t bda[6],
+                               uint16_t itvl_min, uint16_t itvl_max, uint16_t timeout) {
+    (void)conn_id;
+    esp_ble_conn_update_params_t p = {0};
+    memcpy(p.bda, bda, sizeof(p.bda));
+    p.min_int = itvl_min;
+    p.max_int = itvl_max;
+    p.latency = 0;
+    p.timeout = timeout;
+    return esp_ble_gap_update_conn_params(&p);
+}
+
+esp_err_t ble_port_data_len(uint16_t conn_id, const uint8_t bda[6], uint16_t octets) {
+    (void)conn_id;
+    esp_bd_addr_t a;
+    memcpy(a, bda, sizeof(a));
+    return esp_ble_gap_set_pkt_data_len(a, octets);
+}
+
+/* ----- Advertising ----- */
+
+esp_err_t ble_port_adv_start(uint16_t itvl_min, uint16_t itvl_max) {
+    esp_ble_adv_params_t p = {
+        .adv_int_min = itvl_min,
+        .adv_int_max = itvl_max,
+        .adv_type = ADV_TYPE_IND,
+        .own_addr_type = BLE_ADDR_TYPE_PUBLIC,
+        .channel_map = ADV_CHNL_ALL,
+        .adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_ANY,
+    };
+    esp_err_t e = esp_ble_gap_start_advertising(&p);
+    if (e == ESP_ERR_INVALID_STATE) {
+        (void)esp_ble_gap_stop_advertising();
+        e = esp_ble_gap_start_advertising(&p);
+    }
+    return e;
+}
+
+esp_err_t ble_port_adv_stop(void) {
+    return esp_ble_gap_stop_advertising();
+}
+
+esp_err_t ble_port_adv_set_raw(const uint8_t *adv, size_t n) {
+    return esp_ble_gap_config_adv_data_raw((uint8_t *)adv, (uint32_t)n);
+}
+
+esp_err_t ble_port_scan_rsp_set(const uint8_t uuid[16]) {
+    static uint8_t s_uuid[16];
+    memcpy(s_uuid, uuid, sizeof(s_uuid));
+    esp_ble_adv_data_t rsp = {
+        .set_scan_rsp = true,
+        .include_name = true,
+        .include_txpower = true,
+        .appearance = 0,
+        .service_uuid_len = sizeof(s_uuid),
+        .p_service_uuid = s_uuid,
+        .flag = (ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT),
+    };
+    return esp_ble_gap_config_adv_data(&rsp);
+}
@@ -0,0 +1,400 @@
+// port_nimble.c, ble_port.h on NimBLE (CONFIG_BT_NIMBLE_ENABLED).
+// Same service, built from GATT_SVC_TABLE as a ble_gatt_svc_def. Differences from Bluedroid
+// that the core sees: access callbacks answer synchronously (ble_port_req_t.sync), CCCs
+// are kept by the stack and reported as subscribe events, and the ATT server applies
+// read-blob offsets itself (readers always get off = 0).
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_bt.h"
+#include "nimble/nimble_port.h"
+#include "nimble/nimble_port_freertos.h"
+#include "host/ble_hs.h"
+#include "host/util/util.h"
+#include "services/gap/ble_svc_gap.h"
+#include "services/gatt/ble_svc_gatt.h"
+
+#include "app_cfg.h"        // BLE_LOCAL_MTU, BLE_MAX_CONN
+#include "ble_ids.h"        // SERVICE_UUID
+#include "ble_port.h"
+#include "gatt_priv.h"      // gatt_table.h, gatt_defer_note_cb()
+
+#if CONFIG_BT_NIMBLE_MAX_CONNECTIONS < BLE_MAX_CONN
+#error "CONFIG_BT_NIMBLE_MAX_CONNECTIONS must be >= BLE_MAX_CONN"
+#endif
+
+static const char *TAG = "BLE.port";
+
+/* Column vocabulary of GATT_SVC_TABLE; permissions and response mode have no NimBLE
+ * counterpart beyond the flags. */
+#define GP_READ         BLE_GATT_CHR_F_READ
+#define GP_WRITE        BLE_GATT_CHR_F_WRITE
+#define GP_WRITE_NR     BLE_GATT_CHR_F_WRITE_NO_RSP
+#define GP_NOTIFY       BLE_GATT_CHR_F_NOTIFY
+
+/* ATT statuses Bluedroid puts on the wire for the same outcomes. */
+#define ATT_WRONG_STATE   0x8A
+#define ATT_OUT_OF_RANGE  0xFF
+
+static ble_uuid128_t s_svc_uuid = { .u = { .type = BLE_UUID_TYPE_128 } };
+#define UUID_DEF(n, tail, ...) \
+    static const ble_uuid128_t s_uuid_##n = { .u = { .type = BLE_UUID_TYPE_128 }, .value = GATT_UUID128(tail) };
+GATT_SVC_TABLE(UUID_DEF, UUID_DEF)
+
+/* Value handles by IDX_*_VAL, filled in by the stack when the host starts. */
+static uint16_t s_handle[EFBE_IDX_NB];
+
+/* Writes the core must answer (APP rows) carry need_rsp; the rest are fire-and-forget. */
+#define APP_RSP_AUTO 0
+#define APP_RSP_APP  1
+#define APP_ROW(n, tail, props, perm, max_len, rsp, ...) [IDX_##n##_VAL] = APP_RSP_##rsp,
+static const uint8_t s_app_rsp[EFBE_IDX_NB] = { GATT_SVC_TABLE(APP_ROW, APP_ROW) };
+
+static int chr_access(uint16_t conn, uint16_t attr, struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+#define CHR_DEF(n, tail, props, ...) \
+    { .uuid = &s_uuid_##n.u, .access_cb = chr_access, .arg = (void *)(uintptr_t)IDX_##n##_VAL, \
+      .flags = (props), .val_handle = &s_handle[IDX_##n##_VAL] },
+static const struct ble_gatt_chr_def s_chrs[] = {
+    GATT_SVC_TABLE(CHR_DEF, CHR_DEF)
+    { 0 }
+};
+
+static const struct ble_gatt_svc_def s_svcs[] = {
+    { .type = BLE_GATT_SVC_TYPE_PRIMARY, .uuid = &s_svc_uuid.u, .characteristics = s_chrs },
+    { 0 }
+};
+
+static volatile bool s_synced = false;
+static uint8_t s_own_addr;
+
+/* Values of readable attributes without a core reader (TX); the stack keeps none. */
+static uint8_t *s_val[EFBE_IDX_NB];
+static uint16_t s_val_len[EFBE_IDX_NB];
+static portMUX_TYPE s_val_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* ADV payloads set before the host synced; applied from on_sync(). */
+static uint8_t s_adv_raw[BLE_HS_ADV_MAX_SZ];
+static uint8_t s_adv_raw_len = 0;
+static bool    s_rsp_pending = false;
+
+/* Answer of the write being handled in chr_access(); only the host task writes it. */
+static ble_port_status_t s_sync_st;
+
+static int att_status(ble_port_status_t st) {
+    switch (st) {
+    case BLE_PORT_OK:         return 0;
+    case BLE_PORT_ERR_STATE:  return ATT_WRONG_STATE;
+    case BLE_PORT_ERR_RANGE:  return ATT_OUT_OF_RANGE;
+    case BLE_PORT_ERR_OFFSET: return BLE_ATT_ERR_INVALID_OFFSET;
+    default:                  return BLE_ATT_ERR_UNLIKELY;
+    }
+}
+
+static int val_idx(uint16_t h) {
+    if (!h) return -1;
+    for (int i = 0; i < EFBE_IDX_NB; ++i) if (s_handle[i] == h) return i;
+    return -1;
+}
+
+/* NimBLE calls back for the whole value on every Read / Read Blob and applies the
+ * offset itself, so the core is told it cannot see the offset. */
+static int on_read(uint16_t conn, uint8_t idx, struct os_mbuf *om) {
+    static uint8_t buf[BLE_ATT_PAYLOAD_MAX];   // host task only
+    uint16_t n = 0;
+    if (gatt_core_reads(idx)) {
+        ble_port_status_t st = gatt_core_read(conn, idx, BLE_PORT_OFF_WHOLE, buf, sizeof(buf), &n);
+        if (st != BLE_PORT_OK) return att_status(st);
+    } else {
+        portENTER_CRITICAL(&s_val_mux);
+        n = s_val_len[idx];
+        if (n) memcpy(buf, s_val[idx], n);
+        portEXIT_CRITICAL(&s_val_mux);
+    }
+    return (n && os_mbuf_append(om, buf, n)) ? BLE_ATT_ERR_INSUFFICIENT_RES : 0;
+}
+
+static int on_write(uint16_t conn, uint8_t idx, struct os_mbuf *om) {
+    static uint8_t buf[BLE_ATT_PAYLOAD_MAX];
+    uint16_t n = 0;
+    if (OS_MBUF_PKTLEN(om) > sizeof(buf)) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    if (ble_hs_mbuf_to_flat(om, buf, sizeof(buf), &n) != 0) return BLE_ATT_ERR_UNLIKELY;
+
+    const ble_port_req_t r = {
+        .conn_id  = conn,
+        .trans_id = 0,
+        .need_rsp = s_app_rsp[idx] != 0,
+        .sync     = true,
+    };
+    s_sync_st = BLE_PORT_OK;
+    gatt_core_write(&r, idx, buf, n);
+    return att_status(s_sync_st);
+}
+
+/* Host task: everything else BLE waits while it runs. */
+static int chr_access(uint16_t conn, uint16_t attr, struct ble_gatt_access_ctxt *ctxt, void *arg) {
+    (void)attr;
+    int64_t t0 = esp_timer_get_time();
+    uint8_t idx = (uint8_t)(uintptr_t)arg;
+    int rc;
+    switch (ctxt->op) {
+    case BLE_GATT_ACCESS_OP_READ_CHR:  rc = on_read(conn, idx, ctxt->om); break;
+    case BLE_GATT_ACCESS_OP_WRITE_CHR: rc = on_write(conn, idx, ctxt->om); break;
+    default:                           rc = BLE_ATT_ERR_UNLIKELY; break;
+    }
+    gatt_defer_note_cb((uint32_t)(esp_timer_get_time() - t0), (int)ctxt->op);
+    return rc;
+}
+
+static int gap_event(struct ble_gap_event *ev, void *arg) {
+    (void)arg;
+    int64_t t0 = esp_timer_get_time();
+    switch (ev->type) {
+    case BLE_GAP_EVENT_CONNECT: {
+        /* Legacy advertising ends with the connection; a failed one ends it too. */
+        if (ev->connect.status != 0) {
+            fb_gap_on(FB_GAP_ADV_STOPPED, true);
+            break;
+        }
+        uint8_t bda[6] = {0};
+        struct ble_gap_conn_desc d;
+        if (ble_gap_conn_find(ev->connect.conn_handle, &d) == 0) memcpy(bda, d.peer_id_addr.val, sizeof(bda));
+        gatt_core_on_connect(ev->connect.conn_handle, bda);
+        break;
+    }
+    case BLE_GAP_EVENT_DISCONNECT:
+        gatt_core_on_disconnect(ev->disconnect.conn.conn_handle);
+        break;
+    case BLE_GAP_EVENT_MTU:
+        gatt_core_on_mtu(ev->mtu.conn_handle, ev->mtu.value);
+        break;
+    case BLE_GAP_EVENT_SUBSCRIBE: {
+        int i = val_idx(ev->subscribe.attr_handle);
+        if (i >= 0) gatt_core_on_subscribe(ev->subscribe.conn_handle, (uint8_t)(i + 1),   // _VAL -> _CCC
+                                           ev->subscribe.cur_notify);
+        break;
+    }
+    case BLE_GAP_EVENT_NOTIFY_TX: {
+        int i = val_idx(ev->notify_tx.attr_handle);
+        if (i >= 0) gatt_core_on_sent(ev->notify_tx.conn_handle, (uint8_t)i, ev->notify_tx.status == 0, false);
+        break;
+    }
+    case BLE_GAP_EVENT_ADV_COMPLETE:
+        fb_gap_on(FB_GAP_ADV_STOPPED, true);
+        break;
+    default:
+        break;
+    }
+    gatt_defer_note_cb((uint32_t)(esp_timer_get_time() - t0), 0x100 | ev->type);
+    return 0;
+}
+
+static int apply_scan_rsp(void) {
+    struct ble_hs_adv_fields f;
+    memset(&f, 0, sizeof(f));
+    const char *name = ble_svc_gap_device_name();
+    f.name = (uint8_t *)name;
+    f.name_len = (uint8_t)strlen(name);
+    f.name_is_complete = 1;
+    f.tx_pwr_lvl_is_present = 1;
+    f.tx_pwr_lvl = BLE_HS_ADV_TX_PWR_LVL_AUTO;
+    f.uuids128 = &s_svc_uuid;
+    f.num_uuids128 = 1;
+    f.uuids128_is_complete = 1;
+    return ble_gap_adv_rsp_set_fields(&f);
+}
+
+static void on_sync(void) {
+    int rc = ble_hs_util_ensure_addr(0);
+    if (rc == 0) rc = ble_hs_id_infer_auto(0, &s_own_addr);
+    if (rc != 0) ESP_LOGE(TAG, "no usable address: %d", rc);
+    s_synced = true;
+
+    if (s_adv_raw_len) fb_gap_on(FB_GAP_ADV_DATA, ble_gap_adv_set_data(s_adv_raw, s_adv_raw_len) == 0);
+    if (s_rsp_pending) {
+        s_rsp_pending = false;
+        fb_gap_on(FB_GAP_SCAN_RSP, apply_scan_rsp() == 0);
+    }
+    gatt_core_on_started();
+}
+
+static void on_reset(int reason) {
+    s_synced = false;
+    ESP_LOGW(TAG, "host reset: %d", reason);
+}
+
+static void host_task(void *arg) {
+    (void)arg;
+    nimble_port_run();                 // returns after nimble_port_stop()
+    nimble_port_freertos_deinit();
+}
+
+/* ----- Stack ----- */
+
+const char *ble_port_name(void) { return "nimble"; }
+
+/* nimble_port_init() brings the controller up as well (IDF >= 5.0). */
+esp_err_t ble_port_up(const char *dev_name) {
+    esp_err_t e = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
+    if (e != ESP_OK && e != ESP_ERR_INVALID_STATE) return e;
+    e = nimble_port_init();
+    if (e != ESP_OK) return e;
+    ble_hs_cfg.sync_cb = on_sync;
+    ble_hs_cfg.reset_cb = on_reset;
+    ble_svc_gap_init();
+    ble_svc_gatt_init();
+    if (ble_svc_gap_device_name_set(dev_name) != 0) return ESP_FAIL;
+    s_adv_raw_len = 0;
+    s_rsp_pending = false;
+    return ESP_OK;
+}
+
+esp_err_t ble_port_start(void) {
+    nimble_port_freertos_init(host_task);
+    return ESP_OK;
+}
+
+void ble_port_down(void) {
+    s_synced = false;
+    int rc = nimble_port_stop();
+    if (rc != 0) {
+        ESP_LOGE(TAG, "host stop: %d", rc);
+        return;
+    }
+    esp_err_t e = nimble_port_deinit();
+    if (e != ESP_OK) ESP_LOGE(TAG, "nimble teardown: %s", esp_err_to_name(e));
+    for (int i = 0; i < EFBE_IDX_NB; ++i) {
+        free(s_val[i]);
+        s_val[i] = NULL;
+        s_val_len[i] = 0;
+    }
+}
+
+/* ----- GATT ----- */
+
+/* Called between ble_port_up() and ble_port_start(): services must exist before the host
+ * runs; the stack assigns handles and gatt_core_on_started() follows from on_sync(). */
+esp_err_t ble_port_gatt_register(void) {
+    memcpy(s_svc_uuid.value, SERVICE_UUID, sizeof(s_svc_uuid.value));
+    int rc = ble_gatts_count_cfg(s_svcs);
+    if (rc == 0) rc = ble_gatts_add_svcs(s_svcs);
+    if (rc != 0) {
+        ESP_LOGE(TAG, "add services: %d", rc);
+        return ESP_FAIL;
+    }
+    int m = ble_att_set_preferred_mtu(BLE_LOCAL_MTU);
+    if (m != 0) ESP_LOGW(TAG, "preferred MTU %u: %d", (unsigned)BLE_LOCAL_MTU, m);
+    return ESP_OK;
+}
+
+/* Services go with the host in ble_port_down(). */
+void ble_port_gatt_unregister(void) {
+    memset(s_handle, 0, sizeof(s_handle));
+}
+
+bool ble_port_gatt_ready(void) {
+    return s_synced && s_handle[IDX_TX_VAL];
+}
+
+esp_err_t ble_port_notify(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (!s_synced || idx >= EFBE_IDX_NB || !s_handle[idx]) return ESP_ERR_INVALID_STATE;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(v, n);
+    if (!om) return ESP_ERR_NO_MEM;
+    int rc = ble_gatts_notify_custom(conn_id, s_handle[idx], om);   // consumes om
+    if (rc == 0) return ESP_OK;
+    return (rc == BLE_HS_ENOMEM) ? ESP_ERR_NO_MEM : ESP_FAIL;
+}
+
+void ble_port_set_value(uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (idx >= EFBE_IDX_NB || gatt_core_reads(idx)) return;
+    if (n > BLE_ATT_PAYLOAD_MAX) n = BLE_ATT_PAYLOAD_MAX;
+    if (!s_val[idx]) {
+        uint8_t *p = malloc(BLE_ATT_PAYLOAD_MAX);
+        if (!p) return;
+        portENTER_CRITICAL(&s_val_mux);
+        if (!s_val[idx]) { s_val[idx] = p; p = NULL; }
+        portEXIT_CRITICAL(&s_val_mux);
+        free(p);
+    }
+    portENTER_CRITICAL(&s_val_mux);
+    memcpy(s_val[idx], v, n);
+    s_val_len[idx] = n;
+    portEXIT_CRITICAL(&s_val_mux);
+}
+
+void ble_port_write_rsp(const ble_port_req_t *r, ble_port_status_t st) {
+    if (r && r->sync) s_sync_st = st;
+}
+
+void ble_port_close(uint16_t conn_id) {
+    ble_gap_terminate(conn_id, BLE_ERR_REM_USER_CONN_TERM);
+}
+
+esp_err_t ble_port_conn_params(uint16_t conn_id, const uint8_t bda[6],
+                               uint16_t itvl_min, uint16_t itvl_max, uint16_t timeout) {
+    (void)bda;
+    const struct ble_gap_upd_params p = {
+        .itvl_min = itvl_min,
+        .itvl_max = itvl_max,
+        .latency = 0,
+        .supervision_timeout = timeout,
+    };
+    return ble_gap_update_params(conn_id, &p) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t ble_port_data_len(uint16_t conn_id, const uint8_t bda[6], uint16_t octets) {
+    (void)bda;
+    uint16_t time_us = (uint16_t)((octets + 14u) * 8u);   // 1M PHY airtime of the longest PDU
+    return ble_gap_set_data_len(conn_id, octets, time_us) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+/* ----- Advertising: NimBLE calls complete synchronously, so the GAP upcalls fire here. ----- */
+
+esp_err_t ble_port_adv_start(uint16_t itvl_min, uint16_t itvl_max) {
+    if (!s_synced) return ESP_ERR_INVALID_STATE;
+    struct ble_gap_adv_params p;
+    memset(&p, 0, sizeof(p));
+    p.conn_mode = BLE_GAP_CONN_MODE_UND;
+    p.disc_mode = BLE_GAP_DISC_MODE_GEN;
+    p.itvl_min = itvl_min;
+    p.itvl_max = itvl_max;
+    int rc = ble_gap_adv_start(s_own_addr, NULL, BLE_HS_FOREVER, &p, gap_event, NULL);
+    if (rc == BLE_HS_EALREADY) {
+        (void)ble_gap_adv_stop();
+        rc = ble_gap_adv_start(s_own_addr, NULL, BLE_HS_FOREVER, &p, gap_event, NULL);
+    }
+    fb_gap_on(FB_GAP_ADV_STARTED, rc == 0);
+    return rc == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t ble_port_adv_stop(void) {
+    int rc = ble_gap_adv_stop();
+    if (rc == BLE_HS_EALREADY) return ESP_ERR_INVALID_STATE;
+    if (rc != 0) return ESP_FAIL;
+    fb_gap_on(FB_GAP_ADV_STOPPED, true);
+    return ESP_OK;
+}
+
+esp_err_t ble_port_adv_set_raw(const uint8_t *adv, size_t n) {
+    if (n > sizeof(s_adv_raw)) return ESP_ERR_INVALID_SIZE;
+    memcpy(s_adv_raw, adv, n);
+    s_adv_raw_len = (uint8_t)n;
+    if (!s_synced) return ESP_OK;
+    int rc = ble_gap_adv_set_data(adv, (int)n);
+    fb_gap_on(FB_GAP_ADV_DATA, rc == 0);
+    return rc == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t ble_port_scan_rsp_set(const uint8_t uuid[16]) {
+    memcpy(s_svc_uuid.value, uuid, sizeof(s_svc_uuid.value));
+    if (!s_synced) {
+        s_rsp_pending = true;
+        return ESP_OK;
+    }
+    int rc = apply_scan_rsp();
+    fb_gap_on(FB_GAP_SCAN_RSP, rc == 0);
+    return rc == 0 ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,501 @@
+// port_sim.c, ble_port.h without a radio (-DBLE_PORT=sim).
+// The central is whoever calls ble_sim_* (include/ble_sim.h): its calls run the core
+// upcalls on the caller's task, serialized by s_host. Writes are answered as Bluedroid
+// does (asynchronously, CCCs kept by the core); notifications wait in a per-link queue
+// until ble_sim_run_events() sends them and confirms them to the core.
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#include "app_cfg.h"        // BLE_MAX_CONN, BLE_LOCAL_MTU, BLE_SIM_*
+#include "ble_sim.h"
+#include "ble_port.h"
+#include "gatt_priv.h"      // gatt_table.h, gatt_defer_note_cb()
+
+static const char *TAG = "BLE.sim";
+
+/* Column vocabulary of GATT_SVC_TABLE: the characteristic property bits of the spec. */
+#define GP_READ         0x02
+#define GP_WRITE_NR     0x04
+#define GP_WRITE        0x08
+#define GP_NOTIFY       0x10
+
+#define PROPS_ROW(n, tail, props, ...) [IDX_##n##_VAL] = (props),
+static const uint8_t s_props[EFBE_IDX_NB] = { GATT_SVC_TABLE(PROPS_ROW, PROPS_ROW) };
+
+#define SIM_VAL_MAX     (BLE_LOCAL_MTU - 3)
+#define SIM_LL_MIN      27          // LL payload before a data length update
+#define SIM_LL_MAX      251
+
+/* Upcall tags for gatt_defer_note_cb(), apart from the Bluedroid/NimBLE event numbers. */
+enum { SIM_EV_CONNECT = 0x200, SIM_EV_DISCONNECT, SIM_EV_MTU, SIM_EV_CONGEST,
+       SIM_EV_WRITE, SIM_EV_READ, SIM_EV_SENT };
+
+typedef struct {
+    bool     used;
+    bool     closing;               // ble_port_close(): disconnect follows
+    uint16_t conn_id;
+    uint16_t mtu;
+    uint16_t itvl;                  // 1.25 ms units
+    uint16_t octets;                // LL payload per packet
+    uint32_t up_pkts;               // write packets not yet on air
+    uint8_t  q_idx[BLE_SIM_INFLIGHT];
+    uint16_t q_len[BLE_SIM_INFLIGHT];
+    uint8_t  q_head, q_n;
+    uint16_t head_left;             // packets of the head notification still to send
+} sim_link_t;
+
+/* One slot more than the core takes, so a connect past the cap can be refused. */
+static sim_link_t s_link[BLE_MAX_CONN + 1];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t s_host;
+
+static bool s_up, s_started, s_registered, s_adv;
+static bool s_adv_pending, s_rsp_pending;
+
+static uint8_t *s_val[EFBE_IDX_NB];
+static uint16_t s_val_len[EFBE_IDX_NB];
+
+static ble_sim_stats_t s_st;
+static uint16_t s_loss;             // 1/1000 per packet
+static uint32_t s_rng = 1;
+static ble_sim_sink_t s_sink;
+static void *s_sink_user;
+
+/* Write being injected: its answer, if the core gives it before returning. */
+static uint32_t s_trans;
+static ble_port_status_t s_trans_st;
+
+static void note_cb(int64_t t0, int ev) {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    gatt_defer_note_cb(us, ev);
+    portENTER_CRITICAL(&s_mux);
+    s_st.cbs++;
+    s_st.cb_total_us += us;
+    if (us > s_st.cb_max_us) s_st.cb_max_us = us;
+    portEXIT_CRITICAL(&s_mux);
+}
+#define UPCALL(ev, call) do { int64_t t0_ = esp_timer_get_time(); call; note_cb(t0_, (ev)); } while (0)
+
+static bool host_lock(void) {
+    if (!s_host || !s_started) return false;
+    xSemaphoreTake(s_host, portMAX_DELAY);
+    if (s_started) return true;
+    xSemaphoreGive(s_host);
+    return false;
+}
+static void host_unlock(void) { xSemaphoreGive(s_host); }
+
+static sim_link_t *link_find(uint16_t conn_id) {
+    for (int i = 0; i < (int)(sizeof(s_link) / sizeof(s_link[0])); ++i)
+        if (s_link[i].used && s_link[i].conn_id == conn_id) return &s_link[i];
+    return NULL;
+}
+
+/* LL packets for one ATT PDU of `len` value bytes (opcode + handle, L2CAP header). */
+static uint32_t pkts_for(uint16_t len, uint16_t octets) {
+    return ((uint32_t)len + 3u + 4u + octets - 1u) / octets;
+}
+
+static bool lose(void) {
+    if (!s_loss) return false;
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (s_rng % 1000u) < s_loss;
+}
+
+/* Deliver the disconnects ble_port_close() asked for; host lock held. */
+static void reap(void) {
+    for (int i = 0; i < (int)(sizeof(s_link) / sizeof(s_link[0])); ++i) {
+        portENTER_CRITICAL(&s_mux);
+        bool go = s_link[i].used && s_link[i].closing;
+        uint16_t conn = s_link[i].conn_id;
+        portEXIT_CRITICAL(&s_mux);
+        if (!go) continue;
+        UPCALL(SIM_EV_DISCONNECT, gatt_core_on_disconnect(conn));
+        portENTER_CRITICAL(&s_mux);
+        memset(&s_link[i], 0, sizeof(s_link[i]));
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+/* ----- Stack ----- */
+
+const char *ble_port_name(void) { return "sim"; }
+
+esp_err_t ble_port_up(const char *dev_name) {
+    if (!s_host) s_host = xSemaphoreCreateMutex();
+    if (!s_host) return ESP_ERR_NO_MEM;
+    memset(s_link, 0, sizeof(s_link));
+    s_adv = s_adv_pending = s_rsp_pending = false;
+    s_up = true;
+    ESP_LOGI(TAG, "simulated host up as \"%s\"", dev_name);
+    return ESP_OK;
+}
+
+/* The host "syncs" at once: pending ADV payloads, then the service goes live. */
+esp_err_t ble_port_start(void) {
+    if (!s_up) return ESP_ERR_INVALID_STATE;
+    s_started = true;
+    if (s_adv_pending) { s_adv_pending = false; fb_gap_on(FB_GAP_ADV_DATA, true); }
+    if (s_rsp_pending) { s_rsp_pending = false; fb_gap_on(FB_GAP_SCAN_RSP, true); }
+    if (s_registered) gatt_core_on_started();
+    return ESP_OK;
+}
+
+void ble_port_down(void) {
+    if (s_host) xSemaphoreTake(s_host, portMAX_DELAY);
+    s_started = s_up = s_adv = false;
+    portENTER_CRITICAL(&s_mux);
+    memset(s_link, 0, sizeof(s_link));
+    portEXIT_CRITICAL(&s_mux);
+    for (int i = 0; i < EFBE_IDX_NB; ++i) {
+        free(s_val[i]);
+        s_val[i] = NULL;
+        s_val_len[i] = 0;
+    }
+    if (s_host) xSemaphoreGive(s_host);
+}
+
+/* ----- GATT ----- */
+
+esp_err_t ble_port_gatt_register(void) {
+    s_registered = true;
+    return ESP_OK;
+}
+
+void ble_port_gatt_unregister(void) { s_registered = false; }
+
+bool ble_port_gatt_ready(void) { return s_started && s_registered; }
+
+esp_err_t ble_port_notify(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (!s_started || idx >= EFBE_IDX_NB) return ESP_ERR_INVALID_STATE;
+    ble_sim_note_t note = { .conn_id = conn_id, .idx = idx, .len = n, .data = v,
+                            .wall_us = esp_timer_get_time() };
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    esp_err_t e = ESP_OK;
+    if (!l || l->closing)                 e = ESP_ERR_INVALID_STATE;
+    else if (n > l->mtu - 3)              e = ESP_ERR_INVALID_SIZE;
+    else if (l->q_n >= BLE_SIM_INFLIGHT) { e = ESP_ERR_NO_MEM; s_st.notif_busy++; }
+    if (e == ESP_OK) {
+        uint8_t t = (uint8_t)((l->q_head + l->q_n) % BLE_SIM_INFLIGHT);
+        l->q_idx[t] = idx;
+        l->q_len[t] = n;
+        l->q_n++;
+        s_st.notifs++;
+        s_st.notif_bytes += n;
+        note.sim_us = s_st.sim_us;
+    }
+    ble_sim_sink_t sink = s_sink;
+    void *user = s_sink_user;
+    portEXIT_CRITICAL(&s_mux);
+    if (e == ESP_OK && sink) sink(&note, user);
+    return e;
+}
+
+void ble_port_set_value(uint8_t idx, const uint8_t *v, uint16_t n) {
+    if (idx >= EFBE_IDX_NB || gatt_core_reads(idx)) return;
+    if (n > SIM_VAL_MAX) n = SIM_VAL_MAX;
+    if (!s_val[idx]) {
+        uint8_t *p = malloc(SIM_VAL_MAX);
+        if (!p) return;
+        portENTER_CRITICAL(&s_mux);
+        if (!s_val[idx]) { s_val[idx] = p; p = NULL; }
+        portEXIT_CRITICAL(&s_mux);
+        free(p);
+    }
+    portENTER_CRITICAL(&s_mux);
+    memcpy(s_val[idx], v, n);
+    s_val_len[idx] = n;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void ble_port_write_rsp(const ble_port_req_t *r, ble_port_status_t st) {
+    if (!r || !r->need_rsp) return;
+    portENTER_CRITICAL(&s_mux);
+    if (st != BLE_PORT_OK) s_st.write_errs++;
+    if (r->trans_id == s_trans) s_trans_st = st;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+/* The disconnect is delivered when the current (or next) injection returns. */
+void ble_port_close(uint16_t conn_id) {
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (l) l->closing = true;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+/* The simulated central grants every request, taking the shortest interval offered. */
+esp_err_t ble_port_conn_params(uint16_t conn_id, const uint8_t bda[6],
+                               uint16_t itvl_min, uint16_t itvl_max, uint16_t timeout) {
+    (void)bda; (void)itvl_max; (void)timeout;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (l) l->itvl = itvl_min < 6 ? 6 : itvl_min;
+    portEXIT_CRITICAL(&s_mux);
+    return l ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ble_port_data_len(uint16_t conn_id, const uint8_t bda[6], uint16_t octets) {
+    (void)bda;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (l) l->octets = octets < SIM_LL_MIN ? SIM_LL_MIN : (octets > SIM_LL_MAX ? SIM_LL_MAX : octets);
+    portEXIT_CRITICAL(&s_mux);
+    return l ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/* ----- Advertising: completes at once, like NimBLE. ----- */
+
+esp_err_t ble_port_adv_start(uint16_t itvl_min, uint16_t itvl_max) {
+    (void)itvl_min; (void)itvl_max;
+    if (!s_started) return ESP_ERR_INVALID_STATE;
+    s_adv = true;
+    s_st.adv_starts++;
+    fb_gap_on(FB_GAP_ADV_STARTED, true);
+    return ESP_OK;
+}
+
+esp_err_t ble_port_adv_stop(void) {
+    if (!s_adv) return ESP_ERR_INVALID_STATE;
+    s_adv = false;
+    fb_gap_on(FB_GAP_ADV_STOPPED, true);
+    return ESP_OK;
+}
+
+esp_err_t ble_port_adv_set_raw(const uint8_t *adv, size_t n) {
+    (void)adv;
+    if (n > 31) return ESP_ERR_INVALID_SIZE;
+    if (!s_started) { s_adv_pending = true; return ESP_OK; }
+    fb_gap_on(FB_GAP_ADV_DATA, true);
+    return ESP_OK;
+}
+
+esp_err_t ble_port_scan_rsp_set(const uint8_t uuid[16]) {
+    (void)uuid;
+    if (!s_started) { s_rsp_pending = true; return ESP_OK; }
+    fb_gap_on(FB_GAP_SCAN_RSP, true);
+    return ESP_OK;
+}
+
+/* ----- Central side ----- */
+
+esp_err_t ble_sim_connect(uint16_t conn_id) {
+    if (!host_lock()) return ESP_ERR_INVALID_STATE;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    esp_err_t e = l ? ESP_ERR_INVALID_ARG : ESP_ERR_NO_MEM;
+    if (!l) {
+        for (int i = 0; i < (int)(sizeof(s_link) / sizeof(s_link[0])); ++i) {
+            if (s_link[i].used) continue;
+            l = &s_link[i];
+            memset(l, 0, sizeof(*l));
+            l->used = true;
+            l->conn_id = conn_id;
+            l->mtu = 23;
+            l->itvl = BLE_SIM_ITVL;
+            l->octets = SIM_LL_MIN;
+            e = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    if (e != ESP_OK) { host_unlock(); return e; }
+
+    s_adv = false;                                 // legacy advertising ends with the connect
+    const uint8_t bda[6] = { 0xC0, 0xDE, 0x51, 0x4D, (uint8_t)(conn_id >> 8), (uint8_t)conn_id };
+    UPCALL(SIM_EV_CONNECT, gatt_core_on_connect(conn_id, bda));
+    bool refused = l->closing;
+    if (refused) s_st.refused++;
+    else         s_st.connects++;
+    reap();
+    host_unlock();
+    return refused ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+void ble_sim_disconnect(uint16_t conn_id) {
+    ble_port_close(conn_id);
+    if (!host_lock()) return;
+    reap();
+    host_unlock();
+}
+
+void ble_sim_mtu(uint16_t conn_id, uint16_t mtu) {
+    if (!host_lock()) return;
+    uint16_t m = mtu < BLE_LOCAL_MTU ? mtu : BLE_LOCAL_MTU;
+    if (m < 23) m = 23;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (l) l->mtu = m;
+    portEXIT_CRITICAL(&s_mux);
+    if (l) UPCALL(SIM_EV_MTU, gatt_core_on_mtu(conn_id, m));
+    reap();
+    host_unlock();
+}
+
+void ble_sim_congest(uint16_t conn_id, bool congested) {
+    if (!host_lock()) return;
+    UPCALL(SIM_EV_CONGEST, gatt_core_on_congest(conn_id, congested));
+    reap();
+    host_unlock();
+}
+
+/* host lock held */
+static esp_err_t write_locked(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t len,
+                              bool need_rsp) {
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    esp_err_t e = (!l || l->closing) ? ESP_ERR_INVALID_STATE
+                : (len > l->mtu - 3) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+    if (e == ESP_OK) {
+        l->up_pkts += pkts_for(len, l->octets);
+        s_st.writes++;
+        s_trans_st = BLE_PORT_OK;
+    }
+    const ble_port_req_t r = { .conn_id = conn_id, .trans_id = ++s_trans,
+                               .need_rsp = need_rsp, .sync = false };
+    portEXIT_CRITICAL(&s_mux);
+    if (e != ESP_OK) return e;
+    UPCALL(SIM_EV_WRITE, gatt_core_write(&r, idx, v, len));
+    portENTER_CRITICAL(&s_mux);
+    ble_port_status_t st = s_trans_st;
+    portEXIT_CRITICAL(&s_mux);
+    return st == BLE_PORT_OK ? ESP_OK : ESP_FAIL;
+}
+
+/* Write without response wherever the characteristic allows it, as a phone would. */
+esp_err_t ble_sim_write(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t len) {
+    if (idx >= EFBE_IDX_NB) return ESP_ERR_INVALID_ARG;
+    if (!host_lock()) return ESP_ERR_INVALID_STATE;
+    esp_err_t e = write_locked(conn_id, idx, v, len, !(s_props[idx] & GP_WRITE_NR));
+    reap();
+    host_unlock();
+    return e;
+}
+
+esp_err_t ble_sim_subscribe(uint16_t conn_id, uint8_t idx, bool on) {
+    if (idx + 1 >= EFBE_IDX_NB || !(s_props[idx] & GP_NOTIFY)) return ESP_ERR_INVALID_ARG;
+    if (!host_lock()) return ESP_ERR_INVALID_STATE;
+    const uint8_t v[2] = { on ? 0x01 : 0x00, 0x00 };
+    esp_err_t e = write_locked(conn_id, (uint8_t)(idx + 1), v, sizeof(v), true);   // _VAL -> _CCC
+    reap();
+    host_unlock();
+    return e;
+}
+
+esp_err_t ble_sim_read(uint16_t conn_id, uint8_t idx, uint16_t off,
+                       uint8_t *out, uint16_t cap, uint16_t *n) {
+    if (idx >= EFBE_IDX_NB || !out || !n) return ESP_ERR_INVALID_ARG;
+    if (!host_lock()) return ESP_ERR_INVALID_STATE;
+    *n = 0;
+    ble_port_status_t st = BLE_PORT_OK;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (l && cap > l->mtu - 1) cap = l->mtu - 1;         // one read PDU; blobs take `off`
+    portEXIT_CRITICAL(&s_mux);
+    if (!l) {
+        host_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (gatt_core_reads(idx)) {
+        UPCALL(SIM_EV_READ, st = gatt_core_read(conn_id, idx, off, out, cap, n));
+    } else {
+        portENTER_CRITICAL(&s_mux);
+        uint16_t have = s_val_len[idx];
+        if (off > have) st = BLE_PORT_ERR_OFFSET;
+        else {
+            *n = (uint16_t)((have - off) < cap ? (have - off) : cap);
+            if (*n) memcpy(out, s_val[idx] + off, *n);
+        }
+        portEXIT_CRITICAL(&s_mux);
+    }
+    portENTER_CRITICAL(&s_mux);
+    s_st.reads++;
+    if (l->used) l->up_pkts += 1 + pkts_for(*n, l->octets);    // request + response
+    portEXIT_CRITICAL(&s_mux);
+    reap();
+    host_unlock();
+    return st == BLE_PORT_OK ? ESP_OK : ESP_FAIL;
+}
+
+/* One connection event; false once the link is gone. Host lock held. */
+static bool conn_event(uint16_t conn_id, uint32_t *left) {
+    uint8_t sent[BLE_SIM_PKTS_PER_EVT];
+    uint8_t n_sent = 0;
+    portENTER_CRITICAL(&s_mux);
+    sim_link_t *l = link_find(conn_id);
+    if (!l || l->closing) {
+        portEXIT_CRITICAL(&s_mux);
+        *left = 0;
+        return false;
+    }
+    s_st.events++;
+    s_st.sim_us += (int64_t)l->itvl * 1250;
+    for (int budget = BLE_SIM_PKTS_PER_EVT; budget > 0; --budget) {
+        bool up = l->up_pkts > 0;
+        if (!up && !l->q_n) break;
+        s_st.pkts++;
+        if (lose()) { s_st.lost++; break; }      // no ack: the event ends, resent next time
+        if (up) { l->up_pkts--; continue; }
+        if (!l->head_left) l->head_left = (uint16_t)pkts_for(l->q_len[l->q_head], l->octets);
+        if (--l->head_left) continue;
+        sent[n_sent++] = l->q_idx[l->q_head];
+        l->q_head = (uint8_t)((l->q_head + 1) % BLE_SIM_INFLIGHT);
+        l->q_n--;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    for (uint8_t i = 0; i < n_sent; ++i)
+        UPCALL(SIM_EV_SENT, gatt_core_on_sent(conn_id, sent[i], true, false));
+
+    portENTER_CRITICAL(&s_mux);
+    l = link_find(conn_id);
+    *left = l ? l->up_pkts + l->q_n : 0;
+    portEXIT_CRITICAL(&s_mux);
+    return l != NULL;
+}
+
+uint32_t ble_sim_run_events(uint16_t conn_id, uint32_t n) {
+    if (!host_lock()) return 0;
+    uint32_t left = 0;
+    for (uint32_t i = 0; i < n && conn_event(conn_id, &left); ++i) {}
+    reap();
+    host_unlock();
+    return left;
+}
+
+void ble_sim_set_loss(uint16_t permille, uint32_t seed) {
+    portENTER_CRITICAL(&s_mux);
+    s_loss = permille > 1000 ? 1000 : permille;
+    s_rng = seed ? seed : 1;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void ble_sim_set_sink(ble_sim_sink_t fn, void *user) {
+    portENTER_CRITICAL(&s_mux);
+    s_sink = fn;
+    s_sink_user = user;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void ble_sim_get_stats(ble_sim_stats_t *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_st;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void ble_sim_reset_stats(void) {
+    portENTER_CRITICAL(&s_mux);
+    int64_t now = s_st.sim_us;                     // the clock keeps running
+    memset(&s_st, 0, sizeof(s_st));
+    s_st.sim_us = now;
+    portEXIT_CRITICAL(&s_mux);
+}
@@ -0,0 +1,40 @@
+// ble_advsched.h, advertising interval schedule + airtime estimate (internal).
+// Plain C, no RTOS calls; host-buildable. Time comes in as ms so traces replay deterministically.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_fallback.h"   // ble_adv_phase_t, ble_adv_stats_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* FAST for BLE_ADV_FAST_MS after a burst trigger (RECOVERY entry, a disconnect), then MID
+ * until BLE_ADV_MID_MS, then SLOW. A Wi-Fi connect attempt opens a YIELD window
+ * (BLE_ADV_WIFI_LEAD_MS before it, BLE_ADV_WIFI_GUARD_MS long) that overrides the phase. */
+typedef struct {
+    uint32_t burst_ms;      // last burst trigger
+    uint32_t wifi_from;     // yield window start
+    uint32_t wifi_len;      // 0 = none pending
+    uint32_t last_ms;       // accounted up to here
+    uint8_t  phase;         // ble_adv_phase_t currently applied
+    bool     on;            // advertising was running since last_ms
+    uint32_t event_rem;     // sub-event remainder (us) for the event counter
+    ble_adv_stats_t st;
+} ble_advsched_t;
+
+void ble_advsched_reset(ble_advsched_t *s, uint32_t now_ms);
+void ble_advsched_burst(ble_advsched_t *s, uint32_t now_ms);
+/* A connect attempt is expected in in_ms. */
+void ble_advsched_wifi(ble_advsched_t *s, uint32_t now_ms, uint32_t in_ms);
+
+/* Account the time since the last call at the applied phase/interval, then pick the phase
+ * for now. on = advertising is running. *next_ms: re-evaluate after this long. */
+ble_adv_phase_t ble_advsched_eval(ble_advsched_t *s, uint32_t now_ms, bool on, uint32_t *next_ms);
+
+/* Interval range for a phase, in 0.625 ms units (HCI advertising parameters). */
+void ble_advsched_interval(ble_adv_phase_t p, uint16_t *min_units, uint16_t *max_units);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+// ble_port.h, host-stack backend under the lifeboat (internal).
+// The GATT core (gatt/*.c) and the fallback (fallback/*.c) reach the BLE host only through
+// these calls. Exactly one backend is linked, picked by sdkconfig:
+//   CONFIG_BT_BLUEDROID_ENABLED -> port/port_bluedroid.c
+//   CONFIG_BT_NIMBLE_ENABLED    -> port/port_nimble.c
+//   -DBLE_PORT=sim              -> port/port_sim.c (no radio; include/ble_sim.h drives it)
+// All build the same service from GATT_SVC_TABLE and address attributes by IDX_*.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Outcome of a read/write as the core sees it; each backend maps it to an ATT status. */
+typedef enum {
+    BLE_PORT_OK = 0,
+    BLE_PORT_ERR_STATE,      // write from a connection we refused
+    BLE_PORT_ERR_RANGE,      // value out of range
+    BLE_PORT_ERR_OFFSET,     // read-blob offset past the end
+} ble_port_status_t;
+
+/* A write as handed to the core. The core answers it with ble_port_write_rsp(), now or
+ * later from the BLE worker; with `sync` set the answer must come before the upcall
+ * returns (NimBLE access callbacks return the ATT status). */
+typedef struct {
+    uint16_t conn_id;
+    uint32_t trans_id;       // backend cookie
+    bool     need_rsp;
+    bool     sync;
+} ble_port_req_t;
+
+/* ----- Stack (fb_core.c) ----- */
+const char *ble_port_name(void);
+esp_err_t   ble_port_up(const char *dev_name);   /* controller + host; GAP usable, GATT not yet */
+esp_err_t   ble_port_start(void);                /* after GATT registration: host runs */
+void        ble_port_down(void);                 /* host, then controller; memory returned */
+
+/* ----- GATT (gatt_*.c) ----- */
+esp_err_t ble_port_gatt_register(void);          /* gatt_core_on_started() once the service is live */
+void      ble_port_gatt_unregister(void);
+bool      ble_port_gatt_ready(void);
+esp_err_t ble_port_notify(uint16_t conn_id, uint8_t idx, const uint8_t *v, uint16_t n);
+void      ble_port_set_value(uint8_t idx, const uint8_t *v, uint16_t n);   /* value served without the core */
+void      ble_port_write_rsp(const ble_port_req_t *r, ble_port_status_t st);
+void      ble_port_close(uint16_t conn_id);
+/* Connection requests to the central; 1.25 ms / 10 ms units as in the HCI command. */
+esp_err_t ble_port_conn_params(uint16_t conn_id, const uint8_t bda[6],
+                               uint16_t itvl_min, uint16_t itvl_max, uint16_t timeout);
+esp_err_t ble_port_data_len(uint16_t conn_id, const uint8_t bda[6], uint16_t octets);
+
+/* ----- Advertising (fb_gap.c / fb_tlm.c); intervals in 0.625 ms units ----- */
+esp_err_t ble_port_adv_start(uint16_t itvl_min, uint16_t itvl_max);
+esp_err_t ble_port_adv_stop(void);                /* ESP_ERR_INVALID_STATE if not advertising */
+esp_err_t ble_port_adv_set_raw(const uint8_t *adv, size_t n);
+esp_err_t ble_port_scan_rsp_set(const uint8_t uuid[16]);   /* name + TX power + service UUID */
+
+/* ----- Upcalls, backend -> core (host task) ----- */
+void gatt_core_on_started(void);
+void gatt_core_on_connect(uint16_t conn_id, const uint8_t bda[6]);
+void gatt_core_on_disconnect(uint16_t conn_id);
+void gatt_core_on_mtu(uint16_t conn_id, uint16_t mtu);
+void gatt_core_on_sent(uint16_t conn_id, uint8_t idx, bool ok, bool congested);
+void gatt_core_on_congest(uint16_t conn_id, bool congested);
+void gatt_core_on_subscribe(uint16_t conn_id, uint8_t ccc_idx, bool on);   /* stack-managed CCCs */
+bool gatt_core_reads(uint8_t idx);                                         /* has a read handler */
+/* `off` of a host that wants the whole value on every Read / Read Blob and drops the
+ * first offset bytes itself (NimBLE). */
+#define BLE_PORT_OFF_WHOLE 0xFFFFu
+ble_port_status_t gatt_core_read(uint16_t conn_id, uint8_t idx, uint16_t off,
+                                 uint8_t *out, uint16_t cap, uint16_t *n);
+void gatt_core_write(const ble_port_req_t *r, uint8_t idx, const uint8_t *v, uint16_t n);
+
+typedef enum {
+    FB_GAP_ADV_DATA = 0,     // primary ADV payload applied
+    FB_GAP_SCAN_RSP,         // scan response applied
+    FB_GAP_ADV_STARTED,
+    FB_GAP_ADV_STOPPED,
+} fb_gap_ev_t;
+void fb_gap_on(fb_gap_ev_t ev, bool ok);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,7 +5,6 @@
 #include "freertos/timers.h"
 #include <stdbool.h>
 #include <stdint.h>
-#include "esp_gap_ble_api.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,7 +25,7 @@ void  ble_post(ble_evt_t ev);
 extern bool s_stack_ready;
 extern bool s_adv_ready;
 extern bool s_adv_running;
-extern bool s_connected;
+extern uint8_t s_links;                 /* live GATT connections */
 extern bool s_lifeboat_enabled;
 extern bool s_adv_start_deferred;
 
@@ -34,11 +33,11 @@ extern TimerHandle_t s_adv_watch;
 
 extern uint8_t  s_adv_uuid[16];
 extern uint8_t  s_adv_cfg_done;          // bitmask
-extern esp_ble_adv_params_t s_adv_params;
+extern uint16_t s_adv_itvl_min;
+extern uint16_t s_adv_itvl_max;
 
 /* Actions (implemented in fallback) */
 void fb_adv_kick(void);                   // start advertising if policy allows
-void fb_gap_evt(esp_gap_ble_cb_event_t ev, esp_ble_gap_cb_param_t *p);
 
 /* watchdog helpers */
 void fb_watchdog_start_if_needed(void);
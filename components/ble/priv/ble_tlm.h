@@ -0,0 +1,49 @@
+// ble_tlm.h, connectionless status block carried in the primary advertising payload (internal).
+// Plain C, no RTOS calls; host-buildable.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Primary ADV (31 bytes):
+ *   02 01 06                       flags: LE general discoverable, no BR/EDR
+ *   1B 21 <service uuid128> <tlm>  service data (128-bit UUID), 10-byte block:
+ *     [0] ver<<4 | mode   [1] errsrc   [2] alert seq (low byte)   [3] alert code
+ *     [4..5] T int16 LE tenths °C   [6..7] RH uint16 LE tenths %   [8..9] fw hash LE
+ * The UUID list moves to the scan response (with the name). */
+#define BLE_TLM_VER      1
+#define BLE_TLM_LEN      10
+#define BLE_TLM_ADV_LEN  (3 + 2 + 16 + BLE_TLM_LEN)
+#define BLE_TLM_T_NA     INT16_MIN
+#define BLE_TLM_RH_NA    0xFFFFu
+
+typedef struct {
+    uint8_t  mode;        // sc_mode_t
+    uint8_t  errsrc;      // errsrc_t
+    uint8_t  alert_seq;   // low byte of the latest alert seq
+    uint8_t  alert_code;  // alert_code_t
+    int16_t  t_dc;        // BLE_TLM_T_NA when no valid sample
+    uint16_t rh_dp;       // BLE_TLM_RH_NA when no valid sample
+    uint16_t fw;          // first two bytes of the app ELF SHA-256
+} ble_tlm_t;
+
+/* Change + rate gate: one refresh per min_ms, and only when something changed. */
+typedef struct {
+    ble_tlm_t last;
+    uint32_t  last_ms;
+    bool      sent;
+} ble_tlm_gate_t;
+
+/* Whole primary ADV payload; returns its length (BLE_TLM_ADV_LEN) or 0 if cap is short. */
+size_t ble_tlm_build_adv(const ble_tlm_t *t, const uint8_t uuid128[16], uint8_t *out, size_t cap);
+
+/* True if cur should be advertised now; records it as sent. */
+bool ble_tlm_due(ble_tlm_gate_t *g, const ble_tlm_t *cur, uint32_t now_ms, uint32_t min_ms);
+
+#ifdef __cplusplus
+}
+#endif
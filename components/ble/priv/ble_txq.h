@@ -0,0 +1,62 @@
+// ble_txq.h, per-link TX byte queue for TX-characteristic notifications (internal).
+// Plain C, no RTOS calls; host-buildable. The caller provides locking.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "app_cfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ATT caps an attribute value (and so one notification) at 512 bytes. */
+#define BLE_ATT_PAYLOAD_MAX 512
+
+typedef struct {
+    uint32_t lines;     // lines accepted
+    uint32_t dropped;   // lines refused because the queue was full
+    uint32_t notifs;    // notifications handed to the stack
+    uint32_t bytes;     // bytes carried by those notifications (newlines included)
+    uint32_t congest;   // congestion episodes
+    uint32_t errors;    // send/confirm failures
+} ble_txq_stats_t;
+
+/* Lines are queued as one byte stream ("a\nb\n..."); each notification takes as much of
+ * the stream as the MTU allows, so newlines ride in the last chunk and short lines pack. */
+typedef struct {
+    uint8_t  buf[BLE_TXQ_BYTES];
+    uint16_t head;       // oldest queued byte
+    uint16_t len;        // queued bytes
+    uint8_t  inflight;   // notifications not yet confirmed by the stack
+    bool     congested;  // stack reported congestion; wait for uncongest
+    uint16_t last_at;    // newest line (no '\n') for TX reads; nothing writes over it
+    uint16_t last_len;   // before a newer line does
+    ble_txq_stats_t st;
+} ble_txq_t;
+
+void ble_txq_reset(ble_txq_t *q);
+
+/* Queue s[0..n) plus '\n' as a whole, or nothing. Lines longer than the queue are cut. */
+bool ble_txq_push_line(ble_txq_t *q, const char *s, size_t n);
+
+/* Record s[0..n) as the newest line without queueing it (TX notifications off): it goes
+ * into the free space at the tail, cut to fit, and the next line overwrites it. */
+void ble_txq_keep_line(ble_txq_t *q, const char *s, size_t n);
+
+/* Copy the newest line from `off` (read-blob continuation); false if off is past its end. */
+bool ble_txq_last(const ble_txq_t *q, size_t off, uint8_t *out, size_t cap, size_t *n);
+
+/* Contiguous run at the head, at most cap bytes, without consuming it. A run that
+ * wraps the ring end goes out as two notifications; no staging copy is needed. */
+size_t ble_txq_front(const ble_txq_t *q, const uint8_t **p, size_t cap);
+
+/* Drop n sent bytes from the head and count one notification. */
+void ble_txq_consume(ble_txq_t *q, size_t n);
+
+/* Data queued, link not congested and fewer than window notifications outstanding. */
+bool ble_txq_ready(const ble_txq_t *q, uint8_t window);
+
+#ifdef __cplusplus
+}
+#endif
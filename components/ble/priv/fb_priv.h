@@ -5,7 +5,7 @@
 #include "freertos/timers.h"
 #include <stdbool.h>
 #include <stdint.h>
-#include "esp_gap_ble_api.h"
+#include "app_cfg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,20 +13,31 @@ extern "C" {
 
 /* Events -> worker */
 typedef enum {
-  BLE_EVT_ADV_KICK = 1
+  BLE_EVT_ADV_KICK = 1,
+  BLE_EVT_GATT_WRITE,        /* arg = gatt_defer slot */
+  BLE_EVT_TLM,               /* status may have changed: refresh the ADV block */
+  BLE_EVT_FENCE,             /* everything queued before it has run (fb_worker_quiesce) */
+  BLE_EVT_ADV_SCHED,         /* re-evaluate the advertising interval (fb_adv.c) */
 } ble_evt_t;
 
+typedef struct {
+  ble_evt_t ev;
+  uint8_t   arg;
+} ble_msg_t;
+
 /* Worker plumbing (owned by fb_worker.c) */
 extern QueueHandle_t s_ble_q;
 extern TaskHandle_t  s_ble_wkr;
 void  fb_worker_init_once(void);
 void  ble_post(ble_evt_t ev);
+bool  ble_post_arg(ble_evt_t ev, uint8_t arg);   /* false if the queue is full/missing */
+void  fb_worker_quiesce(void);                    /* wait until queued events have run */
 
 /* Shared state (owned by fb_core.c) */
 extern bool s_stack_ready;
 extern bool s_adv_ready;
 extern bool s_adv_running;
-extern bool s_connected;
+extern uint8_t s_links;                 /* live GATT connections */
 extern bool s_lifeboat_enabled;
 extern bool s_adv_start_deferred;
 
@@ -34,11 +45,26 @@ extern TimerHandle_t s_adv_watch;
 
 extern uint8_t  s_adv_uuid[16];
 extern uint8_t  s_adv_cfg_done;          /* bitmask */
-extern esp_ble_adv_params_t s_adv_params;
+extern uint16_t s_adv_itvl_min;          /* 0.625 ms units, per phase (fb_adv.c) */
+extern uint16_t s_adv_itvl_max;
+
+/* Advertising stays on until every connection slot is taken. */
+static inline bool fb_links_full(void) { return s_links >= BLE_MAX_CONN; }
 
 /* Actions (implemented in fallback) */
 void fb_adv_kick(void);                   /* start advertising if policy allows */
-void fb_gap_evt(esp_gap_ble_cb_event_t ev, esp_ble_gap_cb_param_t *p);
+
+/* Advertising status block (fb_tlm.c); worker context. force skips the change/rate gate. */
+void fb_tlm_refresh(bool force);
+
+/* Advertising schedule (fb_adv.c). reset/burst/log from any task; apply on the worker. */
+void fb_adv_sched_reset(void);
+void fb_adv_burst(void);
+void fb_adv_sched_apply(void);
+void fb_adv_log_stats(void);
+
+/* Restart advertising so a new s_adv_itvl_* takes effect (fb_gap.c). */
+void fb_adv_restart(void);
 
 /* watchdog helpers */
 void fb_watchdog_start_if_needed(void);
@@ -49,7 +75,7 @@ void fb_adv_stop_public(void);
 
 /* These were previously public; keep them internal instead. */
 void ble_set_provisioning(bool on);
-void ble_set_connected(bool on);
+void ble_set_links(uint8_t n);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,41 @@
+// gatt_bin.h, binary values of the ERRSRC, ALERT and DHT characteristics (internal).
+// Plain C, no RTOS calls; host-buildable.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A central picks text or binary per characteristic by writing the FMT characteristic:
+ * one byte, a GATT_CCC_* bit set = that characteristic is binary on this link. Each value
+ * starts with a version byte and fits the 20-byte payload of the default MTU:
+ *   ERRSRC (6): [0] ver  [1] errsrc_t  [2..5] ms in this state, u32 LE
+ *   ALERT  (4): [0] ver  [1] alert_code_t  [2..3] seq, u16 LE
+ *   DHT   (10): [0] ver  [1] flags (bit0 valid)  [2..3] T int16 LE, centi-°C
+ *               [4..5] RH uint16 LE, centi-%  [6..9] sample age, u32 LE ms */
+#define GATT_BIN_VER         1
+#define GATT_BIN_ERRSRC_LEN  6
+#define GATT_BIN_ALERT_LEN   4
+#define GATT_BIN_DHT_LEN     10
+#define GATT_BIN_MAX         GATT_BIN_DHT_LEN
+#define GATT_BIN_T_NA        INT16_MIN
+#define GATT_BIN_RH_NA       0xFFFFu
+
+typedef struct {
+    bool     valid;
+    int16_t  t_cdeg;     // GATT_BIN_T_NA when !valid
+    uint16_t rh_cpct;    // GATT_BIN_RH_NA when !valid
+    uint32_t age_ms;
+} gatt_bin_dht_t;
+
+/* Each returns the bytes written, or 0 if cap is short. */
+size_t gatt_bin_errsrc(uint8_t code, uint32_t ms_in_state, uint8_t *out, size_t cap);
+size_t gatt_bin_alert(uint8_t code, uint16_t seq, uint8_t *out, size_t cap);
+size_t gatt_bin_dht(const gatt_bin_dht_t *d, uint8_t *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
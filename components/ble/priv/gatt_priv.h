@@ -2,88 +2,122 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
-#include "esp_gatts_api.h"
-#include "esp_gap_ble_api.h"
+#include <stddef.h>
+#include "errsrc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "app_cfg.h"
+#include "dht.h"
+#include "ble_txq.h"
+#include "gatt_table.h"     // IDX_*, GATT_CCC_*, characteristic UUIDs
+#include "ble_port.h"       // host backend (Bluedroid / NimBLE)
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* ----- Indexes into gatt_handle_table[] (from gatt_attrs.c) ----- */
-enum {
-  IDX_SVC = 0,
-
-  IDX_RX_CHAR,
-  IDX_RX_VAL,
-
-  IDX_TX_CHAR,
-  IDX_TX_VAL,
-  IDX_TX_CCC,
-
-  IDX_WIFI_CHAR,
-  IDX_WIFI_VAL,
-
-  IDX_ERRSRC_CHAR,
-  IDX_ERRSRC_VAL,
-  IDX_ERRSRC_CCC,
-
-  IDX_ALERT_CHAR,
-  IDX_ALERT_VAL,
-  IDX_ALERT_CCC,
-
-  IDX_OTA_CTRL_CHAR,
-  IDX_OTA_CTRL_VAL,
-
-  IDX_OTA_DATA_CHAR,
-  IDX_OTA_DATA_VAL,
-
-  IDX_DHT_CHAR,
-  IDX_DHT_VAL,
-  IDX_DHT_CCC,
-
-  EFBE_IDX_NB
-};
-
 /* ----- Opaque command parser context (ble_cmd.c) ----- */
 typedef struct ble_cmd ble_cmd_t;
+typedef struct ble_link ble_link_t;
 
 ble_cmd_t* ble_cmd_create(void);
 void ble_cmd_destroy(ble_cmd_t* cli);
-void ble_cmd_on_connect(ble_cmd_t* cli, esp_gatt_if_t gatts_if, uint16_t conn_id, uint16_t tx_char_handle);
+void ble_cmd_on_connect(ble_cmd_t* cli, ble_link_t *link);
 void ble_cmd_on_rx(ble_cmd_t* cli, const uint8_t* data, uint16_t len);
 void ble_cmd_on_disconnect(ble_cmd_t* cli);
 
-/* ----- Attribute table + helpers (gatt_attrs.c / gatt_wifi_cred.c / gatt_notify.c) ----- */
-void gatt_build_attr_table(esp_gatt_if_t gatts_if);
-void gatt_on_attr_table_created(esp_ble_gatts_cb_param_t *param);
+/* ----- Per-connection state (gatt_link.c) ----- */
+/* TX notify queue of one link; see gatt_tx.c for the locking rules. */
+typedef struct {
+  ble_txq_t q;
+  SemaphoreHandle_t send;     // elects the single drainer
+  volatile bool kick;         // more to drain; set by whoever lost the election
+} gatt_tx_t;
+
+#define GATT_HIST_BLOB 512      // DHT-HIST value max_len (gatt_table.h)
+
+/* Slots are allocated once and reused, so a ble_link_t* (and its cli/ctx) stays valid
+ * for late replies after a disconnect; `used` says whether it is live. */
+struct ble_link {
+  bool         used;
+  uint16_t     conn_id;
+  uint32_t     gen;           // bumped by gatt_link_open: tells a reused slot/conn_id apart
+  uint8_t      bda[6];        // peer address (connection parameter / data length requests)
+  uint16_t     mtu_payload;   // ATT payload = MTU - 3
+  uint8_t      ccc;           // GATT_CCC_* enabled by this central (see gatt_table.h)
+  uint8_t      bin;           // GATT_CCC_* this central reads in binary (FMT, gatt_bin.h)
+  ble_cmd_t   *cli;
+  gatt_tx_t    tx;
+  dht_filter_t dht_f;         // DHT-CCC deadband/heartbeat state
+  volatile bool dht_f_reset;
+  /* DHT-HIST window this central selected, and its snapshot: a read at offset 0 takes
+   * it, read-blob continuations are served from it. */
+  dht_tier_t   hist_tier;
+  uint8_t      hist_count;    // 0 = as many as fit
+  uint16_t     hist_len;
+  uint16_t     hist_sent;     // BLE_PORT_OFF_WHOLE reads: bytes the client has had (0 = none)
+  uint8_t      hist_blob[GATT_HIST_BLOB];
+};
+
+extern ble_link_t g_links[BLE_MAX_CONN];
+
+void        gatt_link_init(void);                 /* allocate per-slot cli + TX lock */
+ble_link_t *gatt_link_open(uint16_t conn_id);     /* NULL when all slots are taken */
+ble_link_t *gatt_link_find(uint16_t conn_id);
+void        gatt_link_close(ble_link_t *l);
+uint8_t     gatt_link_count(void);
+bool        gatt_link_any(uint8_t ccc_bit);       /* some live link enabled this CCC */
+
+/* ----- Attribute helpers (gatt_server.c / gatt_wifi_cred.c / gatt_notify.c) ----- */
 uint16_t gatt_ccc_decode(const uint8_t *val, uint16_t len);
-void gatt_on_wifi_cred_write(const uint8_t *data, uint16_t len);
-void gatt_server_notify_errsrc(const char *str);
+void gatt_on_wifi_cred_write(ble_link_t *l, const uint8_t *data, uint16_t len);
+void gatt_server_notify_errsrc(errsrc_t code, const char *str);  /* errsrc_cb_t */
+void gatt_errsrc_push(ble_link_t *l);                              /* current value to one link */
+void gatt_dht_on_sample(const dht_sample_t *s);                   /* dht_sample_cb_t */
+void gatt_dht_push(ble_link_t *l);                                 /* CCC enabled: value to one link */
+/* Current value in the link's format (text when l is NULL); bytes written. */
+uint16_t gatt_errsrc_value(const ble_link_t *l, uint8_t *out, uint16_t cap);
+uint16_t gatt_alert_value(const ble_link_t *l, uint8_t *out, uint16_t cap);
+uint16_t gatt_dht_value(const ble_link_t *l, uint8_t *out, uint16_t cap);
 
 /* Internal notifier used by syscoord hook override in gatt_notify.c
  * Keep it loose-typed so we don't pull alerts.h into public surface. */
 void gatt_alert_notify(const void *rec_any); /* rec_any = const alert_record_t* */
-
-/* ----- Shared state (defined in gatt_server.c) ----- */
-extern esp_gatt_if_t g_gatts_if;
-extern uint16_t g_conn_id;
-extern uint16_t g_mtu_payload;
-
-extern bool tx_notify_enabled;
-extern bool es_notify_enabled;
-extern bool alert_notify_enabled;
-
-extern uint16_t  gatt_handle_table[EFBE_IDX_NB];
-extern uint8_t cccd_tx_val[2];
-extern uint8_t cccd_err_val[2];
-extern uint8_t cccd_alert_val[2];
-
-// for DHT
-extern uint8_t cccd_dht_val[2];
-extern bool dht_notify_enabled;
-
-
-extern ble_cmd_t *g_ble_cli;
+void gatt_alert_push(ble_link_t *l);         /* latest alert to one link */
+
+/* ----- TX notify queue (gatt_tx.c) ----- */
+void gatt_tx_init(gatt_tx_t *t);
+void gatt_tx_reset(ble_link_t *l);                               /* connect / CCC change: drop queued bytes, zero stats */
+void gatt_tx_send_line(ble_link_t *l, const char *s, size_t n);  /* queue s + '\n' and pump */
+bool gatt_tx_read_last(ble_link_t *l, uint16_t off, uint8_t *out, uint16_t cap, uint16_t *n);  /* TX read */
+void gatt_tx_on_conf(ble_link_t *l, bool ok, bool congested);   /* one TX notification left the host */
+void gatt_tx_on_congest(ble_link_t *l, bool congested);
+void gatt_tx_log_stats(ble_link_t *l);                           /* notifications per line, bytes per notification */
+
+/* ----- Deferred writes (gatt_defer.c) ----- */
+typedef enum {
+  GATT_DEFER_RX = 0,
+  GATT_DEFER_WIFI,
+  GATT_DEFER_OTA_CTRL,
+} gatt_defer_kind_t;
+
+typedef struct {
+  uint32_t deferred;          // writes handed to the worker
+  uint32_t inline_fallback;   // pool/queue full: handled in the callback anyway
+  uint32_t cb_max_us;         // longest host (GATT) callback since boot
+  int      cb_max_evt;        // its backend event / access op
+} gatt_defer_stats_t;
+
+/* Copy a write into a pool slot and post it to the BLE worker (falls back to inline;
+ * a write whose answer is due before the callback returns always runs inline). */
+void gatt_defer_write(gatt_defer_kind_t kind, ble_link_t *l, const ble_port_req_t *r,
+                      const uint8_t *v, uint16_t n);
+void gatt_defer_run(uint8_t slot);                 /* BLE worker: handle + release a slot */
+void gatt_defer_note_cb(uint32_t us, int event);   /* callback duration sample */
+void gatt_defer_get_stats(gatt_defer_stats_t *out);
+
+/* Send a reply line to one link (the TX characteristic of that central only). */
+void gatt_link_send_line(ble_link_t *l, const char *s);   /* gatt_tx_send_line() with strlen */
 
 #ifdef __cplusplus
 }
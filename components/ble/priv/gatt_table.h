@@ -0,0 +1,55 @@
+// gatt_table.h, the EFBE service layout as one descriptor list (internal).
+// Everything per characteristic is generated from it: UUIDs (ble_ids.c), IDX_* and
+// GATT_CCC_* (below), the host's service definition (port/port_*.c) and the index ->
+// handler dispatch array (gatt_server.c). Adding a characteristic is one row here
+// plus its handlers.
+#pragma once
+#include <stdint.h>
+
+/* Rows, in attribute-table order:
+ *   CHR(name, tail, props, perm, max_len, rsp, on_read, on_write)       declaration + value
+ *   NTF(name, tail, props, perm, max_len, rsp, on_read, on_write)       ... + per-link CCC
+ * name:  IDX_<name>_{CHAR,VAL[,CCC]}, <name>_UUID, GATT_CCC_<name>.
+ * tail:  16-bit UUID tail, efbeXXXX-fbfb-fbfb-fb4b-494545434956.
+ * props: GP_* characteristic properties; perm: R, W or RW.
+ * rsp:   AUTO (stack answers from the stored value) or APP (on_read/on_write answer).
+ *        Rows with an on_read must be APP: the value depends on the reading link.
+ * on_read/on_write: gatt_rd_fn / gatt_wr_fn handlers in gatt_server.c, or 0.
+ * GP_*, GATT_PERM_* and GATT_RSP_* are defined by the backend that expands the columns. */
+#define GATT_SVC_TABLE(CHR, NTF) \
+    CHR(RX,       0x0100, GP_WRITE_NR | GP_WRITE, W,  512, AUTO, 0,           wr_rx)       \
+    NTF(TX,       0x0200, GP_NOTIFY | GP_READ,    R,  512, APP,  rd_tx,       0)           \
+    CHR(WIFI,     0x0300, GP_WRITE,               W,  128, AUTO, 0,           wr_wifi)     \
+    NTF(ERRSRC,   0x0400, GP_READ | GP_NOTIFY,    R,   64, APP,  rd_errsrc,   0)           \
+    NTF(ALERT,    0x0500, GP_READ | GP_NOTIFY,    R,  128, APP,  rd_alert,    0)           \
+    CHR(OTA_CTRL, 0x0600, GP_WRITE,               W,  512, APP,  0,           wr_ota_ctrl) \
+    CHR(OTA_DATA, 0x0700, GP_WRITE_NR,            W,  512, AUTO, 0,           wr_ota_data) \
+    NTF(DHT,      0x0800, GP_READ | GP_NOTIFY,    R,   64, APP,  rd_dht,      0)           \
+    CHR(DHT_HIST, 0x0900, GP_READ | GP_WRITE,     RW, 512, APP,  rd_dht_hist, wr_dht_hist) \
+    CHR(FMT,      0x0A00, GP_READ | GP_WRITE,     RW,   1, APP,  rd_fmt,      wr_fmt)
+
+/* Base efbe0000-fbfb-fbfb-fb4b-494545434956, LSB first (Bluedroid and NimBLE alike). */
+#define GATT_UUID128(tail) { 0x56,0x49,0x43,0x45,0x45,0x49,0x4B,0xFB,0xFB,0xFB,0xFB,0xFB, \
+                             (uint8_t)((tail) & 0xFF), (uint8_t)((tail) >> 8), 0xBE, 0xEF }
+
+#define GATT_ROW_NONE(...)
+
+/* ----- Attribute indexes (the backends map them to handles) ----- */
+#define GATT_IDX_CHR(n, ...) IDX_##n##_CHAR, IDX_##n##_VAL,
+#define GATT_IDX_NTF(n, ...) IDX_##n##_CHAR, IDX_##n##_VAL, IDX_##n##_CCC,
+enum {
+  IDX_SVC = 0,
+  GATT_SVC_TABLE(GATT_IDX_CHR, GATT_IDX_NTF)
+  EFBE_IDX_NB
+};
+
+/* ----- CCC bits, one per notifying characteristic (ble_link_t.ccc) ----- */
+#define GATT_CCC_POS(n, ...) GATT_CCC_POS_##n,
+enum { GATT_SVC_TABLE(GATT_ROW_NONE, GATT_CCC_POS) GATT_CCC_COUNT };
+#define GATT_CCC_BIT(n, ...) GATT_CCC_##n = 1u << GATT_CCC_POS_##n,
+enum { GATT_SVC_TABLE(GATT_ROW_NONE, GATT_CCC_BIT) };
+_Static_assert(GATT_CCC_COUNT <= 8, "ble_link_t.ccc is a uint8_t");
+
+/* ----- Characteristic UUIDs (ble_ids.c) ----- */
+#define GATT_UUID_DECL(n, ...) extern const uint8_t n##_UUID[16];
+GATT_SVC_TABLE(GATT_UUID_DECL, GATT_UUID_DECL)
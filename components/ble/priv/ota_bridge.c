@@ -4,7 +4,7 @@
 
 
 #if !CONFIG_FEATURE_BLE_OTA
-__attribute__((weak)) void ble_ota_on_ctrl_write(const uint8_t *data, uint16_t len) { (void)data; (void)len; }
-__attribute__((weak)) void ble_ota_on_data_write(const uint8_t *data, uint16_t len) { (void)data; (void)len; }
-__attribute__((weak)) void ble_ota_on_disconnect(void) {}
+__attribute__((weak)) void ble_ota_on_ctrl_write(uint16_t conn_id, const uint8_t *data, uint16_t len) { (void)conn_id; (void)data; (void)len; }
+__attribute__((weak)) void ble_ota_on_data_write(uint16_t conn_id, const uint8_t *data, uint16_t len) { (void)conn_id; (void)data; (void)len; }
+__attribute__((weak)) void ble_ota_on_disconnect(uint16_t conn_id) { (void)conn_id; }
 #endif
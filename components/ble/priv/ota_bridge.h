@@ -1,14 +1,30 @@
 // priv/ota_bridge
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
+#include "esp_err.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Called by GATT attribute writes; implemented by OTA module or stub. */
-void ble_ota_on_ctrl_write(const uint8_t *data, uint16_t len);
-void ble_ota_on_data_write(const uint8_t *data, uint16_t len);
-void ble_ota_on_disconnect(void);
+/* Called by GATT attribute writes; implemented by OTA module or stub.
+ * conn_id is the writer; one link owns a transfer from START until it ends. */
+void ble_ota_on_ctrl_write(uint16_t conn_id, const uint8_t *data, uint16_t len);
+void ble_ota_on_data_write(uint16_t conn_id, const uint8_t *data, uint16_t len);
+void ble_ota_on_disconnect(uint16_t conn_id);
+
+/* Where the image goes; the default is ota_handler's xport session (the passive slot).
+ * Called under the BLE-OTA lock, one transfer at a time. */
+typedef struct {
+    esp_err_t (*begin)(size_t total_size, uint32_t crc32_expect, const char *source);
+    esp_err_t (*write)(const uint8_t *data, size_t len);
+    esp_err_t (*finish)(void);
+    void      (*abort)(const char *reason);
+} ble_ota_xport_t;
+
+/* Swap the image sink (NULL: back to flash), e.g. a RAM sink for the simulator scripts.
+ * ESP_ERR_INVALID_STATE while a transfer is starting or active. */
+esp_err_t ble_ota_set_xport(const ble_ota_xport_t *x);
 
 #ifdef __cplusplus
 }
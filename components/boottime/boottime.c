@@ -0,0 +1,50 @@
+// components/boottime/boottime.c
+#include "boottime.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "BOOT";
+
+static int64_t s_marks[BT_MARK_COUNT];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const s_names[BT_MARK_COUNT] = {
+    [BT_APP_MAIN] = "app_main",
+    [BT_NVS_READY] = "nvs",
+    [BT_SYSCOORD_READY] = "syscoord",
+    [BT_CMD_READY] = "cmd",
+    [BT_PERIPH_READY] = "periph",
+    [BT_WIFI_STARTED] = "wifi_start",
+    [BT_WIFI_ASSOC] = "wifi_assoc",
+    [BT_GOT_IP] = "got_ip",
+    [BT_TCP_LISTEN] = "tcp_listen",
+    [BT_TCP_ACCEPT] = "tcp_accept",
+    [BT_FIRST_AUTH] = "first_auth",
+};
+
+const char* boottime_name(boottime_mark_t m) {
+    if ((unsigned)m < BT_MARK_COUNT && s_names[m]) return s_names[m];
+    return "?";
+}
+
+void boottime_mark(boottime_mark_t m) {
+    if ((unsigned)m >= BT_MARK_COUNT) return;
+    int64_t now = esp_timer_get_time();
+    if (now == 0) now = 1;   /* 0 means "not reached" */
+
+    bool first = false;
+    portENTER_CRITICAL(&s_mux);
+    if (!s_marks[m]) { s_marks[m] = now; first = true; }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (first) ESP_LOGI(TAG, "%s @ %u ms", s_names[m], (unsigned)(now / 1000));
+}
+
+int64_t boottime_get_us(boottime_mark_t m) {
+    if ((unsigned)m >= BT_MARK_COUNT) return 0;
+    portENTER_CRITICAL(&s_mux);
+    int64_t v = s_marks[m];
+    portEXIT_CRITICAL(&s_mux);
+    return v;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Boot timeline marks, in the order they are expected to happen. */
+typedef enum {
+    BT_APP_MAIN = 0,     // app_main() entered.
+    BT_NVS_READY,        // NVS initialized.
+    BT_SYSCOORD_READY,   // syscoord_init() done.
+    BT_CMD_READY,        // command bus + router up.
+    BT_PERIPH_READY,     // LED + DHT init done (runs concurrently).
+    BT_WIFI_STARTED,     // esp_wifi_start() returned.
+    BT_WIFI_ASSOC,       // STA_CONNECTED (associated, no IP yet).
+    BT_GOT_IP,           // IP_EVENT_STA_GOT_IP.
+    BT_TCP_LISTEN,       // listen() succeeded.
+    BT_TCP_ACCEPT,       // first client accepted.
+    BT_FIRST_AUTH,       // first AUTH OK over TCP.
+
+    BT_MARK_COUNT        // keep last
+} boottime_mark_t;
+
+/* Record a mark (esp_timer time since boot). Only the first call per mark counts. */
+void boottime_mark(boottime_mark_t m);
+
+/* Time of a mark in microseconds since boot; 0 if not reached yet. */
+int64_t boottime_get_us(boottime_mark_t m);
+
+/* Short printable name of a mark. */
+const char* boottime_name(boottime_mark_t m);
+
+#ifdef __cplusplus
+}
+#endif
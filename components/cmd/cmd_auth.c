@@ -5,6 +5,7 @@
 #include "app_cfg.h"
 #include "nvs.h"
 #include "syscoord.h"
+#include "boottime.h"
 #include "esp_err.h"
 
 static char s_auth_token[65] = APP_DEFAULT_AUTH_TOKEN;
@@ -57,6 +58,7 @@ void cmd_auth(const char *args, cmd_ctx_t *ctx){
 
         // Only TCP auth establishes the “control path OK”
         if (ctx->xport == CMD_XPORT_TCP) {
+            boottime_mark(BT_FIRST_AUTH);
             syscoord_mark_tcp_authed();
             syscoord_control_path_ok("TCP");
         }
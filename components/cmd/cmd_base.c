@@ -1,9 +1,11 @@
 #include <string.h>
+#include <strings.h>
 #include "commands.h"
 #include "syscoord.h"
 #include "errsrc.h"
 #include "esp_ota_ops.h"
 #include "esp_partition.h"
+#include "esp_timer.h"
 
 static const char* mode_to_str(sc_mode_t m){
     switch(m){
@@ -30,9 +32,26 @@ void cmd_version(const char *args, cmd_ctx_t *ctx){
 #endif
 }
 
+/* errsrc hist => per-code entries and dwell time since boot. */
+static void errsrc_hist(cmd_ctx_t *ctx){
+    errsrc_t cur = errsrc_get_code();
+    int64_t now = esp_timer_get_time();
+    cmd_replyf(ctx,"ERRSRC HIST uptime=%u ms cur=%s\n",
+               (unsigned)(now / 1000), errsrc_to_string(cur));
+    for (unsigned i = 0; i < ES_COUNT; ++i) {
+        errsrc_stat_t st; errsrc_get_stats((errsrc_t)i, &st);
+        if (!st.transitions && !st.total_us) continue;
+        cmd_replyf(ctx,"%-12s n=%u time=%u ms last=%d ms ago%s\n",
+                   errsrc_to_string((errsrc_t)i), (unsigned)st.transitions,
+                   (unsigned)(st.total_us / 1000),
+                   st.transitions ? (int)((now - st.last_enter_us) / 1000) : -1,
+                   (errsrc_t)i == cur ? " *" : "");
+    }
+}
+
 void cmd_errsrc(const char *args, cmd_ctx_t *ctx){
-    (void)args;
-    const char *err = errsrc_get(); if(!err) err="NONE";
+    if (args && strncasecmp(args, "hist", 4) == 0) { errsrc_hist(ctx); return; }
+    const char *err = errsrc_get();
     errsrc_t code = errsrc_get_code();
     sc_mode_t m = syscoord_get_mode();
     cmd_replyf(ctx,"mode=%s errsrc=%u %s\n", mode_to_str(m),(unsigned)code,err);
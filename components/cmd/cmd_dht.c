@@ -1,32 +1,66 @@
 #include "commands.h"
 #include "command_bus.h"
+#include "dht.h"
+#include "sensor.h"
+#include <stdio.h>
+#include <strings.h>
 #include <string.h>
 #include <stdlib.h>
 
-/* DHT? => enqueue a query; the DHT task will reply via ctx. */
+/* DHT? [fresh[=<maxage_ms>]] => enqueue a query; the router replies via ctx. */
 void cmd_dht(const char *args, cmd_ctx_t *ctx) {
-    (void)args;
     if (!cmd_bus_is_ready()) { cmd_reply(ctx, "BUS_DOWN\n"); return; }
     cmd_msg_t m = { .cmd = CMD_DHT_QUERY, .ctx = ctx, .u32 = 0 };
+    if (args && *args) {
+        /* fresh[=<maxage_ms>]: a new read unless the cached one is that young. */
+        if (strncasecmp(args, "fresh", 5) != 0 || (args[5] && args[5] != '=')) {
+            cmd_reply(ctx, "usage: DHT? [fresh[=<maxage_ms>]]\n");
+            return;
+        }
+        m.cmd = CMD_DHT_FRESH;
+        if (args[5] == '=') m.u32 = (uint32_t)strtoul(args + 6, NULL, 10);
+    }
     if (cmd_bus_send_msg(&m, pdMS_TO_TICKS(50)) != pdTRUE)
         cmd_reply(ctx, "BUS_FULL\n");
 }
 
-/* DHTSTREAM on/off [ms] => enable/disable streaming via bus. */
+/* Tenths from "0.5" style args; negative/garbage => 0. */
+static uint16_t parse_tenths(const char *v) {
+    float f = strtof(v, NULL);
+    if (!(f > 0.0f)) return 0;
+    if (f > 6553.0f) f = 6553.0f;
+    return (uint16_t)(f * 10.0f + 0.5f);
+}
+
+/* DHTSTREAM on [ms] [dt=<C>] [drh=<%>] [hb=<ms>] | off => subscribe this session via bus. */
 void cmd_dhtstream(const char *args, cmd_ctx_t *ctx) {
+    static const char *usage = "usage: DHTSTREAM on [ms] [dt=<C>] [drh=<%>] [hb=<ms>] | off\n";
     if (!ctx->authed) { cmd_reply(ctx, "DENIED\n"); return; }
     if (!cmd_bus_is_ready()) { cmd_reply(ctx, "BUS_DOWN\n"); return; }
-    if (!args || !*args) { cmd_reply(ctx, "usage: DHTSTREAM on|off [ms]\n"); return; }
+    if (!args || !*args) { cmd_reply(ctx, usage); return; }
 
-    char opt[16] = {0};
-    unsigned interval = 0;
-    int n = sscanf(args, "%15s %u", opt, &interval);
-    if (n < 1) { cmd_reply(ctx, "usage: DHTSTREAM on|off [ms]\n"); return; }
+    char buf[96];
+    strncpy(buf, args, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
 
-    cmd_msg_t m = { .ctx = ctx, .u32 = interval };
+    char *save = NULL;
+    char *opt = strtok_r(buf, " ", &save);
+    if (!opt) { cmd_reply(ctx, usage); return; }
+
+    cmd_msg_t m = { .ctx = ctx };
     if (strcasecmp(opt, "on") == 0)       m.cmd = CMD_DHT_STREAM_ON;
     else if (strcasecmp(opt, "off") == 0) m.cmd = CMD_DHT_STREAM_OFF;
-    else { cmd_reply(ctx, "usage: DHTSTREAM on|off [ms]\n"); return; }
+    else { cmd_reply(ctx, usage); return; }
+
+    uint16_t db_t = 0, db_rh = 0;
+    for (char *tok; (tok = strtok_r(NULL, " ", &save)) != NULL; ) {
+        if      (!strncasecmp(tok, "dt=", 3))  db_t  = parse_tenths(tok + 3);
+        else if (!strncasecmp(tok, "drh=", 4)) db_rh = parse_tenths(tok + 4);
+        else if (!strncasecmp(tok, "hb=", 3))  m.u32c = (uint32_t)strtoul(tok + 3, NULL, 10);
+        else if (*tok >= '0' && *tok <= '9')   m.u32 = (uint32_t)strtoul(tok, NULL, 10);
+        else { cmd_reply(ctx, usage); return; }
+    }
+    m.u32b = (uint32_t)db_t | ((uint32_t)db_rh << 16);
 
     if (cmd_bus_send_msg(&m, pdMS_TO_TICKS(50)) != pdTRUE)
         cmd_reply(ctx, "BUS_FULL\n");
@@ -41,3 +75,76 @@ void cmd_dhtstate(const char *args, cmd_ctx_t *ctx) {
     if (cmd_bus_send_msg(&m, pdMS_TO_TICKS(50)) != pdTRUE)
         cmd_reply(ctx, "BUS_FULL\n");
 }
+
+/* Tenths -> "-1.5" */
+static const char *tenths(char *b, size_t n, int v) {
+    snprintf(b, n, "%s%d.%d", v < 0 ? "-" : "", abs(v) / 10, abs(v) % 10);
+    return b;
+}
+
+/* DHTHIST raw|min|hour [count] => newest window of history, oldest first. */
+void cmd_dhthist(const char *args, cmd_ctx_t *ctx) {
+    char opt[8] = {0};
+    unsigned count = 10;
+    if (!args || sscanf(args, "%7s %u", opt, &count) < 1) {
+        cmd_reply(ctx, "usage: DHTHIST raw|min|hour [count]\n");
+        return;
+    }
+
+    dht_tier_t tier;
+    if      (!strcasecmp(opt, "raw"))  tier = DHT_TIER_RAW;
+    else if (!strcasecmp(opt, "min"))  tier = DHT_TIER_MIN;
+    else if (!strcasecmp(opt, "hour")) tier = DHT_TIER_HOUR;
+    else { cmd_reply(ctx, "usage: DHTHIST raw|min|hour [count]\n"); return; }
+
+    size_t cap = dht_history_capacity(tier) + (tier != DHT_TIER_RAW);  /* + open bucket */
+    if (!count || count > cap) count = (unsigned)cap;
+
+    dht_hist_rec_t *r = malloc(count * sizeof(*r));
+    if (!r) { cmd_reply(ctx, "NOMEM\n"); return; }
+    size_t n = dht_history_read(tier, count, r);
+
+    cmd_replyf(ctx, "DHTHIST %s n=%u\n", opt, (unsigned)n);
+    char a[3][8], b[3][8];
+    for (size_t i = 0; i < n; ++i) {
+        if (tier == DHT_TIER_RAW) {
+            cmd_replyf(ctx, "%u T=%s RH=%s\n", (unsigned)r[i].ts_s,
+                       tenths(a[0], sizeof(a[0]), r[i].t_avg), tenths(b[0], sizeof(b[0]), r[i].rh_avg));
+        } else {
+            cmd_replyf(ctx, "%u T=%s/%s/%s RH=%s/%s/%s n=%u\n", (unsigned)r[i].ts_s,
+                       tenths(a[0], sizeof(a[0]), r[i].t_min), tenths(a[1], sizeof(a[1]), r[i].t_avg),
+                       tenths(a[2], sizeof(a[2]), r[i].t_max),
+                       tenths(b[0], sizeof(b[0]), r[i].rh_min), tenths(b[1], sizeof(b[1]), r[i].rh_avg),
+                       tenths(b[2], sizeof(b[2]), r[i].rh_max), (unsigned)r[i].n);
+        }
+    }
+    free(r);
+}
+
+/* DHTFILTER [med=<n>] [dt=<C/s>] [drh=<%/s>] => show or change the outlier filter. */
+void cmd_dhtfilter(const char *args, cmd_ctx_t *ctx) {
+    static const char *usage = "usage: DHTFILTER [med=<n>] [dt=<C/s>] [drh=<%/s>]\n";
+    int id = sensor_find("DHT");
+    if (id < 0) { cmd_reply(ctx, "DHT NA\n"); return; }
+
+    sensor_filter_cfg_t fc;
+    sensor_get_filter(id, &fc);
+    if (args && *args) {
+        char buf[64];
+        strncpy(buf, args, sizeof(buf) - 1);
+        buf[sizeof(buf) - 1] = '\0';
+        for (char *save = NULL, *tok = strtok_r(buf, " ", &save); tok; tok = strtok_r(NULL, " ", &save)) {
+            if      (!strncasecmp(tok, "med=", 4)) fc.median_n = (uint8_t)strtoul(tok + 4, NULL, 10);
+            else if (!strncasecmp(tok, "dt=", 3))  fc.roc_per_s[0] = parse_tenths(tok + 3);
+            else if (!strncasecmp(tok, "drh=", 4)) fc.roc_per_s[1] = parse_tenths(tok + 4);
+            else { cmd_reply(ctx, usage); return; }
+        }
+        if (fc.median_n > SENSOR_MEDIAN_MAX) { cmd_reply(ctx, usage); return; }
+        sensor_set_filter(id, &fc);
+        sensor_get_filter(id, &fc);
+    }
+
+    char a[8], b[8];
+    cmd_replyf(ctx, "DHTFILTER med=%u dt=%s drh=%s\n", (unsigned)fc.median_n,
+               tenths(a, sizeof(a), (int)fc.roc_per_s[0]), tenths(b, sizeof(b), (int)fc.roc_per_s[1]));
+}
@@ -1,7 +1,15 @@
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "commands.h"
 #include "syscoord.h"
 #include "bootflag.h"
+#include "boottime.h"
+#include "tcp_server.h"
+#include "ble_fallback.h"
+#include "ble_sim.h"
 #include "esp_ota_ops.h"
 #include "esp_partition.h"
 
@@ -42,3 +50,95 @@ void cmd_diag(const char *args, cmd_ctx_t *ctx){
         run ? (unsigned)run->address : 0, run ? (unsigned)run->size : 0,
         _ota_state_str(st), post_rb ? 1 : 0, mode_to_str(mode));
 }
+
+/* boottime => timeline marks (ms since boot) and step deltas. */
+void cmd_boottime(const char *args, cmd_ctx_t *ctx){
+    (void)args;
+    int64_t prev = 0;
+    cmd_reply(ctx, "BOOTTIME\n");
+    for (int i = 0; i < BT_MARK_COUNT; ++i) {
+        int64_t t = boottime_get_us((boottime_mark_t)i);
+        if (!t) {
+            cmd_replyf(ctx, "%-10s -\n", boottime_name((boottime_mark_t)i));
+            continue;
+        }
+        cmd_replyf(ctx, "%-10s %u.%03u ms (+%u ms)\n", boottime_name((boottime_mark_t)i),
+                   (unsigned)(t / 1000), (unsigned)(t % 1000),
+                   (unsigned)(prev ? (t - prev) / 1000 : 0));
+        prev = t;
+    }
+    int64_t acc = boottime_get_us(BT_TCP_ACCEPT);
+    int32_t i2l = tcp_server_ip_to_listen_ms();
+    if (i2l >= 0)  cmd_replyf(ctx, "ip_to_listen=%d ms\n", (int)i2l);
+    if (acc)       cmd_replyf(ctx, "reset_to_accept=%u ms\n", (unsigned)(acc / 1000));
+}
+
+/* bleheap           => BLE stack state and heap around the last init/teardown.
+ * bleheap cycle <n> => n init/stop cycles outside RECOVERY; per-cycle heap, then drift.
+ * Each cycle waits BLECYCLE_UP_MS so GATT registration/service start complete. */
+#define BLECYCLE_MAX   50
+#define BLECYCLE_UP_MS 1500
+
+static void blestat_line(cmd_ctx_t *ctx, const char *tag, const ble_fallback_stats_t *s){
+    cmd_replyf(ctx, "%s host=%s up=%d cycles=%u pre_init=%u up_heap=%u down=%u largest=%u stop=%u ms\n",
+               tag, s->host ? s->host : "-", s->up ? 1 : 0, (unsigned)s->cycles, (unsigned)s->heap_pre_init,
+               (unsigned)s->heap_up, (unsigned)s->heap_down, (unsigned)s->largest_down,
+               (unsigned)s->stop_ms);
+}
+
+void cmd_bleheap(const char *args, cmd_ctx_t *ctx){
+    ble_fallback_stats_t s;
+    ble_fallback_get_stats(&s);
+    unsigned n = 0;
+    if (!args || sscanf(args, "cycle %u", &n) != 1) {
+        blestat_line(ctx, "BLEHEAP", &s);
+        return;
+    }
+    if (n == 0 || n > BLECYCLE_MAX) { cmd_replyf(ctx, "ERR n=1..%u\n", (unsigned)BLECYCLE_MAX); return; }
+    if (syscoord_get_mode() == SC_MODE_RECOVERY) { cmd_reply(ctx, "ERR BLE in use\n"); return; }
+
+    uint32_t first_down = 0, min_largest = UINT32_MAX;
+    for (unsigned i = 0; i < n; ++i) {
+        /* RECOVERY may start meanwhile; its ble_fallback_init() claims the stack and
+         * give_back() then leaves it up. */
+        if (!ble_fallback_borrow()) {
+            cmd_reply(ctx, i ? "ERR RECOVERY entered\n" : "ERR BLE in use\n");
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(BLECYCLE_UP_MS));
+        if (!ble_fallback_give_back()) { cmd_reply(ctx, "ERR RECOVERY entered\n"); return; }
+        ble_fallback_get_stats(&s);
+        if (!i) first_down = s.heap_down;
+        if (s.largest_down < min_largest) min_largest = s.largest_down;
+        char tag[16];
+        snprintf(tag, sizeof(tag), "CYCLE %u", i + 1);
+        blestat_line(ctx, tag, &s);
+    }
+    cmd_replyf(ctx, "BLECYCLE n=%u drift=%d min_largest=%u\n", n,
+               (int)(s.heap_down - first_down), (unsigned)min_largest);
+}
+
+/* bleadv => lifeboat advertising phase, time per phase and estimated airtime. */
+void cmd_bleadv(const char *args, cmd_ctx_t *ctx){
+    (void)args;
+    static const char *const names[BLE_ADV_PHASES] = { "FAST", "MID", "SLOW", "YIELD" };
+    ble_adv_stats_t st;
+    ble_adv_get_stats(&st);
+    uint32_t total = 0;
+    for (int i = 0; i < BLE_ADV_PHASES; ++i) total += st.ms[i];
+    cmd_replyf(ctx, "BLEADV phase=%s fast=%us mid=%us slow=%us yield=%us on=%us\n"
+               "events=%u air=%u ms (%u ppm) bursts=%u yields=%u\n",
+               st.phase < BLE_ADV_PHASES ? names[st.phase] : "?",
+               (unsigned)(st.ms[BLE_ADV_FAST] / 1000), (unsigned)(st.ms[BLE_ADV_MID] / 1000),
+               (unsigned)(st.ms[BLE_ADV_SLOW] / 1000), (unsigned)(st.ms[BLE_ADV_YIELD] / 1000),
+               (unsigned)(st.on_ms / 1000), (unsigned)st.events, (unsigned)(st.air_us / 1000),
+               (unsigned)(total ? st.air_us * 1000u / total : 0), (unsigned)st.bursts, (unsigned)st.yields);
+}
+
+/* blesim session [n] | storm [rounds] | ota <bytes> [loss_permille] [bulk]
+ * => scripted phones against the GATT core; needs a -DBLE_PORT=sim build. */
+static void blesim_out(void *user, const char *line){ cmd_reply((cmd_ctx_t *)user, line); }
+
+void cmd_blesim(const char *args, cmd_ctx_t *ctx){
+    ble_sim_run(args ? args : "", blesim_out, ctx);
+}
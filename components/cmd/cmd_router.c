@@ -3,7 +3,9 @@
 
 #include "command_bus.h"
 #include "commands.h"      // for cmd_reply(), cmd_ctx_t
-#include "dht.h"           // dht_read_latest(), dht_set_stream()
+#include "dht.h"           // dht_set_stream(), capture stats
+#include "sensor.h"        // generic latest record / stream state
+#include "cmd_stream.h"    // per-session stream subscriptions
 #include "led.h"           // expected: void led_on(void); void led_off(void);
 
 #include <stdio.h>
@@ -28,43 +30,86 @@ static void cmd_router_task(void *pv) {
 
         /* ---- DHT ---- */
         case CMD_DHT_QUERY: {
-            dht_sample_t s;
-            dht_read_latest(&s);
+            sensor_rec_t r;
             if (m.ctx) {
-                if (!s.valid) {
+                char buf[96];
+                if (!sensor_latest(sensor_find("DHT"), &r)) {
                     cmd_reply(m.ctx, "DHT NA\n");
-                } else {
-                    char buf[64];
-                    snprintf(buf, sizeof(buf),
-                             "DHT T=%.1fC RH=%.1f%% age=%u ms\n",
-                             s.temp_c, s.rh, (unsigned)s.age_ms);
-                    cmd_reply(m.ctx, buf);
+                    break;
                 }
+                cmd_stream_format(&r, buf, sizeof(buf));
+                cmd_reply(m.ctx, buf);
+            }
+            break;
+        }
+
+        /* Cached sample if young enough, else wait on the shared one-shot read. */
+        case CMD_DHT_FRESH: {
+            if (!m.ctx) break;
+            int id = sensor_find("DHT");
+            sensor_rec_t r;
+            if (!sensor_latest(id, &r)) {
+                cmd_reply(m.ctx, "DHT NA\n");
+            } else if (r.seq && r.age_ms <= m.u32) {
+                char buf[96];
+                cmd_stream_format(&r, buf, sizeof(buf));
+                cmd_reply(m.ctx, buf);
+            } else if (cmd_stream_wait_fresh(m.ctx, id, r.seq + 1)) {
+                sensor_request(id);   /* spacing floor is enforced by the scheduler */
+            } else {
+                cmd_reply(m.ctx, "DHT BUSY\n");
             }
             break;
         }
 
         case CMD_DHT_STREAM_ON: {
             uint32_t every_ms = m.u32 ? m.u32 : 0;
-            dht_set_stream(true, every_ms);
-            if (m.ctx) cmd_reply(m.ctx, "DHTSTREAM ON\n");
+            if (!m.ctx) {
+                dht_set_stream(true, every_ms);
+            } else if (cmd_stream_add(m.ctx, every_ms, (uint16_t)(m.u32b & 0xFFFF),
+                                      (uint16_t)(m.u32b >> 16), m.u32c)) {
+                cmd_reply(m.ctx, "DHTSTREAM ON\n");
+            } else {
+                cmd_reply(m.ctx, "DHTSTREAM FULL\n");
+            }
             break;
         }
 
         case CMD_DHT_STREAM_OFF:
-            dht_set_stream(false, 0);
+            if (m.ctx) cmd_stream_remove(m.ctx);
+            else       dht_set_stream(false, 0);
             if (m.ctx) cmd_reply(m.ctx, "DHTSTREAM OFF\n");
             break;
 
         case CMD_DHT_STATE: {
+            int id = sensor_find("DHT");
             bool on = false; uint32_t interval = 0;
-            dht_get_stream_state(&on, &interval);
-            dht_sample_t s; dht_read_latest(&s);
+            sensor_get_stream(id, &on, &interval);
+            sensor_rec_t r = { 0 };
+            sensor_latest(id, &r);
             if (m.ctx) {
-                char buf[96];
+                char buf[128];
                 snprintf(buf, sizeof(buf),
                         "DHTSTATE stream=%d interval=%u valid=%d age=%u ms\n",
-                        on ? 1 : 0, (unsigned)interval, s.valid ? 1 : 0, (unsigned)s.age_ms);
+                        on ? 1 : 0, (unsigned)interval, r.valid ? 1 : 0, (unsigned)r.age_ms);
+                cmd_reply(m.ctx, buf);
+
+                dht_capture_stats_t cs; dht_get_capture_stats(&cs);
+                snprintf(buf, sizeof(buf),
+                        "DHTCAP backend=%s kind=%s frames=%u crit=%u/%u us\n",
+                        cs.backend, cs.kind == 2 ? "DHT22" : cs.kind == 1 ? "DHT11" : "?",
+                        (unsigned)cs.frames, (unsigned)cs.crit_last_us, (unsigned)cs.crit_max_us);
+                cmd_reply(m.ctx, buf);
+
+                /* to=: no response / handshake / data. Many to_resp = wiring; csum/outl = noise. */
+                sensor_quality_t q; sensor_get_quality(id, &q);
+                sensor_filter_cfg_t fc; sensor_get_filter(id, &fc);
+                snprintf(buf, sizeof(buf),
+                        "DHTQ reads=%u ok=%u retry=%u to=%u/%u/%u csum=%u range=%u outl=%u med=%u\n",
+                        (unsigned)q.reads, (unsigned)q.ok, (unsigned)q.retries,
+                        (unsigned)q.to_resp, (unsigned)q.to_ack, (unsigned)q.to_data,
+                        (unsigned)q.csum, (unsigned)q.range, (unsigned)q.outliers,
+                        (unsigned)fc.median_n);
                 cmd_reply(m.ctx, buf);
             }
             break;
@@ -81,5 +126,6 @@ void cmd_router_start(void) {
     // Must be called after cmd_bus_init().
     configASSERT(cmd_bus_is_ready());
     if (!cmd_bus_is_ready()) return;
+    cmd_stream_init();
     xTaskCreate(cmd_router_task, "cmd.router", 4096, NULL, 5, NULL);
 }
@@ -0,0 +1,317 @@
+// cmd_stream.c, pushes DHT samples to subscribed command sessions and answers `dht? fresh`.
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "commands.h"
+#include "cmd_stream.h"
+#include "dht.h"
+#include "sensor.h"
+
+static const char *TAG = "CMD.stream";
+
+/* Lines go out from their own task: a TCP send may block for seconds and the sample
+ * callbacks run on the sensor scheduler. A blocked send still holds up the other
+ * sessions' lines, never the sensors. */
+#define CMD_STREAM_LINE   96      // one queued line; cmd_stream_format() output fits
+#define CMD_STREAM_STACK  3072
+#define CMD_STREAM_PRIO   3
+
+/* Lines waiting for the writer; when full the oldest goes. */
+typedef struct {
+    uint8_t head, n;
+    uint8_t len[CMD_STREAM_QLEN];
+    char line[CMD_STREAM_QLEN][CMD_STREAM_LINE];
+} stream_q_t;
+
+/* A session is identified by its write target, not by ctx: the ctx pointer
+ * lives on the transport's stack/heap and is not ours to keep. */
+typedef struct {
+    bool used;
+    uint8_t busy;        /* writes in flight; the slot is not reused until 0 */
+    cmd_xport_t xport;
+    void *user;
+    cmd_write_fn write;
+    dht_filter_t f;
+    stream_q_t q;
+} stream_sub_t;
+
+/* A `dht? fresh` caller waiting for the first record with seq >= min_seq. Once it came,
+ * `used` is cleared and the reply waits in `line` (len > 0) for the writer. */
+typedef struct {
+    bool used;
+    uint8_t busy;
+    cmd_xport_t xport;
+    void *user;
+    cmd_write_fn write;
+    uint32_t min_seq;
+    uint8_t len;
+    char line[CMD_STREAM_LINE];
+} fresh_wait_t;
+
+/* One write taken out of the tables: done outside s_lock, then `busy` is dropped. */
+typedef struct {
+    uint8_t *busy;
+    cmd_write_fn write;
+    void *user;
+} stream_out_t;
+
+static stream_sub_t s_subs[CMD_STREAM_MAX];
+static fresh_wait_t s_wait[CMD_FRESH_MAX];
+/* Guards the tables and queues. The writer sends unlocked from a copy; drop() fences it
+ * by emptying the session's queue and waiting for its busy counts to reach 0. */
+static SemaphoreHandle_t s_lock;
+static SemaphoreHandle_t s_idle;   /* given whenever a busy count drops to 0 */
+static TaskHandle_t s_writer;
+
+static int count_locked(void) {
+    int n = 0;
+    for (int i = 0; i < CMD_STREAM_MAX; ++i) if (s_subs[i].used) n++;
+    return n;
+}
+
+static stream_sub_t *find_locked(cmd_xport_t xport, void *user) {
+    for (int i = 0; i < CMD_STREAM_MAX; ++i) {
+        if (s_subs[i].used && s_subs[i].xport == xport && s_subs[i].user == user) return &s_subs[i];
+    }
+    return NULL;
+}
+
+static void q_push(stream_q_t *q, const char *line, size_t n) {
+    if (q->n == CMD_STREAM_QLEN) {
+        q->head = (uint8_t)((q->head + 1) % CMD_STREAM_QLEN);
+        q->n--;
+    }
+    unsigned t = (q->head + q->n) % CMD_STREAM_QLEN;
+    memcpy(q->line[t], line, n);
+    q->len[t] = (uint8_t)n;
+    q->n++;
+}
+
+/* Take the next queued line into buf, round-robin over subscribers then waiters from
+ * *next, and mark its slot busy. */
+static bool take_locked(int *next, stream_out_t *o, char *buf, size_t *n) {
+    const int total = CMD_STREAM_MAX + CMD_FRESH_MAX;
+    for (int k = 0; k < total; ++k) {
+        int i = (*next + k) % total;
+        if (i < CMD_STREAM_MAX) {
+            stream_sub_t *e = &s_subs[i];
+            if (!e->q.n) continue;
+            *n = e->q.len[e->q.head];
+            memcpy(buf, e->q.line[e->q.head], *n);
+            e->q.head = (uint8_t)((e->q.head + 1) % CMD_STREAM_QLEN);
+            e->q.n--;
+            e->busy++;
+            *o = (stream_out_t){ &e->busy, e->write, e->user };
+        } else {
+            fresh_wait_t *w = &s_wait[i - CMD_STREAM_MAX];
+            if (!w->len) continue;
+            *n = w->len;
+            memcpy(buf, w->line, *n);
+            w->len = 0;
+            w->busy++;
+            *o = (stream_out_t){ &w->busy, w->write, w->user };
+        }
+        *next = i + 1;
+        return true;
+    }
+    return false;
+}
+
+static void writer_task(void *arg) {
+    (void)arg;
+    char buf[CMD_STREAM_LINE];
+    int next = 0;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (;;) {
+            stream_out_t o;
+            size_t n = 0;
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            bool got = take_locked(&next, &o, buf, &n);
+            xSemaphoreGive(s_lock);
+            if (!got) break;
+
+            (void)o.write(buf, n, o.user);
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            bool idle = (--*o.busy == 0);
+            xSemaphoreGive(s_lock);
+            if (idle) xSemaphoreGive(s_idle);
+        }
+    }
+}
+
+/* Sample callbacks (sensor scheduler): format and queue only. */
+static void on_sample(const dht_sample_t *s) {
+    char line[64];
+    int n = s->valid
+        ? snprintf(line, sizeof(line), "DHT T=%.1fC RH=%.1f%% age=%u ms\n", (double)s->temp_c, (double)s->rh,
+                   (unsigned)s->age_ms)
+        : snprintf(line, sizeof(line), "DHT NA\n");
+    if (n <= 0) return;
+    if ((size_t)n >= sizeof(line)) n = (int)sizeof(line) - 1;
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+    bool any = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < CMD_STREAM_MAX; ++i) {
+        stream_sub_t *e = &s_subs[i];
+        if (!e->used || !dht_filter_pass(&e->f, s, now_ms)) continue;
+        q_push(&e->q, line, (size_t)n);
+        any = true;
+    }
+    xSemaphoreGive(s_lock);
+    if (any) xTaskNotifyGive(s_writer);
+}
+
+/* Every waiter the record satisfies gets it, then is released. */
+static void on_record(const sensor_rec_t *r, void *arg) {
+    (void)arg;
+    char line[CMD_STREAM_LINE];
+    int n = cmd_stream_format(r, line, sizeof(line));
+    if (n <= 0) return;
+
+    bool any = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < CMD_FRESH_MAX; ++i) {
+        fresh_wait_t *w = &s_wait[i];
+        if (!w->used || (int32_t)(r->seq - w->min_seq) < 0) continue;
+        w->used = false;
+        memcpy(w->line, line, (size_t)n);
+        w->len = (uint8_t)n;
+        any = true;
+    }
+    xSemaphoreGive(s_lock);
+    if (any) xTaskNotifyGive(s_writer);
+}
+
+int cmd_stream_format(const sensor_rec_t *r, char *buf, size_t n) {
+    int w = sensor_format(r, buf, n);
+    if (w < 0 || (size_t)w >= n) return w;
+    int t = r->valid ? snprintf(buf + w, n - w, " age=%u ms\n", (unsigned)r->age_ms)
+                     : snprintf(buf + w, n - w, "\n");
+    w += (t > 0) ? t : 0;
+    return ((size_t)w < n) ? w : (int)n - 1;
+}
+
+bool cmd_stream_wait_fresh(cmd_ctx_t *ctx, int sensor_id, uint32_t min_seq) {
+    if (!s_lock || !ctx || !ctx->write) return false;
+    /* Lazy: the sensor registers from periph init, after the router is up. */
+    if (!sensor_subscribe(sensor_id, on_record, NULL)) return false;
+
+    fresh_wait_t *w = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; !w && i < CMD_FRESH_MAX; ++i) {
+        if (!s_wait[i].used && !s_wait[i].busy && !s_wait[i].len) w = &s_wait[i];
+    }
+    if (w) {
+        *w = (fresh_wait_t){ .used = true, .xport = ctx->xport, .user = cmd_stream_user(ctx),
+                             .write = ctx->write, .min_seq = min_seq };
+    }
+    xSemaphoreGive(s_lock);
+    return w != NULL;
+}
+
+void cmd_stream_init(void) {
+    if (s_lock) return;
+    s_lock = xSemaphoreCreateMutex();
+    s_idle = xSemaphoreCreateBinary();
+    configASSERT(s_lock && s_idle);
+    if (xTaskCreate(writer_task, "cmd.stream", CMD_STREAM_STACK, NULL, CMD_STREAM_PRIO, &s_writer) != pdPASS) {
+        ESP_LOGE(TAG, "writer task failed; no streaming.");
+        return;
+    }
+    if (!dht_subscribe(on_sample)) ESP_LOGE(TAG, "dht_subscribe failed.");
+}
+
+bool cmd_stream_add(cmd_ctx_t *ctx, uint32_t every_ms, uint16_t db_t_dc, uint16_t db_rh_dp,
+                    uint32_t heartbeat_ms) {
+    if (!s_lock || !ctx || !ctx->write) return false;
+    void *user = cmd_stream_user(ctx);
+    dht_filter_cfg_t cfg = { .db_t_dc = db_t_dc, .db_rh_dp = db_rh_dp, .heartbeat_ms = heartbeat_ms };
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    stream_sub_t *e = find_locked(ctx->xport, user);
+    for (int i = 0; !e && i < CMD_STREAM_MAX; ++i) if (!s_subs[i].used && !s_subs[i].busy) e = &s_subs[i];
+    if (e) {
+        *e = (stream_sub_t){ .used = true, .busy = e->busy, .xport = ctx->xport, .user = user,
+                             .write = ctx->write };
+        dht_filter_init(&e->f, &cfg);
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!e) return false;
+    dht_set_stream(true, every_ms);
+    return true;
+}
+
+bool cmd_stream_active(cmd_ctx_t *ctx) {
+    if (!s_lock || !ctx) return false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool on = find_locked(ctx->xport, cmd_stream_user(ctx)) != NULL;
+    xSemaphoreGive(s_lock);
+    return on;
+}
+
+/* Returns subscribers left (-1 if not initialized); *had = the session was listed. */
+static int release(cmd_xport_t xport, void *user, bool *had) {
+    *had = false;
+    if (!s_lock) return -1;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    stream_sub_t *e = find_locked(xport, user);
+    if (e) { e->used = false; e->q.n = 0; *had = true; }
+    int left = count_locked();
+    xSemaphoreGive(s_lock);
+    return left;
+}
+
+void cmd_stream_remove(cmd_ctx_t *ctx) {
+    if (!ctx) return;
+    bool had;
+    /* Explicit OFF stops the sampler once nobody else listens (also the legacy global OFF). */
+    if (release(ctx->xport, cmd_stream_user(ctx), &had) <= 0) dht_set_stream(false, 0);
+}
+
+/* Writes still in flight to this target (entries keep their target after release). */
+static bool busy_locked(cmd_xport_t xport, void *user) {
+    for (int i = 0; i < CMD_STREAM_MAX; ++i) {
+        const stream_sub_t *e = &s_subs[i];
+        if (e->busy && e->xport == xport && e->user == user) return true;
+    }
+    for (int i = 0; i < CMD_FRESH_MAX; ++i) {
+        const fresh_wait_t *w = &s_wait[i];
+        if (w->busy && w->xport == xport && w->user == user) return true;
+    }
+    return false;
+}
+
+void cmd_stream_drop(cmd_xport_t xport, void *user) {
+    bool had;
+    if (s_lock) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (int i = 0; i < CMD_FRESH_MAX; ++i) {
+            fresh_wait_t *w = &s_wait[i];
+            if ((w->used || w->len) && w->xport == xport && w->user == user) {
+                w->used = false;
+                w->len = 0;
+            }
+        }
+        xSemaphoreGive(s_lock);
+    }
+    if (release(xport, user, &had) == 0 && had) dht_set_stream(false, 0);
+    if (!s_lock) return;
+
+    /* Nothing new is snapshotted for this target now; wait out what already was. Several
+     * droppers may share s_idle, hence the timed re-check. */
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    while (busy_locked(xport, user)) {
+        xSemaphoreGive(s_lock);
+        xSemaphoreTake(s_idle, pdMS_TO_TICKS(10));
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+    }
+    xSemaphoreGive(s_lock);
+}
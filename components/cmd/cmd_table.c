@@ -5,15 +5,23 @@ void cmd_ping(const char*, struct cmd_ctx_t*);
 void cmd_auth(const char*, struct cmd_ctx_t*);
 void cmd_settoken(const char*, struct cmd_ctx_t*);
 void cmd_diag(const char*, struct cmd_ctx_t*);
+void cmd_boottime(const char*, struct cmd_ctx_t*);
 void cmd_led_on(const char*, struct cmd_ctx_t*);
 void cmd_led_off(const char*, struct cmd_ctx_t*);
 void cmd_version(const char*, struct cmd_ctx_t*);
 void cmd_ota(const char*, struct cmd_ctx_t*);
 void cmd_setwifi(const char*, struct cmd_ctx_t*);
+void cmd_wifistat(const char*, struct cmd_ctx_t*);
 void cmd_errsrc(const char*, struct cmd_ctx_t*);
 void cmd_dht(const char*, struct cmd_ctx_t*);
 void cmd_dhtstream(const char*, struct cmd_ctx_t*);
 void cmd_dhtstate(const char*, struct cmd_ctx_t*);
+void cmd_dhthist(const char*, struct cmd_ctx_t*);
+void cmd_dhtfilter(const char*, struct cmd_ctx_t*);
+void cmd_tsdump(const char*, struct cmd_ctx_t*);
+void cmd_bleheap(const char*, struct cmd_ctx_t*);
+void cmd_bleadv(const char*, struct cmd_ctx_t*);
+void cmd_blesim(const char*, struct cmd_ctx_t*);
 
 #define CMD(name, auth, fn) { (name), sizeof(name)-1, (auth), (fn) }
 
@@ -22,14 +30,22 @@ const cmd_entry_t CMDS[] = {
     CMD("auth", false, cmd_auth),
     CMD("settoken", true, cmd_settoken),
     CMD("diag", true, cmd_diag),
+    CMD("boottime", false, cmd_boottime),  // boot timeline marks.
     CMD("led_on", true, cmd_led_on),
     CMD("led_off", true, cmd_led_off),
     CMD("version", false, cmd_version),
     CMD("ota", true, cmd_ota),
     CMD("setwifi", true, cmd_setwifi),
-    CMD("errsrc", false, cmd_errsrc),
-    CMD("dht?", false, cmd_dht),         // print last sample.
+    CMD("wifistat", false, cmd_wifistat),   // fast-link cache + time-to-IP.
+    CMD("errsrc", false, cmd_errsrc),        // "errsrc hist" for per-state time.
+    CMD("dht?", false, cmd_dht),         // print last sample (or a fresh one).
     CMD("dhtstream", true, cmd_dhtstream),   // requires auth.
     CMD("dhtstate", false, cmd_dhtstate),    // query state.
+    CMD("dhthist", false, cmd_dhthist),      // history window.
+    CMD("dhtfilter", true, cmd_dhtfilter),   // outlier filter config.
+    CMD("tsdump", false, cmd_tsdump),        // flash time-series (binary).
+    CMD("bleheap", true, cmd_bleheap),       // BT heap; "bleheap cycle <n>" stress.
+    CMD("bleadv", false, cmd_bleadv),        // advertising schedule + airtime.
+    CMD("blesim", true, cmd_blesim),         // scripted centrals (sim builds only).
 };
 const size_t CMD_COUNT = sizeof(CMDS)/sizeof(CMDS[0]);
@@ -0,0 +1,61 @@
+// cmd_ts.c, flash time-series dump.
+#include <stdio.h>
+#include <stdint.h>
+
+#include "commands.h"
+#include "cmd_stream.h"
+#include "ts_store.h"
+
+typedef struct {
+    cmd_ctx_t *ctx;
+    bool ok;
+} dump_sink_t;
+
+/* send() may take a 4 KB block in pieces. */
+static bool write_all(cmd_ctx_t *ctx, const uint8_t *p, size_t n) {
+    void *user = cmd_stream_user(ctx);
+    while (n) {
+        int w = ctx->write(p, n, user);
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+static bool on_chunk(const uint8_t *blk, size_t len, void *arg) {
+    dump_sink_t *d = arg;
+    const uint8_t hdr[2] = { (uint8_t)len, (uint8_t)(len >> 8) };
+    d->ok = write_all(d->ctx, hdr, sizeof(hdr)) && write_all(d->ctx, blk, len);
+    return d->ok;
+}
+
+/* TSDUMP [<from_s> <to_s>] => store stats, or the blocks covering the range as
+ * <len:le16><block> chunks ended by a zero length (TCP only; format in ts_codec.h). */
+void cmd_tsdump(const char *args, cmd_ctx_t *ctx) {
+    unsigned long from = 0, to = 0;
+    if (!args || !*args) {
+        ts_store_stats_t st;
+        ts_store_get_stats(&st);
+        cmd_replyf(ctx, "TS now=%u oldest=%u blocks=%u/%u samples=%u pages=%u erases=%u err=%u drop=%u\n",
+                   (unsigned)st.now_s, (unsigned)st.oldest_s, (unsigned)st.used, (unsigned)st.blocks,
+                   (unsigned)st.samples, (unsigned)st.page_writes, (unsigned)st.erases,
+                   (unsigned)st.errors, (unsigned)st.dropped);
+        return;
+    }
+    if (sscanf(args, "%lu %lu", &from, &to) != 2 || to < from) {
+        cmd_reply(ctx, "usage: TSDUMP [<from_s> <to_s>]\n");
+        return;
+    }
+    if (ctx->xport != CMD_XPORT_TCP) { cmd_reply(ctx, "TSDUMP TCP only\n"); return; }
+    if (cmd_stream_active(ctx)) { cmd_reply(ctx, "TSDUMP BUSY (dhtstream on)\n"); return; }
+
+    cmd_replyf(ctx, "TSDUMP now=%u from=%lu to=%lu\n", (unsigned)ts_store_now(), from, to);
+    dump_sink_t d = { .ctx = ctx, .ok = true };
+    size_t n = ts_store_dump((uint32_t)from, (uint32_t)to, on_chunk, &d);
+    if (!d.ok) return;   /* peer gone or stalled: framing is lost anyway */
+
+    static const uint8_t end[2] = { 0, 0 };
+    if (write_all(ctx, end, sizeof(end)))
+        cmd_replyf(ctx, "TSDUMP END blocks=%u\n", (unsigned)n);
+}
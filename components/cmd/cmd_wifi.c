@@ -13,3 +13,19 @@ void cmd_setwifi(const char *args, cmd_ctx_t *ctx){
         cmd_reply(ctx, "BADFMT\n");
     }
 }
+
+/* wifistat => fast-link cache + time-to-IP per path (fast=directed, slow=full scan). */
+void cmd_wifistat(const char *args, cmd_ctx_t *ctx){
+    (void)args;
+    wifi_fast_t f; wifi_get_fast_snapshot(&f);
+    const uint8_t *b = f.cache.bssid;
+    cmd_replyf(ctx, "WIFISTAT cache=%d ch=%u bssid=%02x:%02x:%02x:%02x:%02x:%02x fails=%u lease_reused=%d\n",
+               f.cache_valid ? 1 : 0, (unsigned)f.cache.channel,
+               b[0], b[1], b[2], b[3], b[4], b[5], (unsigned)f.fast_fails, f.lease_reused ? 1 : 0);
+    static const char *const names[2] = { "slow", "fast" };
+    for (int p = WIFI_PATH_FAST; p >= WIFI_PATH_SLOW; --p) {
+        const wifi_ttip_stat_t *s = &f.st[p];
+        cmd_replyf(ctx, "%s n=%u last=%u min=%u max=%u ms\n", names[p],
+                   (unsigned)s->count, (unsigned)s->last_ms, (unsigned)s->min_ms, (unsigned)s->max_ms);
+    }
+}
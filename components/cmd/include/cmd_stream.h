@@ -0,0 +1,48 @@
+// cmd_stream.h, per-session DHT stream subscriptions and pending `dht? fresh` replies.
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "command.h"
+#include "sensor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CMD_STREAM_MAX
+#define CMD_STREAM_MAX 4
+#endif
+#ifndef CMD_FRESH_MAX
+#define CMD_FRESH_MAX 8      // sessions waiting on a fresh read at once
+#endif
+#ifndef CMD_STREAM_QLEN
+#define CMD_STREAM_QLEN 4    // lines queued per session for the writer task
+#endif
+
+void cmd_stream_init(void);
+
+/* Subscribe (or re-configure) the session behind ctx. Deadbands in tenths,
+ * heartbeat in ms (0 = none); all zero = every sample. Starts the sampler. */
+bool cmd_stream_add(cmd_ctx_t *ctx, uint32_t every_ms, uint16_t db_t_dc, uint16_t db_rh_dp,
+                    uint32_t heartbeat_ms);
+
+/* Unsubscribe the session behind ctx; the sampler stops with the last one. */
+void cmd_stream_remove(cmd_ctx_t *ctx);
+
+/* True if the session behind ctx is streaming (pushes may interleave with its replies). */
+bool cmd_stream_active(cmd_ctx_t *ctx);
+
+/* Reply to ctx with the first record of sensor_id whose seq >= min_seq.
+ * False if the waiter table is full. The caller triggers the read. */
+bool cmd_stream_wait_fresh(cmd_ctx_t *ctx, int sensor_id, uint32_t min_seq);
+
+/* "DHT T=.. RH=.. age=.. ms\n" / "DHT NA\n" for a record; returns chars written. */
+int cmd_stream_format(const sensor_rec_t *r, char *buf, size_t n);
+
+/* Transport teardown: drop a session and its pending replies by write target (fd or BLE link).
+ * Must run before the fd is closed; no write is in flight once this returns. */
+void cmd_stream_drop(cmd_xport_t xport, void *user);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,12 +19,15 @@ typedef enum {
     CMD_DHT_STREAM_ON,
     CMD_DHT_STREAM_OFF,
     CMD_DHT_STATE,
+    CMD_DHT_FRESH,      // u32 = max acceptable age (ms)
 } cmd_t;
 
 typedef struct {
     cmd_t      cmd;
     cmd_ctx_t *ctx;   // originator to reply to (may be NULL)
     uint32_t   u32;   // optional numeric arg
+    uint32_t   u32b;  // second arg (DHTSTREAM: deadband T | RH << 16, tenths)
+    uint32_t   u32c;  // third arg (DHTSTREAM: heartbeat ms)
 } cmd_msg_t;
 
 void cmd_bus_init(void);
@@ -1,226 +1,279 @@
 // components/dht/dht.c
+#include <stdio.h>
 #include <string.h>
 #include "dht.h"
+#include "dht_capture.h"
+#include "dht_decode.h"
+#include "dht_hist.h"
+#include "sensor.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/portmacro.h"
+#include "freertos/semphr.h"
 
 #include "driver/gpio.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 
-#if __has_include("esp_rom_sys.h")
-  #include "esp_rom_sys.h"
-  #define dht_delay_us  esp_rom_delay_us
-#else
-  #include "rom/ets_sys.h"
-  #define dht_delay_us  ets_delay_us
-#endif
-
 static const char *TAG = "DHT";
 
 /* -------- Tunables (safe for DHT11 breakout) -------- */
 #define DHT_RETRIES 3
-#define DHT_INITIAL_LOW_TIMEOUT_US 2000   /* wait sensor pulls LOW after release */
-#define DHT_INITIAL_HIGH_TIMEOUT_US  400   /* then returns HIGH */
-#define DHT_BIT_LOW_WAIT_US 200   /* wait for start-of-bit LOW */
-#define DHT_BIT_RISE_WAIT_US 200   /* wait for HIGH after that */
-#define DHT_BIT_HIGH_END_US 320   /* HIGH must end within this */
-#define DHT_ONE_THRESHOLD_US 50   /* > ~50us => bit '1' */
+#define DHT_RETRY_GAP_MS 2   /* let the sensor finish its frame before a retry */
 #define DHT_MIN_PERIOD_MS 2000  /* DHT11 needs ~2s between reads */
-#define DHT_USE_INTERNAL_PULLUP 0  /* breakout has its own pull-up */
 
 /* -------- Driver state -------- */
 typedef struct {
-    bool inited;
     int gpio;
-    uint32_t def_period_ms;
+    int id;          // sensor registry id (-1 until dht_init)
+} dht_state_t;
 
-    volatile bool stream_on;
-    volatile uint32_t period_ms;
+static dht_state_t S = { .gpio = -1, .id = -1 };
 
-    volatile TickType_t last_tick;
-    volatile dht_sample_t last;
+/* Capture/decode accounting; written by the sensor scheduler only. */
+static dht_edges_t s_edges;
+static dht_kind_t s_kind = DHT_KIND_UNKNOWN;
+static dht_capture_stats_t s_cap_st;
 
-    TaskHandle_t task;
-} dht_state_t;
+/* Sample subscribers; callbacks run in the sensor scheduler, outside any lock. */
+static dht_sample_cb_t s_subs[DHT_MAX_SUBSCRIBERS];
+static portMUX_TYPE s_subs_mux = portMUX_INITIALIZER_UNLOCKED;
 
-static dht_state_t S = {0};
-/* Protects last sample snapshot */
-static portMUX_TYPE s_dht_mux = portMUX_INITIALIZER_UNLOCKED;
-/* Protects the tight 40-bit transaction timing */
-static portMUX_TYPE s_dht_bus_mux = portMUX_INITIALIZER_UNLOCKED;
+/* Sample history; s_hist_lock serializes the scheduler (writer) and readers. */
+static dht_hist_t s_hist;
+static SemaphoreHandle_t s_hist_lock;
 
-static inline int64_t now_us(void) { return esp_timer_get_time(); }
+/* ---------- Sensor driver ---------- */
 
-/* Hot polling loop; kept simple for speed. */
-static bool IRAM_ATTR wait_for_level(int gpio, int level, uint32_t timeout_us) {
-    int64_t start = now_us();
-    while (gpio_get_level(gpio) != level) {
-        if ((uint32_t)(now_us() - start) > timeout_us) return false;
-    }
-    return true;
+/* Idle HIGH (matches your standalone test), then arm the capture backend. */
+static esp_err_t drv_init(void *ctx) {
+    dht_state_t *st = ctx;
+    gpio_reset_pin(st->gpio);
+    gpio_set_direction(st->gpio, GPIO_MODE_OUTPUT);
+    gpio_set_level(st->gpio, 1);
+    gpio_pulldown_dis(st->gpio);
+    return dht_capture_init(st->gpio);
 }
 
-/* One raw dht transaction -=> 5 bytes (40 bits). */
-static bool dht_read_raw_bytes(int gpio, uint8_t out[5]) {
-    memset(out, 0, 5);
-
-    /* Host start pulse: ~18ms LOW, then release. */
-    gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
-    gpio_set_level(gpio, 1);
-    dht_delay_us(10);
-    gpio_set_level(gpio, 0);
-    dht_delay_us(18000);
-    gpio_set_level(gpio, 1);       /* release to pull-up */
-
-    /* Sensor drives the line. */
-    gpio_set_direction(gpio, GPIO_MODE_INPUT);
-#if DHT_USE_INTERNAL_PULLUP
-    gpio_pullup_en(gpio);
-#else
-    gpio_pullup_dis(gpio);
-#endif
-    gpio_pulldown_dis(gpio);
-
-    /* Critical window: response + 40 bits */
-    portENTER_CRITICAL(&s_dht_bus_mux);
-
-    /* Sensor response: ~80us LOW, then ~80us HIGH */
-    if (!wait_for_level(gpio, 0, DHT_INITIAL_LOW_TIMEOUT_US))  { portEXIT_CRITICAL(&s_dht_bus_mux); return false; }
-    if (!wait_for_level(gpio, 1, DHT_INITIAL_HIGH_TIMEOUT_US)) { portEXIT_CRITICAL(&s_dht_bus_mux); return false; }
-
-    /* 40 data bits */
-    for (int bit = 0; bit < 40; ++bit) {
-        if (!wait_for_level(gpio, 0, DHT_BIT_LOW_WAIT_US))  { portEXIT_CRITICAL(&s_dht_bus_mux); return false; }
-        if (!wait_for_level(gpio, 1, DHT_BIT_RISE_WAIT_US)) { portEXIT_CRITICAL(&s_dht_bus_mux); return false; }
-        int64_t t0 = now_us();
-        if (!wait_for_level(gpio, 0, DHT_BIT_HIGH_END_US))  { portEXIT_CRITICAL(&s_dht_bus_mux); return false; }
-        int high_us = (int)(now_us() - t0);
-
-        int byte = bit / 8;
-        out[byte] <<= 1;
-        if (high_us > DHT_ONE_THRESHOLD_US) out[byte] |= 1;
+/* Where a failed attempt went wrong, for the quality counters. */
+static void count_failure(sensor_quality_t *q, dht_dec_err_t de) {
+    if (de == DHT_DEC_CHECKSUM) { q->csum++; return; }
+    switch (dht_stall_phase(&s_edges)) {
+        case DHT_PHASE_RESPONSE: q->to_resp++; break;
+        case DHT_PHASE_ACK:      q->to_ack++;  break;
+        default:                 q->to_data++; break;
     }
-
-    portEXIT_CRITICAL(&s_dht_bus_mux);
-
-    /* Verify checksum. */
-    uint8_t sum = (uint8_t)(out[0] + out[1] + out[2] + out[3]);
-    return (sum == out[4]);
 }
 
-/* Decode to °C / %RH. Retries => jitter?. */
-/* ---------- in dht.c ---------- */
-static bool dht_hw_read(float *out_t_c, float *out_rh) {
-    if (!out_t_c || !out_rh) return false;
+/* A failed frame's edge log at verbose level, 12 edges per line, in the format of
+ * host_test/traces/dht: a monitor capture pastes into a new trace file as is. */
+static void log_edges(const dht_edges_t *e) {
+    char line[12 * 13 + 1];   /* "<u32>:<0|1> " each */
+    for (int i = 0; i < e->n; i += 12) {
+        int len = 0;
+        for (int j = i; j < e->n && j < i + 12; ++j) {
+            len += snprintf(line + len, sizeof(line) - len, "%s%u:%u", j > i ? " " : "",
+                            (unsigned)e->t_us[j], (unsigned)e->level[j]);
+        }
+        ESP_LOGV(TAG, "edges %s", line);
+    }
+}
 
-    gpio_pulldown_dis(S.gpio);
+/* One frame: capture + edge decode + checksum; retries on any failure. */
+static bool drv_read(void *ctx, sensor_quality_t *q, uint8_t *raw, size_t cap, size_t *len) {
+    dht_state_t *st = ctx;
+    if (cap < 5) return false;
 
-    uint8_t raw[5];
     for (int attempt = 0; attempt < DHT_RETRIES; ++attempt) {
-        if (dht_read_raw_bytes(S.gpio, raw)) {
-            // DHT11 datasheet: raw[0] = RH int, raw[2] = Temp int
-            *out_rh  = (float)raw[0];
-            *out_t_c = (float)raw[2];
+        if (attempt) {
+            q->retries++;
+            vTaskDelay(1 + pdMS_TO_TICKS(DHT_RETRY_GAP_MS));
+        }
 
-            // Clamp to DHT11 ranges (extra safety)
-            if (*out_rh < 20.0f || *out_rh > 90.0f) *out_rh = 0.0f;
-            if (*out_t_c < 0.0f  || *out_t_c > 50.0f) *out_t_c = 0.0f;
+        uint32_t crit = 0;
+        bool got = dht_capture_frame(st->gpio, &s_edges, &crit);
+        s_cap_st.frames++;
+        s_cap_st.crit_last_us = crit;
+        if (crit > s_cap_st.crit_max_us) s_cap_st.crit_max_us = crit;
 
+        dht_dec_err_t de = got ? dht_decode_edges(&s_edges, raw) : DHT_DEC_SHORT;
+        if (de == DHT_DEC_OK) {
+            *len = 5;
             return true;
         }
-        dht_delay_us(1200);
+        count_failure(q, de);
+        ESP_LOGD(TAG, "read: %s (%u edges)", dht_dec_err_name(de), (unsigned)s_edges.n);
+        log_edges(&s_edges);
     }
     return false;
 }
 
+/* Frame bytes -> tenths, with a sticky sensor kind. Implausible values are
+ * rejected and counted, never clamped into a fake reading. */
+static bool drv_decode(void *ctx, sensor_quality_t *q, const uint8_t *raw, size_t len, sensor_rec_t *out) {
+    (void)ctx;
+    if (len < 5) return false;
+
+    int16_t t_dc = 0; uint16_t rh_dp = 0; dht_kind_t k = DHT_KIND_UNKNOWN;
+    dht_dec_err_t de = dht_decode_values(raw, s_kind, &t_dc, &rh_dp, &k);
+    /* A sticky kind that no longer fits (sensor swapped): re-detect once. */
+    if (de == DHT_DEC_RANGE && s_kind != DHT_KIND_UNKNOWN)
+        de = dht_decode_values(raw, DHT_KIND_UNKNOWN, &t_dc, &rh_dp, &k);
+    if (de != DHT_DEC_OK) {
+        q->range++;
+        ESP_LOGD(TAG, "decode: %s", dht_dec_err_name(de));
+        return false;
+    }
 
-/* ---------- Sampler task ---------- */
-static void dht_sampler_task(void *pv) {
-    (void)pv;
-    for (;;) {
-        if (!S.stream_on) {
-            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-            continue;
-        }
+    if (k != s_kind) {
+        ESP_LOGI(TAG, "sensor: %s (capture=%s)", dht_kind_name(k), dht_capture_backend_name());
+        s_kind = k;
+    }
+    s_cap_st.kind = (uint8_t)k;
+
+    out->n = 2;
+    out->qty[0] = SENSOR_Q_TEMP_DC; out->v[0] = t_dc;
+    out->qty[1] = SENSOR_Q_RH_DP;   out->v[1] = rh_dp;
+    return true;
+}
+
+static const sensor_driver_t s_drv = {
+    .name = "DHT",
+    .min_period_ms = DHT_MIN_PERIOD_MS,
+    .init = drv_init,
+    .read = drv_read,
+    .decode = drv_decode,
+};
+
+static void to_sample(const sensor_rec_t *r, dht_sample_t *out) {
+    bool ok = r->valid && r->n >= 2;
+    out->valid  = ok;
+    out->temp_c = ok ? (float)r->v[0] / 10.0f : 0.0f;
+    out->rh     = ok ? (float)r->v[1] / 10.0f : 0.0f;
+    out->age_ms = r->age_ms;
+}
+
+/* Scheduler callback: feed history, then the DHT-typed subscribers. */
+static void on_record(const sensor_rec_t *r, void *arg) {
+    (void)arg;
+    if (r->valid && r->n >= 2) {
+        xSemaphoreTake(s_hist_lock, portMAX_DELAY);
+        dht_hist_add(&s_hist, (uint32_t)(esp_timer_get_time() / 1000000), (int16_t)r->v[0], (uint16_t)r->v[1]);
+        xSemaphoreGive(s_hist_lock);
+    }
+
+    dht_sample_t smp;
+    to_sample(r, &smp);
 
-        float t = 0.0f, h = 0.0f;
-        bool ok = dht_hw_read(&t, &h);
-        TickType_t now = xTaskGetTickCount();
-
-        portENTER_CRITICAL(&s_dht_mux);
-        S.last.valid  = ok;
-        S.last.temp_c = ok ? t : 0.0f;
-        S.last.rh = ok ? h : 0.0f;
-        S.last.age_ms = 0;
-        S.last_tick = now;
-        portEXIT_CRITICAL(&s_dht_mux);
-
-        uint32_t ms = S.period_ms ? S.period_ms : S.def_period_ms;
-        if (ms < DHT_MIN_PERIOD_MS) ms = DHT_MIN_PERIOD_MS;
-        ulTaskNotifyTake(pdTRUE, ms / portTICK_PERIOD_MS);
+    dht_sample_cb_t subs[DHT_MAX_SUBSCRIBERS];
+    portENTER_CRITICAL(&s_subs_mux);
+    memcpy(subs, s_subs, sizeof(subs));
+    portEXIT_CRITICAL(&s_subs_mux);
+    for (unsigned i = 0; i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (subs[i]) subs[i](&smp);
     }
 }
 
 /* ---------- Public API ---------- */
 esp_err_t dht_init(const dht_cfg_t *cfg) {
     if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (S.id >= 0) return ESP_OK;
+
+    if (!s_hist_lock) {
+        s_hist_lock = xSemaphoreCreateMutex();
+        if (!s_hist_lock) return ESP_ERR_NO_MEM;
+        dht_hist_init(&s_hist);
+    }
 
     S.gpio = cfg->gpio;
-    S.def_period_ms = cfg->period_ms ? cfg->period_ms : DHT_MIN_PERIOD_MS;
-    S.period_ms = S.def_period_ms;
-    S.stream_on = false;
-
-    /* Idle HIGH (matches your standalone test) */
-    gpio_reset_pin(S.gpio);
-    gpio_set_direction(S.gpio, GPIO_MODE_OUTPUT);
-    gpio_set_level(S.gpio, 1);
-#if DHT_USE_INTERNAL_PULLUP
-    gpio_pullup_dis(S.gpio);    /* enable only when in INPUT mode */
-#endif
-    gpio_pulldown_dis(S.gpio);
-
-    portENTER_CRITICAL(&s_dht_mux);
-    S.last = (dht_sample_t){ .valid=false, .temp_c=0.0f, .rh=0.0f, .age_ms=0 };
-    S.last_tick = xTaskGetTickCount();
-    portEXIT_CRITICAL(&s_dht_mux);
-
-    S.inited = true;
+    int id = sensor_register(&s_drv, &S, cfg->period_ms ? cfg->period_ms : DHT_MIN_PERIOD_MS);
+    if (id < 0) return ESP_FAIL;
+    if (!sensor_subscribe(id, on_record, NULL)) return ESP_ERR_NO_MEM;
+    const sensor_filter_cfg_t fc = {
+        .median_n = cfg->median_n,
+        .roc_per_s = { cfg->roc_t_dc, cfg->roc_rh_dp },
+    };
+    sensor_set_filter(id, &fc);
+    S.id = id;
     return ESP_OK;
 }
 
 esp_err_t dht_start(void) {
-    if (!S.inited) return ESP_ERR_INVALID_STATE;
-    if (S.task)    return ESP_OK;
-    if (xTaskCreate(dht_sampler_task, "dht.sampler", 3072, NULL, 4, &S.task) != pdPASS)
-        return ESP_FAIL;
-    return ESP_OK;
+    if (S.id < 0) return ESP_ERR_INVALID_STATE;
+    return sensor_start();
 }
 
 void dht_get_stream_state(bool *on, uint32_t *every_ms) {
-    if (on) *on = S.stream_on;
-    if (every_ms) *every_ms = S.period_ms;
+    sensor_get_stream(S.id, on, every_ms);
 }
 
 void dht_read_latest(dht_sample_t *out) {
     if (!out) return;
+    sensor_rec_t r;
+    if (!sensor_latest(S.id, &r)) {   /* lock-free snapshot copy */
+        *out = (dht_sample_t){ 0 };
+        return;
+    }
+    to_sample(&r, out);
+}
 
-    TickType_t last_tick;
-    portENTER_CRITICAL(&s_dht_mux);
-    *out = S.last;                 /* Snapshot copy */
-    last_tick = S.last_tick;
-    portEXIT_CRITICAL(&s_dht_mux);
+void dht_set_stream(bool on, uint32_t every_ms) {
+    sensor_set_stream(S.id, on, every_ms);
+    uint32_t ms = 0;
+    sensor_get_stream(S.id, NULL, &ms);
+    ESP_LOGI(TAG, "stream=%d interval=%u ms", on ? 1 : 0, (unsigned)ms);
+}
 
-    TickType_t now = xTaskGetTickCount();
-    out->age_ms = (uint32_t)((now - last_tick) * portTICK_PERIOD_MS);
+void dht_get_capture_stats(dht_capture_stats_t *out) {
+    if (!out) return;
+    *out = s_cap_st;   /* counters only; a torn read is harmless */
+    out->backend = dht_capture_backend_name();
 }
 
-void dht_set_stream(bool on, uint32_t every_ms) {
-    S.stream_on = on;
-    if (every_ms) S.period_ms = every_ms;
-    if (S.task) xTaskNotifyGive(S.task);
-    ESP_LOGI(TAG, "stream=%d interval=%u ms",
-             on ? 1 : 0, (unsigned)(every_ms ? every_ms : S.period_ms));
+void dht_stream_hold(uint32_t owner_bit, bool on) {
+    sensor_hold(S.id, owner_bit, on);
+}
+
+bool dht_subscribe(dht_sample_cb_t cb) {
+    if (!cb) return false;
+    bool ok = false;
+    portENTER_CRITICAL(&s_subs_mux);
+    for (unsigned i = 0; i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i] == cb) { ok = true; break; }
+    }
+    for (unsigned i = 0; !ok && i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (!s_subs[i]) { s_subs[i] = cb; ok = true; }
+    }
+    portEXIT_CRITICAL(&s_subs_mux);
+    return ok;
+}
+
+void dht_unsubscribe(dht_sample_cb_t cb) {
+    portENTER_CRITICAL(&s_subs_mux);
+    for (unsigned i = 0; i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i] == cb) s_subs[i] = NULL;
+    }
+    portEXIT_CRITICAL(&s_subs_mux);
+}
+
+size_t dht_history_read(dht_tier_t tier, size_t count, dht_hist_rec_t *out) {
+    if (!s_hist_lock) return 0;
+    xSemaphoreTake(s_hist_lock, portMAX_DELAY);
+    size_t n = dht_hist_read(&s_hist, tier, count, out);
+    xSemaphoreGive(s_hist_lock);
+    return n;
+}
+
+size_t dht_history_pack(dht_tier_t tier, size_t count, uint8_t *buf, size_t cap) {
+    if (!s_hist_lock) return 0;
+    uint32_t now_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    xSemaphoreTake(s_hist_lock, portMAX_DELAY);
+    size_t n = dht_hist_pack(&s_hist, tier, count, now_s, buf, cap);
+    xSemaphoreGive(s_hist_lock);
+    return n;
+}
+
+size_t dht_history_capacity(dht_tier_t tier) {
+    return dht_hist_capacity(tier);
 }
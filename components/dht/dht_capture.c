@@ -0,0 +1,154 @@
+// components/dht/dht_capture.c
+#include <string.h>
+#include "dht_capture.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#if __has_include("esp_rom_sys.h")
+  #include "esp_rom_sys.h"
+  #define dht_delay_us  esp_rom_delay_us
+#else
+  #include "rom/ets_sys.h"
+  #define dht_delay_us  ets_delay_us
+#endif
+
+static const char *TAG = "DHT";
+
+#define DHT_START_LOW_US      18000  /* DHT11 needs >= 18ms; DHT22 >= 1ms */
+#define DHT_FRAME_TIMEOUT_US  8000   /* response (~160us) + 40 bits (<= 120us each) + slack */
+#define DHT_USE_INTERNAL_PULLUP 0    /* breakout has its own pull-up */
+
+static inline int64_t now_us(void) { return esp_timer_get_time(); }
+
+/* Host start pulse: ~18ms LOW, then release and hand the line to the sensor. */
+static void start_pulse(int gpio) {
+    gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+    gpio_set_level(gpio, 1);
+    dht_delay_us(10);
+    gpio_set_level(gpio, 0);
+    dht_delay_us(DHT_START_LOW_US);
+    gpio_set_level(gpio, 1);       /* release to pull-up */
+}
+
+static void release_line(int gpio) {
+    gpio_set_direction(gpio, GPIO_MODE_INPUT);
+#if DHT_USE_INTERNAL_PULLUP
+    gpio_pullup_en(gpio);
+#else
+    gpio_pullup_dis(gpio);
+#endif
+    gpio_pulldown_dis(gpio);
+}
+
+#if DHT_CAPTURE_BACKEND == DHT_CAPTURE_ISR
+
+/* ISR state; the edge log is only touched by the ISR while armed. */
+static struct {
+    dht_edges_t *e;
+    int gpio;
+    int64_t t0;
+    volatile uint32_t isr_max_us;
+    SemaphoreHandle_t done;   /* not the task notification: the sampler sleeps on that */
+} s_cap;
+
+static void dht_edge_isr(void *arg) {
+    (void)arg;
+    int64_t t = now_us();
+    dht_edges_t *e = s_cap.e;
+    if (!e) return;
+
+    if (e->n < DHT_MAX_EDGES) {
+        e->t_us[e->n]  = (uint32_t)(t - s_cap.t0);
+        e->level[e->n] = (uint8_t)gpio_get_level(s_cap.gpio);
+        e->n++;
+    }
+
+    BaseType_t hp = pdFALSE;
+    if (e->n == DHT_FRAME_EDGES) xSemaphoreGiveFromISR(s_cap.done, &hp);
+
+    uint32_t d = (uint32_t)(now_us() - t);
+    if (d > s_cap.isr_max_us) s_cap.isr_max_us = d;
+    if (hp) portYIELD_FROM_ISR();
+}
+
+esp_err_t dht_capture_init(int gpio) {
+    if (!s_cap.done) s_cap.done = xSemaphoreCreateBinary();
+    if (!s_cap.done) return ESP_ERR_NO_MEM;
+    esp_err_t e = gpio_install_isr_service(0);
+    if (e != ESP_OK && e != ESP_ERR_INVALID_STATE) return e;   /* already installed is fine */
+    gpio_set_intr_type(gpio, GPIO_INTR_ANYEDGE);
+    gpio_intr_disable(gpio);
+    return gpio_isr_handler_add(gpio, dht_edge_isr, NULL);
+}
+
+bool dht_capture_frame(int gpio, dht_edges_t *e, uint32_t *crit_us) {
+    memset(e, 0, sizeof(*e));
+    s_cap.gpio = gpio;
+    s_cap.isr_max_us = 0;
+    (void)xSemaphoreTake(s_cap.done, 0);   /* drop a stale give */
+
+    start_pulse(gpio);
+    s_cap.t0 = now_us();
+    s_cap.e = e;
+    release_line(gpio);
+    gpio_intr_enable(gpio);
+
+    TickType_t to = pdMS_TO_TICKS(DHT_FRAME_TIMEOUT_US / 1000);
+    if (to < 2) to = 2;                  /* at least one full tick */
+    bool full = xSemaphoreTake(s_cap.done, to) == pdTRUE;
+
+    gpio_intr_disable(gpio);
+    s_cap.e = NULL;
+    if (crit_us) *crit_us = s_cap.isr_max_us;
+
+    /* A missing trailing edge still leaves 40 complete bits; let the decoder judge. */
+    if (!full) ESP_LOGD(TAG, "capture: %u/%u edges", (unsigned)e->n, DHT_FRAME_EDGES);
+    return e->n > 0;
+}
+
+const char *dht_capture_backend_name(void) { return "isr"; }
+
+#else /* DHT_CAPTURE_POLL */
+
+/* Protects the tight frame timing */
+static portMUX_TYPE s_dht_bus_mux = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t dht_capture_init(int gpio) {
+    (void)gpio;
+    return ESP_OK;
+}
+
+/* Hot polling loop; records level changes only. */
+bool dht_capture_frame(int gpio, dht_edges_t *e, uint32_t *crit_us) {
+    memset(e, 0, sizeof(*e));
+    start_pulse(gpio);
+    release_line(gpio);
+
+    portENTER_CRITICAL(&s_dht_bus_mux);
+    int64_t t0 = now_us(), t = t0;
+    int lvl = gpio_get_level(gpio);
+    while (e->n < DHT_FRAME_EDGES && (t - t0) < DHT_FRAME_TIMEOUT_US) {
+        int l = gpio_get_level(gpio);
+        t = now_us();
+        if (l != lvl) {
+            e->t_us[e->n]  = (uint32_t)(t - t0);
+            e->level[e->n] = (uint8_t)l;
+            e->n++;
+            lvl = l;
+        }
+    }
+    portEXIT_CRITICAL(&s_dht_bus_mux);
+
+    if (crit_us) *crit_us = (uint32_t)(t - t0);
+    return e->n > 0;
+}
+
+const char *dht_capture_backend_name(void) { return "poll"; }
+
+#endif
@@ -0,0 +1,97 @@
+// dht_decode.c, edge log -> bytes -> values (no driver calls; host-buildable).
+#include <string.h>
+#include "dht_decode.h"
+
+dht_dec_err_t dht_decode_edges(const dht_edges_t *e, uint8_t raw[5]) {
+    if (!e || !raw) return DHT_DEC_SHORT;
+    memset(raw, 0, 5);
+
+    /* Widths of complete HIGH pulses (rise followed by fall). */
+    uint16_t hi[DHT_MAX_EDGES / 2];
+    int nh = 0;
+    for (int i = 0; i + 1 < e->n && i + 1 < DHT_MAX_EDGES; ++i) {
+        if (e->level[i] == 1 && e->level[i + 1] == 0 && nh < (int)(sizeof(hi) / sizeof(hi[0]))) {
+            uint32_t w = e->t_us[i + 1] - e->t_us[i];
+            hi[nh++] = (uint16_t)(w > 0xFFFF ? 0xFFFF : w);
+        }
+    }
+    if (nh < 40) return DHT_DEC_SHORT;
+
+    const uint16_t *bits = &hi[nh - 40];
+    for (int bit = 0; bit < 40; ++bit) {
+        if (bits[bit] > DHT_BIT_HIGH_MAX_US) return DHT_DEC_TIMING;
+        raw[bit / 8] = (uint8_t)((raw[bit / 8] << 1) | (bits[bit] > DHT_ONE_THRESHOLD_US));
+    }
+
+    uint8_t sum = (uint8_t)(raw[0] + raw[1] + raw[2] + raw[3]);
+    return (sum == raw[4]) ? DHT_DEC_OK : DHT_DEC_CHECKSUM;
+}
+
+/* Response is low, high, then the low that opens bit 0: three edges. */
+dht_phase_t dht_stall_phase(const dht_edges_t *e) {
+    if (!e || e->n == 0) return DHT_PHASE_RESPONSE;
+    if (e->n < 3)        return DHT_PHASE_ACK;
+    return DHT_PHASE_DATA;
+}
+
+static bool plausible_22(const uint8_t r[5]) {
+    uint16_t rh = (uint16_t)((r[0] << 8) | r[1]);
+    uint16_t t  = (uint16_t)(((r[2] & 0x7F) << 8) | r[3]);
+    return r[0] <= 3 && rh <= 1000 && t <= 800;
+}
+
+static bool plausible_11(const uint8_t r[5]) {
+    return r[0] >= 4 && r[0] <= 100 && r[1] <= 9 && r[2] <= 60 && (r[3] & 0x7F) <= 9;
+}
+
+dht_kind_t dht_detect_kind(const uint8_t raw[5]) {
+    if (!raw) return DHT_KIND_UNKNOWN;
+    if (plausible_22(raw)) return DHT_KIND_22;
+    if (plausible_11(raw)) return DHT_KIND_11;
+    return DHT_KIND_UNKNOWN;
+}
+
+dht_dec_err_t dht_decode_values(const uint8_t raw[5], dht_kind_t kind,
+                                int16_t *t_dc, uint16_t *rh_dpct, dht_kind_t *out_kind) {
+    if (out_kind) *out_kind = DHT_KIND_UNKNOWN;
+    if (!raw) return DHT_DEC_RANGE;
+    if (kind == DHT_KIND_UNKNOWN) kind = dht_detect_kind(raw);
+
+    int t, rh;
+    if (kind == DHT_KIND_22 && plausible_22(raw)) {
+        rh = (raw[0] << 8) | raw[1];
+        t  = ((raw[2] & 0x7F) << 8) | raw[3];
+        if (raw[2] & 0x80) t = -t;
+    } else if (kind == DHT_KIND_11 && plausible_11(raw)) {
+        /* Integer + tenths bytes; newer DHT11s flag negative temps in bit 7 of the tenths. */
+        rh = raw[0] * 10 + raw[1];
+        t  = raw[2] * 10 + (raw[3] & 0x7F);
+        if (raw[3] & 0x80) t = -t;
+    } else {
+        return DHT_DEC_RANGE;
+    }
+
+    if (t_dc)     *t_dc = (int16_t)t;
+    if (rh_dpct)  *rh_dpct = (uint16_t)rh;
+    if (out_kind) *out_kind = kind;
+    return DHT_DEC_OK;
+}
+
+const char *dht_kind_name(dht_kind_t k) {
+    switch (k) {
+        case DHT_KIND_11: return "DHT11";
+        case DHT_KIND_22: return "DHT22";
+        default:          return "?";
+    }
+}
+
+const char *dht_dec_err_name(dht_dec_err_t e) {
+    switch (e) {
+        case DHT_DEC_OK:       return "ok";
+        case DHT_DEC_SHORT:    return "short";
+        case DHT_DEC_TIMING:   return "timing";
+        case DHT_DEC_CHECKSUM: return "checksum";
+        case DHT_DEC_RANGE:    return "range";
+        default:               return "?";
+    }
+}
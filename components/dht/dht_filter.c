@@ -0,0 +1,36 @@
+// dht_filter.c, deadband + heartbeat gate for sample streams (no driver calls; host-buildable).
+#include <string.h>
+#include <stdlib.h>
+#include "dht_types.h"
+
+static int16_t to_dc(float v)  { return (int16_t)(v >= 0 ? v * 10.0f + 0.5f : v * 10.0f - 0.5f); }
+
+void dht_filter_init(dht_filter_t *f, const dht_filter_cfg_t *cfg) {
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    if (cfg) f->cfg = *cfg;
+}
+
+bool dht_filter_pass(dht_filter_t *f, const dht_sample_t *s, uint32_t now_ms) {
+    if (!f || !s) return false;
+
+    int16_t t = s->valid ? to_dc(s->temp_c) : 0;
+    uint16_t rh = s->valid ? (uint16_t)to_dc(s->rh) : 0;
+
+    bool pass = !f->primed || s->valid != f->last_valid;
+    if (!pass && s->valid) {
+        pass = abs(t - f->last_t_dc) > f->cfg.db_t_dc ||
+               abs((int)rh - (int)f->last_rh_dp) > f->cfg.db_rh_dp;
+    }
+    if (!pass && f->cfg.heartbeat_ms) pass = (uint32_t)(now_ms - f->last_ms) >= f->cfg.heartbeat_ms;
+    /* No deadband and no heartbeat: every sample. */
+    if (!pass && !f->cfg.db_t_dc && !f->cfg.db_rh_dp && !f->cfg.heartbeat_ms) pass = true;
+    if (!pass) return false;
+
+    f->primed = true;
+    f->last_valid = s->valid;
+    f->last_t_dc = t;
+    f->last_rh_dp = rh;
+    f->last_ms = now_ms;
+    return true;
+}
@@ -0,0 +1,164 @@
+// dht_hist.c, history rings and roll-ups (no driver calls; host-buildable).
+#include <string.h>
+#include "dht_hist.h"
+
+_Static_assert(sizeof(dht_hist_t) <= DHT_HIST_RAM_MAX, "DHT history exceeds DHT_HIST_RAM_MAX");
+
+static const uint16_t s_cap[DHT_TIER_COUNT] = { DHT_HIST_RAW_N, DHT_HIST_MIN_N, DHT_HIST_HOUR_N };
+static const uint32_t s_width_s[DHT_TIER_COUNT] = { 0, 60, 3600 };
+
+size_t dht_hist_capacity(dht_tier_t tier) {
+    return ((unsigned)tier < DHT_TIER_COUNT) ? s_cap[tier] : 0;
+}
+
+void dht_hist_init(dht_hist_t *h) {
+    if (h) memset(h, 0, sizeof(*h));
+}
+
+static void acc_add(dht_hist_acc_t *a, uint32_t bucket, int16_t t, uint16_t rh) {
+    if (!a->n) {
+        memset(a, 0, sizeof(*a));
+        a->bucket = bucket;
+        a->t_min = a->t_max = t;
+        a->rh_min = a->rh_max = rh;
+    }
+    a->sum_t  += t;
+    a->sum_rh += rh;
+    if (t < a->t_min) a->t_min = t;
+    if (t > a->t_max) a->t_max = t;
+    if (rh < a->rh_min) a->rh_min = rh;
+    if (rh > a->rh_max) a->rh_max = rh;
+    a->n++;
+}
+
+/* Rounded to nearest, symmetric for negative temperatures. */
+static int16_t avg_t(const dht_hist_acc_t *a) {
+    int32_t n = a->n;
+    return (int16_t)(a->sum_t >= 0 ? (a->sum_t + n / 2) / n : (a->sum_t - n / 2) / n);
+}
+
+static dht_hist_agg_t acc_close(const dht_hist_acc_t *a, uint32_t width_s) {
+    dht_hist_agg_t g = {
+        .ts_s = a->bucket * width_s,
+        .t_min = a->t_min, .t_avg = avg_t(a), .t_max = a->t_max,
+        .rh_min = a->rh_min, .rh_avg = (uint16_t)((a->sum_rh + a->n / 2U) / a->n), .rh_max = a->rh_max,
+        .n = a->n,
+    };
+    return g;
+}
+
+static void push_agg(dht_hist_t *h, dht_tier_t tier, const dht_hist_agg_t *g) {
+    dht_hist_agg_t *ring = (tier == DHT_TIER_MIN) ? h->min : h->hour;
+    ring[h->head[tier]] = *g;
+    h->head[tier] = (uint16_t)((h->head[tier] + 1U) % s_cap[tier]);
+    if (h->len[tier] < s_cap[tier]) h->len[tier]++;
+}
+
+static void roll(dht_hist_t *h, dht_tier_t tier, dht_hist_acc_t *a, uint32_t ts_s, int16_t t, uint16_t rh) {
+    uint32_t b = ts_s / s_width_s[tier];
+    if (a->n && (a->bucket != b || a->n == UINT16_MAX)) {
+        dht_hist_agg_t g = acc_close(a, s_width_s[tier]);
+        push_agg(h, tier, &g);
+        a->n = 0;
+    }
+    acc_add(a, b, t, rh);
+}
+
+void dht_hist_add(dht_hist_t *h, uint32_t ts_s, int16_t t, uint16_t rh) {
+    if (!h) return;
+    h->raw[h->head[DHT_TIER_RAW]] = (dht_hist_raw_t){ .ts_s = ts_s, .t = t, .rh = rh };
+    h->head[DHT_TIER_RAW] = (uint16_t)((h->head[DHT_TIER_RAW] + 1U) % DHT_HIST_RAW_N);
+    if (h->len[DHT_TIER_RAW] < DHT_HIST_RAW_N) h->len[DHT_TIER_RAW]++;
+
+    roll(h, DHT_TIER_MIN,  &h->acc_min,  ts_s, t, rh);
+    roll(h, DHT_TIER_HOUR, &h->acc_hour, ts_s, t, rh);
+}
+
+static dht_hist_rec_t rec_from_agg(const dht_hist_agg_t *g) {
+    return (dht_hist_rec_t){
+        .ts_s = g->ts_s,
+        .t_min = g->t_min, .t_avg = g->t_avg, .t_max = g->t_max,
+        .rh_min = g->rh_min, .rh_avg = g->rh_avg, .rh_max = g->rh_max,
+        .n = g->n,
+    };
+}
+
+/* i-th of the last `take` closed records (oldest first) plus the open bucket at the end. */
+static bool rec_at(const dht_hist_t *h, dht_tier_t tier, size_t take, bool open, size_t i,
+                   dht_hist_rec_t *r) {
+    if (open && i == take) {
+        const dht_hist_acc_t *a = (tier == DHT_TIER_MIN) ? &h->acc_min : &h->acc_hour;
+        dht_hist_agg_t g = acc_close(a, s_width_s[tier]);
+        *r = rec_from_agg(&g);
+        return true;
+    }
+    if (i >= take) return false;
+    size_t cap = s_cap[tier];
+    size_t idx = (h->head[tier] + cap - take + i) % cap;
+    if (tier == DHT_TIER_RAW) {
+        const dht_hist_raw_t *s = &h->raw[idx];
+        *r = (dht_hist_rec_t){ .ts_s = s->ts_s, .t_min = s->t, .t_avg = s->t, .t_max = s->t,
+                               .rh_min = s->rh, .rh_avg = s->rh, .rh_max = s->rh, .n = 1 };
+    } else {
+        *r = rec_from_agg((tier == DHT_TIER_MIN) ? &h->min[idx] : &h->hour[idx]);
+    }
+    return true;
+}
+
+/* Split a request into closed records + optional open bucket. */
+static size_t window(const dht_hist_t *h, dht_tier_t tier, size_t count, bool *open) {
+    *open = false;
+    if (tier != DHT_TIER_RAW) {
+        const dht_hist_acc_t *a = (tier == DHT_TIER_MIN) ? &h->acc_min : &h->acc_hour;
+        if (a->n && count) { *open = true; count--; }
+    }
+    return count < h->len[tier] ? count : h->len[tier];
+}
+
+size_t dht_hist_read(const dht_hist_t *h, dht_tier_t tier, size_t count, dht_hist_rec_t *out) {
+    if (!h || !out || (unsigned)tier >= DHT_TIER_COUNT) return 0;
+    bool open;
+    size_t take = window(h, tier, count, &open);
+    size_t n = take + (open ? 1 : 0);
+    for (size_t i = 0; i < n; ++i) (void)rec_at(h, tier, take, open, i, &out[i]);
+    return n;
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); return p + 2; }
+static uint8_t *put32(uint8_t *p, uint32_t v) { p = put16(p, (uint16_t)v); return put16(p, (uint16_t)(v >> 16)); }
+
+size_t dht_hist_pack(const dht_hist_t *h, dht_tier_t tier, size_t count, uint32_t now_s,
+                     uint8_t *buf, size_t cap) {
+    const size_t hdr = 8, rsz = (tier == DHT_TIER_RAW) ? 8 : 18;
+    if (!h || !buf || cap < hdr || (unsigned)tier >= DHT_TIER_COUNT) return 0;
+
+    size_t fit = (cap - hdr) / rsz;
+    if (count > fit) count = fit;
+    bool open;
+    size_t take = window(h, tier, count, &open);
+    size_t n = take + (open ? 1 : 0);
+
+    uint8_t *p = buf;
+    *p++ = DHT_HIST_PACK_VER;
+    *p++ = (uint8_t)tier;
+    p = put16(p, (uint16_t)n);
+    p = put32(p, now_s);
+    for (size_t i = 0; i < n; ++i) {
+        dht_hist_rec_t r;
+        (void)rec_at(h, tier, take, open, i, &r);
+        p = put32(p, r.ts_s);
+        if (tier == DHT_TIER_RAW) {
+            p = put16(p, (uint16_t)r.t_avg);
+            p = put16(p, r.rh_avg);
+        } else {
+            p = put16(p, (uint16_t)r.t_min);
+            p = put16(p, (uint16_t)r.t_avg);
+            p = put16(p, (uint16_t)r.t_max);
+            p = put16(p, r.rh_min);
+            p = put16(p, r.rh_avg);
+            p = put16(p, r.rh_max);
+            p = put16(p, r.n);
+        }
+    }
+    return (size_t)(p - buf);
+}
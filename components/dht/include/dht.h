@@ -1,7 +1,9 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
+#include "dht_types.h"    // samples, history records, filters
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,19 +12,21 @@ extern "C" {
 typedef struct {
     int gpio;            // DHT data pin.
     uint32_t period_ms;  // Default poll interval (ms).
+    uint8_t median_n;    // Outlier filter: median window (odd, <= 7; 0/1 = off).
+    uint16_t roc_t_dc;   // Max temperature change, tenths of °C per second (0 = off).
+    uint16_t roc_rh_dp;  // Max humidity change, tenths of %RH per second (0 = off).
 } dht_cfg_t;
 
-typedef struct {
-    bool valid;      // Last sample valid?
-    float temp_c;     // Temperature in °C.
-    float rh;         // Relative humidity in %.
-    uint32_t age_ms;  // ms since it was captured.
-} dht_sample_t;
+// Sample subscribers: called from the sensor scheduler after every read (valid or not).
+#ifndef DHT_MAX_SUBSCRIBERS
+#define DHT_MAX_SUBSCRIBERS 4
+#endif
+typedef void (*dht_sample_cb_t)(const dht_sample_t *s);
 
-// Init with pin/period (does not start the sampler task).
+// Init with pin/period and register as a sensor driver (does not start sampling).
 esp_err_t dht_init(const dht_cfg_t *cfg);
 
-// Start background sampler task (safe to call once).
+// Start the shared sensor scheduler (idempotent).
 esp_err_t dht_start(void);
 
 // Copy latest sample (non-blocking).
@@ -31,9 +35,30 @@ void dht_read_latest(dht_sample_t *out);
 // Enable/disable periodic sampling; if every_ms == 0, current/default period.
 void dht_set_stream(bool on, uint32_t every_ms);
 
+// Keep the sampler running for a consumer outside the command sessions (e.g. BLE CCC),
+// independent of dht_set_stream(). One bit per owner.
+#define DHT_HOLD_BLE (1u << 0)
+void dht_stream_hold(uint32_t owner_bit, bool on);
+
 // Query current streaming state and period (returns via out params; either may be NULL).
 void dht_get_stream_state(bool *on, uint32_t *every_ms);
 
+// Register/unregister a sample callback (max DHT_MAX_SUBSCRIBERS).
+bool dht_subscribe(dht_sample_cb_t cb);
+void dht_unsubscribe(dht_sample_cb_t cb);
+
+// Newest `count` history records of a tier, oldest first; returns records written.
+size_t dht_history_read(dht_tier_t tier, size_t count, dht_hist_rec_t *out);
+
+// Same window packed little-endian for BLE (format in dht_hist.h); returns bytes written.
+size_t dht_history_pack(dht_tier_t tier, size_t count, uint8_t *buf, size_t cap);
+
+// Records a tier can hold.
+size_t dht_history_capacity(dht_tier_t tier);
+
+// Copy capture/decode counters.
+void dht_get_capture_stats(dht_capture_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,30 @@
+// dht_capture.h, DHT frame capture backends (internal).
+// A backend only records edge timestamps; dht_decode.c turns them into bytes.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dht_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DHT_CAPTURE_ISR   1   /* GPIO any-edge interrupt, timestamps only */
+#define DHT_CAPTURE_POLL  2   /* legacy busy-poll with interrupts masked for the frame */
+
+#ifndef DHT_CAPTURE_BACKEND
+#define DHT_CAPTURE_BACKEND DHT_CAPTURE_ISR
+#endif
+
+esp_err_t dht_capture_init(int gpio);
+
+/* Host start pulse, then log edges until the frame completes or times out.
+ * *crit_us gets the longest stretch spent with interrupts masked. */
+bool dht_capture_frame(int gpio, dht_edges_t *e, uint32_t *crit_us);
+
+const char *dht_capture_backend_name(void);
+
+#ifdef __cplusplus
+}
+#endif
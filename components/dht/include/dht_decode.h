@@ -0,0 +1,67 @@
+// dht_decode.h, DHT11/DHT22 frame decoding from captured edges (internal).
+// Plain C, no driver calls: capture backends fill dht_edges_t, this turns it into values.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Edges after host release: response low/high, 40 bits (rise + fall), trailing low/release. */
+#define DHT_FRAME_EDGES 84
+#ifndef DHT_MAX_EDGES
+#define DHT_MAX_EDGES   96
+#endif
+
+#define DHT_ONE_THRESHOLD_US 50   /* bit HIGH > ~50us => '1' (26-28us '0', ~70us '1') */
+#define DHT_BIT_HIGH_MAX_US  100  /* longer data HIGH => lost edge */
+
+/* Edge log: time since capture start and line level after each edge. */
+typedef struct {
+    uint32_t t_us[DHT_MAX_EDGES];
+    uint8_t  level[DHT_MAX_EDGES];
+    uint16_t n;
+} dht_edges_t;
+
+typedef enum {
+    DHT_KIND_UNKNOWN = 0,
+    DHT_KIND_11,
+    DHT_KIND_22,
+} dht_kind_t;
+
+typedef enum {
+    DHT_DEC_OK = 0,
+    DHT_DEC_SHORT,     // fewer than 40 complete HIGH pulses
+    DHT_DEC_TIMING,    // a data HIGH out of range
+    DHT_DEC_CHECKSUM,
+    DHT_DEC_RANGE,     // checksum ok but fits neither sensor
+} dht_dec_err_t;
+
+/* Where a failed frame stalled, judged from the edges that did arrive. */
+typedef enum {
+    DHT_PHASE_RESPONSE = 0,   // no edge: sensor never pulled the line (wiring/power)
+    DHT_PHASE_ACK,            // response low/high incomplete
+    DHT_PHASE_DATA,           // bits cut short or mistimed
+} dht_phase_t;
+
+dht_phase_t dht_stall_phase(const dht_edges_t *e);
+
+/* Edges -> 5 raw bytes (checksum verified). Uses the last 40 complete HIGH pulses,
+ * so a missing response edge at the start does not matter. */
+dht_dec_err_t dht_decode_edges(const dht_edges_t *e, uint8_t raw[5]);
+
+/* DHT22 humidity high byte is 0..3 (<= 100.0%); DHT11 humidity is >= 20%. */
+dht_kind_t dht_detect_kind(const uint8_t raw[5]);
+
+/* Raw bytes -> tenths of °C / tenths of %RH. kind DHT_KIND_UNKNOWN autodetects;
+ * *out_kind (optional) gets the kind used. */
+dht_dec_err_t dht_decode_values(const uint8_t raw[5], dht_kind_t kind,
+                                int16_t *t_dc, uint16_t *rh_dpct, dht_kind_t *out_kind);
+
+const char *dht_kind_name(dht_kind_t k);
+const char *dht_dec_err_name(dht_dec_err_t e);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+// dht_hist.h, DHT sample history: raw ring + 1-minute / 1-hour min/max/avg tiers (internal).
+// Plain C, no locking or driver calls; dht.c owns the instance and serializes access.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "dht_types.h"    // dht_tier_t, dht_hist_rec_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DHT_HIST_RAW_N
+#define DHT_HIST_RAW_N   256   /* ~8.5 min at the 2 s minimum period */
+#endif
+#ifndef DHT_HIST_MIN_N
+#define DHT_HIST_MIN_N   120   /* 2 h of 1-minute buckets */
+#endif
+#ifndef DHT_HIST_HOUR_N
+#define DHT_HIST_HOUR_N  72    /* 3 days of 1-hour buckets */
+#endif
+#ifndef DHT_HIST_RAM_MAX
+#define DHT_HIST_RAM_MAX 8192  /* compile-time bound on sizeof(dht_hist_t) */
+#endif
+
+#define DHT_HIST_PACK_VER 1
+
+/* Stored layouts: tenths of °C / %RH, timestamps in seconds since boot. */
+typedef struct {
+    uint32_t ts_s;
+    int16_t  t;
+    uint16_t rh;
+} dht_hist_raw_t;
+
+typedef struct {
+    uint32_t ts_s;                 // bucket start
+    int16_t  t_min, t_avg, t_max;
+    uint16_t rh_min, rh_avg, rh_max;
+    uint16_t n;
+} dht_hist_agg_t;
+
+/* Open bucket accumulator. */
+typedef struct {
+    uint32_t bucket;               // ts_s / width; valid only if n
+    int32_t  sum_t;
+    uint32_t sum_rh;
+    int16_t  t_min, t_max;
+    uint16_t rh_min, rh_max;
+    uint16_t n;
+} dht_hist_acc_t;
+
+typedef struct {
+    dht_hist_raw_t raw[DHT_HIST_RAW_N];
+    dht_hist_agg_t min[DHT_HIST_MIN_N];
+    dht_hist_agg_t hour[DHT_HIST_HOUR_N];
+    uint16_t head[DHT_TIER_COUNT];  // next write slot
+    uint16_t len[DHT_TIER_COUNT];
+    dht_hist_acc_t acc_min, acc_hour;
+} dht_hist_t;
+
+void dht_hist_init(dht_hist_t *h);
+
+/* Append one valid sample; rolls up closed minute/hour buckets. */
+void dht_hist_add(dht_hist_t *h, uint32_t ts_s, int16_t t, uint16_t rh);
+
+/* Newest `count` records of a tier, oldest first. Aggregate tiers end with the
+ * open (partial) bucket. Returns records written. */
+size_t dht_hist_read(const dht_hist_t *h, dht_tier_t tier, size_t count, dht_hist_rec_t *out);
+
+/* Same window, little-endian packed for BLE: header {ver u8, tier u8, count u16, now_s u32},
+ * then raw {ts u32, t i16, rh u16} or agg {ts u32, t min/avg/max i16, rh min/avg/max u16, n u16}.
+ * Returns bytes written (as many whole records as fit in cap). */
+size_t dht_hist_pack(const dht_hist_t *h, dht_tier_t tier, size_t count, uint32_t now_s,
+                     uint8_t *buf, size_t cap);
+
+/* Capacity of a tier (records). */
+size_t dht_hist_capacity(dht_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,71 @@
+// dht_types.h, DHT values, history records and the per-consumer change filter.
+// Plain C, no ESP-IDF headers: shared by the driver (dht.h) and the host-buildable
+// modules (dht_hist.c, dht_filter.c).
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    bool valid;      // Last sample valid?
+    float temp_c;     // Temperature in °C.
+    float rh;         // Relative humidity in %.
+    uint32_t age_ms;  // ms since it was captured.
+} dht_sample_t;
+
+// Capture counters (read quality lives in sensor_get_quality()). crit_*_us: longest
+// interrupts-masked stretch per frame (whole frame for poll, one edge ISR for isr).
+typedef struct {
+    const char *backend;   // "isr" or "poll".
+    uint8_t kind;          // 0 unknown, 1 DHT11, 2 DHT22.
+    uint32_t frames;       // capture attempts.
+    uint32_t crit_last_us;
+    uint32_t crit_max_us;
+} dht_capture_stats_t;
+
+// History tiers (see dht_hist.h for sizes).
+typedef enum {
+    DHT_TIER_RAW = 0,   // every valid sample
+    DHT_TIER_MIN,       // 1-minute buckets
+    DHT_TIER_HOUR,      // 1-hour buckets
+    DHT_TIER_COUNT
+} dht_tier_t;
+
+// One history record; tenths of °C / %RH. Raw samples have min == avg == max, n == 1.
+typedef struct {
+    uint32_t ts_s;      // seconds since boot (bucket start for aggregates)
+    int16_t  t_min, t_avg, t_max;
+    uint16_t rh_min, rh_avg, rh_max;
+    uint16_t n;         // samples in the bucket
+} dht_hist_rec_t;
+
+// Per-consumer change filter. A sample passes when T or RH moved by more than the
+// deadband since the last one that passed, validity flipped, or heartbeat_ms of silence.
+// All-zero config passes every sample.
+typedef struct {
+    uint16_t db_t_dc;        // temperature deadband, tenths of °C
+    uint16_t db_rh_dp;       // humidity deadband, tenths of %RH
+    uint32_t heartbeat_ms;   // max silence (0 = none)
+} dht_filter_cfg_t;
+
+typedef struct {
+    dht_filter_cfg_t cfg;
+    bool primed;             // something passed already
+    bool last_valid;
+    int16_t last_t_dc;
+    uint16_t last_rh_dp;
+    uint32_t last_ms;
+} dht_filter_t;
+
+// Reset a filter with a new config.
+void dht_filter_init(dht_filter_t *f, const dht_filter_cfg_t *cfg);
+
+// True if `s` should be sent now; updates the filter state when it passes.
+bool dht_filter_pass(dht_filter_t *f, const dht_sample_t *s, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,12 +1,18 @@
 #include "errsrc.h"
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
 
-static char s_err[ERRSRC_STR_MAX] = "NONE";
-static errsrc_cb_t s_cb = 0;
 static errsrc_t s_last = ES_NONE;
+static errsrc_cb_t s_subs[ERRSRC_MAX_SUBSCRIBERS];
+static errsrc_stat_t s_stats[ES_COUNT];
+static int64_t s_since_us = 0;   /* entry time of s_last (boot for the initial NONE) */
 
-/* Canonical strings for enums. */
-static const char* s_tab[] = {
+/* Guards s_last/s_stats/s_subs; callbacks run outside it. */
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Canonical strings for enums (interned; index == code). */
+static const char* const s_tab[ES_COUNT] = {
     [ES_NONE] = "NONE",
     [ES_NO_CREDS] = "NO_CREDS",
     [ES_IP_LOST] = "IP_LOST",
@@ -17,51 +23,117 @@ static const char* s_tab[] = {
     [ES_ASSOC_EXPIRE] = "ASSOC_EXPIRE",
     [ES_BEACON_TO] = "BEACON_TO",
     [ES_DISCONNECTED] = "DISCONNECTED",
+    [ES_TRYING] = "TRYING",
+    [ES_SCANNING] = "SCANNING",
 };
+_Static_assert(sizeof(s_tab) / sizeof(s_tab[0]) == ES_COUNT, "errsrc string table out of sync");
 
 const char* errsrc_to_string(errsrc_t e) {
-    if ((unsigned)e < (sizeof(s_tab) / sizeof(s_tab[0])) && s_tab[e]) return s_tab[e];
+    if ((unsigned)e < ES_COUNT && s_tab[e]) return s_tab[e];
     return "UNKNOWN";
 }
 
-/* Map canonical string back to enum for callers that still set by string. */
-static errsrc_t str_to_enum(const char *s) {
+/* Map canonical string back to enum (string callers only). */
+errsrc_t errsrc_from_string(const char *s) {
     if (!s || !*s) return ES_NONE;
-    for (unsigned i = 0; i < sizeof(s_tab) / sizeof(s_tab[0]); ++i) {
+    for (unsigned i = 0; i < ES_COUNT; ++i) {
         if (s_tab[i] && strcmp(s, s_tab[i]) == 0) return (errsrc_t)i;
     }
-    return ES_NONE;
+    return ES_COUNT;
 }
 
-void errsrc_set_enum(errsrc_t e) {
-    s_last = e;
-    errsrc_set(errsrc_to_string(e));
-}
+/* Call `only` (or every subscriber) with e. Callbacks run outside s_mux, so a concurrent
+ * setter's fan-out can finish before this one; re-read the code afterwards and deliver
+ * again until the last code delivered is the current one. */
+static void fan_out(errsrc_t e, errsrc_cb_t only) {
+    for (;;) {
+        errsrc_cb_t subs[ERRSRC_MAX_SUBSCRIBERS] = { only };
+        if (!only) {
+            portENTER_CRITICAL(&s_mux);
+            memcpy(subs, s_subs, sizeof(subs));
+            portEXIT_CRITICAL(&s_mux);
+        }
+        for (unsigned i = 0; i < ERRSRC_MAX_SUBSCRIBERS; ++i) {
+            if (subs[i]) subs[i](e, s_tab[e]);
+        }
 
-void errsrc_set(const char *s) {
-    if (!s || !*s) s = "NONE";
+        portENTER_CRITICAL(&s_mux);
+        errsrc_t cur = s_last;
+        portEXIT_CRITICAL(&s_mux);
+        if (cur == e) return;
+        e = cur;
+    }
+}
 
-    /* De-dup on the stored snapshot width. */
-    if (strncmp(s_err, s, ERRSRC_STR_MAX) == 0) return;
+void errsrc_set_enum(errsrc_t e) {
+    if ((unsigned)e >= ES_COUNT) return;
 
-    strncpy(s_err, s, ERRSRC_STR_MAX - 1);
-    s_err[ERRSRC_STR_MAX - 1] = '\0';
+    int64_t now = esp_timer_get_time();
 
-    /* enum in sync even for string callers. */
-    s_last = str_to_enum(s);
+    portENTER_CRITICAL(&s_mux);
+    if (e == s_last) {   /* de-dup on the code */
+        portEXIT_CRITICAL(&s_mux);
+        return;
+    }
+    s_stats[s_last].total_us += now - s_since_us;
+    s_stats[e].transitions++;
+    s_stats[e].last_enter_us = now;
+    s_since_us = now;
+    s_last = e;
+    portEXIT_CRITICAL(&s_mux);
 
-    if (s_cb) s_cb(s_err);
+    fan_out(e, NULL);
 }
 
-const char* errsrc_get(void) {
-    return s_err; /* Snapshot pointer; consumer should copy if needed. */
+bool errsrc_set(const char *s) {
+    errsrc_t e = errsrc_from_string(s);
+    if (e == ES_COUNT) return false;
+    errsrc_set_enum(e);
+    return true;
 }
 
-void errsrc_subscribe(errsrc_cb_t cb) {
-    s_cb = cb;
-    if (s_cb) s_cb(s_err);  /* Push current snapshot immediately. */
+const char* errsrc_get(void) {
+    return s_tab[s_last]; /* interned; stable for the lifetime of the program */
 }
 
 errsrc_t errsrc_get_code(void) {
     return s_last;
 }
+
+bool errsrc_subscribe(errsrc_cb_t cb) {
+    if (!cb) return false;
+
+    bool ok = false;
+    errsrc_t cur;
+    portENTER_CRITICAL(&s_mux);
+    for (unsigned i = 0; i < ERRSRC_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i] == cb) { ok = true; break; }
+    }
+    for (unsigned i = 0; !ok && i < ERRSRC_MAX_SUBSCRIBERS; ++i) {
+        if (!s_subs[i]) { s_subs[i] = cb; ok = true; }
+    }
+    cur = s_last;
+    portEXIT_CRITICAL(&s_mux);
+
+    if (ok) fan_out(cur, cb);  /* Push current snapshot immediately. */
+    return ok;
+}
+
+void errsrc_unsubscribe(errsrc_cb_t cb) {
+    portENTER_CRITICAL(&s_mux);
+    for (unsigned i = 0; i < ERRSRC_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i] == cb) s_subs[i] = NULL;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void errsrc_get_stats(errsrc_t e, errsrc_stat_t *out) {
+    if (!out) return;
+    if ((unsigned)e >= ES_COUNT) { memset(out, 0, sizeof(*out)); return; }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats[e];
+    if (e == s_last) out->total_us += now - s_since_us;
+    portEXIT_CRITICAL(&s_mux);
+}
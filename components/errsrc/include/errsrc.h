@@ -1,9 +1,13 @@
 #pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Canonical error sources used by monitor/wifi. */
+/* Canonical error sources used by monitor/wifi.
+ * Numeric values are reported to clients ("errsrc=<n>"); append only. */
 typedef enum {
     ES_NONE = 0,
     ES_NO_CREDS,
@@ -15,25 +19,50 @@ typedef enum {
     ES_ASSOC_EXPIRE,
     ES_BEACON_TO,
     ES_DISCONNECTED,
+    ES_TRYING,          /* new credentials applied; reconnect pending */
+    ES_SCANNING,        /* STA started; first connect pending */
+
+    ES_COUNT            /* number of codes; keep last */
 } errsrc_t;
 
 /* Max printable length for the string snapshot (includes NUL). */
 #define ERRSRC_STR_MAX 64
 
-typedef void (*errsrc_cb_t)(const char *str);
+/* Max number of concurrent subscribers. */
+#ifndef ERRSRC_MAX_SUBSCRIBERS
+#define ERRSRC_MAX_SUBSCRIBERS 4
+#endif
 
-/* String API. */
-void errsrc_set(const char *s);
-const char* errsrc_get(void);
-static inline void errsrc_clear(void) { errsrc_set("NONE"); }
+/* Subscriber gets the code and its interned (static) string. */
+typedef void (*errsrc_cb_t)(errsrc_t code, const char *str);
 
-/* Subscriber (single subscriber; last one wins). */
-void errsrc_subscribe(errsrc_cb_t cb);
+/* Per-code accounting (esp_timer microseconds). */
+typedef struct {
+    uint32_t transitions;    // times this code was entered.
+    int64_t  last_enter_us;  // when it was last entered (0 = never).
+    int64_t  total_us;       // time spent in it, including the current stay.
+} errsrc_stat_t;
 
-/* Enum helpers. */
-const char* errsrc_to_string(errsrc_t e);
+/* Enum API (canonical). */
 void errsrc_set_enum(errsrc_t e);
 errsrc_t errsrc_get_code(void);
+const char* errsrc_to_string(errsrc_t e);
+static inline void errsrc_clear(void) { errsrc_set_enum(ES_NONE); }
+
+/* String API (legacy). Only canonical names are accepted; NULL/"" clears.
+ * Unknown strings are ignored and return false. */
+bool errsrc_set(const char *s);
+const char* errsrc_get(void);           /* interned; never NULL */
+errsrc_t errsrc_from_string(const char *s); /* ES_COUNT if unknown */
+
+/* Subscribers (up to ERRSRC_MAX_SUBSCRIBERS). The current code is pushed on subscribe.
+ * Concurrent setters may deliver out of order, but a subscriber's last call always
+ * carries the current code (a code may be repeated). */
+bool errsrc_subscribe(errsrc_cb_t cb);
+void errsrc_unsubscribe(errsrc_cb_t cb);
+
+/* Copy accounting for one code (out is zeroed for invalid codes). */
+void errsrc_get_stats(errsrc_t e, errsrc_stat_t *out);
 
 #ifdef __cplusplus
 } /* extern "C" */
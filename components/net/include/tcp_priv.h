@@ -1,14 +1,15 @@
 #pragma once
+#include <stdbool.h>
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Spawn a task to serve one accepted TCP client fd */
-void tcp_client_spawn(int fd);
+/* Spawn a task to serve one accepted TCP client fd; false if the task could not be created */
+bool tcp_client_spawn(int fd);
 
-/* Listener keeps the client count; client calls these on connect/disconnect */
-void tcp_on_client_connected(void);
-void tcp_on_client_disconnected(void);
+/* Listener owns the client table (fd is listed before spawn). The client task calls this
+ * on exit, before close(fd), so a listed fd is never a reused one. */
+void tcp_on_client_disconnected(int fd);
 
 #ifdef __cplusplus
 }
@@ -1,11 +1,24 @@
 // tcp_server.h
 #pragma once
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void launch_tcp_server(void);
+/* Start the persistent listener (idempotent). It binds INADDR_ANY right away,
+ * so it survives IP loss/changes and is already listening when an IP arrives. */
+void tcp_server_start(void);
+
+/* Got-IP: revalidate the listener (rebind if dead) and drop clients bound to
+ * a different local address. ip is esp_ip4_addr_t.addr. */
+void tcp_server_on_ip(uint32_t ip);
+
+/* IP lost: close every client session. */
+void tcp_server_on_ip_lost(void);
+
+/* Last got-IP -> listening time in ms (-1 if not measured yet). */
+int32_t tcp_server_ip_to_listen_ms(void);
 
 #ifdef __cplusplus
 }
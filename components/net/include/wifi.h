@@ -1,5 +1,6 @@
 // wifi.h
 #pragma once
+#include "wifi_fast.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -8,6 +9,9 @@ extern "C" {
 void wifi_start(const char *ssid, const char *pwd);
 void wifi_set_credentials(const char *ssid, const char *pwd);
 
+/* Copy of the fast-reconnect state (cache + time-to-IP per path). */
+void wifi_get_fast_snapshot(wifi_fast_t *out);
+
 #ifdef __cplusplus
 }
 #endif
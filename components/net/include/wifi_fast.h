@@ -0,0 +1,76 @@
+// wifi_fast.h, fast-reconnect decision logic (internal).
+// Plain C, no driver calls: the Wi-Fi glue feeds it events and applies its decisions.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Consecutive failed directed connects before falling back to full scans
+ * until the next success re-learns the AP. */
+#ifndef WIFI_FAST_MAX_FAILS
+#define WIFI_FAST_MAX_FAILS 2
+#endif
+
+#define WIFI_FAST_CACHE_VER 1
+
+/* Persisted last-good link (NVS blob). Addresses as in esp_ip4_addr_t.addr. */
+typedef struct {
+    uint8_t  ver;
+    uint8_t  channel;
+    uint8_t  bssid[6];
+    char     ssid[33];
+    uint32_t ip;
+    uint32_t gw;
+    uint32_t netmask;
+} wifi_fast_cache_t;
+
+typedef enum {
+    WIFI_PATH_SLOW = 0,   // full all-channel scan
+    WIFI_PATH_FAST = 1,   // directed connect to cached BSSID/channel
+} wifi_path_t;
+
+/* Time-to-IP accounting for one path. */
+typedef struct {
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} wifi_ttip_stat_t;
+
+typedef struct {
+    wifi_fast_cache_t cache;
+    bool cache_valid;
+    bool lease_reused;        // last got-IP matched the cached address
+    uint8_t fast_fails;       // consecutive failed directed connects
+    wifi_path_t cur;          // path of the attempt in flight
+    int64_t cycle_start_us;   // first attempt since link loss (0 = idle)
+    wifi_ttip_stat_t st[2];   // indexed by wifi_path_t
+} wifi_fast_t;
+
+void wifi_fast_init(wifi_fast_t *f, const wifi_fast_cache_t *c_opt);
+
+/* True if a directed connect would be tried for this SSID. */
+bool wifi_fast_ready(const wifi_fast_t *f, const char *ssid);
+
+/* Pick the path for the next connect attempt and open a timing cycle if idle. */
+wifi_path_t wifi_fast_next_attempt(wifi_fast_t *f, const char *ssid, int64_t now_us);
+
+/* Attempt failed / link lost. */
+void wifi_fast_on_disconnect(wifi_fast_t *f);
+
+/* IP obtained: closes the timing cycle. Returns the winning path; *out_ms is time-to-IP
+ * (0 if no cycle was open, e.g. DHCP renew). */
+wifi_path_t wifi_fast_on_got_ip(wifi_fast_t *f, int64_t now_us, uint32_t ip, uint32_t *out_ms);
+
+/* Adopt a new last-good link. Returns true if it differs from the cache (persist it). */
+bool wifi_fast_learn(wifi_fast_t *f, const wifi_fast_cache_t *c);
+
+/* Drop the cache (credentials changed). */
+void wifi_fast_forget(wifi_fast_t *f);
+
+#ifdef __cplusplus
+}
+#endif
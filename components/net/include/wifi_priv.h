@@ -4,8 +4,10 @@
 #include "freertos/timers.h"
 #include "esp_timer.h"
 #include "esp_event.h" 
+#include "esp_netif.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include "errsrc.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,14 +15,18 @@ extern "C" {
 
 /* Backoff subsystem (internal) */
 void wifi_backoff_reset(void);
-void wifi_backoff_schedule(void);
+/* Arm the reconnect timer for a failure with `reason`; returns true if the
+ * failure should be escalated to the health monitor (see wifi_sched.c). */
+bool wifi_backoff_schedule(errsrc_t reason);
 void wifi_backoff_stop_timer(void);
 
-/* TCP start timer helpers (internal) */
-void wifi_tcp_timer_create_once(void);
-bool wifi_tcp_timer_is_active(void);
-void wifi_tcp_timer_stop_if_active(void);
-void wifi_tcp_timer_schedule_us(uint64_t usec);
+/* Fast-link cache + connect attempts (wifi_cache.c) */
+void wifi_cache_load(void);
+void wifi_cache_forget(void);
+bool wifi_cache_fast_ready(void);
+void wifi_connect_attempt(void);
+void wifi_cache_on_disconnect(void);
+void wifi_cache_on_got_ip(const esp_netif_ip_info_t *ipi);
 
 /* Event handlers implemented in wifi_event.c */
 void got_ip(void *arg, esp_event_base_t base, int32_t id, void *data);
@@ -0,0 +1,51 @@
+// wifi_sched.h, reason-aware reconnect scheduling (internal).
+// Plain C, no driver calls: randomness comes in as an argument so traces replay deterministically.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "errsrc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-reason retry policy. */
+typedef struct {
+    uint16_t fast_ms;        // delay for the first fast_retries attempts (transient reasons).
+    uint8_t  fast_retries;   // attempts retried at fast_ms before backing off.
+    uint8_t  escalate_after; // failures since got-IP before monitor_on_wifi_error() (0 = never).
+    uint32_t base_ms;        // decorrelated-jitter floor.
+    uint32_t cap_ms;         // decorrelated-jitter ceiling.
+    uint16_t give_up;        // consecutive failures with this reason after which we park (0 = never);
+                             // give-up reasons count together.
+} wifi_sched_policy_t;
+
+/* Fast retries, escalation and the jitter state run on `fails`, which only a got-IP
+ * (wifi_sched_reset) clears: an AP flapping between reasons still backs off and escalates.
+ * A new reason only switches the policy row. */
+typedef struct {
+    errsrc_t reason;     // reason of the last failure (selects the policy row).
+    uint16_t attempts;   // consecutive failures with that reason, or with give-up reasons in a row.
+    uint16_t fails;      // failures of any reason since the last got-IP.
+    uint32_t prev_ms;    // last backoff delay (jitter state).
+    bool     parked;     // gave up; retrying at the park interval only.
+} wifi_sched_t;
+
+typedef struct {
+    uint32_t delay_ms;   // schedule the next connect after this.
+    bool     escalate;   // report this failure to the health monitor.
+    bool     parked;     // policy gave up; delay is the park interval.
+} wifi_sched_decision_t;
+
+void wifi_sched_reset(wifi_sched_t *s);   /* link up (got-IP) or new credentials */
+
+/* One failure with `reason`; rnd is any uniformly random 32-bit value.
+ * ES_SCANNING / ES_TRYING ask for the first connect and are not counted as failures. */
+wifi_sched_decision_t wifi_sched_next(wifi_sched_t *s, errsrc_t reason, uint32_t rnd);
+
+/* Policy table entry used for a reason. */
+const wifi_sched_policy_t *wifi_sched_policy(errsrc_t reason);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,14 +5,17 @@
 #include <limits.h>       // INT_MAX
 #include <unistd.h>       // close, shutdown
 #include <sys/socket.h>   // recv, send
+#include <sys/time.h>     // struct timeval
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 
+#include "app_cfg.h"
 #include "command.h"
 #include "commands.h"
 #include "tcp_priv.h"
+#include "cmd_stream.h"
 
 static const char *TAG = "TCP.cli";
 
@@ -34,7 +37,9 @@ static void client_task(void *arg) {
     int fd = (int)(intptr_t)arg;
     ESP_LOGI(TAG, "Client connected: fd=%d", fd);
 
-    tcp_on_client_connected();
+    /* Streamed samples are sent from the sampler task; never let a stalled peer hold it. */
+    struct timeval snd_to = { .tv_sec = TCP_SEND_TIMEOUT_S, .tv_usec = 0 };
+    (void)setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &snd_to, sizeof(snd_to));
 
     cmd_ctx_t ctx = {
         .authed   = false,
@@ -88,14 +93,15 @@ static void client_task(void *arg) {
     }
     /*Stop any late router replies for this client */
     ctx.write = NULL;
+    cmd_stream_drop(CMD_XPORT_TCP, (void *)(intptr_t)fd);
 
+    tcp_on_client_disconnected(fd);
     shutdown(fd, SHUT_RDWR);
     close(fd);
 
-    tcp_on_client_disconnected();
     vTaskDelete(NULL);
 }
 
-void tcp_client_spawn(int fd) {
-    xTaskCreate(client_task, "tcp_cli", 4096, (void *)(intptr_t)fd, 5, NULL);
+bool tcp_client_spawn(int fd) {
+    return xTaskCreate(client_task, "tcp_cli", 4096, (void *)(intptr_t)fd, 5, NULL) == pdPASS;
 }
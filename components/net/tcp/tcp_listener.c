@@ -7,40 +7,101 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
+#include "app_cfg.h"
 #include "tcp_server.h"
 #include "tcp_priv.h"
 #include "syscoord.h"
+#include "boottime.h"
 
 #define PORT 8080
 static const char *TAG = "TCP.srv";
 
-/* Track total TCP clients to inform policy */
-static _Atomic int s_client_count = 0;
+/* Listener socket + client table. s_lock guards both: the listener is only
+ * closed under it, and clients leave the table before they close their fd. */
+static SemaphoreHandle_t s_lock;
+static TaskHandle_t s_task;
+static int s_lfd = -1;
+static int s_cli[TCP_MAX_CLIENTS];
+static int64_t s_ip_wait_us = 0;             // got-IP time while the listener is not ready (s_lock)
 
-void tcp_on_client_connected(void) {
-    int new_cnt = atomic_fetch_add(&s_client_count, 1) + 1;
-    syscoord_on_tcp_clients(new_cnt);
+static _Atomic bool    s_rebind = false;
+static _Atomic int32_t s_ip_to_listen_ms = -1;
+
+static int client_count_locked(void) {
+    int n = 0;
+    for (int i = 0; i < TCP_MAX_CLIENTS; ++i) if (s_cli[i] >= 0) n++;
+    return n;
 }
 
-void tcp_on_client_disconnected(void) {
-    int new_cnt = atomic_fetch_sub(&s_client_count, 1) - 1;
-    if (new_cnt < 0) {
-        atomic_store(&s_client_count, 0);
-        new_cnt = 0;
+static bool client_add(int fd) {
+    int n = -1;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < TCP_MAX_CLIENTS; ++i) {
+        if (s_cli[i] < 0) { s_cli[i] = fd; n = client_count_locked(); break; }
     }
-    syscoord_on_tcp_clients(new_cnt);
+    xSemaphoreGive(s_lock);
+    if (n < 0) return false;
+    syscoord_on_tcp_clients(n);
+    return true;
 }
 
-static void server_task(void *pv) {
-    (void)pv;
+void tcp_on_client_disconnected(int fd) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < TCP_MAX_CLIENTS; ++i) if (s_cli[i] == fd) s_cli[i] = -1;
+    int n = client_count_locked();
+    xSemaphoreGive(s_lock);
+    syscoord_on_tcp_clients(n);
+}
+
+/* Wake client tasks out of recv(); they unlist and close themselves. keep_ip = 0 drops all. */
+static int drop_clients(uint32_t keep_ip) {
+    int dropped = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < TCP_MAX_CLIENTS; ++i) {
+        int fd = s_cli[i];
+        if (fd < 0) continue;
+        if (keep_ip) {
+            struct sockaddr_in la = {0};
+            socklen_t len = sizeof(la);
+            if (getsockname(fd, (struct sockaddr *)&la, &len) == 0 && la.sin_addr.s_addr == keep_ip) continue;
+        }
+        shutdown(fd, SHUT_RDWR);
+        dropped++;
+    }
+    xSemaphoreGive(s_lock);
+    return dropped;
+}
+
+static bool listener_ok_locked(void) {
+    if (s_lfd < 0) return false;
+    int err = 0, acc = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(s_lfd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err) return false;
+    len = sizeof(acc);
+    if (getsockopt(s_lfd, SOL_SOCKET, SO_ACCEPTCONN, &acc, &len) < 0 || !acc) return false;
+    return true;
+}
 
+static void note_listen_time(void) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int64_t t0 = s_ip_wait_us;
+    s_ip_wait_us = 0;
+    xSemaphoreGive(s_lock);
+    if (!t0) return;
+    int64_t ms = (esp_timer_get_time() - t0) / 1000;
+    atomic_store(&s_ip_to_listen_ms, (int32_t)(ms < 0 ? 0 : ms));
+    ESP_LOGI(TAG, "Listening %d ms after got-IP.", (int)atomic_load(&s_ip_to_listen_ms));
+}
+
+static int listener_open(void) {
     int s = socket(AF_INET, SOCK_STREAM, 0);
     if (s < 0) {
         ESP_LOGE(TAG, "socket(): %d", errno);
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
 
     int one = 1;
@@ -55,33 +116,130 @@ static void server_task(void *pv) {
     if (bind(s, (struct sockaddr *)&a, sizeof(a)) < 0) {
         ESP_LOGE(TAG, "bind(): %d", errno);
         close(s);
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
     if (listen(s, 4) < 0) {
         ESP_LOGE(TAG, "listen(): %d", errno);
         close(s);
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
-    ESP_LOGI(TAG, "Listening on %d.", PORT);
+    return s;
+}
+
+static void listener_close(void) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_lfd >= 0) close(s_lfd);
+    s_lfd = -1;
+    xSemaphoreGive(s_lock);
+}
+
+static void server_task(void *pv) {
+    (void)pv;
 
     for (;;) {
-        int c = accept(s, NULL, NULL);
-        if (c >= 0) {
-            tcp_client_spawn(c);
-        } else {
+        if (atomic_exchange(&s_rebind, false)) {
+            ESP_LOGW(TAG, "Listener invalid; rebinding.");
+            listener_close();
+        }
+
+        if (s_lfd < 0) {
+            int s = listener_open();
+            if (s < 0) {
+                vTaskDelay(pdMS_TO_TICKS(TCP_REBIND_RETRY_MS));
+                continue;
+            }
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_lfd = s;
+            xSemaphoreGive(s_lock);
+            boottime_mark(BT_TCP_LISTEN);
+            ESP_LOGI(TAG, "Listening on %d.", PORT);
+            note_listen_time();
+        }
+
+        /* Bounded wait so a rebind request is picked up without a wakeup socket. */
+        fd_set rf;
+        FD_ZERO(&rf);
+        FD_SET(s_lfd, &rf);
+        struct timeval tv = { .tv_sec = 0, .tv_usec = TCP_LISTEN_POLL_MS * 1000 };
+        int r = select(s_lfd + 1, &rf, NULL, NULL, &tv);
+        if (r == 0) continue;
+        if (r < 0) {
+            if (errno != EINTR) {
+                ESP_LOGW(TAG, "select(): %d", errno);
+                atomic_store(&s_rebind, true);
+            }
+            continue;
+        }
+
+        int c = accept(s_lfd, NULL, NULL);
+        if (c < 0) {
             // Only log non-transient errors to avoid noise
             if (errno != EINTR && errno != EAGAIN) {
                 ESP_LOGW(TAG, "accept(): %d", errno);
             }
             vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+        boottime_mark(BT_TCP_ACCEPT);
+        if (!client_add(c)) {
+            ESP_LOGW(TAG, "Client table full (%d); refusing fd=%d.", TCP_MAX_CLIENTS, c);
+            close(c);
+            continue;
+        }
+        if (!tcp_client_spawn(c)) {
+            ESP_LOGE(TAG, "Client task create failed; closing fd=%d.", c);
+            tcp_on_client_disconnected(c);
+            close(c);
         }
     }
 
     // (not reached)
 }
 
-void launch_tcp_server(void) {
-    xTaskCreate(server_task, "tcp_srv", 4096, NULL, 4, NULL);
+void tcp_server_start(void) {
+    if (s_task) return;
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        configASSERT(s_lock);
+        for (int i = 0; i < TCP_MAX_CLIENTS; ++i) s_cli[i] = -1;
+    }
+    if (xTaskCreate(server_task, "tcp_srv", 4096, NULL, 4, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "Listener task create failed.");
+        s_task = NULL;
+    }
+}
+
+void tcp_server_on_ip(uint32_t ip) {
+    if (!s_lock) return;
+    int64_t t0 = esp_timer_get_time();
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool ok = listener_ok_locked();
+    s_ip_wait_us = ok ? 0 : t0;              // closed by note_listen_time() after the rebind
+    xSemaphoreGive(s_lock);
+
+    if (ok) {
+        /* Already bound to INADDR_ANY: the new address is served as-is. */
+        int64_t ms = (esp_timer_get_time() - t0) / 1000;
+        atomic_store(&s_ip_to_listen_ms, (int32_t)ms);
+        ESP_LOGI(TAG, "Listener valid at got-IP (%d ms).", (int)ms);
+    } else {
+        atomic_store(&s_rebind, true);
+    }
+
+    int n = drop_clients(ip);
+    if (n) ESP_LOGI(TAG, "Closed %d client(s) bound to the old address.", n);
+}
+
+void tcp_server_on_ip_lost(void) {
+    if (!s_lock) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_ip_wait_us = 0;
+    xSemaphoreGive(s_lock);
+    int n = drop_clients(0);
+    if (n) ESP_LOGI(TAG, "IP lost; closed %d client(s).", n);
+}
+
+int32_t tcp_server_ip_to_listen_ms(void) {
+    return atomic_load(&s_ip_to_listen_ms);
 }
@@ -4,7 +4,6 @@
 #include "freertos/FreeRTOS.h"
 #include "esp_event.h"
 #include "esp_log.h"
-#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "nvs.h"
@@ -12,46 +11,14 @@
 #include "app_cfg.h"
 #include "wifi.h"          // public API
 #include "wifi_priv.h"     // internal helpers
-#include "tcp_server.h"    // launch_tcp_server()
+#include "tcp_server.h"    // tcp_server_start()
 #include "errsrc.h"
 #include "monitor.h"
 #include "syscoord.h"
+#include "boottime.h"
 
 #define TAG "WIFI"
 
-static esp_timer_handle_t s_tcp_start_timer = NULL;
-
-/* --- TCP start timer plumbing (internal) --- */
-static void tcp_start_timer_cb(void *args) {
-    (void)args;
-    launch_tcp_server();
-    ESP_LOGI(TAG, "TCP server started after Got_IP settled.");
-}
-
-void wifi_tcp_timer_create_once(void) {
-    if (s_tcp_start_timer) return;
-    const esp_timer_create_args_t args = {
-        .callback = &tcp_start_timer_cb,
-        .name = "tcp_start_after_ip"
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&args, &s_tcp_start_timer));
-}
-
-bool wifi_tcp_timer_is_active(void) {
-    return s_tcp_start_timer && esp_timer_is_active(s_tcp_start_timer);
-}
-
-void wifi_tcp_timer_stop_if_active(void) {
-    if (s_tcp_start_timer && esp_timer_is_active(s_tcp_start_timer)) {
-        ESP_ERROR_CHECK(esp_timer_stop(s_tcp_start_timer));
-    }
-}
-
-void wifi_tcp_timer_schedule_us(uint64_t usec) {
-    if (!s_tcp_start_timer) return;
-    ESP_ERROR_CHECK(esp_timer_start_once(s_tcp_start_timer, usec));
-}
-
 /* --- Public API --- */
 void wifi_set_credentials(const char *ssid, const char *pwd) {
     nvs_handle_t h;
@@ -74,6 +41,13 @@ void wifi_set_credentials(const char *ssid, const char *pwd) {
     }
     ESP_LOGI(TAG, "Wi-Fi credentials saved: SSID=%s", ssid);
 
+    /* A different network invalidates the fast-link cache. */
+    wifi_config_t cur = {0};
+    if (esp_wifi_get_config(WIFI_IF_STA, &cur) == ESP_OK &&
+        strncmp((const char*)cur.sta.ssid, ssid, sizeof(cur.sta.ssid)) != 0) {
+        wifi_cache_forget();
+    }
+
     /* Apply new config and reconnect */
     esp_err_t de = esp_wifi_disconnect();
     if (de != ESP_OK && de != ESP_ERR_WIFI_NOT_STARTED && de != ESP_ERR_WIFI_NOT_INIT) {
@@ -86,12 +60,12 @@ void wifi_set_credentials(const char *ssid, const char *pwd) {
     sta_cfg.sta.threshold.authmode = strlen(pwd) ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &sta_cfg));
 
-    errsrc_set("TRYING");
+    errsrc_set_enum(ES_TRYING);
 
     /* start a fresh backoff-driven reconnect */
     wifi_backoff_stop_timer();
     wifi_backoff_reset();
-    wifi_backoff_schedule();
+    (void)wifi_backoff_schedule(ES_TRYING);
 }
 
 
@@ -103,8 +77,9 @@ void wifi_start(const char *ssid, const char *pwd) {
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-    wifi_tcp_timer_create_once();
+    /* Creds live in our own NVS namespace; keep per-attempt config changes out of flash. */
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    wifi_cache_load();
 
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
         WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_evt, NULL, NULL));
@@ -143,7 +118,10 @@ void wifi_start(const char *ssid, const char *pwd) {
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &sta_cfg));
+    /* Listener binds INADDR_ANY now and stays up across IP loss/changes. */
+    tcp_server_start();
     ESP_ERROR_CHECK(esp_wifi_start());
+    boottime_mark(BT_WIFI_STARTED);
     ESP_LOGI(TAG, "Wi-Fi driver started - waiting for IP …");
 }
 /* handlers are declared in wifi_priv.h and defined in wifi_event.c */
\ No newline at end of file
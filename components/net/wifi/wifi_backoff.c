@@ -6,58 +6,47 @@
 #include "esp_system.h"
 #include "app_cfg.h"
 #include "wifi_priv.h"
+#include "wifi_sched.h"
+#include "errsrc.h"
+#include "syscoord.h"
 
 #define TAG "WIFI"
 
-#define RECONN_BASE_MS WIFI_RECONN_BASE_MS
-#define RECONN_MAX_MS  WIFI_RECONN_MAX_MS
-
 static TimerHandle_t s_reconn_tmr;
-static int s_retries = 0;
+static wifi_sched_t s_sched = { .reason = ES_NONE };
 
 static void wifi_reconnect_timer_cb(TimerHandle_t xTimer) {
     (void)xTimer;
-    esp_err_t e = esp_wifi_connect();
-    if (e == ESP_ERR_WIFI_CONN) {
-        ESP_LOGW(TAG, "connect(): already connecting; will rely on events.");
-    } else if (e != ESP_OK) {
-        ESP_LOGE(TAG, "connect(): %s", esp_err_to_name(e));
-    } else {
-        ESP_LOGI(TAG, "connect(): requested.");
-    }
+    wifi_connect_attempt();   // directed to the cached AP first, full scan otherwise.
 }
 
 void wifi_backoff_reset(void) {
-    s_retries = 0;
+    wifi_sched_reset(&s_sched);
 }
 
 void wifi_backoff_stop_timer(void) {
     if (s_reconn_tmr) xTimerStop(s_reconn_tmr, 0);
 }
 
-void wifi_backoff_schedule(void) {
+bool wifi_backoff_schedule(errsrc_t reason) {
     if (!s_reconn_tmr) {
         s_reconn_tmr = xTimerCreate("wifi.reconn", pdMS_TO_TICKS(1000), pdFALSE, NULL, wifi_reconnect_timer_cb);
     }
-    uint32_t delay_ms = RECONN_BASE_MS << (s_retries < 6 ? s_retries : 6); // up to 32x
-    if (delay_ms > RECONN_MAX_MS) delay_ms = RECONN_MAX_MS;
-
-#if WIFI_RECONN_JITTER_PCT > 0
-    {
-        uint32_t span = (delay_ms * WIFI_RECONN_JITTER_PCT) / 100U; // e.g., 10%
-        if (span) {
-            uint32_t r   = esp_random();
-            int32_t  off = (int32_t)(r % span) - (int32_t)(span / 2U);
-            int32_t  d2  = (int32_t)delay_ms + off;
-            delay_ms = (uint32_t)((d2 < 0) ? 0 : d2);
-        }
-    }
-#endif
+    wifi_sched_decision_t d = wifi_sched_next(&s_sched, reason, esp_random());
+    TickType_t ticks = pdMS_TO_TICKS(d.delay_ms);
+    if (ticks == 0) ticks = 1;   /* xTimerChangePeriod rejects 0 */
 
     xTimerStop(s_reconn_tmr, 0);
-    xTimerChangePeriod(s_reconn_tmr, pdMS_TO_TICKS(delay_ms), 0);
+    xTimerChangePeriod(s_reconn_tmr, ticks, 0);
     xTimerStart(s_reconn_tmr, 0);
+    syscoord_on_wifi_attempt(d.delay_ms);
 
-    ESP_LOGI(TAG, "Will reconnect in %u ms (retry #%d).", (unsigned)delay_ms, s_retries);
-    s_retries++;
+    if (d.parked) {
+        ESP_LOGW(TAG, "Giving up on %s after %u tries; parked, next try in %u ms.",
+                 errsrc_to_string(reason), (unsigned)s_sched.attempts, (unsigned)d.delay_ms);
+    } else {
+        ESP_LOGI(TAG, "Will reconnect in %u ms (%s, failure #%u).",
+                 (unsigned)d.delay_ms, errsrc_to_string(reason), (unsigned)s_sched.fails);
+    }
+    return d.escalate;
 }
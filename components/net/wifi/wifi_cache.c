@@ -0,0 +1,149 @@
+// wifi_cache.c, last-good link cache (NVS) + directed/full-scan connect attempts.
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+
+#include "app_cfg.h"
+#include "wifi.h"
+#include "wifi_priv.h"
+#include "wifi_fast.h"
+#include "syscoord.h"
+
+#define TAG "WIFI"
+
+static wifi_fast_t s_fast;
+static portMUX_TYPE s_fast_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void cache_save(const wifi_fast_cache_t *c) {
+    nvs_handle_t h;
+    if (nvs_open(NVS_NS_WIFI, NVS_READWRITE, &h) != ESP_OK) return;
+    esp_err_t e = c ? nvs_set_blob(h, NVS_KEY_WIFI_FAST, c, sizeof(*c))
+                    : nvs_erase_key(h, NVS_KEY_WIFI_FAST);
+    if (e == ESP_OK || e == ESP_ERR_NVS_NOT_FOUND) e = nvs_commit(h);
+    nvs_close(h);
+    if (e != ESP_OK) ESP_LOGW(TAG, "fast-link cache save: %s", esp_err_to_name(e));
+}
+
+void wifi_cache_load(void) {
+    wifi_fast_cache_t c = {0};
+    size_t len = sizeof(c);
+    bool ok = false;
+
+    nvs_handle_t h;
+    if (nvs_open(NVS_NS_WIFI, NVS_READONLY, &h) == ESP_OK) {
+        ok = (nvs_get_blob(h, NVS_KEY_WIFI_FAST, &c, &len) == ESP_OK && len == sizeof(c));
+        nvs_close(h);
+    }
+
+    portENTER_CRITICAL(&s_fast_mux);
+    wifi_fast_init(&s_fast, ok ? &c : NULL);
+    ok = s_fast.cache_valid;
+    portEXIT_CRITICAL(&s_fast_mux);
+
+    if (ok) ESP_LOGI(TAG, "Fast-link cache: ch=%u bssid=" MACSTR, c.channel, MAC2STR(c.bssid));
+}
+
+void wifi_cache_forget(void) {
+    portENTER_CRITICAL(&s_fast_mux);
+    wifi_fast_forget(&s_fast);
+    portEXIT_CRITICAL(&s_fast_mux);
+    cache_save(NULL);
+}
+
+bool wifi_cache_fast_ready(void) {
+    wifi_config_t cfg = {0};
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return false;
+    char ssid[33] = {0};
+    memcpy(ssid, cfg.sta.ssid, sizeof(cfg.sta.ssid));
+
+    portENTER_CRITICAL(&s_fast_mux);
+    bool r = wifi_fast_ready(&s_fast, ssid);
+    portEXIT_CRITICAL(&s_fast_mux);
+    return r;
+}
+
+/* One connect attempt: directed to the cached AP if allowed, else a full scan. */
+void wifi_connect_attempt(void) {
+    wifi_config_t cfg = {0};
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+    char ssid[33] = {0};
+    memcpy(ssid, cfg.sta.ssid, sizeof(cfg.sta.ssid));
+
+    uint8_t bssid[6], ch;
+    portENTER_CRITICAL(&s_fast_mux);
+    wifi_path_t p = wifi_fast_next_attempt(&s_fast, ssid, esp_timer_get_time());
+    memcpy(bssid, s_fast.cache.bssid, sizeof(bssid));
+    ch = s_fast.cache.channel;
+    portEXIT_CRITICAL(&s_fast_mux);
+
+    if (p == WIFI_PATH_FAST) {
+        cfg.sta.bssid_set   = true;
+        memcpy(cfg.sta.bssid, bssid, sizeof(cfg.sta.bssid));
+        cfg.sta.channel     = ch;
+        cfg.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        cfg.sta.bssid_set   = false;
+        cfg.sta.channel     = 0;
+        cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    }
+    esp_err_t e = esp_wifi_set_config(WIFI_IF_STA, &cfg);
+    if (e != ESP_OK) ESP_LOGW(TAG, "set_config(%s): %s", p == WIFI_PATH_FAST ? "fast" : "slow", esp_err_to_name(e));
+
+    syscoord_on_wifi_attempt(0);   // immediate attempts bypass wifi_backoff_schedule()
+    e = esp_wifi_connect();
+    if (e == ESP_ERR_WIFI_CONN) {
+        ESP_LOGW(TAG, "connect(): already connecting; will rely on events.");
+    } else if (e != ESP_OK) {
+        ESP_LOGE(TAG, "connect(): %s", esp_err_to_name(e));
+    } else if (p == WIFI_PATH_FAST) {
+        ESP_LOGI(TAG, "connect(): directed to " MACSTR " ch=%u.", MAC2STR(bssid), ch);
+    } else {
+        ESP_LOGI(TAG, "connect(): requested (full scan).");
+    }
+}
+
+void wifi_cache_on_disconnect(void) {
+    portENTER_CRITICAL(&s_fast_mux);
+    wifi_fast_on_disconnect(&s_fast);
+    portEXIT_CRITICAL(&s_fast_mux);
+}
+
+void wifi_cache_on_got_ip(const esp_netif_ip_info_t *ipi) {
+    wifi_fast_cache_t c = {0};
+    wifi_ap_record_t ap;
+    bool have_ap = ipi && esp_wifi_sta_get_ap_info(&ap) == ESP_OK;
+    if (have_ap) {
+        c.channel = ap.primary;
+        memcpy(c.bssid, ap.bssid, sizeof(c.bssid));
+        memcpy(c.ssid, ap.ssid, sizeof(c.ssid) - 1);
+        c.ip      = ipi->ip.addr;
+        c.gw      = ipi->gw.addr;
+        c.netmask = ipi->netmask.addr;
+    }
+
+    uint32_t ms = 0;
+    bool changed = false, reused;
+    wifi_fast_cache_t save;
+    portENTER_CRITICAL(&s_fast_mux);
+    wifi_path_t p = wifi_fast_on_got_ip(&s_fast, esp_timer_get_time(), ipi ? ipi->ip.addr : 0, &ms);
+    reused = s_fast.lease_reused;
+    if (have_ap) changed = wifi_fast_learn(&s_fast, &c);
+    save = s_fast.cache;
+    portEXIT_CRITICAL(&s_fast_mux);
+
+    if (ms) {
+        ESP_LOGI(TAG, "Time-to-IP %u ms via %s path%s.", (unsigned)ms,
+                 p == WIFI_PATH_FAST ? "fast" : "slow", reused ? " (lease reused)" : "");
+    }
+    if (changed) cache_save(&save);
+}
+
+void wifi_get_fast_snapshot(wifi_fast_t *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_fast_mux);
+    *out = s_fast;
+    portEXIT_CRITICAL(&s_fast_mux);
+}
@@ -8,6 +8,9 @@
 #include "errsrc.h"
 #include "monitor.h"
 #include "gatt_server.h"
+#include "boottime.h"
+#include "app_cfg.h"
+#include "tcp_server.h"
 
 #include "wifi_priv.h"
 
@@ -31,6 +34,7 @@ static const char *wifi_event_name(int32_t id) {
 void got_ip(void *arg, esp_event_base_t base, int32_t id, void *data) {
     (void)arg; (void)base; (void)id;
     ip_event_got_ip_t *ev = (ip_event_got_ip_t *)data;
+    boottime_mark(BT_GOT_IP);
 
     char ip[16];
     snprintf(ip, sizeof(ip), IPSTR, IP2STR(&ev->ip_info.ip));
@@ -41,25 +45,22 @@ void got_ip(void *arg, esp_event_base_t base, int32_t id, void *data) {
     syscoord_on_wifi_state(true);
     ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&ev->ip_info.ip));
 
-    errsrc_set(NULL);
+    errsrc_clear();
     monitor_on_wifi_error(ES_NONE);
+    wifi_cache_on_got_ip(&ev->ip_info);
 
     /* reset backoff + stop any pending reconnect timer */
     wifi_backoff_reset();
     wifi_backoff_stop_timer();
 
-    if (!wifi_tcp_timer_is_active()) {
-        ESP_LOGI(TAG, "Scheduling TCP server start in 800 ms …");
-        wifi_tcp_timer_schedule_us(800000);
-    } else {
-        ESP_LOGI(TAG, "TCP server already started or timer not set.");
-    }
+    tcp_server_on_ip(ev->ip_info.ip.addr);
 }
 
 void got_ip_lost(void *arg, esp_event_base_t base, int32_t id, void *data) {
     (void)arg; (void)base; (void)id; (void)data;
 
     syscoord_on_wifi_state(false);
+    tcp_server_on_ip_lost();
 
     // Only post IP_LOST if we're not already in a specific Wi-Fi failure.
     errsrc_t cur_code = errsrc_get_code();
@@ -81,8 +82,9 @@ void wifi_evt(void *arg, esp_event_base_t base, int32_t id, void *data) {
         /* Only connect if we have an SSID configured */
         wifi_config_t cur = {0};
         if (esp_wifi_get_config(WIFI_IF_STA, &cur) == ESP_OK && cur.sta.ssid[0] != '\0') {
-            errsrc_set("SCANNING");
-            wifi_backoff_schedule();
+            errsrc_set_enum(ES_SCANNING);
+            if (wifi_cache_fast_ready()) wifi_connect_attempt();  // known AP: no need to wait.
+            else (void)wifi_backoff_schedule(ES_SCANNING);
         } else {
             errsrc_set_enum(ES_NO_CREDS);
             monitor_on_wifi_error(ES_NO_CREDS);
@@ -90,11 +92,12 @@ void wifi_evt(void *arg, esp_event_base_t base, int32_t id, void *data) {
         }
         return;
 
+    } else if (id == WIFI_EVENT_STA_CONNECTED) {
+        boottime_mark(BT_WIFI_ASSOC);
+        return;
+
     } else if (id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (wifi_tcp_timer_is_active()) {
-            ESP_LOGI(TAG, "Cancelling pending TCP start due to disconnect.");
-            wifi_tcp_timer_stop_if_active();
-        }
+        /* TCP sessions are kept: they survive a reconnect that gets the same IP. */
         syscoord_on_wifi_state(false);
 
         wifi_event_sta_disconnected_t *d = (wifi_event_sta_disconnected_t *)data;
@@ -111,9 +114,10 @@ void wifi_evt(void *arg, esp_event_base_t base, int32_t id, void *data) {
             default: err = ES_DISCONNECTED; break;
         }
         errsrc_set_enum(err);
-        monitor_on_wifi_error(err);
+        wifi_cache_on_disconnect();
 
-        wifi_backoff_schedule();
+        /* Policy decides both the retry delay and when this counts as a real failure. */
+        if (wifi_backoff_schedule(err)) monitor_on_wifi_error(err);
         return;
 
     } else if (id == WIFI_EVENT_STA_STOP) {
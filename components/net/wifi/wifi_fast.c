@@ -0,0 +1,87 @@
+// wifi_fast.c, fast-reconnect decisions (no driver calls; host-buildable).
+#include <string.h>
+#include "wifi_fast.h"
+
+static bool ssid_matches(const wifi_fast_cache_t *c, const char *ssid) {
+    return ssid && *ssid && strncmp(c->ssid, ssid, sizeof(c->ssid)) == 0;
+}
+
+static bool cache_equal(const wifi_fast_cache_t *a, const wifi_fast_cache_t *b) {
+    return a->channel == b->channel && memcmp(a->bssid, b->bssid, sizeof(a->bssid)) == 0 &&
+           strncmp(a->ssid, b->ssid, sizeof(a->ssid)) == 0 &&
+           a->ip == b->ip && a->gw == b->gw && a->netmask == b->netmask;
+}
+
+void wifi_fast_init(wifi_fast_t *f, const wifi_fast_cache_t *c_opt) {
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    if (c_opt && c_opt->ver == WIFI_FAST_CACHE_VER && c_opt->channel && c_opt->ssid[0]) {
+        f->cache = *c_opt;
+        f->cache.ssid[sizeof(f->cache.ssid) - 1] = '\0';
+        f->cache_valid = true;
+    }
+}
+
+bool wifi_fast_ready(const wifi_fast_t *f, const char *ssid) {
+    return f && f->cache_valid && f->fast_fails < WIFI_FAST_MAX_FAILS &&
+           ssid_matches(&f->cache, ssid);
+}
+
+wifi_path_t wifi_fast_next_attempt(wifi_fast_t *f, const char *ssid, int64_t now_us) {
+    if (!f) return WIFI_PATH_SLOW;
+    if (!f->cycle_start_us) f->cycle_start_us = now_us ? now_us : 1;
+    f->cur = wifi_fast_ready(f, ssid) ? WIFI_PATH_FAST : WIFI_PATH_SLOW;
+    return f->cur;
+}
+
+void wifi_fast_on_disconnect(wifi_fast_t *f) {
+    if (!f) return;
+    if (f->cur == WIFI_PATH_FAST && f->fast_fails < 0xFF) f->fast_fails++;
+    f->cur = WIFI_PATH_SLOW;
+}
+
+wifi_path_t wifi_fast_on_got_ip(wifi_fast_t *f, int64_t now_us, uint32_t ip, uint32_t *out_ms) {
+    if (out_ms) *out_ms = 0;
+    if (!f) return WIFI_PATH_SLOW;
+
+    wifi_path_t p = f->cur;
+    f->lease_reused = f->cache_valid && ip && ip == f->cache.ip;
+    if (f->cycle_start_us) {
+        int64_t d = (now_us - f->cycle_start_us) / 1000;
+        uint32_t ms = (d < 0) ? 0 : (d > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)d);
+        wifi_ttip_stat_t *s = &f->st[p];
+        if (!s->count || ms < s->min_ms) s->min_ms = ms;
+        if (ms > s->max_ms) s->max_ms = ms;
+        s->last_ms = ms;
+        s->count++;
+        if (out_ms) *out_ms = ms;
+    }
+    f->cycle_start_us = 0;
+    f->fast_fails = 0;
+    f->cur = WIFI_PATH_SLOW;   /* link is up: losing it later is no directed-connect failure */
+    return p;
+}
+
+bool wifi_fast_learn(wifi_fast_t *f, const wifi_fast_cache_t *c) {
+    if (!f || !c || !c->channel || !c->ssid[0]) return false;
+    wifi_fast_cache_t n;
+    memset(&n, 0, sizeof(n));   /* zero padding: the blob goes to NVS as-is */
+    n.ver = WIFI_FAST_CACHE_VER;
+    n.channel = c->channel;
+    memcpy(n.bssid, c->bssid, sizeof(n.bssid));
+    strncpy(n.ssid, c->ssid, sizeof(n.ssid) - 1);
+    n.ip = c->ip; n.gw = c->gw; n.netmask = c->netmask;
+
+    bool changed = !f->cache_valid || !cache_equal(&f->cache, &n);
+    f->cache = n;
+    f->cache_valid = true;
+    f->fast_fails = 0;
+    return changed;
+}
+
+void wifi_fast_forget(wifi_fast_t *f) {
+    if (!f) return;
+    memset(&f->cache, 0, sizeof(f->cache));
+    f->cache_valid = false;
+    f->fast_fails = 0;
+}
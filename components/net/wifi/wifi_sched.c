@@ -0,0 +1,94 @@
+// wifi_sched.c, policy table + decorrelated jitter (no driver calls; host-buildable).
+#include <string.h>
+#include "app_cfg.h"
+#include "wifi_sched.h"
+
+#define BASE WIFI_RECONN_BASE_MS
+#define CAP  WIFI_RECONN_MAX_MS
+
+/* fast_ms, fast_retries, escalate_after, base_ms, cap_ms, give_up */
+static const wifi_sched_policy_t s_default =
+    { 200, 1, 2, BASE, CAP, 0 };
+
+static const wifi_sched_policy_t s_pol[ES_COUNT] = {
+    /* Link-layer blips: the AP is usually still there. Retry fast, escalate late. */
+    [ES_BEACON_TO]    = { 100, 2, 3, BASE,     CAP / 2,  0 },
+    [ES_DISCONNECTED] = { 200, 1, 2, BASE,     CAP,      0 },
+    [ES_ASSOC_EXPIRE] = { 200, 1, 2, BASE * 2, CAP,      0 },
+    [ES_AUTH_EXPIRE]  = { 200, 1, 2, BASE * 2, CAP,      0 },
+    [ES_IP_LOST]      = { 100, 1, 2, BASE,     CAP,      0 },
+    /* AP missing: radio time is wasted until it returns. */
+    [ES_NO_AP]        = {   0, 0, 1, BASE * 4, CAP * 2,  0 },
+    /* Credentials problems: retrying hard will not fix them. */
+    [ES_4WAY_TIMEOUT] = {   0, 0, 1, BASE * 4, CAP * 2,  8 },
+    [ES_AUTH_FAIL]    = {   0, 0, 1, BASE * 10, CAP * 4, 4 },
+    /* First attempt after start / new credentials: go now. Not failures (fast_ms only). */
+    [ES_SCANNING]     = { 100, 1, 0, BASE,     CAP,      0 },
+    [ES_TRYING]       = { 100, 1, 0, BASE,     CAP,      0 },
+};
+
+const wifi_sched_policy_t *wifi_sched_policy(errsrc_t reason) {
+    if ((unsigned)reason < ES_COUNT && s_pol[reason].base_ms) return &s_pol[reason];
+    return &s_default;
+}
+
+void wifi_sched_reset(wifi_sched_t *s) {
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    s->reason = ES_NONE;
+}
+
+/* Short fixed delay with up to +50% jitter. */
+static uint32_t fast_delay(const wifi_sched_policy_t *p, uint32_t rnd) {
+    return p->fast_ms + (p->fast_ms ? rnd % (p->fast_ms / 2U + 1U) : 0);
+}
+
+wifi_sched_decision_t wifi_sched_next(wifi_sched_t *s, errsrc_t reason, uint32_t rnd) {
+    wifi_sched_decision_t d = { 0 };
+    if (!s) return d;
+
+    if (reason == ES_SCANNING || reason == ES_TRYING) {
+        d.delay_ms = fast_delay(wifi_sched_policy(reason), rnd);
+        return d;
+    }
+
+    /* A different reason switches the policy row; the failure count carries on. Reasons
+     * that can give up (credential failures) share the give-up count, since a wrong key
+     * may show up as AUTH_FAIL and 4WAY_TIMEOUT in turn. */
+    if (reason != s->reason) {
+        bool keep = wifi_sched_policy(reason)->give_up && wifi_sched_policy(s->reason)->give_up;
+        s->reason = reason;
+        if (!keep) {
+            s->attempts = 0;
+            s->parked = false;
+        }
+    }
+    const wifi_sched_policy_t *p = wifi_sched_policy(reason);
+    if (s->attempts < 0xFFFF) s->attempts++;
+    if (s->fails < 0xFFFF) s->fails++;
+
+    d.escalate = p->escalate_after && s->fails >= p->escalate_after;
+
+    if (p->give_up && s->attempts >= p->give_up) {
+        s->parked = true;
+        d.parked = true;
+        d.delay_ms = WIFI_RECONN_PARK_MS;
+        return d;
+    }
+
+    if (s->fails <= p->fast_retries) {   /* transient */
+        d.delay_ms = fast_delay(p, rnd);
+        return d;
+    }
+
+    /* Decorrelated jitter: uniform in [base, 3 * prev], clamped to cap. prev may come
+     * from another reason's row. */
+    uint32_t prev = s->prev_ms ? s->prev_ms : p->base_ms;
+    uint64_t hi = (uint64_t)prev * 3U;
+    if (hi > p->cap_ms) hi = p->cap_ms;
+    uint32_t span = (hi > p->base_ms) ? (uint32_t)(hi - p->base_ms) : 0;
+    d.delay_ms = p->base_ms + (span ? rnd % (span + 1U) : 0);
+    if (d.delay_ms > p->cap_ms) d.delay_ms = p->cap_ms;
+    s->prev_ms = d.delay_ms;
+    return d;
+}
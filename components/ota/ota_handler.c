@@ -129,7 +129,7 @@ esp_err_t ota_perform(int client_fd, uint32_t image_size) {
 }
 
 /* BLE xport compatibility API kept the same, just delegating to session. */
-static ota_session_t s_ble;  /* Single BLE session. */
+static ota_session_t s_ble;  /* Single BLE session; ble_ota.c serializes the xport calls. */
 
 esp_err_t ota_begin_xport(size_t total_size, uint32_t crc32_expect, const char *source) {
     ota_session_crc_init();
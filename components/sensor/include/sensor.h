@@ -0,0 +1,98 @@
+// sensor.h, sensor registry + one shared sampler task for every driver.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sensor_filter.h"
+#include "sensor_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SENSOR_MAX
+#define SENSOR_MAX 4                // registered drivers (<= SENSOR_WHEEL_IDS)
+#endif
+#ifndef SENSOR_MAX_SUBSCRIBERS
+#define SENSOR_MAX_SUBSCRIBERS 4    // callbacks per sensor
+#endif
+#ifndef SENSOR_TICK_MS
+#define SENSOR_TICK_MS 100          // scheduler granularity; periods round up to it
+#endif
+#define SENSOR_RAW_MAX    16
+
+// Per-sensor read quality. The scheduler counts reads/ok/outliers; drivers the rest.
+typedef struct {
+    uint32_t reads;      // scheduled reads
+    uint32_t ok;         // valid records published
+    uint32_t retries;    // extra bus attempts inside reads
+    uint32_t to_resp;    // timeouts: no response at all
+    uint32_t to_ack;     // timeouts: response handshake incomplete
+    uint32_t to_data;    // timeouts: data phase cut short or mistimed
+    uint32_t csum;       // checksum failures
+    uint32_t range;      // decoded but implausible (rejected, never clamped)
+    uint32_t outliers;   // rejected by the outlier filter
+} sensor_quality_t;
+
+// Driver vtable. read/decode run in the scheduler task (and own *q there); the rest in the caller.
+typedef struct {
+    const char *name;                   // registry key and reply prefix ("DHT")
+    uint32_t min_period_ms;             // hardware floor between reads
+    esp_err_t (*init)(void *ctx);       // claim pins/buses (from sensor_register)
+    esp_err_t (*start)(void *ctx);      // optional, once the scheduler runs
+    bool (*read)(void *ctx, sensor_quality_t *q, uint8_t *raw, size_t cap, size_t *len);  // one bus transaction
+    bool (*decode)(void *ctx, sensor_quality_t *q, const uint8_t *raw, size_t len, sensor_rec_t *out);
+} sensor_driver_t;
+
+// Called from the scheduler task after every read (valid or not), outside any lock.
+typedef void (*sensor_cb_t)(const sensor_rec_t *r, void *arg);
+
+// Register a driver (calls drv->init); returns its id or -1. period_ms is the default.
+int sensor_register(const sensor_driver_t *drv, void *ctx, uint32_t period_ms);
+
+// Start the scheduler task (idempotent).
+esp_err_t sensor_start(void);
+
+// Registered drivers; ids are 0..count-1.
+int sensor_count(void);
+
+// Id by driver name, or -1.
+int sensor_find(const char *name);
+const char *sensor_name(int id);
+
+// Copy the latest record (non-blocking); false for an unknown id.
+bool sensor_latest(int id, sensor_rec_t *out);
+
+// Periodic sampling on/off; every_ms == 0 keeps the current period.
+void sensor_set_stream(int id, bool on, uint32_t every_ms);
+
+// Keep a sensor sampling for an owner outside sensor_set_stream(). One bit per owner:
+// low byte per driver (e.g. DHT_HOLD_BLE), the rest shared.
+#define SENSOR_HOLD_LOG (1u << 8)   // flash time-series logger
+void sensor_hold(int id, uint32_t owner_bit, bool on);
+
+// One read as soon as the driver's spacing floor allows. Requests made before it
+// completes share it (including one already on the bus); watch for seq to advance.
+void sensor_request(int id);
+
+// Sampling state (stream or any hold) and period; either out may be NULL.
+void sensor_get_stream(int id, bool *on, uint32_t *every_ms);
+
+// Copy the quality counters (a torn read is harmless).
+void sensor_get_quality(int id, sensor_quality_t *out);
+
+// Outlier filter for valid reads (median-of-N, rate-of-change); all-zero = off.
+// Takes effect at the next read and restarts the filter's history.
+void sensor_set_filter(int id, const sensor_filter_cfg_t *cfg);
+void sensor_get_filter(int id, sensor_filter_cfg_t *out);
+
+bool sensor_subscribe(int id, sensor_cb_t cb, void *arg);
+void sensor_unsubscribe(int id, sensor_cb_t cb, void *arg);
+
+// "<name> T=23.4C RH=45.0%" or "<name> NA"; returns chars written (snprintf-clamped).
+int sensor_format(const sensor_rec_t *r, char *buf, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
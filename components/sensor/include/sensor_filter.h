@@ -0,0 +1,47 @@
+// sensor_filter.h, outlier filter for sensor records (internal).
+// Plain C, no RTOS calls: runs in the scheduler but replays on a host.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_FILTER_VALUES 4   // == SENSOR_MAX_VALUES
+#define SENSOR_MEDIAN_MAX    7
+
+/* Consecutive rate rejections after which the next out-of-rate value is accepted as a
+ * real level (a genuine step, e.g. the sensor was moved), re-seeding the filter. */
+#ifndef SENSOR_ROC_REJECT_MAX
+#define SENSOR_ROC_REJECT_MAX 3
+#endif
+
+typedef struct {
+    uint8_t  median_n;                          // window, odd, <= SENSOR_MEDIAN_MAX (<= 1 = off)
+    uint32_t roc_per_s[SENSOR_FILTER_VALUES];   // max |change| per second vs last accepted (0 = off)
+} sensor_filter_cfg_t;
+
+typedef struct {
+    sensor_filter_cfg_t cfg;
+    int32_t  win[SENSOR_FILTER_VALUES][SENSOR_MEDIAN_MAX];
+    uint8_t  fill, pos;          // median window occupancy / next slot
+    bool     have_last;
+    int32_t  last[SENSOR_FILTER_VALUES];   // last accepted raw values
+    uint32_t last_ms;
+    uint8_t  rejects;            // consecutive rate rejections
+} sensor_filter_t;
+
+/* Clamp a config to the limits above (median window odd, <= SENSOR_MEDIAN_MAX). */
+void sensor_filter_normalize(sensor_filter_cfg_t *cfg);
+
+/* Reset with a new config (normalized). */
+void sensor_filter_init(sensor_filter_t *f, const sensor_filter_cfg_t *cfg);
+
+/* One valid reading of n values at t_ms. Returns false if it is a rate outlier;
+ * otherwise v[] is replaced by the median of the window and true is returned. */
+bool sensor_filter_step(sensor_filter_t *f, int32_t *v, unsigned n, uint32_t t_ms);
+
+#ifdef __cplusplus
+}
+#endif
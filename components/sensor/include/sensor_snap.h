@@ -0,0 +1,29 @@
+// sensor_snap.h, latest-record snapshot: double buffer + generation (internal).
+// Plain C11 atomics, no RTOS calls; host-buildable.
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+#include "sensor_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single writer. The writer fills the unpublished slot and bumps gen; readers copy
+ * the published slot and retry only if a publish completed meanwhile, so they never
+ * block, spin on a preempted writer, or mask interrupts. Zero-initialised is valid
+ * (buf[0] published). */
+typedef struct {
+    sensor_rec_t buf[2];
+    _Atomic uint32_t gen;   /* buf[gen & 1] is published */
+} sensor_snap_t;
+
+/* Writer side; one task only. */
+void sensor_snap_publish(sensor_snap_t *sn, const sensor_rec_t *r);
+
+/* Any number of readers, any core. */
+void sensor_snap_read(sensor_snap_t *sn, sensor_rec_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+// sensor_types.h, the common sample record.
+// Plain C, no ESP-IDF headers: shared by the registry (sensor.h) and sensor_snap.c.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SENSOR_MAX_VALUES 4
+
+// What a record value measures; all fixed-point tenths.
+typedef enum {
+    SENSOR_Q_NONE = 0,
+    SENSOR_Q_TEMP_DC,    // tenths of °C
+    SENSOR_Q_RH_DP,      // tenths of %RH
+} sensor_qty_t;
+
+// One sample in the common format.
+typedef struct {
+    uint8_t  id;                        // registry id
+    bool     valid;
+    uint8_t  n;                         // values in use (0 when invalid)
+    uint8_t  qty[SENSOR_MAX_VALUES];    // sensor_qty_t per value
+    int32_t  v[SENSOR_MAX_VALUES];
+    uint32_t seq;                       // reads since boot
+    uint32_t t_ms;                      // capture time, ms since boot
+    uint32_t age_ms;                    // filled by sensor_latest()
+} sensor_rec_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+// sensor_wheel.h, hashed timer wheel for the sensor scheduler (internal).
+// Plain C, no RTOS calls: the scheduler feeds it tick numbers, so schedules replay on a host.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Slots must be a power of two; ids index a 32-bit mask. */
+#define SENSOR_WHEEL_SLOTS 32
+#define SENSOR_WHEEL_IDS   32
+
+/* Each armed id sits in slot (due % SLOTS) with its absolute due tick, so one
+ * expire() pass services every id due on the same tick together. Ticks wrap. */
+typedef struct {
+    uint32_t slot[SENSOR_WHEEL_SLOTS];   // id bitmask per slot
+    uint32_t due[SENSOR_WHEEL_IDS];      // absolute due tick per armed id
+    uint32_t armed;                      // id bitmask
+    uint32_t now;                        // last tick expired up to
+} sensor_wheel_t;
+
+void sensor_wheel_init(sensor_wheel_t *w, uint32_t now);
+
+/* (Re)arm `id` for tick `due`; a due tick in the past fires on the next expire(). */
+void sensor_wheel_arm(sensor_wheel_t *w, unsigned id, uint32_t due);
+void sensor_wheel_disarm(sensor_wheel_t *w, unsigned id);
+bool sensor_wheel_armed(const sensor_wheel_t *w, unsigned id);
+
+/* Advance to `now`; returns the ids due by then (disarmed). */
+uint32_t sensor_wheel_expire(sensor_wheel_t *w, uint32_t now);
+
+/* Earliest due tick among armed ids; false if none are armed. */
+bool sensor_wheel_next(const sensor_wheel_t *w, uint32_t *out_due);
+
+/* First tick on the `period` grid that is >= `earliest` (period 0 = earliest). Aligning
+ * every sensor to the same grid makes harmonic periods land on shared wakeups. */
+uint32_t sensor_wheel_align(uint32_t earliest, uint32_t period);
+
+#ifdef __cplusplus
+}
+#endif
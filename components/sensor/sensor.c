@@ -0,0 +1,394 @@
+// components/sensor/sensor.c
+#include <string.h>
+#include <stdio.h>
+#include "sensor.h"
+#include "sensor_snap.h"
+#include "sensor_wheel.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/portmacro.h"
+
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "SENSOR";
+
+_Static_assert(SENSOR_MAX <= SENSOR_WHEEL_IDS, "SENSOR_MAX exceeds the wheel id mask");
+_Static_assert(SENSOR_MAX_VALUES == SENSOR_FILTER_VALUES, "filter width != record width");
+
+#define SENSOR_TASK_STACK 3072
+#define SENSOR_TASK_PRIO  4
+
+typedef struct {
+    sensor_cb_t cb;
+    void *arg;
+} sensor_sub_t;
+
+typedef struct {
+    const sensor_driver_t *drv;
+    void *ctx;
+
+    /* Control state; written under s_mux, consumed by the scheduler. */
+    bool stream_on;
+    uint32_t hold;           // owner bits
+    bool want;               // one-shot read requested (sensor_request)
+    uint32_t period_ms;
+    sensor_filter_cfg_t filt_cfg;
+    bool filt_new;           // filt_cfg changed since the scheduler last looked
+
+    sensor_sub_t subs[SENSOR_MAX_SUBSCRIBERS];   // under s_mux
+    sensor_snap_t snap;
+
+    /* Scheduler-owned. */
+    sensor_quality_t q;      // readers copy without a lock
+    sensor_filter_t filt;
+    uint32_t seq;
+    uint32_t last_tick;      // wheel tick of the last read
+    bool ever_read;
+} sensor_t;
+
+static sensor_t s_sen[SENSOR_MAX];
+static unsigned s_count;
+static uint32_t s_dirty;         // ids whose control state changed (under s_mux)
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task;
+static sensor_wheel_t s_wheel;   // scheduler-owned
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static uint32_t now_tick(void) {
+    return (uint32_t)(esp_timer_get_time() / (SENSOR_TICK_MS * 1000LL));
+}
+
+static uint32_t ms_to_ticks_up(uint32_t ms) {
+    uint32_t t = (ms + SENSOR_TICK_MS - 1U) / SENSOR_TICK_MS;
+    return t ? t : 1U;
+}
+
+static sensor_t *get(int id) {
+    return (id >= 0 && (unsigned)id < s_count) ? &s_sen[id] : NULL;
+}
+
+static void mark_dirty(unsigned id) {
+    s_dirty |= 1U << id;   /* caller holds s_mux */
+}
+
+static void kick(void) {
+    if (s_task) xTaskNotifyGive(s_task);
+}
+
+/* ---------- Scheduler task ---------- */
+
+/* Next due tick after a read at `from`: the first point on the period grid that
+ * also honours the driver's spacing floor. */
+static uint32_t next_due(const sensor_t *s, uint32_t from, uint32_t period_ms) {
+    uint32_t min_ms = s->drv->min_period_ms;
+    if (period_ms < min_ms) period_ms = min_ms;
+    return sensor_wheel_align(from + ms_to_ticks_up(min_ms), ms_to_ticks_up(period_ms));
+}
+
+static void sample(unsigned id, uint32_t tick) {
+    sensor_t *s = &s_sen[id];
+    uint8_t raw[SENSOR_RAW_MAX];
+    size_t len = 0;
+    sensor_rec_t r;
+    memset(&r, 0, sizeof(r));
+
+    s->q.reads++;
+    bool ok = s->drv->read(s->ctx, &s->q, raw, sizeof(raw), &len) &&
+              s->drv->decode(s->ctx, &s->q, raw, len, &r);
+    if (!ok || r.n > SENSOR_MAX_VALUES) r.n = 0;
+    r.t_ms = now_ms();
+
+    portENTER_CRITICAL(&s_mux);
+    bool refilt = s->filt_new;
+    sensor_filter_cfg_t fc = s->filt_cfg;
+    s->filt_new = false;
+    portEXIT_CRITICAL(&s_mux);
+    if (refilt) sensor_filter_init(&s->filt, &fc);
+
+    /* Failed reads leave the filter alone: a dropout is not a level. */
+    if (r.n && !sensor_filter_step(&s->filt, r.v, r.n, r.t_ms)) {
+        s->q.outliers++;
+        r.n = 0;
+    }
+    r.id = (uint8_t)id;
+    r.valid = ok && r.n;
+    if (r.valid) s->q.ok++;
+    r.seq = ++s->seq;
+    /* Requests made while the bus was busy are served by this read. */
+    portENTER_CRITICAL(&s_mux);
+    s->want = false;
+    portEXIT_CRITICAL(&s_mux);
+    s->last_tick = tick;
+    s->ever_read = true;
+    sensor_snap_publish(&s->snap, &r);
+
+    sensor_sub_t subs[SENSOR_MAX_SUBSCRIBERS];
+    portENTER_CRITICAL(&s_mux);
+    memcpy(subs, s->subs, sizeof(subs));
+    portEXIT_CRITICAL(&s_mux);
+    for (unsigned i = 0; i < SENSOR_MAX_SUBSCRIBERS; ++i) {
+        if (subs[i].cb) subs[i].cb(&r, subs[i].arg);
+    }
+}
+
+/* Apply control changes: arm newly active sensors, drop idle ones, re-grid on a new period. */
+static void apply_dirty(uint32_t tick) {
+    portENTER_CRITICAL(&s_mux);
+    uint32_t dirty = s_dirty;
+    s_dirty = 0;
+    portEXIT_CRITICAL(&s_mux);
+
+    for (unsigned id = 0; dirty; ++id, dirty >>= 1) {
+        if (!(dirty & 1U)) continue;
+        sensor_t *s = &s_sen[id];
+        portENTER_CRITICAL(&s_mux);
+        bool active = s->stream_on || s->hold;
+        bool want = s->want;
+        uint32_t period = s->period_ms;
+        portEXIT_CRITICAL(&s_mux);
+
+        if (!active && !want) {
+            sensor_wheel_disarm(&s_wheel, id);
+        } else if (!s->ever_read) {
+            sensor_wheel_arm(&s_wheel, id, tick);
+        } else {
+            /* Read now if the floor allows, else at the first legal point: the period
+             * grid for streams, the bare spacing floor for a one-shot request. */
+            uint32_t floor_t = s->last_tick + ms_to_ticks_up(s->drv->min_period_ms);
+            uint32_t due = ((int32_t)(floor_t - tick) <= 0) ? tick
+                         : active ? next_due(s, s->last_tick, period) : floor_t;
+            if (!sensor_wheel_armed(&s_wheel, id) || (int32_t)(due - s_wheel.due[id]) < 0)
+                sensor_wheel_arm(&s_wheel, id, due);
+        }
+    }
+}
+
+static void sensor_task(void *pv) {
+    (void)pv;
+    sensor_wheel_init(&s_wheel, now_tick());
+
+    for (;;) {
+        uint32_t tick = now_tick();
+        apply_dirty(tick);
+
+        uint32_t due = sensor_wheel_expire(&s_wheel, tick);
+        for (unsigned id = 0; due; ++id, due >>= 1) {
+            if (!(due & 1U)) continue;
+            sample(id, tick);
+
+            sensor_t *s = &s_sen[id];
+            portENTER_CRITICAL(&s_mux);
+            bool active = s->stream_on || s->hold;
+            bool want = s->want;   /* asked for after this read was captured */
+            uint32_t period = s->period_ms;
+            portEXIT_CRITICAL(&s_mux);
+            if (active)    sensor_wheel_arm(&s_wheel, id, next_due(s, tick, period));
+            else if (want) sensor_wheel_arm(&s_wheel, id, tick + ms_to_ticks_up(s->drv->min_period_ms));
+        }
+
+        uint32_t next;
+        TickType_t wait = portMAX_DELAY;
+        if (sensor_wheel_next(&s_wheel, &next)) {
+            int64_t left_us = (int64_t)next * SENSOR_TICK_MS * 1000LL - esp_timer_get_time();
+            wait = (left_us <= 0) ? 0 : (TickType_t)((left_us / 1000 + portTICK_PERIOD_MS) / portTICK_PERIOD_MS);
+        }
+        if (wait) ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+/* ---------- Public API ---------- */
+int sensor_register(const sensor_driver_t *drv, void *ctx, uint32_t period_ms) {
+    if (!drv || !drv->name || !drv->read || !drv->decode) return -1;
+    if (sensor_find(drv->name) >= 0) {
+        ESP_LOGE(TAG, "%s already registered", drv->name);
+        return -1;
+    }
+
+    if (s_count >= SENSOR_MAX) {
+        ESP_LOGE(TAG, "registry full (%u), %s dropped", (unsigned)SENSOR_MAX, drv->name);
+        return -1;
+    }
+    if (drv->init) {
+        esp_err_t e = drv->init(ctx);
+        if (e != ESP_OK) {
+            ESP_LOGE(TAG, "%s init: %s", drv->name, esp_err_to_name(e));
+            return -1;
+        }
+    }
+
+    /* Fill the entry before bumping s_count so the task never sees it half-built. */
+    portENTER_CRITICAL(&s_mux);
+    int id = (int)s_count;
+    sensor_t *s = &s_sen[id];
+    memset(s, 0, sizeof(*s));
+    s->drv = drv;
+    s->ctx = ctx;
+    s->period_ms = period_ms > drv->min_period_ms ? period_ms : drv->min_period_ms;
+    s->snap.buf[0] = (sensor_rec_t){ .id = (uint8_t)id, .t_ms = now_ms() };
+    s_count++;
+    portEXIT_CRITICAL(&s_mux);
+
+    if (s_task && drv->start) drv->start(ctx);
+    ESP_LOGI(TAG, "%s registered as #%d (period %u ms)", drv->name, id, (unsigned)s->period_ms);
+    return id;
+}
+
+esp_err_t sensor_start(void) {
+    if (s_task) return ESP_OK;
+    for (unsigned i = 0; i < s_count; ++i) {
+        if (s_sen[i].drv->start) s_sen[i].drv->start(s_sen[i].ctx);
+    }
+    if (xTaskCreate(sensor_task, "sensor.sched", SENSOR_TASK_STACK, NULL,
+                    SENSOR_TASK_PRIO, &s_task) != pdPASS)
+        return ESP_FAIL;
+    return ESP_OK;
+}
+
+int sensor_count(void) {
+    return (int)s_count;
+}
+
+int sensor_find(const char *name) {
+    if (!name) return -1;
+    for (unsigned i = 0; i < s_count; ++i) {
+        if (strcmp(s_sen[i].drv->name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+const char *sensor_name(int id) {
+    sensor_t *s = get(id);
+    return s ? s->drv->name : "?";
+}
+
+bool sensor_latest(int id, sensor_rec_t *out) {
+    sensor_t *s = get(id);
+    if (!s || !out) return false;
+    sensor_snap_read(&s->snap, out);
+    out->age_ms = now_ms() - out->t_ms;
+    return true;
+}
+
+void sensor_set_stream(int id, bool on, uint32_t every_ms) {
+    sensor_t *s = get(id);
+    if (!s) return;
+    portENTER_CRITICAL(&s_mux);
+    s->stream_on = on;
+    if (every_ms) s->period_ms = every_ms;
+    mark_dirty((unsigned)id);
+    portEXIT_CRITICAL(&s_mux);
+    kick();
+}
+
+void sensor_hold(int id, uint32_t owner_bit, bool on) {
+    sensor_t *s = get(id);
+    if (!s) return;
+    portENTER_CRITICAL(&s_mux);
+    uint32_t prev = s->hold;
+    s->hold = on ? (prev | owner_bit) : (prev & ~owner_bit);
+    bool changed = (!prev) != (!s->hold);
+    if (changed) mark_dirty((unsigned)id);
+    portEXIT_CRITICAL(&s_mux);
+    if (changed) kick();
+}
+
+void sensor_request(int id) {
+    sensor_t *s = get(id);
+    if (!s) return;
+    portENTER_CRITICAL(&s_mux);
+    bool first = !s->want;
+    s->want = true;
+    if (first) mark_dirty((unsigned)id);
+    portEXIT_CRITICAL(&s_mux);
+    if (first) kick();
+}
+
+void sensor_get_quality(int id, sensor_quality_t *out) {
+    sensor_t *s = get(id);
+    if (!out) return;
+    if (s) *out = s->q;
+    else   memset(out, 0, sizeof(*out));
+}
+
+void sensor_set_filter(int id, const sensor_filter_cfg_t *cfg) {
+    sensor_t *s = get(id);
+    if (!s) return;
+    portENTER_CRITICAL(&s_mux);
+    if (cfg) s->filt_cfg = *cfg;
+    else     memset(&s->filt_cfg, 0, sizeof(s->filt_cfg));
+    sensor_filter_normalize(&s->filt_cfg);
+    s->filt_new = true;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void sensor_get_filter(int id, sensor_filter_cfg_t *out) {
+    sensor_t *s = get(id);
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    if (s) *out = s->filt_cfg;
+    else   memset(out, 0, sizeof(*out));
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void sensor_get_stream(int id, bool *on, uint32_t *every_ms) {
+    sensor_t *s = get(id);
+    portENTER_CRITICAL(&s_mux);
+    if (on) *on = s && (s->stream_on || s->hold);
+    if (every_ms) *every_ms = s ? s->period_ms : 0;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool sensor_subscribe(int id, sensor_cb_t cb, void *arg) {
+    sensor_t *s = get(id);
+    if (!s || !cb) return false;
+    bool ok = false;
+    portENTER_CRITICAL(&s_mux);
+    for (unsigned i = 0; i < SENSOR_MAX_SUBSCRIBERS; ++i) {
+        if (s->subs[i].cb == cb && s->subs[i].arg == arg) { ok = true; break; }
+    }
+    for (unsigned i = 0; !ok && i < SENSOR_MAX_SUBSCRIBERS; ++i) {
+        if (!s->subs[i].cb) { s->subs[i] = (sensor_sub_t){ cb, arg }; ok = true; }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return ok;
+}
+
+void sensor_unsubscribe(int id, sensor_cb_t cb, void *arg) {
+    sensor_t *s = get(id);
+    if (!s) return;
+    portENTER_CRITICAL(&s_mux);
+    for (unsigned i = 0; i < SENSOR_MAX_SUBSCRIBERS; ++i) {
+        if (s->subs[i].cb == cb && s->subs[i].arg == arg) s->subs[i] = (sensor_sub_t){ 0 };
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+/* ---------- Formatting ---------- */
+static int put_tenths(char *b, size_t n, const char *key, int32_t v, const char *unit) {
+    const char *sign = v < 0 ? "-" : "";
+    uint32_t a = (uint32_t)(v < 0 ? -v : v);
+    return snprintf(b, n, " %s=%s%u.%u%s", key, sign, (unsigned)(a / 10), (unsigned)(a % 10), unit);
+}
+
+int sensor_format(const sensor_rec_t *r, char *buf, size_t n) {
+    if (!buf || !n) return 0;
+    const char *name = r ? sensor_name(r->id) : "?";
+    size_t w = (size_t)snprintf(buf, n, "%s", name);
+    if (!r || !r->valid) {
+        if (w < n) w += (size_t)snprintf(buf + w, n - w, " NA");
+        return (int)(w < n ? w : n - 1);
+    }
+    for (unsigned i = 0; i < r->n && w < n; ++i) {
+        switch (r->qty[i]) {
+        case SENSOR_Q_TEMP_DC: w += (size_t)put_tenths(buf + w, n - w, "T", r->v[i], "C"); break;
+        case SENSOR_Q_RH_DP:   w += (size_t)put_tenths(buf + w, n - w, "RH", r->v[i], "%"); break;
+        default:               w += (size_t)snprintf(buf + w, n - w, " v%u=%d", i, (int)r->v[i]); break;
+        }
+    }
+    return (int)(w < n ? w : n - 1);
+}
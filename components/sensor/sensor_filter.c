@@ -0,0 +1,69 @@
+// sensor_filter.c, median-of-N + rate-of-change rejection (no RTOS calls; host-buildable).
+#include <string.h>
+#include "sensor_filter.h"
+
+void sensor_filter_normalize(sensor_filter_cfg_t *cfg) {
+    if (!cfg) return;
+    if (cfg->median_n > SENSOR_MEDIAN_MAX) cfg->median_n = SENSOR_MEDIAN_MAX;
+    if (cfg->median_n && !(cfg->median_n & 1U)) cfg->median_n--;   /* odd: a real middle */
+}
+
+void sensor_filter_init(sensor_filter_t *f, const sensor_filter_cfg_t *cfg) {
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    if (cfg) f->cfg = *cfg;
+    sensor_filter_normalize(&f->cfg);
+}
+
+static bool rate_ok(const sensor_filter_t *f, const int32_t *v, unsigned n, uint32_t t_ms) {
+    if (!f->have_last) return true;
+    uint32_t dt = t_ms - f->last_ms;
+    if (!dt) dt = 1;
+    for (unsigned i = 0; i < n; ++i) {
+        uint32_t lim = f->cfg.roc_per_s[i];
+        if (!lim) continue;
+        int64_t d = (int64_t)v[i] - f->last[i];
+        if (d < 0) d = -d;
+        /* |d| / (dt / 1000) > lim, without dividing. */
+        if ((uint64_t)d * 1000U > (uint64_t)lim * dt) return false;
+    }
+    return true;
+}
+
+static int32_t median(const int32_t *w, unsigned k) {
+    int32_t s[SENSOR_MEDIAN_MAX];
+    memcpy(s, w, k * sizeof(*s));
+    for (unsigned i = 1; i < k; ++i) {          /* insertion sort, k <= 7 */
+        int32_t x = s[i];
+        unsigned j = i;
+        while (j && s[j - 1] > x) { s[j] = s[j - 1]; --j; }
+        s[j] = x;
+    }
+    return s[k / 2];
+}
+
+bool sensor_filter_step(sensor_filter_t *f, int32_t *v, unsigned n, uint32_t t_ms) {
+    if (!f || !v) return true;
+    if (n > SENSOR_FILTER_VALUES) n = SENSOR_FILTER_VALUES;
+
+    if (!rate_ok(f, v, n, t_ms)) {
+        if (++f->rejects <= SENSOR_ROC_REJECT_MAX) return false;
+        /* Persistent: a real step. Start over from here. */
+        sensor_filter_cfg_t cfg = f->cfg;
+        sensor_filter_init(f, &cfg);
+    }
+    f->rejects = 0;
+    f->have_last = true;
+    f->last_ms = t_ms;
+    memcpy(f->last, v, n * sizeof(*v));
+
+    unsigned k = f->cfg.median_n;
+    if (k <= 1) return true;
+    for (unsigned i = 0; i < n; ++i) f->win[i][f->pos] = v[i];
+    f->pos = (uint8_t)((f->pos + 1U) % k);
+    if (f->fill < k) f->fill++;
+    /* Until the window fills (slots 0..fill-1), the newest odd count of entries. */
+    unsigned m = (f->fill & 1U) ? f->fill : f->fill - 1U;
+    for (unsigned i = 0; i < n; ++i) v[i] = median(&f->win[i][f->fill - m], m);
+    return true;
+}
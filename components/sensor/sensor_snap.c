@@ -0,0 +1,21 @@
+// sensor_snap.c, double-buffered latest record (no RTOS calls; host-buildable).
+#include "sensor_snap.h"
+
+void sensor_snap_publish(sensor_snap_t *sn, const sensor_rec_t *r) {
+    uint32_t g = atomic_load_explicit(&sn->gen, memory_order_relaxed);
+    /* The last publish's gen store must land before this slot's writes: that slot is
+     * the one published two generations ago, and a reader still on that gen must see
+     * it change. Free on TSO hosts, a barrier on weakly ordered cores. */
+    atomic_thread_fence(memory_order_release);
+    sn->buf[(g + 1) & 1] = *r;
+    atomic_store_explicit(&sn->gen, g + 1, memory_order_release);
+}
+
+void sensor_snap_read(sensor_snap_t *sn, sensor_rec_t *out) {
+    uint32_t g;
+    do {
+        g = atomic_load_explicit(&sn->gen, memory_order_acquire);
+        *out = sn->buf[g & 1];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&sn->gen, memory_order_relaxed) != g);
+}
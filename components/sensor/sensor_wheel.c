@@ -0,0 +1,87 @@
+// sensor_wheel.c, hashed timer wheel (no RTOS calls; host-buildable).
+#include <string.h>
+#include "sensor_wheel.h"
+
+#define MASK (SENSOR_WHEEL_SLOTS - 1U)
+
+/* Wrap-safe "a is at or before b". */
+static bool tick_le(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) <= 0;
+}
+
+void sensor_wheel_init(sensor_wheel_t *w, uint32_t now) {
+    if (!w) return;
+    memset(w, 0, sizeof(*w));
+    w->now = now;
+}
+
+void sensor_wheel_disarm(sensor_wheel_t *w, unsigned id) {
+    if (!w || id >= SENSOR_WHEEL_IDS) return;
+    uint32_t bit = 1U << id;
+    if (!(w->armed & bit)) return;
+    w->slot[w->due[id] & MASK] &= ~bit;
+    w->armed &= ~bit;
+}
+
+void sensor_wheel_arm(sensor_wheel_t *w, unsigned id, uint32_t due) {
+    if (!w || id >= SENSOR_WHEEL_IDS) return;
+    sensor_wheel_disarm(w, id);
+    /* Past-due entries go in the current slot so the next pass sees them. */
+    if (tick_le(due, w->now)) due = w->now;
+    w->due[id] = due;
+    w->slot[due & MASK] |= 1U << id;
+    w->armed |= 1U << id;
+}
+
+bool sensor_wheel_armed(const sensor_wheel_t *w, unsigned id) {
+    return w && id < SENSOR_WHEEL_IDS && (w->armed & (1U << id));
+}
+
+uint32_t sensor_wheel_expire(sensor_wheel_t *w, uint32_t now) {
+    if (!w) return 0;
+    uint32_t fired = 0;
+    /* Visit the slots passed since the last call (all of them after a long gap). */
+    uint32_t span = now - w->now;
+    if (span >= SENSOR_WHEEL_SLOTS) span = SENSOR_WHEEL_SLOTS - 1U;
+    for (uint32_t i = 0; i <= span; ++i) {
+        uint32_t s = (now - i) & MASK;
+        uint32_t m = w->slot[s];
+        while (m) {
+            unsigned id = (unsigned)__builtin_ctz(m);
+            m &= m - 1U;
+            if (tick_le(w->due[id], now)) fired |= 1U << id;
+        }
+        w->slot[s] &= ~fired;
+    }
+    w->armed &= ~fired;
+    w->now = now;
+    return fired;
+}
+
+bool sensor_wheel_next(const sensor_wheel_t *w, uint32_t *out_due) {
+    if (!w || !w->armed) return false;
+    /* Common case: something is due within one revolution. */
+    for (uint32_t t = w->now; t != w->now + SENSOR_WHEEL_SLOTS; ++t) {
+        uint32_t m = w->slot[t & MASK];
+        while (m) {
+            unsigned id = (unsigned)__builtin_ctz(m);
+            m &= m - 1U;
+            if (w->due[id] == t) { if (out_due) *out_due = t; return true; }
+        }
+    }
+    /* Only far deadlines left: take the earliest. */
+    uint32_t best = 0;
+    bool have = false;
+    for (uint32_t m = w->armed; m; m &= m - 1U) {
+        unsigned id = (unsigned)__builtin_ctz(m);
+        if (!have || tick_le(w->due[id], best)) { best = w->due[id]; have = true; }
+    }
+    if (out_due) *out_due = best;
+    return have;
+}
+
+uint32_t sensor_wheel_align(uint32_t earliest, uint32_t period) {
+    if (!period) return earliest;
+    uint32_t r = earliest % period;
+    return r ? earliest + (period - r) : earliest;
+}
@@ -19,6 +19,7 @@ void syscoord_mark_tcp_authed(void);
 void syscoord_control_path_ok(const char *source);
 
 void syscoord_on_wifi_state(bool up);
+void syscoord_on_wifi_attempt(uint32_t in_ms);  // a connect attempt starts in in_ms (0 = now)
 void syscoord_on_tcp_clients(int count);
 void syscoord_on_ble_state(bool connected);
 
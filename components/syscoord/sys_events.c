@@ -13,6 +13,11 @@ void syscoord_on_wifi_state(bool up) {
   }
 }
 
+/* Wi-Fi and the BLE lifeboat share one radio: let advertising back off around attempts. */
+void syscoord_on_wifi_attempt(uint32_t in_ms) {
+  if (atomic_load(&g_mode) == SC_MODE_RECOVERY) ble_adv_on_wifi_attempt(in_ms);
+}
+
 /* Informational today; reserved for policy use later */
 void syscoord_on_tcp_clients(int count) { (void)count; }
 void syscoord_on_ble_state(bool connected) { (void)connected; }
@@ -0,0 +1,62 @@
+// ts_codec.h, delta encoding of sensor samples into fixed-size flash blocks (internal).
+// Plain C, no flash calls: the store feeds it bytes, so blocks decode the same on a host.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TS_BLOCK_SIZE  4096        // one flash sector
+#define TS_PAGE_SIZE   256         // flash program page; the unit of every write
+#define TS_HDR_SIZE    16
+#define TS_MAGIC       0x31425354u // "TSB1"
+#define TS_MAX_IDS     16
+#define TS_MAX_VALUES  4
+#define TS_REC_MAX     (1 + 5 + TS_MAX_VALUES * 5)
+
+/* Block: header <magic:le32><seq:le32><t0:le32><~seq:le32>, then records until
+ * the first 0xFF byte (erased flash) or the end of the block. A record is
+ *   <(id << 2) | (n - 1)> <dt varint> n x <zigzag varint delta>
+ * dt is seconds since the previous record (the first: since t0); each delta is
+ * against the previous value of the same id and slot in this block (0 at start). */
+typedef struct {
+    uint32_t seq;   // block number, +1 per block written
+    uint32_t t0;    // store time of the block's first record (s)
+} ts_block_hdr_t;
+
+typedef struct {
+    uint32_t ts;    // store time (s)
+    uint8_t  id;
+    uint8_t  n;
+    int32_t  v[TS_MAX_VALUES];
+} ts_sample_t;
+
+/* Delta state, shared by encoder and decoder. */
+typedef struct {
+    uint32_t last_ts;
+    int32_t  prev[TS_MAX_IDS][TS_MAX_VALUES];
+} ts_delta_t;
+
+void   ts_hdr_pack(uint8_t out[TS_HDR_SIZE], uint32_t seq, uint32_t t0);
+bool   ts_hdr_parse(const uint8_t in[TS_HDR_SIZE], ts_block_hdr_t *out);
+
+/* Start a block's delta chain at t0. */
+void   ts_delta_reset(ts_delta_t *d, uint32_t t0);
+
+/* Encode one sample; returns bytes written to out (0 = unencodable: id/n out of
+ * range or time going backwards). The state only advances on success. */
+size_t ts_enc_record(ts_delta_t *d, const ts_sample_t *s, uint8_t out[TS_REC_MAX]);
+
+/* Decode the record at *pos of a block body (blk[0..len)); false at the end of
+ * data or on a damaged record (e.g. cut short by power loss). */
+bool   ts_dec_record(ts_delta_t *d, const uint8_t *blk, size_t len, size_t *pos, ts_sample_t *out);
+
+/* Bytes in use: header + every decodable record (TS_HDR_SIZE if none, 0 if no header). */
+size_t ts_block_used(const uint8_t *blk, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+// ts_store.h, flash time-series of sensor samples on the spiffs data partition.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Samples go through a small RAM queue to a low-priority writer task, which erases and
+// programs flash; the sensor scheduler never waits on flash. Flash is programmed one
+// 256 B page (TS_PAGE_SIZE, ~50 DHT samples) at a time: the partial page and anything
+// still queued are lost on reset or power cut. tsdump includes the partial page.
+//
+// Store time: seconds, monotonic across reboots. Each boot resumes one second after
+// the newest stored sample, so power-off gaps collapse; map to wall time with `now`.
+typedef struct {
+    uint32_t blocks;       // partition size in blocks
+    uint32_t used;         // blocks holding data
+    uint32_t oldest_s;     // t0 of the oldest block (0 if empty)
+    uint32_t now_s;        // current store time
+    uint32_t samples;      // appended since boot
+    uint32_t page_writes;
+    uint32_t erases;
+    uint32_t errors;       // flash read/write/erase failures
+    uint32_t dropped;      // samples lost: writer queue full (flash stalled)
+} ts_store_stats_t;
+
+// Mount the partition, rebuild the block index and log every registered sensor
+// (kept sampling, decimated to every_s). Call after the sensor drivers registered.
+esp_err_t ts_store_init(uint32_t every_s);
+
+uint32_t ts_store_now(void);
+void ts_store_get_stats(ts_store_stats_t *out);
+
+// Chunk sink for ts_store_dump(); return false to stop.
+typedef bool (*ts_chunk_fn)(const uint8_t *blk, size_t len, void *arg);
+
+// Hand every block that may hold samples in [from_s, to_s] to `out`, oldest first,
+// as raw encoded bytes (ts_codec.h; trailing erased bytes trimmed). Samples outside the
+// range at the edges are the reader's to skip. Returns blocks delivered.
+size_t ts_store_dump(uint32_t from_s, uint32_t to_s, ts_chunk_fn out, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
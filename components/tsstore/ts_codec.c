@@ -0,0 +1,104 @@
+// ts_codec.c, block header + delta records (no flash calls; host-buildable).
+#include <string.h>
+#include "ts_codec.h"
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static size_t put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* At most 5 bytes; erased flash (0xFF...) never terminates, so it reads as damage. */
+static bool get_varint(const uint8_t *p, size_t len, size_t *pos, uint32_t *out) {
+    uint32_t v = 0;
+    for (unsigned i = 0; i < 5; ++i) {
+        if (*pos >= len) return false;
+        uint8_t b = p[(*pos)++];
+        v |= (uint32_t)(b & 0x7F) << (7 * i);
+        if (!(b & 0x80)) { *out = v; return true; }
+    }
+    return false;
+}
+
+static uint32_t zz(int32_t v)   { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t  unzz(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1U); }
+
+void ts_hdr_pack(uint8_t out[TS_HDR_SIZE], uint32_t seq, uint32_t t0) {
+    put32(out, TS_MAGIC);
+    put32(out + 4, seq);
+    put32(out + 8, t0);
+    put32(out + 12, ~seq);
+}
+
+bool ts_hdr_parse(const uint8_t in[TS_HDR_SIZE], ts_block_hdr_t *out) {
+    if (get32(in) != TS_MAGIC || get32(in + 12) != ~get32(in + 4)) return false;
+    if (out) {
+        out->seq = get32(in + 4);
+        out->t0  = get32(in + 8);
+    }
+    return true;
+}
+
+void ts_delta_reset(ts_delta_t *d, uint32_t t0) {
+    memset(d, 0, sizeof(*d));
+    d->last_ts = t0;
+}
+
+size_t ts_enc_record(ts_delta_t *d, const ts_sample_t *s, uint8_t out[TS_REC_MAX]) {
+    if (!d || !s || s->id >= TS_MAX_IDS || !s->n || s->n > TS_MAX_VALUES) return 0;
+    if ((int32_t)(s->ts - d->last_ts) < 0) return 0;
+
+    size_t n = 0;
+    out[n++] = (uint8_t)((s->id << 2) | (s->n - 1U));
+    n += put_varint(out + n, s->ts - d->last_ts);
+    for (unsigned i = 0; i < s->n; ++i) {
+        n += put_varint(out + n, zz((int32_t)((uint32_t)s->v[i] - (uint32_t)d->prev[s->id][i])));
+    }
+
+    d->last_ts = s->ts;
+    for (unsigned i = 0; i < s->n; ++i) d->prev[s->id][i] = s->v[i];
+    return n;
+}
+
+bool ts_dec_record(ts_delta_t *d, const uint8_t *blk, size_t len, size_t *pos, ts_sample_t *out) {
+    if (!d || !blk || !pos || !out || *pos >= len) return false;
+    size_t p = *pos;
+    uint8_t h = blk[p++];
+    if (h == 0xFF) return false;                 /* erased: end of data */
+
+    ts_sample_t s = { .id = (uint8_t)(h >> 2), .n = (uint8_t)((h & 3U) + 1U) };
+    uint32_t dt;
+    if (s.id >= TS_MAX_IDS || !get_varint(blk, len, &p, &dt)) return false;
+    s.ts = d->last_ts + dt;
+    for (unsigned i = 0; i < s.n; ++i) {
+        uint32_t z;
+        if (!get_varint(blk, len, &p, &z)) return false;
+        s.v[i] = (int32_t)((uint32_t)d->prev[s.id][i] + (uint32_t)unzz(z));
+    }
+
+    d->last_ts = s.ts;
+    for (unsigned i = 0; i < s.n; ++i) d->prev[s.id][i] = s.v[i];
+    *out = s;
+    *pos = p;
+    return true;
+}
+
+size_t ts_block_used(const uint8_t *blk, size_t len) {
+    ts_block_hdr_t h;
+    if (!blk || len < TS_HDR_SIZE || !ts_hdr_parse(blk, &h)) return 0;
+    ts_delta_t d;
+    ts_delta_reset(&d, h.t0);
+    size_t pos = TS_HDR_SIZE;
+    ts_sample_t s;
+    while (ts_dec_record(&d, blk, len, &pos, &s)) { }
+    return pos;
+}
@@ -0,0 +1,339 @@
+// components/tsstore/ts_store.c
+#include <string.h>
+#include <stdlib.h>
+#include "ts_store.h"
+#include "ts_codec.h"
+#include "sensor.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "TS";
+
+#define TS_EMPTY UINT32_MAX
+#define TS_PAGES (TS_BLOCK_SIZE / TS_PAGE_SIZE)
+
+/* Flash work runs in its own low-priority task: an erase takes tens of ms and must not
+ * hold up the sensor scheduler. The queue covers a stalled erase at any sane rate. */
+#define TS_QUEUE_DEPTH   16
+#define TS_WRITER_STACK  3072
+#define TS_WRITER_PRIO   2
+
+_Static_assert(SENSOR_MAX <= TS_MAX_IDS, "sensor ids do not fit the record header");
+_Static_assert(SENSOR_MAX_VALUES <= TS_MAX_VALUES, "record too narrow for sensor values");
+
+/* Blocks are written round-robin, so block seq maps to a sector arithmetically:
+ * the index only needs each sector's t0 plus the head. */
+static struct {
+    const esp_partition_t *part;
+    uint32_t nblk;
+    uint32_t *t0;            // per sector; TS_EMPTY if it holds no live block
+    uint32_t head;           // sector of the newest block
+    uint32_t head_seq;       // its seq (0 = nothing written yet)
+    uint32_t used;           // live blocks, ending at head
+
+    bool open;               // head accepts records
+    uint32_t page;           // next page to program in head
+    uint16_t fill;           // bytes staged in pg
+    uint8_t pg[TS_PAGE_SIZE];
+    ts_delta_t enc;
+
+    uint32_t base_s;         // store time at boot
+    int64_t boot_us;
+
+    ts_store_stats_t st;
+    SemaphoreHandle_t lock;  // everything above; base_s/boot_us are fixed after init
+
+    /* Sensor scheduler side: decimation and hand-off, no lock. */
+    uint32_t every_s;
+    uint32_t last_s[SENSOR_MAX];
+    bool seen[SENSOR_MAX];
+    volatile uint32_t dropped;   // queue full
+    QueueHandle_t q;             // ts_sample_t to the writer
+    TaskHandle_t writer;
+} T;
+
+static uint32_t store_now(void) {
+    return T.base_s + (uint32_t)((esp_timer_get_time() - T.boot_us) / 1000000);
+}
+
+static uint32_t sector_of(uint32_t seq) {
+    uint32_t back = T.head_seq - seq;   /* < used <= nblk */
+    return (T.head + T.nblk - back) % T.nblk;
+}
+
+static size_t offset_of(uint32_t sector) {
+    return (size_t)sector * TS_BLOCK_SIZE;
+}
+
+/* ---------- Writer task (lock held) ---------- */
+
+static bool write_page(void) {
+    esp_err_t e = esp_partition_write(T.part, offset_of(T.head) + T.page * TS_PAGE_SIZE, T.pg, TS_PAGE_SIZE);
+    T.page++;
+    T.fill = 0;
+    memset(T.pg, 0xFF, sizeof(T.pg));
+    if (T.page >= TS_PAGES) T.open = false;
+    if (e != ESP_OK) {
+        T.st.errors++;
+        ESP_LOGW(TAG, "page write: %s", esp_err_to_name(e));
+        return false;
+    }
+    T.st.page_writes++;
+    return true;
+}
+
+/* Reclaim the next sector (oldest block once the ring is full) and start a block there. */
+static bool open_block(uint32_t t0) {
+    uint32_t next = (T.head + 1) % T.nblk;
+    if (T.used == T.nblk) T.used--;          /* the oldest goes */
+    T.t0[next] = TS_EMPTY;
+
+    esp_err_t e = esp_partition_erase_range(T.part, offset_of(next), TS_BLOCK_SIZE);
+    if (e != ESP_OK) {
+        T.st.errors++;
+        ESP_LOGW(TAG, "erase block %u: %s", (unsigned)next, esp_err_to_name(e));
+        return false;
+    }
+    T.st.erases++;
+
+    T.head = next;
+    T.head_seq++;
+    T.used++;
+    T.t0[next] = t0;
+    T.page = 0;
+    memset(T.pg, 0xFF, sizeof(T.pg));
+    ts_hdr_pack(T.pg, T.head_seq, t0);
+    T.fill = TS_HDR_SIZE;
+    ts_delta_reset(&T.enc, t0);
+    T.open = true;
+    return true;
+}
+
+static void append(const ts_sample_t *s) {
+    uint8_t rec[TS_REC_MAX];
+    ts_delta_t save = T.enc;
+    size_t n = T.open ? ts_enc_record(&T.enc, s, rec) : 0;
+    size_t room = T.open ? TS_BLOCK_SIZE - (T.page * TS_PAGE_SIZE + T.fill) : 0;
+
+    if (!n || n > room) {
+        /* Close the block: program the staged page (erased padding), start anew. */
+        T.enc = save;
+        if (T.open && T.fill) write_page();
+        T.open = false;
+        if (!open_block(s->ts)) return;
+        n = ts_enc_record(&T.enc, s, rec);
+        if (!n) return;
+    }
+
+    /* Records straddle pages; only whole pages reach flash. */
+    for (size_t off = 0; off < n; ) {
+        size_t k = TS_PAGE_SIZE - T.fill;
+        if (k > n - off) k = n - off;
+        memcpy(T.pg + T.fill, rec + off, k);
+        T.fill += (uint16_t)k;
+        off += k;
+        if (T.fill == TS_PAGE_SIZE) write_page();
+    }
+    T.st.samples++;
+}
+
+static void ts_writer_task(void *arg) {
+    (void)arg;
+    ts_sample_t s;
+    for (;;) {
+        if (xQueueReceive(T.q, &s, portMAX_DELAY) != pdTRUE) continue;
+        xSemaphoreTake(T.lock, portMAX_DELAY);
+        append(&s);
+        xSemaphoreGive(T.lock);
+    }
+}
+
+/* Sensor scheduler callback: decimate per sensor, queue for the writer, never block. */
+static void on_record(const sensor_rec_t *r, void *arg) {
+    (void)arg;
+    if (!r->valid || !r->n || r->id >= SENSOR_MAX) return;
+
+    uint32_t now = store_now();
+    if (T.seen[r->id] && now - T.last_s[r->id] < T.every_s) return;
+    T.seen[r->id] = true;
+    T.last_s[r->id] = now;
+    ts_sample_t s = { .ts = now, .id = r->id, .n = r->n };
+    memcpy(s.v, r->v, r->n * sizeof(s.v[0]));
+    if (xQueueSend(T.q, &s, 0) != pdTRUE) T.dropped++;
+}
+
+/* ---------- Mount ---------- */
+
+/* Rebuild the index from block headers; live blocks are the run of consecutive
+ * seqs ending at the highest one. */
+static void mount(uint8_t *blk) {
+    uint8_t h[TS_HDR_SIZE];
+    uint32_t best = 0;
+    bool any = false;
+    for (uint32_t i = 0; i < T.nblk; ++i) {
+        ts_block_hdr_t bh;
+        T.t0[i] = TS_EMPTY;
+        if (esp_partition_read(T.part, offset_of(i), h, sizeof(h)) != ESP_OK || !ts_hdr_parse(h, &bh)) continue;
+        T.t0[i] = bh.t0;
+        if (!any || bh.seq > T.head_seq) { T.head_seq = bh.seq; best = i; }
+        any = true;
+    }
+    if (!any) {
+        T.head = T.nblk - 1;
+        T.head_seq = 0;
+        T.used = 0;
+        return;
+    }
+
+    T.head = best;
+    T.used = 0;
+    uint32_t prev_t0 = TS_EMPTY;
+    for (uint32_t k = 0; k < T.nblk; ++k) {
+        uint32_t sec = (best + T.nblk - k) % T.nblk;
+        ts_block_hdr_t bh;
+        if (T.t0[sec] == TS_EMPTY ||
+            esp_partition_read(T.part, offset_of(sec), h, sizeof(h)) != ESP_OK ||
+            !ts_hdr_parse(h, &bh) || bh.seq != T.head_seq - k ||
+            (prev_t0 != TS_EMPTY && bh.t0 > prev_t0)) break;
+        prev_t0 = bh.t0;
+        T.used++;
+    }
+    for (uint32_t k = T.used; k < T.nblk; ++k) T.t0[(best + T.nblk - k) % T.nblk] = TS_EMPTY;
+
+    /* Resume the clock one second past the newest sample. */
+    T.base_s = T.t0[best];
+    if (esp_partition_read(T.part, offset_of(best), blk, TS_BLOCK_SIZE) == ESP_OK) {
+        ts_delta_t d;
+        ts_delta_reset(&d, T.t0[best]);
+        size_t pos = TS_HDR_SIZE;
+        ts_sample_t s;
+        while (ts_dec_record(&d, blk, TS_BLOCK_SIZE, &pos, &s)) T.base_s = s.ts;
+    }
+    T.base_s++;
+}
+
+/* ---------- Public API ---------- */
+esp_err_t ts_store_init(uint32_t every_s) {
+    if (T.lock) return ESP_OK;
+
+    T.part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+    if (!T.part) return ESP_ERR_NOT_FOUND;
+    T.nblk = T.part->size / TS_BLOCK_SIZE;
+    if (T.nblk < 2) return ESP_ERR_INVALID_SIZE;
+
+    T.t0 = malloc(T.nblk * sizeof(T.t0[0]));
+    uint8_t *blk = malloc(TS_BLOCK_SIZE);
+    T.lock = xSemaphoreCreateMutex();
+    T.q = xQueueCreate(TS_QUEUE_DEPTH, sizeof(ts_sample_t));
+    if (!T.t0 || !blk || !T.lock || !T.q) {
+        free(T.t0); free(blk);
+        if (T.lock) vSemaphoreDelete(T.lock);
+        if (T.q) vQueueDelete(T.q);
+        T.t0 = NULL; T.lock = NULL; T.q = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t t = esp_timer_get_time();
+    mount(blk);
+    free(blk);
+    T.boot_us = esp_timer_get_time();
+    T.every_s = every_s ? every_s : 1;
+    T.open = false;   /* a new boot always starts a new block */
+    memset(T.pg, 0xFF, sizeof(T.pg));
+
+    ESP_LOGI(TAG, "%u blocks, %u live, head=%u seq=%u, now=%u s (mount %u ms)",
+             (unsigned)T.nblk, (unsigned)T.used, (unsigned)T.head, (unsigned)T.head_seq,
+             (unsigned)T.base_s, (unsigned)((T.boot_us - t) / 1000));
+
+    if (xTaskCreate(ts_writer_task, "ts.writer", TS_WRITER_STACK, NULL, TS_WRITER_PRIO, &T.writer) != pdPASS) {
+        ESP_LOGE(TAG, "writer task failed; not logging");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int id = 0; id < sensor_count(); ++id) {
+        if (!sensor_subscribe(id, on_record, NULL)) {
+            ESP_LOGW(TAG, "subscribe %s failed", sensor_name(id));
+            continue;
+        }
+        sensor_hold(id, SENSOR_HOLD_LOG, true);
+    }
+    return ESP_OK;
+}
+
+uint32_t ts_store_now(void) {
+    return T.lock ? store_now() : 0;
+}
+
+void ts_store_get_stats(ts_store_stats_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!T.lock) return;
+    xSemaphoreTake(T.lock, portMAX_DELAY);
+    *out = T.st;
+    out->dropped = T.dropped;
+    out->blocks = T.nblk;
+    out->used = T.used;
+    out->oldest_s = T.used ? T.t0[sector_of(T.head_seq - T.used + 1)] : 0;
+    out->now_s = store_now();
+    xSemaphoreGive(T.lock);
+}
+
+/* Last live seq whose block starts at or before from_s (else the oldest). Lock held. */
+static uint32_t first_seq_for(uint32_t from_s) {
+    uint32_t lo = T.head_seq - T.used + 1, hi = T.head_seq, ans = lo;
+    while (lo <= hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (T.t0[sector_of(mid)] <= from_s) { ans = mid; lo = mid + 1; }
+        else                                                { hi = mid - 1; }
+    }
+    return ans;
+}
+
+size_t ts_store_dump(uint32_t from_s, uint32_t to_s, ts_chunk_fn out, void *arg) {
+    if (!T.lock || !out || to_s < from_s) return 0;
+    uint8_t *blk = malloc(TS_BLOCK_SIZE);
+    if (!blk) return 0;
+
+    size_t sent = 0;
+    xSemaphoreTake(T.lock, portMAX_DELAY);
+    bool any = T.used > 0;
+    uint32_t seq = any ? first_seq_for(from_s) : 0;
+    uint32_t last = T.head_seq;
+    xSemaphoreGive(T.lock);
+
+    for (; any && seq <= last; ++seq) {
+        size_t len = 0;
+        bool stop = false;
+
+        /* Copy one block under the lock; the writer may reclaim it right after. */
+        xSemaphoreTake(T.lock, portMAX_DELAY);
+        if (seq + T.used > T.head_seq && seq <= T.head_seq) {       /* still live */
+            uint32_t sec = sector_of(seq);
+            if (T.t0[sec] > to_s) {
+                stop = true;
+            } else if (esp_partition_read(T.part, offset_of(sec), blk, TS_BLOCK_SIZE) == ESP_OK) {
+                if (sec == T.head && T.open) {
+                    /* Staged page (and header, before the first program) lives in RAM. */
+                    memcpy(blk + T.page * TS_PAGE_SIZE, T.pg, TS_PAGE_SIZE);
+                }
+                len = ts_block_used(blk, TS_BLOCK_SIZE);
+            } else {
+                T.st.errors++;
+            }
+        }
+        xSemaphoreGive(T.lock);
+
+        if (stop) break;
+        if (len && !out(blk, len, arg)) break;
+        if (len) sent++;
+    }
+    free(blk);
+    return sent;
+}
@@ -0,0 +1,275 @@
+// ble_advsched_sim.c, replays advertising traces through ble_advsched_eval().
+// Usage: ble_advsched_sim <trace>...
+// Drives the schedule the way fb_adv.c does: a re-evaluation when the returned next_ms
+// runs out, and one right after every trace event. Per trace it prints the phase
+// changes, time per phase and the airtime estimate, then checks the `expect` lines
+// (exit status 1 if one fails).
+//
+// Trace lines ('#' starts a comment); the schedule is reset at t=0, advertising off:
+//   <t_ms> on | off                advertising starts / stops
+//   <t_ms> burst                   burst trigger (disconnect, RECOVERY entry)
+//   <t_ms> wifi <in_ms>            a Wi-Fi connect attempt is expected in in_ms
+//   end_ms <ms>                    stop there (default 10 min)
+//   expect phase <t_ms> <PHASE>    phase applied at t_ms (FAST, MID, SLOW, YIELD)
+//   expect ms <PHASE> <ms>         time spent in the phase
+//   expect interval <PHASE> <min_ms> <max_ms>   advertising interval range of the phase
+//   expect on_ms <ms>              time advertising was running
+//   expect events <min> <max>      advertising events counted
+//   expect air_ms <min> <max>      TX airtime estimate
+//   expect bursts <n> / yields <n>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ble_advsched.h"
+
+#define MAX_EVENTS  64
+#define MAX_EXPECT  32
+#define MAX_CHANGES 256
+
+static const char *const s_name[BLE_ADV_PHASES] = { "FAST", "MID", "SLOW", "YIELD" };
+
+typedef enum { EV_ON, EV_OFF, EV_BURST, EV_WIFI } ev_kind_t;
+
+typedef struct {
+    uint32_t  t_ms;
+    ev_kind_t kind;
+    uint32_t  arg;
+} ev_t;
+
+typedef enum { X_PHASE, X_MS, X_INTERVAL, X_ON_MS, X_EVENTS, X_AIR_MS, X_BURSTS, X_YIELDS } x_kind_t;
+
+typedef struct {
+    x_kind_t kind;
+    int      phase;
+    double   a, b;
+} expect_t;
+
+typedef struct {
+    ev_t     ev[MAX_EVENTS];
+    int      nev;
+    expect_t x[MAX_EXPECT];
+    int      nx;
+    uint32_t end_ms;
+} trace_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t  phase;
+} change_t;
+
+typedef struct {
+    change_t ch[MAX_CHANGES];
+    int      nch;
+    uint32_t evals;
+    ble_adv_stats_t st;
+} result_t;
+
+static int phase_of(const char *w) {
+    for (int i = 0; i < BLE_ADV_PHASES; ++i) {
+        if (strcmp(w, s_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static bool parse_expect(char **w, int n, expect_t *x) {
+    memset(x, 0, sizeof(*x));
+    x->phase = -1;
+    if (strcmp(w[1], "phase") == 0 && n == 4) {
+        x->kind = X_PHASE;
+        x->a = strtod(w[2], NULL);
+        x->phase = phase_of(w[3]);
+    } else if (strcmp(w[1], "ms") == 0 && n == 4) {
+        x->kind = X_MS;
+        x->phase = phase_of(w[2]);
+        x->a = strtod(w[3], NULL);
+    } else if (strcmp(w[1], "interval") == 0 && n == 5) {
+        x->kind = X_INTERVAL;
+        x->phase = phase_of(w[2]);
+        x->a = strtod(w[3], NULL);
+        x->b = strtod(w[4], NULL);
+    } else if (strcmp(w[1], "events") == 0 && n == 4) {
+        x->kind = X_EVENTS;
+        x->a = strtod(w[2], NULL);
+        x->b = strtod(w[3], NULL);
+    } else if (strcmp(w[1], "air_ms") == 0 && n == 4) {
+        x->kind = X_AIR_MS;
+        x->a = strtod(w[2], NULL);
+        x->b = strtod(w[3], NULL);
+    } else if (n == 3 && (strcmp(w[1], "on_ms") == 0 || strcmp(w[1], "bursts") == 0 ||
+                          strcmp(w[1], "yields") == 0)) {
+        x->kind = w[1][0] == 'o' ? X_ON_MS : w[1][0] == 'b' ? X_BURSTS : X_YIELDS;
+        x->a = strtod(w[2], NULL);
+        return true;
+    } else {
+        return false;
+    }
+    return x->kind == X_EVENTS || x->kind == X_AIR_MS || x->phase >= 0;
+}
+
+static bool load(const char *path, trace_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->end_ms = 600000;
+
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return false; }
+    char line[256];
+    int ln = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++ln;
+        char *h = strchr(line, '#');
+        if (h) *h = '\0';
+        char *w[6];
+        int n = 0;
+        for (char *tok = strtok(line, " \t\r\n"); tok && n < 6; tok = strtok(NULL, " \t\r\n")) {
+            w[n++] = tok;
+        }
+        if (!n) continue;
+
+        if (strcmp(w[0], "end_ms") == 0 && n == 2) {
+            t->end_ms = (uint32_t)strtoul(w[1], NULL, 10);
+        } else if (strcmp(w[0], "expect") == 0 && n >= 3 && t->nx < MAX_EXPECT) {
+            ok = parse_expect(w, n, &t->x[t->nx++]);
+        } else if (isdigit((unsigned char)w[0][0]) && n >= 2 && t->nev < MAX_EVENTS) {
+            ev_t *e = &t->ev[t->nev++];
+            e->t_ms = (uint32_t)strtoul(w[0], NULL, 10);
+            if      (strcmp(w[1], "on") == 0 && n == 2)    e->kind = EV_ON;
+            else if (strcmp(w[1], "off") == 0 && n == 2)   e->kind = EV_OFF;
+            else if (strcmp(w[1], "burst") == 0 && n == 2) e->kind = EV_BURST;
+            else if (strcmp(w[1], "wifi") == 0 && n == 3) {
+                e->kind = EV_WIFI;
+                e->arg = (uint32_t)strtoul(w[2], NULL, 10);
+            } else ok = false;
+            if (t->nev > 1 && e->t_ms < t->ev[t->nev - 2].t_ms) ok = false;
+        } else {
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) fprintf(stderr, "%s:%d: bad line\n", path, ln);
+    return ok;
+}
+
+static void eval(ble_advsched_t *s, uint32_t now, bool on, uint32_t *next, result_t *r) {
+    ble_adv_phase_t p = ble_advsched_eval(s, now, on, next);
+    r->evals++;
+    if ((!r->nch || r->ch[r->nch - 1].phase != p) && r->nch < MAX_CHANGES) {
+        r->ch[r->nch++] = (change_t){ now, (uint8_t)p };
+    }
+}
+
+static void run(const trace_t *t, result_t *r) {
+    memset(r, 0, sizeof(*r));
+    ble_advsched_t s;
+    ble_advsched_reset(&s, 0);
+
+    bool on = false;
+    uint32_t now = 0, next = 0;
+    int i = 0;
+    for (;;) {
+        /* Everything at `now` first, then one evaluation (the worker's BLE_EVT_ADV_SCHED). */
+        for (; i < t->nev && t->ev[i].t_ms == now; ++i) {
+            const ev_t *e = &t->ev[i];
+            switch (e->kind) {
+            case EV_ON:    on = true; break;
+            case EV_OFF:   on = false; break;
+            case EV_BURST: ble_advsched_burst(&s, now); break;
+            case EV_WIFI:  ble_advsched_wifi(&s, now, e->arg); break;
+            }
+        }
+        eval(&s, now, on, &next, r);
+
+        uint32_t wake = now + next;
+        if (i < t->nev && t->ev[i].t_ms < wake) wake = t->ev[i].t_ms;
+        if (wake >= t->end_ms) break;
+        now = wake;
+    }
+    if (now < t->end_ms) eval(&s, t->end_ms, on, &next, r);   // account up to the end
+    r->st = s.st;
+}
+
+static int phase_at(const result_t *r, uint32_t t_ms) {
+    int p = -1;
+    for (int i = 0; i < r->nch && r->ch[i].t_ms <= t_ms; ++i) p = r->ch[i].phase;
+    return p;
+}
+
+static bool check(const char *what, bool ok, double got, double lo, double hi) {
+    if (ok) return true;
+    if (lo == hi) printf("  FAIL %s: got %g, expected %g\n", what, got, lo);
+    else printf("  FAIL %s: got %g, expected %g..%g\n", what, got, lo, hi);
+    return false;
+}
+
+static bool report(const char *path, const trace_t *t, const result_t *r) {
+    const ble_adv_stats_t *st = &r->st;
+    printf("%s: %u evaluations, %u bursts, %u yields\n  phases:", path, (unsigned)r->evals,
+           (unsigned)st->bursts, (unsigned)st->yields);
+    for (int i = 0; i < r->nch; ++i) printf(" %.1f %s", r->ch[i].t_ms / 1000.0, s_name[r->ch[i].phase]);
+    printf("\n  time:");
+    for (int p = 0; p < BLE_ADV_PHASES; ++p) printf(" %s %.1f s", s_name[p], st->ms[p] / 1000.0);
+    printf("; on %.1f s, %u events, airtime %.1f ms (%u ppm)\n", st->on_ms / 1000.0,
+           (unsigned)st->events, st->air_us / 1000.0, (unsigned)(t->end_ms ? st->air_us * 1000u / t->end_ms : 0));
+
+    bool ok = true;
+    char what[48];
+    for (int k = 0; k < t->nx; ++k) {
+        const expect_t *x = &t->x[k];
+        const char *pn = x->phase >= 0 ? s_name[x->phase] : "";
+        double got;
+        switch (x->kind) {
+        case X_PHASE:
+            got = phase_at(r, (uint32_t)x->a);
+            snprintf(what, sizeof(what), "phase at %.0f ms (%s)", x->a, got >= 0 ? s_name[(int)got] : "-");
+            ok &= check(what, got == x->phase, got, x->phase, x->phase);
+            break;
+        case X_MS:
+            snprintf(what, sizeof(what), "%s ms", pn);
+            ok &= check(what, st->ms[x->phase] == x->a, st->ms[x->phase], x->a, x->a);
+            break;
+        case X_INTERVAL: {
+            uint16_t lo, hi;
+            ble_advsched_interval((ble_adv_phase_t)x->phase, &lo, &hi);
+            snprintf(what, sizeof(what), "%s interval min ms", pn);
+            ok &= check(what, lo * 0.625 == x->a, lo * 0.625, x->a, x->a);
+            snprintf(what, sizeof(what), "%s interval max ms", pn);
+            ok &= check(what, hi * 0.625 == x->b, hi * 0.625, x->b, x->b);
+            break;
+        }
+        case X_ON_MS:
+            ok &= check("on_ms", st->on_ms == x->a, st->on_ms, x->a, x->a);
+            break;
+        case X_EVENTS:
+            ok &= check("events", st->events >= x->a && st->events <= x->b, st->events, x->a, x->b);
+            break;
+        case X_AIR_MS:
+            got = st->air_us / 1000.0;
+            ok &= check("air_ms", got >= x->a && got <= x->b, got, x->a, x->b);
+            break;
+        case X_BURSTS:
+            ok &= check("bursts", st->bursts == x->a, st->bursts, x->a, x->a);
+            break;
+        case X_YIELDS:
+            ok &= check("yields", st->yields == x->a, st->yields, x->a, x->a);
+            break;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace>...\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        trace_t t;
+        result_t r;
+        if (!load(argv[i], &t)) { ok = false; continue; }
+        run(&t, &r);
+        ok &= report(argv[i], &t, &r);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// dht_trace_check.c, runs dht_decode over captured edge logs.
+// Usage: dht_trace_check <trace>...
+// Per trace it prints what the decoder made of the frame and checks the `expect` line
+// (exit status 1 if one fails).
+//
+// Trace lines ('#' starts a comment):
+//   expect <ok|short|timing|checksum|range> [DHT11|DHT22 <t_dc> <rh_dpct>]
+//                          decode result (edges, then values) and, for ok, the reading
+//   phase <RESPONSE|ACK|DATA>
+//                          dht_stall_phase() of the log
+//   ... edges <t_us>:<level> ...
+//                          edge log entries, in order. This is what dht.c prints at
+//                          verbose level after a failed read, so a monitor line can be
+//                          pasted in as is; anything before "edges" is ignored.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dht_decode.h"
+
+static const char *const s_phase[] = { "RESPONSE", "ACK", "DATA" };
+
+typedef struct {
+    dht_edges_t e;
+    char expect[16];
+    char kind[8];
+    long t_dc, rh_dpct;
+    int phase;                 // -1: not given
+} trace_t;
+
+static bool load(const char *path, trace_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->phase = -1;
+
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return false; }
+    char line[512];
+    int ln = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++ln;
+        char *h = strchr(line, '#');
+        if (h) *h = '\0';
+        char *ed = strstr(line, "edges ");
+        if (ed) {
+            for (char *tok = strtok(ed + 6, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+                unsigned us, lvl;
+                char tail;
+                if (sscanf(tok, "%u:%u%c", &us, &lvl, &tail) != 2 || lvl > 1) break;   // e.g. a colour reset
+                if (t->e.n >= DHT_MAX_EDGES) { ok = false; break; }
+                t->e.t_us[t->e.n] = us;
+                t->e.level[t->e.n] = (uint8_t)lvl;
+                t->e.n++;
+            }
+            continue;
+        }
+        char w[4][16];
+        int n = sscanf(line, "%15s %15s %15s %15s", w[0], w[1], w[2], w[3]);
+        if (n <= 0) continue;
+        if (strcmp(w[0], "expect") == 0) {
+            int m = sscanf(line, "%*s %15s %7s %ld %ld", t->expect, t->kind, &t->t_dc, &t->rh_dpct);
+            if (m != 1 && m != 4) ok = false;
+        } else if (strcmp(w[0], "phase") == 0 && n == 2) {
+            for (int i = 0; i < 3; ++i) {
+                if (strcmp(w[1], s_phase[i]) == 0) t->phase = i;
+            }
+            if (t->phase < 0) ok = false;
+        } else {
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) fprintf(stderr, "%s:%d: bad line\n", path, ln);
+    if (ok && !t->expect[0]) {
+        fprintf(stderr, "%s: no expect line\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+static bool run(const char *path, const trace_t *t) {
+    uint8_t raw[5];
+    int16_t t_dc = 0;
+    uint16_t rh = 0;
+    dht_kind_t kind = DHT_KIND_UNKNOWN;
+    dht_dec_err_t de = dht_decode_edges(&t->e, raw);
+    if (de == DHT_DEC_OK) de = dht_decode_values(raw, DHT_KIND_UNKNOWN, &t_dc, &rh, &kind);
+    dht_phase_t ph = dht_stall_phase(&t->e);
+
+    printf("%s: %u edges, %s", path, (unsigned)t->e.n, dht_dec_err_name(de));
+    if (de == DHT_DEC_OK) printf(" %s %s%d.%d C %u.%u %%RH", dht_kind_name(kind), t_dc < 0 ? "-" : "",
+                               abs(t_dc) / 10, abs(t_dc) % 10, rh / 10, rh % 10);
+    printf(", phase %s\n", s_phase[ph]);
+
+    bool ok = true;
+    if (strcmp(dht_dec_err_name(de), t->expect) != 0) {
+        printf("  FAIL result: got %s, expected %s\n", dht_dec_err_name(de), t->expect);
+        ok = false;
+    } else if (t->kind[0] && (strcmp(dht_kind_name(kind), t->kind) != 0 || t_dc != t->t_dc || rh != t->rh_dpct)) {
+        printf("  FAIL reading: got %s %d %u, expected %s %ld %ld\n", dht_kind_name(kind), t_dc, rh,
+               t->kind, t->t_dc, t->rh_dpct);
+        ok = false;
+    }
+    if (t->phase >= 0 && (int)ph != t->phase) {
+        printf("  FAIL phase: got %s, expected %s\n", s_phase[ph], s_phase[t->phase]);
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace>...\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        static trace_t t;
+        if (!load(argv[i], &t)) { ok = false; continue; }
+        ok &= run(argv[i], &t);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+// host_test.h, minimal checks for the host tests (host_test/CMakeLists.txt).
+#pragma once
+#include <stdio.h>
+
+static int g_fails;
+
+#define CHECK(c) do { \
+    if (!(c)) { ++g_fails; fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long long a_ = (long long)(a), b_ = (long long)(b); \
+    if (a_ != b_) { ++g_fails; fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", \
+                                       __FILE__, __LINE__, #a, a_, b_); } \
+} while (0)
+
+/* Last line of main(). */
+#define HOST_TEST_DONE() do { \
+    if (g_fails) fprintf(stderr, "%d check(s) failed\n", g_fails); \
+    return g_fails ? 1 : 0; \
+} while (0)
@@ -0,0 +1,134 @@
+// esp_stubs.c, the ESP-IDF calls of the BLE core and the OTA writer (host build only).
+// The passive app slot is a RAM buffer; nothing here touches a file.
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_ota_ops.h"
+
+#define HOST_HEAP_BYTES  (512u * 1024u)       // nominal, like an ESP32 with the stack up
+#define HOST_SLOT_BYTES  (1536u * 1024u)
+
+const char *esp_err_to_name(esp_err_t e) {
+    switch (e) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+    default:                       return "ERROR";
+    }
+}
+
+uint32_t esp_log_timestamp(void) { return (uint32_t)(esp_timer_get_time() / 1000); }
+
+void esp_restart(void) {
+    fprintf(stderr, "esp_restart() on the host build\n");
+    abort();
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    size_t used = mallinfo2().uordblks;
+    return used < HOST_HEAP_BYTES ? HOST_HEAP_BYTES - used : 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) { return heap_caps_get_free_size(caps); }
+
+/* ---------- App slots ---------- */
+
+static const esp_partition_t s_run  = { 0x010000, HOST_SLOT_BYTES, "ota_0" };
+static const esp_partition_t s_next = { 0x190000, HOST_SLOT_BYTES, "ota_1" };
+
+static portMUX_TYPE s_ota_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t *s_slot;                 // s_next's contents
+static esp_ota_handle_t s_open;         // 0: none
+static host_ota_stats_t s_st;
+
+const esp_partition_t *esp_ota_get_running_partition(void) { return &s_run; }
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start) {
+    (void)start;
+    return &s_next;
+}
+
+esp_err_t esp_ota_get_partition_description(const esp_partition_t *p, esp_app_desc_t *out) {
+    if (!p || !out) return ESP_ERR_INVALID_ARG;
+    if (p != &s_run) return ESP_ERR_NOT_FOUND;      // the passive slot never holds an app here
+    memset(out, 0, sizeof(*out));
+    snprintf(out->project_name, sizeof(out->project_name), "lopy4");
+    snprintf(out->version, sizeof(out->version), "host");
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *p, size_t image_size, esp_ota_handle_t *out) {
+    if (p != &s_next || !out) return ESP_ERR_INVALID_ARG;
+    if (image_size > p->size) return ESP_ERR_INVALID_SIZE;
+    portENTER_CRITICAL(&s_ota_mux);
+    if (!s_slot) s_slot = malloc(HOST_SLOT_BYTES);
+    esp_err_t e = !s_slot ? ESP_ERR_NO_MEM : s_open ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (e == ESP_OK) {
+        memset(s_slot, 0xFF, HOST_SLOT_BYTES);      // erased flash
+        host_ota_stats_t keep = s_st;
+        memset(&s_st, 0, sizeof(s_st));
+        s_st.begins = keep.begins + 1;
+        s_st.data = s_slot;
+        *out = s_open = s_st.begins;
+    }
+    portEXIT_CRITICAL(&s_ota_mux);
+    return e;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t h, const void *data, size_t len) {
+    portENTER_CRITICAL(&s_ota_mux);
+    esp_err_t e = !h || h != s_open ? ESP_ERR_INVALID_ARG
+                : s_st.written + len > HOST_SLOT_BYTES ? ESP_ERR_INVALID_SIZE : ESP_OK;
+    if (e == ESP_OK) {
+        memcpy(s_slot + s_st.written, data, len);
+        s_st.written += len;
+    }
+    portEXIT_CRITICAL(&s_ota_mux);
+    return e;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t h) {
+    portENTER_CRITICAL(&s_ota_mux);
+    esp_err_t e = !h || h != s_open ? ESP_ERR_INVALID_ARG : ESP_OK;
+    if (e == ESP_OK) { s_st.ends++; s_open = 0; }
+    portEXIT_CRITICAL(&s_ota_mux);
+    return e;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t h) {
+    portENTER_CRITICAL(&s_ota_mux);
+    esp_err_t e = !h || h != s_open ? ESP_ERR_INVALID_ARG : ESP_OK;
+    if (e == ESP_OK) { s_st.aborts++; s_open = 0; }
+    portEXIT_CRITICAL(&s_ota_mux);
+    return e;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *p) {
+    if (p != &s_next) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_ota_mux);
+    s_st.boot_sets++;
+    portEXIT_CRITICAL(&s_ota_mux);
+    return ESP_OK;
+}
+
+void host_ota_stats(host_ota_stats_t *out) {
+    portENTER_CRITICAL(&s_ota_mux);
+    *out = s_st;
+    portEXIT_CRITICAL(&s_ota_mux);
+}
@@ -0,0 +1,138 @@
+// fakes.c, the components the BLE core calls into, reduced to what a session needs
+// (host build only). Commands: `ping` answers PONG, anything else WHAT, as command.c does.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+#include "alerts.h"
+#include "command.h"
+#include "commands.h"
+#include "cmd_stream.h"
+#include "dht.h"
+#include "monitor.h"
+#include "sensor.h"
+#include "syscoord.h"
+#include "host_fakes.h"
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* ---------- cmd ---------- */
+
+void cmd_dispatch_line(char *line, size_t len, cmd_ctx_t *ctx) {
+    while (len && (unsigned char)line[len - 1] <= ' ') len--;
+    if (!len) return;
+    cmd_reply(ctx, len == 4 && strncasecmp(line, "ping", 4) == 0 ? "PONG\n" : "WHAT\n");
+}
+
+void cmd_stream_drop(cmd_xport_t xport, void *user) { (void)xport; (void)user; }
+
+/* ---------- syscoord / monitor / alerts ---------- */
+
+static sc_mode_t s_mode = SC_MODE_STARTUP;
+static uint32_t s_ble_calls;
+static bool s_ble_connected;
+
+void host_set_mode(sc_mode_t m) {
+    portENTER_CRITICAL(&s_mux);
+    s_mode = m;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+sc_mode_t syscoord_get_mode(void) {
+    portENTER_CRITICAL(&s_mux);
+    sc_mode_t m = s_mode;
+    portEXIT_CRITICAL(&s_mux);
+    return m;
+}
+
+void syscoord_on_ble_state(bool connected) {
+    portENTER_CRITICAL(&s_mux);
+    s_ble_calls++;
+    s_ble_connected = connected;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+uint32_t host_ble_state_calls(bool *connected) {
+    portENTER_CRITICAL(&s_mux);
+    uint32_t n = s_ble_calls;
+    if (connected) *connected = s_ble_connected;
+    portEXIT_CRITICAL(&s_mux);
+    return n;
+}
+
+void syscoord_on_ble_service_started(void) {}
+
+void health_monitor_control_ok(const char *path) { (void)path; }
+
+void alert_latest(alert_record_t *out) { memset(out, 0, sizeof(*out)); }
+
+/* ---------- dht / sensor ---------- */
+
+static dht_sample_cb_t s_subs[DHT_MAX_SUBSCRIBERS];
+static sensor_rec_t s_rec = { .id = 0 };
+
+bool dht_subscribe(dht_sample_cb_t cb) {
+    bool ok = false;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < DHT_MAX_SUBSCRIBERS && !ok; ++i) {
+        if (s_subs[i] == cb) ok = true;
+    }
+    for (int i = 0; i < DHT_MAX_SUBSCRIBERS && !ok; ++i) {
+        if (!s_subs[i]) { s_subs[i] = cb; ok = true; }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return ok;
+}
+
+void dht_unsubscribe(dht_sample_cb_t cb) {
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (s_subs[i] == cb) s_subs[i] = NULL;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void dht_stream_hold(uint32_t owner_bit, bool on) { (void)owner_bit; (void)on; }
+
+size_t dht_history_pack(dht_tier_t tier, size_t count, uint8_t *buf, size_t cap) {
+    (void)tier; (void)count; (void)buf; (void)cap;
+    return 0;                                // no history yet
+}
+
+void host_dht_sample(const dht_sample_t *s) {
+    dht_sample_cb_t subs[DHT_MAX_SUBSCRIBERS];
+    portENTER_CRITICAL(&s_mux);
+    s_rec.valid = s->valid;
+    s_rec.n = s->valid ? 2 : 0;
+    s_rec.qty[0] = SENSOR_Q_TEMP_DC;
+    s_rec.qty[1] = SENSOR_Q_RH_DP;
+    s_rec.v[0] = (int32_t)(s->temp_c * 10.0f + (s->temp_c < 0 ? -0.5f : 0.5f));
+    s_rec.v[1] = (int32_t)(s->rh * 10.0f + 0.5f);
+    s_rec.seq++;
+    s_rec.age_ms = s->age_ms;
+    memcpy(subs, s_subs, sizeof(subs));
+    portEXIT_CRITICAL(&s_mux);
+    for (int i = 0; i < DHT_MAX_SUBSCRIBERS; ++i) {
+        if (subs[i]) subs[i](s);
+    }
+}
+
+int sensor_find(const char *name) { return strcmp(name, "DHT") == 0 ? 0 : -1; }
+
+bool sensor_latest(int id, sensor_rec_t *out) {
+    if (id != 0) return false;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_rec;
+    portEXIT_CRITICAL(&s_mux);
+    return out->seq != 0;
+}
+
+int sensor_format(const sensor_rec_t *r, char *buf, size_t n) {
+    int k = r->valid
+        ? snprintf(buf, n, "DHT T=%s%d.%dC RH=%d.%d%%", r->v[0] < 0 ? "-" : "",
+                   (int)(abs(r->v[0]) / 10), (int)(abs(r->v[0]) % 10),
+                   (int)(r->v[1] / 10), (int)(r->v[1] % 10))
+        : snprintf(buf, n, "DHT NA");
+    return k < 0 ? 0 : (k >= (int)n ? (int)n - 1 : k);
+}
@@ -0,0 +1,277 @@
+// freertos_posix.c, the FreeRTOS calls of the BLE core on pthreads (host build only).
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/timers.h"
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_t0_us;
+__attribute__((constructor)) static void clock_start(void) { s_t0_us = now_us(); }
+
+/* Absolute CLOCK_MONOTONIC deadline `ticks` from now (condition variables use it too). */
+static struct timespec deadline(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec  += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    return ts;
+}
+
+static void cond_init(pthread_cond_t *c) {
+    pthread_condattr_t a;
+    pthread_condattr_init(&a);
+    pthread_condattr_setclock(&a, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &a);
+    pthread_condattr_destroy(&a);
+}
+
+/* Wait on `c` until `ready` or the timeout; false on timeout. `m` is held. */
+static bool cond_wait_for(pthread_cond_t *c, pthread_mutex_t *m, const int *ready, TickType_t wait) {
+    if (wait == portMAX_DELAY) {
+        while (!*ready) pthread_cond_wait(c, m);
+        return true;
+    }
+    struct timespec until = deadline(wait);
+    while (!*ready) {
+        if (pthread_cond_timedwait(c, m, &until) == ETIMEDOUT) return *ready != 0;
+    }
+    return true;
+}
+
+int64_t esp_timer_get_time(void) { return now_us() - s_t0_us; }
+
+/* ---------- Tasks ---------- */
+
+struct host_task {
+    TaskFunction_t fn;
+    void *arg;
+};
+
+static __thread struct host_task *t_self;
+static struct host_task s_main;
+
+static void *task_entry(void *p) {
+    t_self = p;
+    t_self->fn(t_self->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *out) {
+    (void)name; (void)stack; (void)prio;
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (!t) return pdFAIL;
+    t->fn = fn;
+    t->arg = arg;
+    pthread_t th;
+    if (pthread_create(&th, NULL, task_entry, t) != 0) { free(t); return pdFAIL; }
+    pthread_detach(th);
+    if (out) *out = t;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t t) {
+    if (t == NULL) pthread_exit(NULL);
+    abort();                     // deleting another task: not needed by the core
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = { .tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(esp_timer_get_time() / 1000); }
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return t_self ? t_self : &s_main; }
+
+/* ---------- Semaphores ---------- */
+
+struct host_sem {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    int count;
+    int max;
+};
+
+static SemaphoreHandle_t sem_new(int max, int initial) {
+    struct host_sem *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_init(&s->m, NULL);
+    cond_init(&s->c);
+    s->count = initial;
+    s->max = max;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return sem_new(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return sem_new(1, 0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+    pthread_mutex_lock(&s->m);
+    bool ok = cond_wait_for(&s->c, &s->m, &s->count, wait);
+    if (ok) s->count--;
+    pthread_mutex_unlock(&s->m);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    pthread_mutex_lock(&s->m);
+    bool ok = s->count < s->max;
+    if (ok) { s->count++; pthread_cond_signal(&s->c); }
+    pthread_mutex_unlock(&s->m);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) {
+    if (!s) return;
+    pthread_cond_destroy(&s->c);
+    pthread_mutex_destroy(&s->m);
+    free(s);
+}
+
+/* ---------- Queues ---------- */
+
+struct host_queue {
+    pthread_mutex_t m;
+    pthread_cond_t  c;
+    uint8_t *buf;
+    size_t   item;
+    int      len, head, n;
+    int      has_room;           // len - n > 0, for cond_wait_for()
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size) {
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q || !(q->buf = calloc(len, item_size))) { free(q); return NULL; }
+    pthread_mutex_init(&q->m, NULL);
+    cond_init(&q->c);
+    q->item = item_size;
+    q->len = (int)len;
+    q->has_room = len > 0;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait) {
+    pthread_mutex_lock(&q->m);
+    bool ok = cond_wait_for(&q->c, &q->m, &q->has_room, wait);
+    if (ok) {
+        memcpy(q->buf + (size_t)((q->head + q->n) % q->len) * q->item, item, q->item);
+        q->n++;
+        q->has_room = q->n < q->len;
+        pthread_cond_broadcast(&q->c);
+    }
+    pthread_mutex_unlock(&q->m);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *out, TickType_t wait) {
+    pthread_mutex_lock(&q->m);
+    bool ok = cond_wait_for(&q->c, &q->m, &q->n, wait);
+    if (ok) {
+        memcpy(out, q->buf + (size_t)q->head * q->item, q->item);
+        q->head = (q->head + 1) % q->len;
+        q->n--;
+        q->has_room = 1;
+        pthread_cond_broadcast(&q->c);
+    }
+    pthread_mutex_unlock(&q->m);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+/* ---------- Timers: one service thread scans an unsorted list (there are few) ---------- */
+
+struct host_timer {
+    struct host_timer *next;
+    TimerCallbackFunction_t cb;
+    void      *id;
+    TickType_t period;
+    bool       reload;
+    bool       armed;
+    int64_t    due_us;
+};
+
+static pthread_mutex_t s_tm_mux = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_tm_cond;
+static struct host_timer *s_timers;
+static bool s_tm_started;
+
+static void *timer_service(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&s_tm_mux);
+    for (;;) {
+        int64_t now = esp_timer_get_time(), next = INT64_MAX;
+        struct host_timer *fire = NULL;
+        for (struct host_timer *t = s_timers; t; t = t->next) {
+            if (!t->armed) continue;
+            if (t->due_us <= now) { fire = t; break; }
+            if (t->due_us < next) next = t->due_us;
+        }
+        if (fire) {
+            if (fire->reload) fire->due_us += (int64_t)fire->period * 1000;
+            else fire->armed = false;
+            pthread_mutex_unlock(&s_tm_mux);
+            fire->cb(fire);
+            pthread_mutex_lock(&s_tm_mux);
+        } else if (next == INT64_MAX) {
+            pthread_cond_wait(&s_tm_cond, &s_tm_mux);
+        } else {
+            struct timespec until = deadline((TickType_t)((next - now + 999) / 1000));
+            pthread_cond_timedwait(&s_tm_cond, &s_tm_mux, &until);
+        }
+    }
+    return NULL;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload,
+                           void *id, TimerCallbackFunction_t cb) {
+    (void)name;
+    struct host_timer *t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    t->cb = cb;
+    t->id = id;
+    t->period = period;
+    t->reload = auto_reload != 0;
+    pthread_mutex_lock(&s_tm_mux);
+    if (!s_tm_started) {
+        cond_init(&s_tm_cond);
+        pthread_t th;
+        s_tm_started = pthread_create(&th, NULL, timer_service, NULL) == 0;
+        if (s_tm_started) pthread_detach(th);
+    }
+    t->next = s_timers;
+    s_timers = t;
+    pthread_mutex_unlock(&s_tm_mux);
+    return t;
+}
+
+static BaseType_t timer_set(TimerHandle_t t, bool armed, TickType_t period) {
+    pthread_mutex_lock(&s_tm_mux);
+    t->period = period;
+    t->armed = armed;
+    t->due_us = esp_timer_get_time() + (int64_t)period * 1000;
+    pthread_cond_signal(&s_tm_cond);
+    pthread_mutex_unlock(&s_tm_mux);
+    return pdPASS;
+}
+
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t wait) { (void)wait; return timer_set(t, true, t->period); }
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t wait) { (void)wait; return timer_set(t, false, t->period); }
+BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait) {
+    (void)wait;
+    return timer_set(t, true, period);
+}
+
+void *pvTimerGetTimerID(TimerHandle_t t) { return t->id; }
@@ -0,0 +1,10 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT     (1u << 2)
+#define MALLOC_CAP_DEFAULT  (1u << 12)
+
+/* A nominal heap minus what malloc has handed out, so differences are real. */
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
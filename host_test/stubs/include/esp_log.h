@@ -0,0 +1,14 @@
+// esp_log.h, host build: one line per message on stderr, stamped in ms since start.
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+
+uint32_t esp_log_timestamp(void);
+
+#define HOST_LOG_(l, tag, fmt, ...) \
+    fprintf(stderr, l " (%u) %s: " fmt "\n", (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG_("E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG_("W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG_("I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { (void)(tag); } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { (void)(tag); } while (0)
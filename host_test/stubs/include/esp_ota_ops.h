@@ -0,0 +1,32 @@
+// esp_ota_ops.h, host build: esp_ota_* write into the RAM slot; host_ota_* let a test look.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+typedef uint32_t esp_ota_handle_t;
+
+typedef struct {
+    char    project_name[32];
+    char    version[32];
+    uint8_t app_elf_sha256[32];
+} esp_app_desc_t;
+
+const esp_partition_t *esp_ota_get_running_partition(void);
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start);
+esp_err_t esp_ota_get_partition_description(const esp_partition_t *p, esp_app_desc_t *out);
+esp_err_t esp_ota_begin(const esp_partition_t *p, size_t image_size, esp_ota_handle_t *out);
+esp_err_t esp_ota_write(esp_ota_handle_t h, const void *data, size_t len);
+esp_err_t esp_ota_end(esp_ota_handle_t h);
+esp_err_t esp_ota_abort(esp_ota_handle_t h);
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *p);
+
+/* What reached the passive slot since the last esp_ota_begin(). */
+typedef struct {
+    uint32_t begins, ends, aborts, boot_sets;
+    size_t   written;
+    const uint8_t *data;        /* slot contents, `written` bytes */
+} host_ota_stats_t;
+void host_ota_stats(host_ota_stats_t *out);
@@ -0,0 +1,11 @@
+// esp_partition.h, host build: two app slots, the passive one backed by RAM (stubs/esp_stubs.c).
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char     label[17];
+} esp_partition_t;
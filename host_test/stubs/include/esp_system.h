@@ -0,0 +1,5 @@
+#pragma once
+#include "esp_err.h"
+
+/* There is nothing to reboot into: prints and aborts, so a test that gets here fails. */
+void esp_restart(void) __attribute__((noreturn));
@@ -0,0 +1,28 @@
+// FreeRTOS.h, host build: the subset the BLE core uses, on pthreads (stubs/freertos_posix.c).
+// One tick is 1 ms. Critical sections are a recursive mutex per portMUX: they exclude each
+// other, not the scheduler.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskIDLE_PRIORITY    0
+
+typedef pthread_mutex_t portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+#define portENTER_CRITICAL(m) pthread_mutex_lock(m)
+#define portEXIT_CRITICAL(m)  pthread_mutex_unlock(m)
+
+#define configASSERT(x) do { if (!(x)) __builtin_trap(); } while (0)
@@ -0,0 +1,12 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+/* Mutexes are binary semaphores given once at creation: no priority inheritance, and no
+ * owner check on give. */
+typedef struct host_sem *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t s);
+void              vSemaphoreDelete(SemaphoreHandle_t s);
@@ -0,0 +1,13 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/* A detached thread; stack size and priority are ignored. */
+BaseType_t   xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                         UBaseType_t prio, TaskHandle_t *out);
+void         vTaskDelete(TaskHandle_t t);   /* NULL only: ends the calling thread */
+void         vTaskDelay(TickType_t ticks);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
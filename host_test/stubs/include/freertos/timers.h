@@ -0,0 +1,14 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Callbacks run on one service thread, like the FreeRTOS timer task. */
+typedef struct host_timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t t);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload,
+                           void *id, TimerCallbackFunction_t cb);
+BaseType_t    xTimerStart(TimerHandle_t t, TickType_t wait);
+BaseType_t    xTimerStop(TimerHandle_t t, TickType_t wait);
+BaseType_t    xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait);
+void         *pvTimerGetTimerID(TimerHandle_t t);
@@ -0,0 +1,23 @@
+// host_fakes.h, controls for the fakes of the components around the BLE core (fakes.c).
+#pragma once
+#include <stdint.h>
+#include "dht.h"
+#include "syscoord.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Mode syscoord_get_mode() reports; STARTUP until set. */
+void host_set_mode(sc_mode_t m);
+
+/* A DHT read: becomes the latest sensor record and goes to every dht_subscribe() callback,
+ * as the sampler task would deliver it. */
+void host_dht_sample(const dht_sample_t *s);
+
+/* syscoord_on_ble_state() calls so far, and the last argument. */
+uint32_t host_ble_state_calls(bool *connected);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#pragma once
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
@@ -0,0 +1,90 @@
+// test_ble_tlm.c, telemetry advertising payload and its change/rate gate.
+#include <string.h>
+#include "host_test.h"
+#include "ble_tlm.h"
+
+static const uint8_t UUID[16] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+                                  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f };
+
+int main(void) {
+    uint8_t adv[40];
+    const ble_tlm_t t = { .mode = 3, .errsrc = 9, .alert_seq = 0x42, .alert_code = 5,
+                          .t_dc = -123, .rh_dp = 456, .fw = 0xA1B2 };
+
+    /* Layout: AD structures chain exactly to 31 bytes, the legacy ADV maximum. */
+    size_t n = ble_tlm_build_adv(&t, UUID, adv, sizeof(adv));
+    CHECK_EQ(n, BLE_TLM_ADV_LEN);
+    CHECK_EQ(n, 31);
+    size_t at = 0, ads = 0;
+    while (at < n) {
+        CHECK(adv[at] > 0);
+        at += 1 + adv[at];
+        ++ads;
+    }
+    CHECK_EQ(at, n);
+    CHECK_EQ(ads, 2);
+    CHECK(adv[0] == 2 && adv[1] == 0x01 && adv[2] == 0x06);
+    CHECK_EQ(adv[3], 1 + 16 + BLE_TLM_LEN);
+    CHECK_EQ(adv[4], 0x21);
+    CHECK(memcmp(adv + 5, UUID, 16) == 0);
+
+    /* The 10-byte block. */
+    const uint8_t want[BLE_TLM_LEN] = { (BLE_TLM_VER << 4) | 3, 9, 0x42, 5,
+                                        0x85, 0xFF,     // -123 LE
+                                        0xC8, 0x01,     // 456 LE
+                                        0xB2, 0xA1 };
+    CHECK(memcmp(adv + 21, want, BLE_TLM_LEN) == 0);
+
+    /* Mode is a nibble; the N/A markers encode as given. */
+    ble_tlm_t na = t;
+    na.mode = 0x1F;
+    na.t_dc = BLE_TLM_T_NA;
+    na.rh_dp = BLE_TLM_RH_NA;
+    CHECK_EQ(ble_tlm_build_adv(&na, UUID, adv, 31), 31);
+    CHECK_EQ(adv[21], (BLE_TLM_VER << 4) | 0x0F);
+    CHECK(adv[25] == 0x00 && adv[26] == 0x80 && adv[27] == 0xFF && adv[28] == 0xFF);
+    CHECK_EQ(ble_tlm_build_adv(&t, UUID, adv, 30), 0);
+
+    /* Gate: first block always; unchanged never; a change waits out min_ms. */
+    ble_tlm_gate_t g;
+    memset(&g, 0, sizeof(g));
+    ble_tlm_t cur = t;
+    CHECK(ble_tlm_due(&g, &cur, 1000, 5000));
+    CHECK(!ble_tlm_due(&g, &cur, 1001, 5000));
+    CHECK(!ble_tlm_due(&g, &cur, 60000, 5000));     // no change: nothing to refresh
+    cur.t_dc++;
+    CHECK(!ble_tlm_due(&g, &cur, 5999, 5000));      // too soon after the last one
+    CHECK(ble_tlm_due(&g, &cur, 6000, 5000));
+    cur.errsrc = 2;
+    CHECK(!ble_tlm_due(&g, &cur, 10999, 5000));
+    CHECK(ble_tlm_due(&g, &cur, 11000, 5000));
+    CHECK_EQ(g.last.errsrc, 2);
+    /* Every field counts as a change. */
+    ble_tlm_t base = cur;
+    uint32_t now = 20000;
+    for (int f = 0; f < 7; ++f) {
+        ble_tlm_t c = base;
+        switch (f) {
+            case 0: c.mode++; break;
+            case 1: c.errsrc++; break;
+            case 2: c.alert_seq++; break;
+            case 3: c.alert_code++; break;
+            case 4: c.t_dc++; break;
+            case 5: c.rh_dp++; break;
+            default: c.fw++; break;
+        }
+        CHECK(ble_tlm_due(&g, &c, now, 5000));
+        now += 5000;
+        CHECK(ble_tlm_due(&g, &base, now, 5000));
+        now += 5000;
+    }
+    /* The rate limit survives the ms tick wrapping. */
+    memset(&g, 0, sizeof(g));
+    CHECK(ble_tlm_due(&g, &base, UINT32_MAX - 1000, 5000));
+    cur = base;
+    cur.fw++;
+    CHECK(!ble_tlm_due(&g, &cur, 3000, 5000));
+    CHECK(ble_tlm_due(&g, &cur, 4000, 5000));
+
+    HOST_TEST_DONE();
+}
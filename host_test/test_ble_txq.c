@@ -0,0 +1,135 @@
+// test_ble_txq.c, TX byte ring: packing, wrap, newest-line reads and overflow.
+#include <string.h>
+#include "host_test.h"
+#include "ble_txq.h"
+
+static ble_txq_t q;
+
+/* Send everything queued the way gatt_tx.c does: front() chunks of at most cap bytes. */
+static size_t drain(size_t cap, char *out, size_t out_cap, unsigned *notifs) {
+    size_t got = 0;
+    const uint8_t *p;
+    size_t n;
+    *notifs = 0;
+    while ((n = ble_txq_front(&q, &p, cap)) > 0) {
+        CHECK(n <= cap);
+        if (got + n <= out_cap) memcpy(out + got, p, n);
+        got += n;
+        ble_txq_consume(&q, n);
+        ++*notifs;
+    }
+    return got;
+}
+
+static bool last_is(size_t off, const char *want) {
+    uint8_t out[BLE_TXQ_BYTES];
+    size_t n = 0;
+    if (!ble_txq_last(&q, off, out, sizeof(out), &n)) return false;
+    return n == strlen(want) && memcmp(out, want, n) == 0;
+}
+
+int main(void) {
+    char out[2 * BLE_TXQ_BYTES];
+    unsigned notifs;
+
+    /* Short lines pack into one notification, newlines included. */
+    ble_txq_reset(&q);
+    CHECK(!ble_txq_ready(&q, 2));
+    CHECK(ble_txq_push_line(&q, "OK", 2));
+    CHECK(ble_txq_push_line(&q, "T=21.5", 6));
+    CHECK(ble_txq_ready(&q, 2));
+    CHECK_EQ(drain(244, out, sizeof(out), &notifs), 10);
+    CHECK_EQ(notifs, 1);
+    CHECK(memcmp(out, "OK\nT=21.5\n", 10) == 0);
+
+    /* A line longer than the MTU payload spans notifications; the newline rides last. */
+    ble_txq_reset(&q);
+    char big[50];
+    for (int i = 0; i < 50; ++i) big[i] = (char)('a' + i % 26);
+    CHECK(ble_txq_push_line(&q, big, sizeof(big)));
+    CHECK_EQ(drain(20, out, sizeof(out), &notifs), 51);
+    CHECK_EQ(notifs, 3);
+    CHECK(memcmp(out, big, 50) == 0 && out[50] == '\n');
+    CHECK_EQ(q.st.notifs, 3);
+    CHECK_EQ(q.st.bytes, 51);
+
+    /* Wrap: move the head near the ring end, then queue a line across it. front() stops
+     * at the end (no staging copy) and the rest follows from the start. */
+    ble_txq_reset(&q);
+    size_t pre = BLE_TXQ_BYTES - 10;
+    CHECK(ble_txq_push_line(&q, big, 0));
+    for (size_t left = pre - 1; left; ) {
+        size_t n = left > 40 ? 40 : left;
+        /* n - 1 bytes plus the newline */
+        CHECK(ble_txq_push_line(&q, big, n - 1));
+        left -= n;
+    }
+    CHECK_EQ(q.len, pre);
+    drain(512, out, sizeof(out), &notifs);
+    CHECK_EQ(q.head, pre);
+    CHECK(ble_txq_push_line(&q, "0123456789abcdefghij", 20));
+    const uint8_t *p;
+    CHECK_EQ(ble_txq_front(&q, &p, 512), 10);
+    CHECK(memcmp(p, "0123456789", 10) == 0);
+    ble_txq_consume(&q, 10);
+    CHECK_EQ(q.head, 0);
+    CHECK_EQ(ble_txq_front(&q, &p, 512), 11);
+    CHECK(memcmp(p, "abcdefghij\n", 11) == 0);
+    /* The newest line reads back whole across the wrap, also from an offset. */
+    CHECK(last_is(0, "0123456789abcdefghij"));
+    CHECK(last_is(8, "89abcdefghij"));
+    ble_txq_consume(&q, 11);
+    CHECK_EQ(q.len, 0);
+
+    /* keep_line (notifications off) then last(), after a queued line was consumed. */
+    ble_txq_reset(&q);
+    CHECK(last_is(0, ""));
+    CHECK(ble_txq_push_line(&q, "first", 5));
+    drain(244, out, sizeof(out), &notifs);
+    CHECK(last_is(0, "first"));          // consumed bytes stay readable until overwritten
+    ble_txq_keep_line(&q, "hello", 5);
+    CHECK_EQ(q.len, 0);                  // kept, not queued
+    CHECK(last_is(0, "hello"));
+    CHECK(last_is(2, "llo"));
+    CHECK(last_is(5, ""));
+    uint8_t tmp[4];
+    size_t n;
+    CHECK(!ble_txq_last(&q, 6, tmp, sizeof(tmp), &n));
+    CHECK(ble_txq_last(&q, 0, tmp, 3, &n) && n == 3 && memcmp(tmp, "hel", 3) == 0);
+    ble_txq_keep_line(&q, "bye", 3);     // the next line overwrites it
+    CHECK(last_is(0, "bye"));
+
+    /* keep_line with a full queue keeps only what fits (nothing). */
+    ble_txq_reset(&q);
+    CHECK(ble_txq_push_line(&q, out, BLE_TXQ_BYTES - 1));
+    CHECK_EQ(q.len, BLE_TXQ_BYTES);
+    ble_txq_keep_line(&q, "x", 1);
+    CHECK(last_is(0, ""));
+
+    /* Overflow: a line is queued whole or not at all, and the drop is counted. */
+    ble_txq_reset(&q);
+    memset(out, 'z', sizeof(out));
+    CHECK(ble_txq_push_line(&q, out, BLE_TXQ_BYTES - 11));   // 10 bytes left
+    CHECK(!ble_txq_push_line(&q, out, 10));                   // needs 11
+    CHECK_EQ(q.st.dropped, 1);
+    CHECK_EQ(q.len, BLE_TXQ_BYTES - 10);
+    CHECK(ble_txq_push_line(&q, out, 9));                     // exactly fits
+    CHECK_EQ(q.len, BLE_TXQ_BYTES);
+    CHECK(!ble_txq_push_line(&q, "", 0));                     // not even a newline
+    CHECK_EQ(q.st.dropped, 2);
+    CHECK_EQ(q.st.lines, 2);
+    q.congested = true;
+    CHECK(!ble_txq_ready(&q, 2));
+    q.congested = false;
+    q.inflight = 2;
+    CHECK(!ble_txq_ready(&q, 2));
+    CHECK(ble_txq_ready(&q, 3));
+
+    /* A line longer than the whole queue is cut to fit an empty one. */
+    ble_txq_reset(&q);
+    CHECK(ble_txq_push_line(&q, out, sizeof(out)));
+    CHECK_EQ(q.len, BLE_TXQ_BYTES);
+    CHECK_EQ(q.last_len, BLE_TXQ_BYTES - 1);
+
+    HOST_TEST_DONE();
+}
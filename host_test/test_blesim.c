@@ -0,0 +1,235 @@
+// test_blesim.c, the BLE core on Linux: port_sim.c as the host, scripted phones as centrals.
+// Runs the blesim scripts (session, storm, ota) and checks their result lines, then drives
+// a link by hand: DHT notifications, an unknown command, the RECOVERY gate and a BLE-OTA
+// through ota_handler into the stubbed passive slot.
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "app_cfg.h"          // BLE_MAX_CONN
+#include "ble_fallback.h"
+#include "ble_sim.h"
+#include "esp_ota_ops.h"      // host_ota_stats()
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "gatt_priv.h"        // IDX_*, gatt_link_count()
+#include "host_fakes.h"
+
+#define MTU      185
+#define WAIT_MS  2000
+
+/* ---------- blesim scripts ---------- */
+
+static char s_out[2048];
+
+static void collect(void *user, const char *line) {
+    (void)user;
+    strncat(s_out, line, sizeof(s_out) - strlen(s_out) - 1);
+}
+
+static const char *run(const char *script) {
+    s_out[0] = '\0';
+    CHECK_EQ(ble_sim_run(script, collect, NULL), ESP_OK);
+    printf("> blesim %s\n%s", script, s_out);
+    return s_out;
+}
+
+/* Value of `key=` in the line starting with `tag`; -1 if there is none. */
+static long field(const char *out, const char *tag, const char *key) {
+    const char *l = strstr(out, tag);
+    if (!l) return -1;
+    const char *end = strchr(l, '\n');
+    char k[24];
+    snprintf(k, sizeof(k), " %s=", key);
+    const char *v = strstr(l, k);
+    if (!v || (end && v > end)) return -1;
+    return strtol(v + strlen(k), NULL, 10);
+}
+
+static void test_session(void) {
+    const char *o = run("session 20");
+    CHECK_EQ(field(o, "SESSION", "replies"), 20);
+    CHECK(field(o, "SESSION", "notifs") >= 20);
+    CHECK_EQ(field(o, "SESSION", "busy"), 0);
+    CHECK_EQ(gatt_link_count(), 0);
+}
+
+static void test_storm(void) {
+    const char *o = run("storm 5");
+    CHECK_EQ(field(o, "STORM", "connects"), 5 * BLE_MAX_CONN);
+    CHECK_EQ(field(o, "STORM", "refused"), 5);
+    CHECK_EQ(field(o, "STORM", "replies"), 5 * BLE_MAX_CONN);
+    CHECK_EQ(field(o, "STORM", "links_left"), 0);
+}
+
+static void test_ota_script(const char *script, long size) {
+    host_ota_stats_t before, after;
+    host_ota_stats(&before);
+    const char *o = run(script);
+    CHECK_EQ(field(o, "OTA", "bytes"), size - 1);
+    CHECK(strstr(o, "abort not acked") == NULL);
+    CHECK(strstr(o, "IMG got=") != NULL);
+    char want[48];
+    snprintf(want, sizeof(want), "IMG got=%ld/%ld bad=0 aborted\n", size - 1, size);
+    CHECK(strstr(o, want) != NULL);
+    host_ota_stats(&after);
+    CHECK_EQ(after.begins, before.begins);   // the RAM sink took it, not the slot
+}
+
+/* ---------- A link driven by hand ---------- */
+
+static struct {
+    portMUX_TYPE mux;
+    char     part[256];
+    size_t   part_n;
+    char     last[256];
+    uint32_t lines;
+    char     dht[64];           // newest DHT notification, as text
+    uint32_t dhts;
+} s_rx = { .mux = portMUX_INITIALIZER_UNLOCKED };
+
+static void sink(const ble_sim_note_t *n, void *user) {
+    (void)user;
+    portENTER_CRITICAL(&s_rx.mux);
+    if (n->idx == IDX_TX_VAL) {
+        for (uint16_t i = 0; i < n->len; ++i) {
+            char c = (char)n->data[i];
+            if (c == '\n') {
+                memcpy(s_rx.last, s_rx.part, s_rx.part_n);
+                s_rx.last[s_rx.part_n] = '\0';
+                s_rx.part_n = 0;
+                s_rx.lines++;
+            } else if (s_rx.part_n < sizeof(s_rx.part) - 1) {
+                s_rx.part[s_rx.part_n++] = c;
+            }
+        }
+    } else if (n->idx == IDX_DHT_VAL) {
+        size_t k = n->len < sizeof(s_rx.dht) - 1 ? n->len : sizeof(s_rx.dht) - 1;
+        memcpy(s_rx.dht, n->data, k);
+        s_rx.dht[k] = '\0';
+        s_rx.dhts++;
+    }
+    portEXIT_CRITICAL(&s_rx.mux);
+}
+
+static uint32_t lines(void) {
+    portENTER_CRITICAL(&s_rx.mux);
+    uint32_t n = s_rx.lines;
+    portEXIT_CRITICAL(&s_rx.mux);
+    return n;
+}
+
+/* Connection events until a TX line past `seen` arrives (CTRL runs on the BLE worker). */
+static bool reply(uint16_t conn, uint32_t seen, char *out, size_t cap) {
+    for (int ms = 0; ms < WAIT_MS; ++ms) {
+        ble_sim_run_events(conn, 1);
+        portENTER_CRITICAL(&s_rx.mux);
+        bool got = s_rx.lines > seen;
+        if (got) snprintf(out, cap, "%s", s_rx.last);
+        portEXIT_CRITICAL(&s_rx.mux);
+        if (got) return true;
+        vTaskDelay(1);
+    }
+    out[0] = '\0';
+    return false;
+}
+
+static void write_str(uint16_t conn, uint8_t idx, const char *s) {
+    CHECK_EQ(ble_sim_write(conn, idx, (const uint8_t *)s, (uint16_t)strlen(s)), ESP_OK);
+}
+
+static void send_cmd(uint16_t conn, uint8_t idx, const char *s, char *out, size_t cap) {
+    uint32_t seen = lines();
+    write_str(conn, idx, s);
+    if (!reply(conn, seen, out, cap)) fprintf(stderr, "no reply to '%s'\n", s);
+}
+
+static void test_link(uint16_t conn) {
+    char line[64];
+    send_cmd(conn, IDX_RX_VAL, "hello\n", line, sizeof(line));
+    CHECK(strcmp(line, "WHAT") == 0);
+
+    /* DHT: the value on subscribe, then the sampler's reads through the per-link filter. */
+    CHECK_EQ(ble_sim_subscribe(conn, IDX_DHT_VAL, true), ESP_OK);
+    while (ble_sim_run_events(conn, 1)) {}
+    CHECK(strcmp(s_rx.dht, "DHT NA") == 0);
+    uint32_t n0 = s_rx.dhts;
+    host_dht_sample(&(dht_sample_t){ .valid = true, .temp_c = 23.4f, .rh = 45.0f, .age_ms = 12 });
+    while (ble_sim_run_events(conn, 1)) {}
+    CHECK_EQ(s_rx.dhts, n0 + 1);
+    CHECK(strcmp(s_rx.dht, "DHT T=23.4C RH=45.0% age=12ms") == 0);
+    host_dht_sample(&(dht_sample_t){ .valid = true, .temp_c = 23.4f, .rh = 45.0f, .age_ms = 5 });
+    while (ble_sim_run_events(conn, 1)) {}
+    CHECK_EQ(s_rx.dhts, n0 + 1);             // no change: inside the deadband
+    CHECK_EQ(ble_sim_subscribe(conn, IDX_DHT_VAL, false), ESP_OK);
+
+    host_set_mode(SC_MODE_NORMAL);
+    send_cmd(conn, IDX_OTA_CTRL_VAL, "BL_OTA START 1000 0", line, sizeof(line));
+    CHECK(strcmp(line, "ERR FORBIDDEN") == 0);
+    host_set_mode(SC_MODE_RECOVERY);
+}
+
+/* Framed BLE-OTA through ota_handler into the stubbed slot: all but the last byte, abort. */
+static void test_ota_slot(uint16_t conn) {
+    const uint32_t size = 3000, chunk = MTU - 3 - 6;
+    char line[64];
+    send_cmd(conn, IDX_OTA_CTRL_VAL, "BL_OTA START 3000 0", line, sizeof(line));
+    CHECK(strcmp(line, "ACK START") == 0);
+
+    uint8_t frame[MTU];
+    uint32_t sent = 0, seq = 0;
+    while (sent < size - 1) {
+        uint32_t n = size - 1 - sent < chunk ? size - 1 - sent : chunk;
+        frame[0] = (uint8_t)seq; frame[1] = (uint8_t)(seq >> 8); frame[2] = frame[3] = 0;
+        frame[4] = (uint8_t)n;   frame[5] = (uint8_t)(n >> 8);
+        for (uint32_t i = 0; i < n; ++i) frame[6 + i] = (uint8_t)((sent + i) * 7);
+        CHECK_EQ(ble_sim_write(conn, IDX_OTA_DATA_VAL, frame, (uint16_t)(n + 6)), ESP_OK);
+        while (ble_sim_run_events(conn, 1)) {}
+        sent += n;
+        seq++;
+    }
+    host_ota_stats_t st;
+    host_ota_stats(&st);
+    CHECK_EQ(st.written, size - 1);
+    bool same = true;
+    for (uint32_t i = 0; i < size - 1 && st.data; ++i) same &= st.data[i] == (uint8_t)(i * 7);
+    CHECK(same);
+
+    send_cmd(conn, IDX_OTA_CTRL_VAL, "BL_OTA ABORT", line, sizeof(line));
+    CHECK(strcmp(line, "OK ABORTED") == 0);
+    host_ota_stats(&st);
+    CHECK_EQ(st.aborts, 1);
+    CHECK_EQ(st.ends, 0);
+    CHECK_EQ(st.boot_sets, 0);
+}
+
+int main(void) {
+    host_set_mode(SC_MODE_RECOVERY);
+
+    test_session();                          // borrows the stack and gives it back
+    ble_fallback_stats_t fs;
+    ble_fallback_get_stats(&fs);
+    CHECK(!fs.up);
+    CHECK_EQ(fs.cycles, 1);
+
+    ble_fallback_init();                     // as RECOVERY entry does
+    test_storm();
+    test_ota_script("ota 20000 0 bulk", 20000);
+    test_ota_script("ota 5000 100", 5000);
+
+    ble_sim_set_sink(sink, NULL);
+    const uint16_t conn = 1;
+    CHECK_EQ(ble_sim_connect(conn), ESP_OK);
+    ble_sim_mtu(conn, MTU);
+    CHECK_EQ(ble_sim_subscribe(conn, IDX_TX_VAL, true), ESP_OK);
+    test_link(conn);
+    test_ota_slot(conn);
+    ble_sim_disconnect(conn);
+    ble_sim_set_sink(NULL, NULL);
+    CHECK_EQ(gatt_link_count(), 0);
+
+    ble_fallback_stop();
+    ble_fallback_get_stats(&fs);
+    CHECK(!fs.up);
+    CHECK_EQ(fs.cycles, 2);
+    HOST_TEST_DONE();
+}
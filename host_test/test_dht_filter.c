@@ -0,0 +1,45 @@
+// test_dht_filter.c, deadband + heartbeat gate of the DHT stream.
+#include "host_test.h"
+#include "dht_types.h"
+
+static dht_filter_t f;
+
+static bool feed(bool valid, float t, float rh, uint32_t ms) {
+    const dht_sample_t s = { .valid = valid, .temp_c = t, .rh = rh };
+    return dht_filter_pass(&f, &s, ms);
+}
+
+int main(void) {
+    /* All zero: every sample. */
+    dht_filter_init(&f, &(dht_filter_cfg_t){ 0 });
+    CHECK(feed(true, 21.0f, 40.0f, 0));
+    CHECK(feed(true, 21.0f, 40.0f, 2000));
+
+    /* 0.2 °C / 1.0 %RH deadband, 60 s heartbeat. */
+    dht_filter_init(&f, &(dht_filter_cfg_t){ .db_t_dc = 2, .db_rh_dp = 10, .heartbeat_ms = 60000 });
+    CHECK(feed(true, 21.0f, 40.0f, 1000));        // first sample always
+    CHECK(!feed(true, 21.2f, 40.9f, 3000));       // within both deadbands
+    CHECK(feed(true, 21.3f, 40.0f, 5000));        // T moved 0.3 from the last sent
+    CHECK(!feed(true, 21.1f, 40.0f, 7000));       // 0.2 back: not more than the band
+    CHECK(feed(true, 21.3f, 38.9f, 9000));        // RH moved 1.1
+    CHECK(!feed(true, 21.3f, 38.9f, 68999));
+    CHECK(feed(true, 21.3f, 38.9f, 69000));       // heartbeat
+
+    /* Validity flips pass both ways, whatever the values. */
+    CHECK(feed(false, 0, 0, 70000));
+    CHECK(!feed(false, 0, 0, 72000));
+    CHECK(feed(true, 21.3f, 38.9f, 74000));
+
+    /* Negative temperatures round symmetrically. */
+    CHECK(feed(true, -5.0f, 50.0f, 76000));
+    CHECK(!feed(true, -5.2f, 50.0f, 78000));
+    CHECK(feed(true, -5.3f, 50.0f, 80000));
+
+    /* The heartbeat survives the ms tick wrapping. */
+    dht_filter_init(&f, &(dht_filter_cfg_t){ .db_t_dc = 50, .heartbeat_ms = 10000 });
+    CHECK(feed(true, 20.0f, 40.0f, UINT32_MAX - 4000));
+    CHECK(!feed(true, 20.0f, 40.0f, 4000));
+    CHECK(feed(true, 20.0f, 40.0f, 6000));
+
+    HOST_TEST_DONE();
+}
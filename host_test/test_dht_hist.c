@@ -0,0 +1,80 @@
+// test_dht_hist.c, history rings, minute/hour roll-ups and the BLE pack format.
+#include <string.h>
+#include "host_test.h"
+#include "dht_hist.h"
+
+static dht_hist_t h;
+static dht_hist_rec_t rec[DHT_HIST_RAW_N + 8];
+
+static uint16_t le16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return le16(p) | (uint32_t)le16(p + 2) << 16; }
+
+int main(void) {
+    dht_hist_init(&h);
+    CHECK_EQ(dht_hist_read(&h, DHT_TIER_MIN, 10, rec), 0);
+
+    /* Minute 0: 3 samples; minute 1: 1 sample (open). Negative temperatures round
+     * away from zero like positive ones. */
+    dht_hist_add(&h, 10, -15, 400);
+    dht_hist_add(&h, 30, -20, 420);
+    dht_hist_add(&h, 50, -16, 410);
+    dht_hist_add(&h, 70, 5, 500);
+
+    size_t n = dht_hist_read(&h, DHT_TIER_MIN, 10, rec);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(rec[0].ts_s, 0);
+    CHECK_EQ(rec[0].n, 3);
+    CHECK_EQ(rec[0].t_min, -20);
+    CHECK_EQ(rec[0].t_max, -15);
+    CHECK_EQ(rec[0].t_avg, -17);     // -51 / 3
+    CHECK_EQ(rec[0].rh_avg, 410);
+    CHECK_EQ(rec[1].ts_s, 60);       // open bucket last
+    CHECK_EQ(rec[1].n, 1);
+    CHECK_EQ(rec[1].t_avg, 5);
+
+    /* A window of one is the open bucket only. */
+    CHECK_EQ(dht_hist_read(&h, DHT_TIER_MIN, 1, rec), 1);
+    CHECK_EQ(rec[0].ts_s, 60);
+
+    /* Hour tier still has everything in its open bucket. */
+    CHECK_EQ(dht_hist_read(&h, DHT_TIER_HOUR, 5, rec), 1);
+    CHECK_EQ(rec[0].n, 4);
+
+    /* Raw ring wraps: newest DHT_HIST_RAW_N survive, oldest first. */
+    for (uint32_t i = 0; i < DHT_HIST_RAW_N + 5; ++i) dht_hist_add(&h, 3600 + 2 * i, (int16_t)i, 300);
+    n = dht_hist_read(&h, DHT_TIER_RAW, DHT_HIST_RAW_N + 8, rec);
+    CHECK_EQ(n, DHT_HIST_RAW_N);
+    CHECK_EQ(rec[0].t_avg, 5);
+    CHECK_EQ(rec[n - 1].t_avg, DHT_HIST_RAW_N + 4);
+    CHECK_EQ(rec[n - 1].n, 1);
+
+    /* The first hour closed when the 3600 s sample arrived. */
+    n = dht_hist_read(&h, DHT_TIER_HOUR, 5, rec);
+    CHECK_EQ(n, 2);
+    CHECK_EQ(rec[0].ts_s, 0);
+    CHECK_EQ(rec[0].n, 4);
+    CHECK_EQ(rec[1].ts_s, 3600);
+
+    /* Pack: header + whole records only; a 2-record buffer gets 2 of them. */
+    uint8_t buf[8 + 2 * 18 + 5];
+    size_t len = dht_hist_pack(&h, DHT_TIER_MIN, 50, 9999, buf, sizeof(buf));
+    CHECK_EQ(len, 8 + 2 * 18);
+    CHECK_EQ(buf[0], DHT_HIST_PACK_VER);
+    CHECK_EQ(buf[1], DHT_TIER_MIN);
+    CHECK_EQ(le16(buf + 2), 2);
+    CHECK_EQ(le32(buf + 4), 9999);
+    dht_hist_read(&h, DHT_TIER_MIN, 2, rec);
+    CHECK_EQ(le32(buf + 8), rec[0].ts_s);
+    CHECK_EQ((int16_t)le16(buf + 8 + 4), rec[0].t_min);
+    CHECK_EQ(le16(buf + 8 + 16), rec[0].n);
+    CHECK_EQ(le32(buf + 8 + 18), rec[1].ts_s);
+
+    len = dht_hist_pack(&h, DHT_TIER_RAW, 3, 0, buf, sizeof(buf));
+    CHECK_EQ(len, 8 + 3 * 8);
+    CHECK_EQ((int16_t)le16(buf + 8 + 2 * 8 + 4), DHT_HIST_RAW_N + 4);
+
+    CHECK_EQ(dht_hist_pack(&h, DHT_TIER_RAW, 3, 0, buf, 7), 0);
+    CHECK_EQ(dht_hist_capacity(DHT_TIER_HOUR), DHT_HIST_HOUR_N);
+
+    HOST_TEST_DONE();
+}
@@ -0,0 +1,53 @@
+// test_gatt_bin.c, byte layouts of the binary ERRSRC, ALERT and DHT values.
+// Clients parse these byte by byte, so every byte is pinned here.
+#include <string.h>
+#include "host_test.h"
+#include "gatt_bin.h"
+
+static bool bytes_are(const uint8_t *got, size_t n, const uint8_t *want, size_t wn) {
+    if (n != wn) { fprintf(stderr, "length %zu, expected %zu\n", n, wn); return false; }
+    for (size_t i = 0; i < n; ++i) {
+        if (got[i] != want[i]) {
+            fprintf(stderr, "byte %zu: 0x%02x, expected 0x%02x\n", i, got[i], want[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    uint8_t b[GATT_BIN_MAX + 4];
+    size_t n;
+
+    CHECK_EQ(GATT_BIN_MAX, 10);
+    CHECK(GATT_BIN_MAX <= 20);   // fits the default-MTU payload
+
+    /* ERRSRC: ver, code, ms u32 LE. */
+    n = gatt_bin_errsrc(7, 0x12345678u, b, sizeof(b));
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 7, 0x78, 0x56, 0x34, 0x12 }, 6));
+    n = gatt_bin_errsrc(0, 0xFFFFFFFFu, b, GATT_BIN_ERRSRC_LEN);
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 0, 0xFF, 0xFF, 0xFF, 0xFF }, 6));
+    CHECK_EQ(gatt_bin_errsrc(1, 0, b, GATT_BIN_ERRSRC_LEN - 1), 0);
+
+    /* ALERT: ver, code, seq u16 LE. */
+    n = gatt_bin_alert(3, 0xBEEF, b, sizeof(b));
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 3, 0xEF, 0xBE }, 4));
+    CHECK_EQ(gatt_bin_alert(3, 1, b, 3), 0);
+
+    /* DHT: ver, flags, T int16 LE (two's complement), RH u16 LE, age u32 LE. */
+    n = gatt_bin_dht(&(gatt_bin_dht_t){ .valid = true, .t_cdeg = 2350, .rh_cpct = 6510, .age_ms = 1500 },
+                     b, sizeof(b));
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 1, 0x2E, 0x09, 0x6E, 0x19, 0xDC, 0x05, 0, 0 }, 10));
+    n = gatt_bin_dht(&(gatt_bin_dht_t){ .valid = true, .t_cdeg = -1010, .rh_cpct = 0, .age_ms = 0x01020304 },
+                     b, sizeof(b));
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 1, 0x0E, 0xFC, 0, 0, 0x04, 0x03, 0x02, 0x01 }, 10));
+
+    /* Invalid: the N/A markers whatever the fields hold; age still reported. */
+    n = gatt_bin_dht(&(gatt_bin_dht_t){ .valid = false, .t_cdeg = 2000, .rh_cpct = 5000, .age_ms = 9 },
+                     b, sizeof(b));
+    CHECK(bytes_are(b, n, (const uint8_t[]){ 1, 0, 0x00, 0x80, 0xFF, 0xFF, 9, 0, 0, 0 }, 10));
+    CHECK_EQ(gatt_bin_dht(&(gatt_bin_dht_t){ 0 }, b, GATT_BIN_DHT_LEN - 1), 0);
+    CHECK_EQ(gatt_bin_dht(NULL, b, sizeof(b)), 0);
+
+    HOST_TEST_DONE();
+}
@@ -0,0 +1,103 @@
+// test_sensor_filter.c, rate-of-change rejection and the odd-window median.
+#include <string.h>
+#include "host_test.h"
+#include "sensor_filter.h"
+
+static sensor_filter_t f;
+
+/* One single-value step; *out gets the filtered value when accepted. */
+static bool step1(int32_t v, uint32_t ms, int32_t *out) {
+    int32_t x[1] = { v };
+    bool ok = sensor_filter_step(&f, x, 1, ms);
+    if (ok && out) *out = x[0];
+    return ok;
+}
+
+int main(void) {
+    int32_t o = 0;
+
+    /* Normalize: windows are odd and capped. */
+    sensor_filter_cfg_t c = { .median_n = 4 };
+    sensor_filter_normalize(&c);
+    CHECK_EQ(c.median_n, 3);
+    c.median_n = 20;
+    sensor_filter_normalize(&c);
+    CHECK_EQ(c.median_n, SENSOR_MEDIAN_MAX);
+
+    /* Filter off: values pass untouched. */
+    sensor_filter_init(&f, NULL);
+    CHECK(step1(123, 0, &o) && o == 123);
+    CHECK(step1(-9999, 1, &o) && o == -9999);
+
+    /* Median of 5: a single spike never reaches the output. Before the window fills,
+     * the newest odd number of entries. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .median_n = 5 });
+    const int32_t in[]  = { 10, 12, 100, 11, 13, 9, -50, 12, 12 };
+    const int32_t out[] = { 10, 12,  12, 12, 12, 12,  11, 11, 12 };
+    for (unsigned i = 0; i < sizeof(in) / sizeof(in[0]); ++i) {
+        CHECK(step1(in[i], i * 2000, &o));
+        if (o != out[i]) { fprintf(stderr, "median step %u: %d, expected %d\n", i, o, out[i]); ++g_fails; }
+    }
+
+    /* Each value has its own window. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .median_n = 3 });
+    int32_t v2[2];
+    const int32_t a[3][2] = { { 1, 300 }, { 50, 100 }, { 2, 200 } };
+    for (int i = 0; i < 3; ++i) {
+        memcpy(v2, a[i], sizeof(v2));
+        CHECK(sensor_filter_step(&f, v2, 2, (uint32_t)i * 1000));
+    }
+    CHECK_EQ(v2[0], 2);
+    CHECK_EQ(v2[1], 200);
+
+    /* Rate limit 10/s, no median: 2 s after 200, 220 is fine, 250 is not. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .roc_per_s = { 10 } });
+    CHECK(step1(200, 0, &o));
+    CHECK(step1(220, 2000, &o) && o == 220);      // exactly at the limit
+    CHECK(!step1(241, 4000, NULL));               // 21 in 2 s
+    CHECK_EQ(f.rejects, 1);
+    CHECK(step1(235, 5000, &o));                  // 15 in 3 s since the last accepted
+    CHECK_EQ(f.rejects, 0);
+    CHECK(!step1(100, 5000, NULL));               // same ms: counts as 1 ms
+
+    /* A real step: SENSOR_ROC_REJECT_MAX rejections in a row, then the new level is taken
+     * and the filter re-seeds from it. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .roc_per_s = { 10 } });
+    CHECK(step1(200, 0, NULL));
+    uint32_t t = 0;
+    for (int i = 0; i < SENSOR_ROC_REJECT_MAX; ++i) {
+        t += 2000;
+        CHECK(!step1(500, t, NULL));
+    }
+    CHECK_EQ(f.rejects, SENSOR_ROC_REJECT_MAX);
+    t += 2000;
+    CHECK(step1(500, t, &o) && o == 500);
+    CHECK_EQ(f.rejects, 0);
+    CHECK(!step1(200, t + 2000, NULL));           // the old level is now the outlier
+
+    /* An in-rate value breaks the run: the count starts over. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .roc_per_s = { 10 } });
+    CHECK(step1(200, 0, NULL));
+    CHECK(!step1(500, 1000, NULL));
+    CHECK(!step1(500, 2000, NULL));
+    CHECK(step1(205, 3000, NULL));
+    for (int i = 0; i < SENSOR_ROC_REJECT_MAX; ++i) CHECK(!step1(500, 4000 + (uint32_t)i * 1000, NULL));
+
+    /* Rate check per value; 0 turns it off for that value. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .roc_per_s = { 0, 5 } });
+    v2[0] = 0; v2[1] = 0;
+    CHECK(sensor_filter_step(&f, v2, 2, 0));
+    v2[0] = 100000; v2[1] = 5;
+    CHECK(sensor_filter_step(&f, v2, 2, 1000));
+    v2[0] = 0; v2[1] = 11;
+    CHECK(!sensor_filter_step(&f, v2, 2, 2000));
+
+    /* Rejected values never enter the median window. */
+    sensor_filter_init(&f, &(sensor_filter_cfg_t){ .median_n = 3, .roc_per_s = { 10 } });
+    CHECK(step1(100, 0, NULL));
+    CHECK(!step1(900, 1000, NULL));
+    CHECK(step1(105, 2000, NULL));
+    CHECK(step1(110, 3000, &o) && o == 105);
+
+    HOST_TEST_DONE();
+}
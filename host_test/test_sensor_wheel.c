@@ -0,0 +1,145 @@
+// test_sensor_wheel.c, hashed timer wheel: arm, re-arm, disarm, slot collisions, wrap.
+// Explicit cases first, then random operations checked against a flat list of deadlines.
+#include <string.h>
+#include "host_test.h"
+#include "sensor_wheel.h"
+
+static sensor_wheel_t w;
+
+static uint32_t rng = 0x2545F491u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Reference model: armed ids and their (clamped) deadlines. */
+typedef struct {
+    uint32_t armed;
+    uint32_t due[SENSOR_WHEEL_IDS];
+    uint32_t now;
+} model_t;
+
+static bool le(uint32_t a, uint32_t b) { return (int32_t)(a - b) <= 0; }
+
+static void random_ops(uint32_t start, int rounds) {
+    model_t m = { .now = start };
+    sensor_wheel_init(&w, start);
+    for (int r = 0; r < rounds; ++r) {
+        uint32_t op = xorshift() % 8;
+        unsigned id = xorshift() % 6;                // few ids: plenty of collisions
+        if (op < 3) {
+            /* Near, same-slot-as-others, far (beyond a revolution) or past deadlines. */
+            uint32_t kind = xorshift() % 4, d;
+            if (kind == 0)      d = m.now + xorshift() % 8;
+            else if (kind == 1) d = m.now + SENSOR_WHEEL_SLOTS * (1 + xorshift() % 3);
+            else if (kind == 2) d = m.now + xorshift() % 200;
+            else                d = m.now - xorshift() % 5;
+            sensor_wheel_arm(&w, id, d);
+            m.armed |= 1U << id;
+            m.due[id] = le(d, m.now) ? m.now : d;
+        } else if (op == 3) {
+            sensor_wheel_disarm(&w, id);
+            m.armed &= ~(1U << id);
+        } else {
+            uint32_t step = (op == 7) ? 40 + xorshift() % 100 : xorshift() % 4;   // sometimes > a revolution
+            m.now += step;
+            uint32_t want = 0;
+            for (unsigned i = 0; i < SENSOR_WHEEL_IDS; ++i)
+                if ((m.armed & (1U << i)) && le(m.due[i], m.now)) want |= 1U << i;
+            uint32_t got = sensor_wheel_expire(&w, m.now);
+            if (got != want) {
+                fprintf(stderr, "round %d @%u: fired 0x%x, expected 0x%x\n", r, (unsigned)m.now,
+                        (unsigned)got, (unsigned)want);
+                ++g_fails;
+                return;
+            }
+            m.armed &= ~want;
+        }
+        CHECK_EQ(w.armed, m.armed);
+        uint32_t nd = 0;
+        bool have = sensor_wheel_next(&w, &nd);
+        CHECK_EQ(have, m.armed != 0);
+        if (have) {
+            bool any_earlier = false, hit = false;
+            for (unsigned i = 0; i < SENSOR_WHEEL_IDS; ++i) {
+                if (!(m.armed & (1U << i))) continue;
+                if (m.due[i] == nd) hit = true;
+                if ((int32_t)(m.due[i] - nd) < 0) any_earlier = true;
+            }
+            CHECK(hit && !any_earlier);
+        }
+    }
+}
+
+int main(void) {
+    uint32_t due;
+
+    /* Arm, expire exactly on the due tick, not before. */
+    sensor_wheel_init(&w, 100);
+    CHECK(!sensor_wheel_next(&w, &due));
+    sensor_wheel_arm(&w, 0, 105);
+    CHECK(sensor_wheel_armed(&w, 0));
+    CHECK(sensor_wheel_next(&w, &due) && due == 105);
+    CHECK_EQ(sensor_wheel_expire(&w, 104), 0);
+    CHECK_EQ(sensor_wheel_expire(&w, 105), 1U << 0);
+    CHECK(!sensor_wheel_armed(&w, 0));
+    CHECK_EQ(sensor_wheel_expire(&w, 106), 0);      // fires once
+
+    /* Same slot, different revolutions: only the due one fires. */
+    sensor_wheel_init(&w, 0);
+    sensor_wheel_arm(&w, 1, 10);
+    sensor_wheel_arm(&w, 2, 10 + SENSOR_WHEEL_SLOTS);
+    sensor_wheel_arm(&w, 3, 10);
+    CHECK_EQ(sensor_wheel_expire(&w, 10), (1U << 1) | (1U << 3));
+    CHECK(sensor_wheel_armed(&w, 2));
+    CHECK(sensor_wheel_next(&w, &due) && due == 10 + SENSOR_WHEEL_SLOTS);
+    CHECK_EQ(sensor_wheel_expire(&w, 10 + SENSOR_WHEEL_SLOTS), 1U << 2);
+
+    /* Re-arm moves an id; disarm cancels; past-due fires on the next pass. */
+    sensor_wheel_init(&w, 50);
+    sensor_wheel_arm(&w, 4, 60);
+    sensor_wheel_arm(&w, 4, 55);
+    CHECK(sensor_wheel_next(&w, &due) && due == 55);
+    CHECK_EQ(sensor_wheel_expire(&w, 56), 1U << 4);
+    CHECK_EQ(sensor_wheel_expire(&w, 60), 0);       // the old slot was cleared
+    sensor_wheel_arm(&w, 5, 70);
+    sensor_wheel_disarm(&w, 5);
+    sensor_wheel_disarm(&w, 5);                     // twice is harmless
+    CHECK_EQ(sensor_wheel_expire(&w, 80), 0);
+    sensor_wheel_arm(&w, 6, 10);                    // in the past
+    CHECK(sensor_wheel_next(&w, &due) && due == 80);
+    CHECK_EQ(sensor_wheel_expire(&w, 80), 1U << 6);
+
+    /* A gap longer than a revolution still fires everything due. */
+    sensor_wheel_init(&w, 0);
+    for (unsigned id = 0; id < 8; ++id) sensor_wheel_arm(&w, id, 3 * id + 1);
+    sensor_wheel_arm(&w, 8, 1000);
+    CHECK_EQ(sensor_wheel_expire(&w, 500), 0xFFu);
+    CHECK(sensor_wheel_next(&w, &due) && due == 1000);
+
+    /* The tick counter wraps. */
+    sensor_wheel_init(&w, UINT32_MAX - 3);
+    sensor_wheel_arm(&w, 7, UINT32_MAX - 1);
+    sensor_wheel_arm(&w, 9, 2);                     // after the wrap
+    CHECK(sensor_wheel_next(&w, &due) && due == UINT32_MAX - 1);
+    CHECK_EQ(sensor_wheel_expire(&w, UINT32_MAX), 1U << 7);
+    CHECK_EQ(sensor_wheel_expire(&w, 1), 0);
+    CHECK_EQ(sensor_wheel_expire(&w, 2), 1U << 9);
+
+    /* Ids out of range are ignored. */
+    sensor_wheel_arm(&w, SENSOR_WHEEL_IDS, 5);
+    CHECK_EQ(w.armed, 0);
+    CHECK(!sensor_wheel_armed(&w, SENSOR_WHEEL_IDS));
+
+    /* Align: harmonic periods share the grid. */
+    CHECK_EQ(sensor_wheel_align(41, 20), 60);
+    CHECK_EQ(sensor_wheel_align(40, 20), 40);
+    CHECK_EQ(sensor_wheel_align(41, 0), 41);
+
+    random_ops(0, 200000);
+    random_ops(UINT32_MAX - 5000, 200000);          // crosses the wrap
+
+    HOST_TEST_DONE();
+}
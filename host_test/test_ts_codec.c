@@ -0,0 +1,196 @@
+// test_ts_codec.c, flash time-series block codec: round trips, extremes, block boundaries.
+// Usage: test_ts_codec [<stream.bin> <expect.txt>]
+// With arguments it also writes a `tsdump` capture (<len:le16><block> chunks, zero length
+// at the end) and the samples it holds, one "<ts> <id> <v>..." line each, so the client
+// decoder (app/tsdump.py) can be checked against the encoder.
+#include <stdlib.h>
+#include <string.h>
+#include "host_test.h"
+#include "ts_codec.h"
+
+static uint32_t rng = 0x9E3779B9u;
+static uint32_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Fill one block the way ts_store.c does: records while they fit, then erased bytes. */
+typedef struct {
+    uint8_t  b[TS_BLOCK_SIZE];
+    size_t   pos;
+    ts_delta_t enc;
+    ts_sample_t s[TS_BLOCK_SIZE];
+    size_t   n;
+} block_t;
+
+static void block_open(block_t *k, uint32_t seq, uint32_t t0) {
+    memset(k->b, 0xFF, sizeof(k->b));
+    ts_hdr_pack(k->b, seq, t0);
+    k->pos = TS_HDR_SIZE;
+    k->n = 0;
+    ts_delta_reset(&k->enc, t0);
+}
+
+/* false: does not fit (block full); the delta state is left as it was. */
+static bool block_add(block_t *k, const ts_sample_t *s) {
+    uint8_t rec[TS_REC_MAX];
+    ts_delta_t save = k->enc;
+    size_t n = ts_enc_record(&k->enc, s, rec);
+    if (!n || n > TS_BLOCK_SIZE - k->pos) { k->enc = save; return false; }
+    memcpy(k->b + k->pos, rec, n);
+    k->pos += n;
+    k->s[k->n++] = *s;
+    return true;
+}
+
+static bool same(const ts_sample_t *a, const ts_sample_t *b) {
+    if (a->ts != b->ts || a->id != b->id || a->n != b->n) return false;
+    for (unsigned i = 0; i < a->n; ++i) if (a->v[i] != b->v[i]) return false;
+    return true;
+}
+
+/* Decode a block's first len bytes and compare with what went in. */
+static void check_block(const block_t *k, size_t len, const char *what) {
+    ts_block_hdr_t h;
+    CHECK(ts_hdr_parse(k->b, &h));
+    ts_delta_t d;
+    ts_delta_reset(&d, h.t0);
+    size_t pos = TS_HDR_SIZE, i = 0;
+    ts_sample_t s;
+    while (ts_dec_record(&d, k->b, len, &pos, &s)) {
+        if (i >= k->n || !same(&s, &k->s[i])) {
+            fprintf(stderr, "%s: record %zu differs\n", what, i);
+            ++g_fails;
+            return;
+        }
+        ++i;
+    }
+    if (i != k->n || pos != k->pos) {
+        fprintf(stderr, "%s: %zu of %zu records, stopped at %zu of %zu\n", what, i, k->n, pos, k->pos);
+        ++g_fails;
+    }
+    CHECK_EQ(ts_block_used(k->b, len), k->pos);
+}
+
+static ts_sample_t rnd_sample(uint32_t ts) {
+    ts_sample_t s = { .ts = ts, .id = (uint8_t)(xorshift() % TS_MAX_IDS),
+                      .n = (uint8_t)(1 + xorshift() % TS_MAX_VALUES) };
+    for (unsigned i = 0; i < s.n; ++i) {
+        switch (xorshift() % 4) {
+            case 0:  s.v[i] = (int32_t)(xorshift() % 41) - 20; break;         // small, both signs
+            case 1:  s.v[i] = (xorshift() & 1) ? INT32_MAX : INT32_MIN; break; // largest swings
+            case 2:  s.v[i] = (int32_t)xorshift(); break;
+            default: s.v[i] = 250 + (int32_t)(xorshift() % 5); break;          // a steady sensor
+        }
+    }
+    return s;
+}
+
+static block_t k;
+
+int main(int argc, char **argv) {
+    /* Header: round trip; a torn header (seq vs ~seq) is not a block. */
+    uint8_t h[TS_HDR_SIZE];
+    ts_block_hdr_t bh;
+    ts_hdr_pack(h, 0xDEADBEEF, 1234567);
+    CHECK(ts_hdr_parse(h, &bh) && bh.seq == 0xDEADBEEF && bh.t0 == 1234567);
+    CHECK(memcmp(h, "TSB1", 4) == 0);
+    h[12] ^= 1;
+    CHECK(!ts_hdr_parse(h, NULL));
+    memset(h, 0xFF, sizeof(h));
+    CHECK(!ts_hdr_parse(h, NULL));
+
+    /* Record sizes: a steady value is 3 bytes; the worst case is TS_REC_MAX. */
+    ts_delta_t d;
+    uint8_t rec[TS_REC_MAX];
+    ts_delta_reset(&d, 100);
+    ts_sample_t s = { .ts = 100, .id = 1, .n = 1, .v = { 0 } };
+    CHECK_EQ(ts_enc_record(&d, &s, rec), 3);
+    ts_delta_reset(&d, 0);
+    s = (ts_sample_t){ .ts = 0x7FFFFFFF, .id = TS_MAX_IDS - 1, .n = TS_MAX_VALUES,
+                       .v = { INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN } };
+    CHECK_EQ(ts_enc_record(&d, &s, rec), TS_REC_MAX);
+    /* ...and the full swing back: delta INT32_MAX - INT32_MIN wraps, still exact. */
+    ts_sample_t s2 = s;
+    for (int i = 0; i < TS_MAX_VALUES; ++i) s2.v[i] = INT32_MAX;
+    uint8_t rec2[TS_REC_MAX];
+    size_t n2 = ts_enc_record(&d, &s2, rec2);
+    CHECK(n2 > 0);
+    ts_delta_t dd;
+    ts_delta_reset(&dd, 0);
+    size_t pos = 0;
+    ts_sample_t o;
+    CHECK(ts_dec_record(&dd, rec, TS_REC_MAX, &pos, &o) && same(&o, &s) && pos == TS_REC_MAX);
+    pos = 0;
+    CHECK(ts_dec_record(&dd, rec2, n2, &pos, &o) && same(&o, &s2));
+
+    /* Refused: id/n out of range, time going backwards (the state does not move). */
+    ts_delta_reset(&d, 1000);
+    CHECK_EQ(ts_enc_record(&d, &(ts_sample_t){ .ts = 1000, .id = TS_MAX_IDS, .n = 1 }, rec), 0);
+    CHECK_EQ(ts_enc_record(&d, &(ts_sample_t){ .ts = 1000, .id = 0, .n = 0 }, rec), 0);
+    CHECK_EQ(ts_enc_record(&d, &(ts_sample_t){ .ts = 1000, .id = 0, .n = TS_MAX_VALUES + 1 }, rec), 0);
+    CHECK_EQ(ts_enc_record(&d, &(ts_sample_t){ .ts = 999, .id = 0, .n = 1 }, rec), 0);
+    CHECK_EQ(d.last_ts, 1000);
+
+    /* Sign flips: zigzag keeps +-1 steps one byte; 63 <-> -64 is a 127 step, two bytes. */
+    block_open(&k, 1, 50);
+    for (int i = 0; i < 40; ++i) {
+        s = (ts_sample_t){ .ts = 50 + (uint32_t)i, .id = 2, .n = 2, .v = { (i & 1) ? -1 : 1, (i & 1) ? -64 : 63 } };
+        CHECK(block_add(&k, &s));
+    }
+    CHECK_EQ(k.pos, TS_HDR_SIZE + 4 + 39 * 5);   // the first record is against 0: 1 and 63
+    check_block(&k, TS_BLOCK_SIZE, "sign flips");
+
+    /* Random blocks filled to the brim: the next record did not fit. Decoding stops at
+     * the erased tail, or exactly at the end when the dump trims it. */
+    FILE *bin = NULL, *txt = NULL;
+    if (argc == 3) {
+        bin = fopen(argv[1], "wb");
+        txt = fopen(argv[2], "w");
+        CHECK(bin && txt);
+    }
+    uint32_t ts = 1000;
+    for (uint32_t seq = 7; seq < 7 + 6; ++seq) {
+        block_open(&k, seq, ts);
+        for (;;) {
+            ts += (xorshift() % 8 == 0) ? xorshift() % 100000 : xorshift() % 3;
+            ts_sample_t r = rnd_sample(ts);
+            if (!block_add(&k, &r)) break;
+        }
+        CHECK(k.pos > TS_BLOCK_SIZE - TS_REC_MAX);
+        check_block(&k, TS_BLOCK_SIZE, "full block");
+        check_block(&k, k.pos, "trimmed block");
+        if (bin && txt) {
+            const uint8_t len[2] = { (uint8_t)k.pos, (uint8_t)(k.pos >> 8) };
+            fwrite(len, 1, 2, bin);
+            fwrite(k.b, 1, k.pos, bin);
+            for (size_t i = 0; i < k.n; ++i) {
+                fprintf(txt, "%u %u", (unsigned)k.s[i].ts, (unsigned)k.s[i].id);
+                for (unsigned j = 0; j < k.s[i].n; ++j) fprintf(txt, " %d", (int)k.s[i].v[j]);
+                fputc('\n', txt);
+            }
+        }
+    }
+    if (bin) { fwrite("\0\0", 1, 2, bin); fclose(bin); }
+    if (txt) fclose(txt);
+
+    /* A record cut short (power lost mid-page) ends the data before it, as does erased
+     * flash inside a varint. */
+    block_open(&k, 1, 0);
+    for (uint32_t i = 0; i < 5; ++i) {
+        s = rnd_sample(i);
+        CHECK(block_add(&k, &s));
+    }
+    size_t full = k.pos;
+    s = (ts_sample_t){ .ts = 9, .id = 3, .n = 4, .v = { INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX } };
+    CHECK(block_add(&k, &s));
+    CHECK_EQ(ts_block_used(k.b, k.pos - 1), full);
+    k.b[k.pos - 1] = 0xFF;
+    CHECK_EQ(ts_block_used(k.b, TS_BLOCK_SIZE), full);
+    memset(k.b, 0xFF, TS_HDR_SIZE);
+    CHECK_EQ(ts_block_used(k.b, TS_BLOCK_SIZE), 0);
+
+    HOST_TEST_DONE();
+}
@@ -0,0 +1,131 @@
+// test_wifi_fast.c, wifi_fast_* driven by scripted Wi-Fi events.
+// Each step is what wifi_cache.c feeds the module for one driver event, at a time in ms.
+#include <string.h>
+#include "host_test.h"
+#include "wifi_fast.h"
+
+typedef enum {
+    EV_ATTEMPT,      // wifi_connect_attempt(): expect = path picked
+    EV_DISC,         // WIFI_EVENT_STA_DISCONNECTED (attempt failed or link lost)
+    EV_GOT_IP,       // IP_EVENT_STA_GOT_IP from AP1: expect = winning path, ms = time-to-IP
+    EV_SSID,         // credentials changed: forget, connect to `ssid` from now on
+    EV_END,
+} ev_t;
+
+typedef struct {
+    uint32_t t_ms;
+    ev_t ev;
+    int expect;      // wifi_path_t, or -1
+    uint32_t ms;     // EV_GOT_IP: expected time-to-IP
+    uint8_t fails;   // fast_fails after the step
+} step_t;
+
+static const wifi_fast_cache_t AP1 = {
+    .channel = 6, .bssid = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55}, .ssid = "lab",
+    .ip = 0x0501a8c0, .gw = 0x0101a8c0, .netmask = 0x00ffffff,
+};
+
+static wifi_fast_t f;
+static char ssid[33];
+
+static void run(const char *name, const step_t *s) {
+    for (; s->ev != EV_END; ++s) {
+        int64_t now = (int64_t)s->t_ms * 1000;
+        int got = -1;
+        uint32_t ms = 0;
+        switch (s->ev) {
+        case EV_ATTEMPT:
+            got = wifi_fast_next_attempt(&f, ssid, now);
+            break;
+        case EV_DISC:
+            wifi_fast_on_disconnect(&f);
+            break;
+        case EV_GOT_IP:
+            got = wifi_fast_on_got_ip(&f, now, AP1.ip, &ms);
+            wifi_fast_learn(&f, &AP1);
+            CHECK_EQ(ms, s->ms);
+            break;
+        case EV_SSID:
+            wifi_fast_forget(&f);
+            strcpy(ssid, "other");
+            break;
+        default:
+            break;
+        }
+        if (s->expect >= 0 && got != s->expect) {
+            fprintf(stderr, "%s @%u ms: path %d, expected %d\n", name, (unsigned)s->t_ms, got, s->expect);
+            ++g_fails;
+        }
+        CHECK_EQ(f.fast_fails, s->fails);
+    }
+}
+
+int main(void) {
+    /* Cold boot, empty NVS: full scan, learn the AP. */
+    strcpy(ssid, "lab");
+    wifi_fast_init(&f, NULL);
+    CHECK(!wifi_fast_ready(&f, ssid));
+    run("cold", (const step_t[]){
+        {   10, EV_ATTEMPT, WIFI_PATH_SLOW, 0, 0 },
+        { 3210, EV_GOT_IP,  WIFI_PATH_SLOW, 3200, 0 },
+        {    0, EV_END, -1, 0, 0 },
+    });
+    CHECK(f.cache_valid && !f.lease_reused);
+    CHECK_EQ(f.st[WIFI_PATH_SLOW].count, 1);
+
+    /* OTA reboot with the cache in NVS: directed connect, same lease. */
+    wifi_fast_cache_t nvs = f.cache;
+    wifi_fast_init(&f, &nvs);
+    run("reboot", (const step_t[]){
+        {   10, EV_ATTEMPT, WIFI_PATH_FAST, 0, 0 },
+        {  460, EV_GOT_IP,  WIFI_PATH_FAST, 450, 0 },
+        {    0, EV_END, -1, 0, 0 },
+    });
+    CHECK(f.lease_reused);
+    CHECK_EQ(f.st[WIFI_PATH_FAST].min_ms, 450);
+
+    /* A working link drops several times: none of that is a directed-connect failure. */
+    run("drops", (const step_t[]){
+        { 60000, EV_DISC,    -1, 0, 0 },
+        { 60100, EV_ATTEMPT, WIFI_PATH_FAST, 0, 0 },
+        { 60700, EV_GOT_IP,  WIFI_PATH_FAST, 600, 0 },
+        { 90000, EV_DISC,    -1, 0, 0 },
+        { 95000, EV_DISC,    -1, 0, 0 },   // late duplicate event: still no attempt in flight
+        { 95100, EV_ATTEMPT, WIFI_PATH_FAST, 0, 0 },
+        { 95600, EV_GOT_IP,  WIFI_PATH_FAST, 500, 0 },
+        {     0, EV_END, -1, 0, 0 },
+    });
+
+    /* AP moved: directed connects fail WIFI_FAST_MAX_FAILS times, then full scans until
+     * one succeeds; time-to-IP runs from the first attempt of the cycle. */
+    run("moved", (const step_t[]){
+        { 100000, EV_DISC,    -1, 0, 0 },
+        { 100100, EV_ATTEMPT, WIFI_PATH_FAST, 0, 0 },
+        { 103100, EV_DISC,    -1, 0, 1 },
+        { 103600, EV_ATTEMPT, WIFI_PATH_FAST, 0, 1 },
+        { 106600, EV_DISC,    -1, 0, 2 },
+        { 107600, EV_ATTEMPT, WIFI_PATH_SLOW, 0, 2 },
+        { 110600, EV_DISC,    -1, 0, 2 },
+        { 112600, EV_ATTEMPT, WIFI_PATH_SLOW, 0, 2 },
+        { 115100, EV_GOT_IP,  WIFI_PATH_SLOW, 15000, 0 },
+        {      0, EV_END, -1, 0, 0 },
+    });
+    CHECK(wifi_fast_ready(&f, "lab"));
+    CHECK_EQ(f.st[WIFI_PATH_SLOW].max_ms, 15000);
+
+    /* New credentials: the cached AP is for another SSID. */
+    run("creds", (const step_t[]){
+        { 200000, EV_SSID,    -1, 0, 0 },
+        { 200100, EV_DISC,    -1, 0, 0 },
+        { 200200, EV_ATTEMPT, WIFI_PATH_SLOW, 0, 0 },
+        {      0, EV_END, -1, 0, 0 },
+    });
+    CHECK(!f.cache_valid);
+
+    /* A bad blob from NVS is ignored. */
+    nvs.ver = WIFI_FAST_CACHE_VER + 1;
+    wifi_fast_init(&f, &nvs);
+    CHECK(!f.cache_valid);
+
+    HOST_TEST_DONE();
+}
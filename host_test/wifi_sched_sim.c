@@ -0,0 +1,239 @@
+// wifi_sched_sim.c, replays disconnect traces through wifi_sched_next().
+// Usage: wifi_sched_sim [-s seed] <trace>...
+// A trace describes what the AP does after the link drops at t=0; each connect attempt
+// fails with the reason in force when it starts, or succeeds once the trace says UP.
+// Per trace it reports time-to-reconnect, attempts, escalations and the policy rows used,
+// then checks the trace's `expect` lines (exit status 1 if one fails).
+//
+// Trace lines ('#' starts a comment):
+//   <t_ms> <REASON> [REASON...]   from t_ms on attempts fail; several reasons take turns
+//   <t_ms> UP                     from t_ms on attempts succeed
+//   attempt_ms <ms>               how long one attempt takes (default 1000)
+//   end_ms <ms>                   stop there if still down (default 1 h)
+//   expect escalate_by <n>        first escalation at failure <= n (0: never escalates)
+//   expect reconnect_max_ms <ms>  reconnected within ms
+//   expect attempts_max <n>       at most n attempts
+//   expect parked <0|1>           a policy gave up
+//   expect backoff_after <n> <ms> every delay after failure n is >= ms
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wifi_sched.h"
+
+#define MAX_SEGS    32
+#define MAX_REASONS 8
+
+/* errsrc.c's canonical names (that file needs the RTOS). */
+static const char *const s_name[ES_COUNT] = {
+    [ES_NONE] = "NONE", [ES_NO_CREDS] = "NO_CREDS", [ES_IP_LOST] = "IP_LOST",
+    [ES_AUTH_EXPIRE] = "AUTH_EXPIRE", [ES_AUTH_FAIL] = "AUTH_FAIL", [ES_NO_AP] = "NO_AP",
+    [ES_4WAY_TIMEOUT] = "4WAY_TIMEOUT", [ES_ASSOC_EXPIRE] = "ASSOC_EXPIRE",
+    [ES_BEACON_TO] = "BEACON_TO", [ES_DISCONNECTED] = "DISCONNECTED",
+    [ES_TRYING] = "TRYING", [ES_SCANNING] = "SCANNING",
+};
+
+typedef struct {
+    uint32_t t_ms;
+    bool     up;
+    uint8_t  n;
+    errsrc_t reason[MAX_REASONS];
+} seg_t;
+
+typedef struct {
+    seg_t    seg[MAX_SEGS];
+    int      nseg;
+    uint32_t attempt_ms;
+    uint32_t end_ms;
+    /* expectations; negative = not given */
+    long escalate_by, reconnect_max_ms, attempts_max, parked, backoff_n, backoff_ms;
+} trace_t;
+
+typedef struct {
+    bool     reconnected;
+    uint32_t reconnect_ms;
+    uint32_t attempts;
+    uint32_t escalations;
+    uint32_t first_esc;          // failure number of the first escalation (0 = none)
+    bool     parked;
+    uint32_t min_late_delay;     // smallest delay after failure backoff_n
+    uint32_t fails[ES_COUNT];    // failures per policy row
+    uint64_t delay_sum[ES_COUNT];
+    uint32_t delay_max[ES_COUNT];
+} result_t;
+
+static uint32_t s_rng;
+
+static uint32_t xorshift(void) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static int reason_of(const char *w) {
+    for (int i = 0; i < ES_COUNT; ++i) {
+        if (strcmp(w, s_name[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static bool load(const char *path, trace_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->attempt_ms = 1000;
+    t->end_ms = 3600000;
+    t->escalate_by = t->reconnect_max_ms = t->attempts_max = t->parked = t->backoff_n = -1;
+
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return false; }
+    char line[256];
+    int ln = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++ln;
+        char *h = strchr(line, '#');
+        if (h) *h = '\0';
+        char *w[2 + MAX_REASONS];
+        int n = 0;
+        for (char *tok = strtok(line, " \t\r\n"); tok && n < 2 + MAX_REASONS; tok = strtok(NULL, " \t\r\n")) {
+            w[n++] = tok;
+        }
+        if (!n) continue;
+
+        if (strcmp(w[0], "attempt_ms") == 0 && n == 2) {
+            t->attempt_ms = (uint32_t)strtoul(w[1], NULL, 10);
+        } else if (strcmp(w[0], "end_ms") == 0 && n == 2) {
+            t->end_ms = (uint32_t)strtoul(w[1], NULL, 10);
+        } else if (strcmp(w[0], "expect") == 0 && n >= 3) {
+            long v = strtol(w[2], NULL, 10);
+            if      (strcmp(w[1], "escalate_by") == 0)      t->escalate_by = v;
+            else if (strcmp(w[1], "reconnect_max_ms") == 0) t->reconnect_max_ms = v;
+            else if (strcmp(w[1], "attempts_max") == 0)     t->attempts_max = v;
+            else if (strcmp(w[1], "parked") == 0)           t->parked = v;
+            else if (strcmp(w[1], "backoff_after") == 0 && n == 4) {
+                t->backoff_n = v;
+                t->backoff_ms = strtol(w[3], NULL, 10);
+            } else ok = false;
+        } else if (isdigit((unsigned char)w[0][0]) && n >= 2 && t->nseg < MAX_SEGS) {
+            seg_t *s = &t->seg[t->nseg++];
+            s->t_ms = (uint32_t)strtoul(w[0], NULL, 10);
+            s->up = strcmp(w[1], "UP") == 0;
+            for (int i = 1; !s->up && i < n; ++i) {
+                int r = reason_of(w[i]);
+                if (r < 0) { ok = false; break; }
+                s->reason[s->n++] = (errsrc_t)r;
+            }
+        } else {
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (!ok) fprintf(stderr, "%s:%d: bad line\n", path, ln);
+    if (ok && (!t->nseg || t->seg[0].t_ms != 0 || t->seg[0].up)) {
+        fprintf(stderr, "%s: must start with a failure at t=0\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+static const seg_t *seg_at(const trace_t *t, uint32_t ms) {
+    const seg_t *s = &t->seg[0];
+    for (int i = 1; i < t->nseg && t->seg[i].t_ms <= ms; ++i) s = &t->seg[i];
+    return s;
+}
+
+static void run(const trace_t *t, result_t *r) {
+    memset(r, 0, sizeof(*r));
+    r->min_late_delay = UINT32_MAX;
+    wifi_sched_t s;
+    wifi_sched_reset(&s);
+
+    uint32_t now = 0, turn = 0, nf = 0;
+    const seg_t *g = seg_at(t, 0);
+    errsrc_t reason = g->reason[0];     // the drop itself
+    for (;;) {
+        wifi_sched_decision_t d = wifi_sched_next(&s, reason, xorshift());
+        ++nf;
+        r->fails[reason]++;
+        r->delay_sum[reason] += d.delay_ms;
+        if (d.delay_ms > r->delay_max[reason]) r->delay_max[reason] = d.delay_ms;
+        if (d.escalate && !r->escalations++) r->first_esc = nf;
+        if (d.parked) r->parked = true;
+        if (t->backoff_n >= 0 && nf > (uint32_t)t->backoff_n && d.delay_ms < r->min_late_delay) {
+            r->min_late_delay = d.delay_ms;
+        }
+
+        now += d.delay_ms;
+        if (now >= t->end_ms) return;
+        r->attempts++;
+        g = seg_at(t, now);
+        now += t->attempt_ms;
+        if (g->up) {
+            r->reconnected = true;
+            r->reconnect_ms = now;
+            return;
+        }
+        reason = g->reason[turn++ % g->n];
+    }
+}
+
+static bool check(const char *what, bool ok, long got, long want) {
+    if (!ok) printf("  FAIL %s: got %ld, expected %ld\n", what, got, want);
+    return ok;
+}
+
+static bool report(const char *path, const trace_t *t, const result_t *r) {
+    printf("%s: ", path);
+    if (r->reconnected) printf("reconnected after %.1f s", r->reconnect_ms / 1000.0);
+    else printf("still down after %.1f s", t->end_ms / 1000.0);
+    printf(", %u attempts, %u escalations", (unsigned)r->attempts, (unsigned)r->escalations);
+    if (r->first_esc) printf(" (first at failure %u)", (unsigned)r->first_esc);
+    printf("%s\n", r->parked ? ", parked" : "");
+    for (int i = 0; i < ES_COUNT; ++i) {
+        if (!r->fails[i]) continue;
+        printf("  %-13s %4u failures, delay avg %6u ms, max %6u ms\n", s_name[i], (unsigned)r->fails[i],
+               (unsigned)(r->delay_sum[i] / r->fails[i]), (unsigned)r->delay_max[i]);
+    }
+
+    bool ok = true;
+    if (t->escalate_by == 0) {
+        ok &= check("escalations", r->escalations == 0, r->escalations, 0);
+    } else if (t->escalate_by > 0) {
+        ok &= check("first escalation", r->first_esc && r->first_esc <= t->escalate_by,
+                    r->first_esc, t->escalate_by);
+    }
+    if (t->reconnect_max_ms >= 0) {
+        ok &= check("reconnect_ms", r->reconnected && r->reconnect_ms <= t->reconnect_max_ms,
+                    r->reconnected ? (long)r->reconnect_ms : -1, t->reconnect_max_ms);
+    }
+    if (t->attempts_max >= 0) ok &= check("attempts", r->attempts <= t->attempts_max, r->attempts, t->attempts_max);
+    if (t->parked >= 0) ok &= check("parked", r->parked == (t->parked != 0), r->parked, t->parked);
+    if (t->backoff_n >= 0 && r->min_late_delay != UINT32_MAX) {
+        ok &= check("delay after backoff_n", r->min_late_delay >= t->backoff_ms,
+                    r->min_late_delay, t->backoff_ms);
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t seed = 1;
+    int i = 1;
+    if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+        seed = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        i += 2;
+    }
+    if (i >= argc) {
+        fprintf(stderr, "usage: %s [-s seed] <trace>...\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for (; i < argc; ++i) {
+        trace_t t;
+        result_t r;
+        s_rng = seed ? seed : 1;
+        if (!load(argv[i], &t)) { ok = false; continue; }
+        run(&t, &r);
+        ok &= report(argv[i], &t, &r);
+    }
+    return ok ? 0 : 1;
+}
@@ -12,8 +12,37 @@
 #include "cmd_router.h"
 #include "led.h"
 #include "dht.h"
+#include "ts_store.h"
+#include "boottime.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* LED + DHT only touch their own GPIOs; bring them up off the critical path. */
+static void periph_init(void) {
+    // LED driver init (no task needed for simple on/off).
+    ESP_ERROR_CHECK(led_init());
+
+    // DHT sampler.
+    dht_cfg_t dcfg = {.gpio = DHT_GPIO, .period_ms = DHT_PERIOD_MS, .median_n = DHT_MEDIAN_N,
+                      .roc_t_dc = DHT_ROC_T_DC, .roc_rh_dp = DHT_ROC_RH_DP};
+    ESP_ERROR_CHECK(dht_init(&dcfg));
+    ESP_ERROR_CHECK(dht_start());
+
+    // Flash time-series of every registered sensor; history is nice-to-have, not fatal.
+    esp_err_t e = ts_store_init(TS_LOG_EVERY_S);
+    if (e != ESP_OK) ESP_LOGW("MAIN", "time-series store: %s", esp_err_to_name(e));
+
+    boottime_mark(BT_PERIPH_READY);
+}
+
+static void periph_init_task(void *arg) {
+    (void)arg;
+    periph_init();
+    vTaskDelete(NULL);
+}
 
 void app_main(void) {
+    boottime_mark(BT_APP_MAIN);
     // sdkconfig's global verbosity (Menuconfig => Log output => Default log verbosity).
     esp_log_level_set("*", CONFIG_LOG_DEFAULT_LEVEL);
 
@@ -25,6 +54,7 @@ void app_main(void) {
     } else {
         ESP_ERROR_CHECK(err);
     }
+    boottime_mark(BT_NVS_READY);
 
     // If we booted the factory image, clear any stale post-rollback latch.
     const esp_partition_t *run = esp_ota_get_running_partition();
@@ -32,19 +62,20 @@ void app_main(void) {
         bootflag_set_post_rollback(false);
     }
 
-    syscoord_init();  // System coordination.
-    // Command routing.
-    cmd_bus_init();
-   
-    // DHT sampler.
-    dht_cfg_t dcfg = {.gpio = DHT_GPIO, .period_ms = DHT_PERIOD_MS};
-    ESP_ERROR_CHECK(dht_init(&dcfg));
-    ESP_ERROR_CHECK(dht_start()); 
+    syscoord_init();  // System coordination (must precede Wi-Fi events).
+    boottime_mark(BT_SYSCOORD_READY);
 
-    // LED driver init (no task needed for simple on/off).
-    ESP_ERROR_CHECK(led_init());
+    // Command routing (cheap; must be up before the first TCP client).
+    cmd_bus_init();
     cmd_router_start();
+    boottime_mark(BT_CMD_READY);
+
+    // Peripherals in parallel with the Wi-Fi bring-up below.
+    if (xTaskCreate(periph_init_task, "init.periph", 3072, NULL, 4, NULL) != pdPASS) {
+        periph_init();  // no room for a helper task: do it inline.
+    }
 
+    // Wi-Fi is the long pole (PHY cal, scan, DHCP); start it as early as deps allow.
     // Use saved credentials from NVS.
     // wifi_start("ssid", "password");
     wifi_start(NULL, NULL);